@@ -27,9 +27,18 @@
 #include "math/mMatrix.h"
 #include "T3D/gameBase/moveManager.h"
 #include "console/engineAPI.h"
+#include "T3D/gameBase/gameProcess.h"
+#include "platform/profiler.h"
+
+#ifdef TORQUE_NAVIGATION_ENABLED
+#include "navigation/navMesh.h"
+#endif
 
 IMPLEMENT_CO_NETOBJECT_V1(AIPlayer);
 
+Vector<AIPlayer::LOSCheck> AIPlayer::smLOSChecks;
+bool AIPlayer::smLOSFlushHooked = false;
+
 ConsoleDocClass( AIPlayer,
 	"@brief A Player object not controlled by conventional input, but by an AI engine.\n\n"
 
@@ -49,6 +58,9 @@ ConsoleDocClass( AIPlayer,
    "The actual point at which this callback is called is when the AIPlayer is within the mMoveTolerance "
    "of the defined destination.\n\n"
 
+   "void onPathFailed(AIPlayer obj) \n"
+   "Called when no path could be found to the destination given to setPathDestination().\n\n"
+
    "void onMoveStuck(AIPlayer obj) \n"
    "While in motion, if an AIPlayer has moved less than moveStuckTolerance within a single tick, this "
    "callback is called.  From here you could choose an alternate destination to get the AIPlayer moving "
@@ -99,6 +111,11 @@ AIPlayer::AIPlayer()
    mAimOffset = Point3F(0.0f, 0.0f, 0.0f);
 
    mIsAiControlled = true;
+
+#ifdef TORQUE_NAVIGATION_ENABLED
+   mPathIndex = -1;
+   mPathSlowdown = true;
+#endif
 }
 
 /**
@@ -106,6 +123,9 @@ AIPlayer::AIPlayer()
  */
 AIPlayer::~AIPlayer()
 {
+#ifdef TORQUE_NAVIGATION_ENABLED
+   clearPath();
+#endif
 }
 
 void AIPlayer::initPersistFields()
@@ -166,6 +186,9 @@ void AIPlayer::setMoveSpeed( F32 speed )
 void AIPlayer::stopMove()
 {
    mMoveState = ModeStop;
+#ifdef TORQUE_NAVIGATION_ENABLED
+   clearPath();
+#endif
 }
 
 /**
@@ -186,6 +209,9 @@ void AIPlayer::setMoveTolerance( const F32 tolerance )
  */
 void AIPlayer::setMoveDestination( const Point3F &location, bool slowdown )
 {
+#ifdef TORQUE_NAVIGATION_ENABLED
+   clearPath();
+#endif
    mMoveDestination = location;
    mMoveState = ModeMove;
    mMoveSlowdown = slowdown;
@@ -338,7 +364,13 @@ bool AIPlayer::getAIMove(Move *movePtr)
       if (mFabs(xDiff) < mMoveTolerance && mFabs(yDiff) < mMoveTolerance) 
       {
          mMoveState = ModeStop;
+#ifdef TORQUE_NAVIGATION_ENABLED
+         // Carry on to the next node if we're following a path.
+         if (!moveToNextPathNode())
+            throwCallback("onReachDestination");
+#else
          throwCallback("onReachDestination");
+#endif
       }
       else 
       {
@@ -423,22 +455,9 @@ bool AIPlayer::getAIMove(Move *movePtr)
       eyeMat.getColumn(3,&location);
       Point3F targetLoc = mAimObject->getBoxCenter();
 
-      // This ray ignores non-static shapes. Cast Ray returns true
-      // if it hit something.
-      RayInfo dummy;
-      if (getContainer()->castRay( location, targetLoc,
-            StaticShapeObjectType | StaticObjectType |
-            TerrainObjectType, &dummy)) {
-         if (mTargetInLOS) {
-            throwCallback( "onTargetExitLOS" );
-            mTargetInLOS = false;
-         }
-      }
-      else
-         if (!mTargetInLOS) {
-            throwCallback( "onTargetEnterLOS" );
-            mTargetInLOS = true;
-         }
+      // The test is cast along with those of all other AIPlayers
+      // once the tick is over.
+      queueLOSCheck( location, targetLoc );
    }
 
    // Replicate the trigger state into the move so that
@@ -451,6 +470,161 @@ bool AIPlayer::getAIMove(Move *movePtr)
    return true;
 }
 
+/**
+ * Queues a line of sight test to the aim object for the end of the tick
+ *
+ * @param start Eye position
+ * @param end Target position
+ */
+void AIPlayer::queueLOSCheck( const Point3F &start, const Point3F &end )
+{
+   if ( !smLOSFlushHooked )
+   {
+      ServerProcessList::get()->postTickSignal().notify( &AIPlayer::_flushLOSChecks );
+      smLOSFlushHooked = true;
+   }
+
+   smLOSChecks.increment();
+   LOSCheck &check = smLOSChecks.last();
+   check.player = this;
+
+   // This ray ignores non-static shapes.
+   check.ray.start = start;
+   check.ray.end = end;
+   check.ray.mask = StaticShapeObjectType | StaticObjectType | TerrainObjectType;
+   check.ray.exempt = NULL;
+}
+
+/**
+ * Updates whether the aim object is in sight, calling back on changes
+ *
+ * @param inLOS True if nothing blocks the line of sight
+ */
+void AIPlayer::setTargetInLOS( bool inLOS )
+{
+   // The aim may have been cleared since the test was queued.
+   if ( !mAimObject || inLOS == mTargetInLOS )
+      return;
+
+   mTargetInLOS = inLOS;
+   throwCallback( inLOS ? "onTargetEnterLOS" : "onTargetExitLOS" );
+}
+
+/**
+ * Casts the queued line of sight tests as one batch
+ */
+void AIPlayer::_flushLOSChecks( SimTime timeDelta )
+{
+   if ( smLOSChecks.empty() )
+      return;
+
+   PROFILE_SCOPE( AIPlayer_flushLOSChecks );
+
+   // Callbacks may run script, so work on our own copy.
+   Vector<LOSCheck> checks = smLOSChecks;
+   smLOSChecks.clear();
+
+   Vector<SceneContainer::BatchRay> rays( checks.size() );
+   rays.setSize( checks.size() );
+   for ( U32 i = 0; i < checks.size(); i++ )
+      rays[i] = checks[i].ray;
+
+   Vector<bool> blocked( checks.size() );
+   blocked.setSize( checks.size() );
+
+   // Any hit means the line of sight is blocked, so there is no need to
+   // find the nearest.
+   gServerContainer.castRayBatch( rays.address(), rays.size(), blocked.address(), NULL, true );
+
+   for ( U32 i = 0; i < checks.size(); i++ )
+   {
+      AIPlayer *player = checks[i].player;
+      if ( player )
+         player->setTargetInLOS( !blocked[i] );
+   }
+}
+
+#ifdef TORQUE_NAVIGATION_ENABLED
+/**
+ * Requests a path to a location on a NavMesh, which the bot will follow
+ * once it has been planned
+ *
+ * @param mesh NavMesh to plan on
+ * @param location Point to run to
+ * @param slowdown Slow down when nearing the end of the path
+ * @param priority Priority of the path request
+ */
+bool AIPlayer::setPathDestination( NavMesh *mesh, const Point3F &location, bool slowdown, F32 priority )
+{
+   clearPath();
+
+   if ( !mesh )
+      return false;
+
+   mPathSlowdown = slowdown;
+   mPathQuery = new NavPathQuery( mesh, getPosition(), location, priority );
+   mPathQuery->mOnComplete.bind( this, &AIPlayer::onPathQueryComplete );
+   NAVQUERIES->submit( mPathQuery );
+
+   return true;
+}
+
+/**
+ * Cancels any pending path request and stops following the current path
+ */
+void AIPlayer::clearPath()
+{
+   if ( mPathQuery )
+      mPathQuery->cancel();
+   mPathQuery = NULL;
+   mPathPoints.clear();
+   mPathIndex = -1;
+}
+
+void AIPlayer::onPathQueryComplete( NavPathQuery *query )
+{
+   if ( query != mPathQuery )
+      return;
+
+   mPathQuery = NULL;
+
+   if ( !query->isSuccess() )
+   {
+      throwCallback( "onPathFailed" );
+      return;
+   }
+
+   // The first node is our starting position.
+   mPathPoints = query->getPoints();
+   mPathIndex = 0;
+   if ( !moveToNextPathNode() )
+      throwCallback( "onReachDestination" );
+}
+
+/**
+ * Heads for the next node of the path we are following
+ *
+ * @return False if there are no nodes left
+ */
+bool AIPlayer::moveToNextPathNode()
+{
+   if ( mPathIndex < 0 || mPathIndex + 1 >= mPathPoints.size() )
+   {
+      mPathPoints.clear();
+      mPathIndex = -1;
+      return false;
+   }
+
+   mPathIndex++;
+   mMoveDestination = mPathPoints[mPathIndex];
+   mMoveState = ModeMove;
+   mMoveSlowdown = mPathSlowdown && mPathIndex == mPathPoints.size() - 1;
+   mMoveStuckTestCountdown = mMoveStuckTestDelay;
+
+   return true;
+}
+#endif
+
 /**
  * Utility function to throw callbacks. Callbacks always occure
  * on the datablock class.
@@ -520,6 +694,27 @@ DefineEngineMethod( AIPlayer, setMoveDestination, void, ( Point3F goal, bool slo
    object->setMoveDestination( goal, slowDown);
 }
 
+#ifdef TORQUE_NAVIGATION_ENABLED
+DefineEngineMethod( AIPlayer, setPathDestination, bool, ( NavMesh *mesh, Point3F goal, bool slowDown, F32 priority ), ( true, 1.0f ),
+   "@brief Tells the AI to find a path across a NavMesh to the location provided and follow it\n\n"
+
+   "The path is planned on worker threads, so the bot will start moving a short time after "
+   "this call.  If no path can be found, onPathFailed is called on the datablock.\n\n"
+
+   "@param mesh The NavMesh to plan the path on.\n"
+   "@param goal Coordinates in world space representing location to move to.\n"
+   "@param slowDown A boolean value. If set to true, the bot will slow down "
+   "when it gets within 5-meters of the end of the path.\n"
+   "@param priority Paths with a higher priority are planned before others.\n\n"
+
+   "@return False if the mesh is invalid.\n"
+
+   "@see setMoveDestination()\n")
+{
+   return object->setPathDestination( mesh, goal, slowDown, priority );
+}
+#endif
+
 DefineEngineMethod( AIPlayer, getMoveDestination, Point3F, (),,
    "@brief Get the AIPlayer's current destination.\n\n"
 
@@ -27,6 +27,14 @@
 #include "T3D/player.h"
 #endif
 
+#ifndef _SCENECONTAINER_H_
+#include "scene/sceneContainer.h"
+#endif
+
+#ifdef TORQUE_NAVIGATION_ENABLED
+#include "navigation/navPathQuery.h"
+#endif
+
 
 class AIPlayer : public Player {
 
@@ -58,6 +66,32 @@ private:
 
    Point3F mAimOffset;
 
+   /// A target line of sight test waiting for the end of the tick.
+   struct LOSCheck
+   {
+      SimObjectPtr<AIPlayer> player;
+      SceneContainer::BatchRay ray;
+   };
+
+   /// Line of sight tests of all AIPlayers, cast together in one batch
+   /// after each server tick.
+   static Vector<LOSCheck> smLOSChecks;
+   static bool smLOSFlushHooked;
+
+   void queueLOSCheck( const Point3F &start, const Point3F &end );
+   void setTargetInLOS( bool inLOS );
+   static void _flushLOSChecks( SimTime timeDelta );
+
+#ifdef TORQUE_NAVIGATION_ENABLED
+   NavPathQueryRef mPathQuery;         // Pending path request
+   Vector<Point3F> mPathPoints;        // Path we are following
+   S32 mPathIndex;                     // Path node we are moving to
+   bool mPathSlowdown;                 // Slowdown as we near the end of the path
+
+   void onPathQueryComplete( NavPathQuery *query );
+   bool moveToNextPathNode();
+#endif
+
    // Utility Methods
    void throwCallback( const char *name );
 
@@ -89,6 +123,12 @@ public:
    void setMoveDestination( const Point3F &location, bool slowdown );
    Point3F getMoveDestination() const { return mMoveDestination; }
    void stopMove();
+
+#ifdef TORQUE_NAVIGATION_ENABLED
+   // Pathfinding
+   bool setPathDestination( NavMesh *mesh, const Point3F &location, bool slowdown, F32 priority );
+   void clearPath();
+#endif
 };
 
 #endif
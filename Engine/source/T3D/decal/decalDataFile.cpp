@@ -63,6 +63,7 @@ DecalDataFile::DecalDataFile()
      mSphereWithLastInsertion( NULL )
 {
    VECTOR_SET_ASSOCIATION( mSphereList );
+   VECTOR_SET_ASSOCIATION( mLargeSpheres );
 }
 
 //-----------------------------------------------------------------------------
@@ -80,6 +81,8 @@ void DecalDataFile::clear()
       delete mSphereList[i];
 
    mSphereList.clear();
+   mSphereGrid.clear();
+   mLargeSpheres.clear();
    mSphereWithLastInsertion = NULL;
    mChunker.freeBlocks();
 
@@ -240,6 +243,12 @@ bool DecalDataFile::read( Stream &stream )
       inst->mIndices = NULL;
       inst->mVertCount = 0;
       inst->mIndxCount = 0;
+      inst->mLastAlpha = -1.0f;
+      inst->mCustomTex = NULL;
+      inst->mSphere = NULL;
+      inst->mInStaticBuffer = false;
+      inst->mLRUPrev = NULL;
+      inst->mLRUNext = NULL;
 
       data = allDatablocks[ dataIndex ];
 
@@ -309,6 +318,11 @@ DecalInstance* DecalDataFile::addDecal( const Point3F& pos, const Point3F& norma
    newDecal->mFlags = flags;
    newDecal->mFlags |= ClipDecal;
 
+   newDecal->mSphere = NULL;
+   newDecal->mInStaticBuffer = false;
+   newDecal->mLRUPrev = NULL;
+   newDecal->mLRUNext = NULL;
+
    _addDecalToSpheres( newDecal );
 
    return newDecal;
@@ -316,6 +330,83 @@ DecalInstance* DecalDataFile::addDecal( const Point3F& pos, const Point3F& norma
 
 //-----------------------------------------------------------------------------
 
+void DecalDataFile::findSpheres( const Box3F &box, Vector< DecalSphere* > *outSpheres ) const
+{
+   // Spheres are binned by their center, so widen the query by the
+   // largest radius a binned sphere can have.
+
+   const F32 halfCell = F32( GRID_CELL_SIZE ) / 2.f;
+
+   const S32 minX = _getGridCoord( box.minExtents.x - halfCell );
+   const S32 minY = _getGridCoord( box.minExtents.y - halfCell );
+   const S32 maxX = _getGridCoord( box.maxExtents.x + halfCell );
+   const S32 maxY = _getGridCoord( box.maxExtents.y + halfCell );
+
+   // If the box covers more cells than we have spheres, walking
+   // the cells is slower than just returning all of them.
+
+   const F32 numCells = F32( maxX - minX + 1 ) * F32( maxY - minY + 1 );
+   if( numCells >= F32( mSphereList.size() ) || ( maxX - minX ) >= 0x7FFF || ( maxY - minY ) >= 0x7FFF )
+   {
+      outSpheres->merge( mSphereList );
+      return;
+   }
+
+   outSpheres->merge( mLargeSpheres );
+
+   for( S32 y = minY; y <= maxY; ++ y )
+      for( S32 x = minX; x <= maxX; ++ x )
+      {
+         const U32 key = _getGridKey( x, y );
+
+         HashTable< U32, DecalSphere* >::ConstIterator iter = mSphereGrid.find( key );
+         for( ; iter != mSphereGrid.end() && iter->key == key; ++ iter )
+         {
+            const SphereF &sphere = iter->value->mWorldSphere;
+            if(   sphere.center.z + sphere.radius >= box.minExtents.z &&
+                  sphere.center.z - sphere.radius <= box.maxExtents.z )
+               outSpheres->push_back( iter->value );
+         }
+      }
+}
+
+//-----------------------------------------------------------------------------
+
+void DecalDataFile::_updateSphereBinning( DecalSphere *sphere )
+{
+   const SphereF &worldSphere = sphere->mWorldSphere;
+
+   U32 key = U32_MAX;
+   if( worldSphere.radius <= F32( GRID_CELL_SIZE ) / 2.f )
+      key = _getGridKey( _getGridCoord( worldSphere.center.x ), _getGridCoord( worldSphere.center.y ) );
+
+   if( key == sphere->mGridKey && key != U32_MAX )
+      return;
+
+   _removeSphereBinning( sphere );
+
+   if( key == U32_MAX )
+      mLargeSpheres.push_back( sphere );
+   else
+      mSphereGrid.insertEqual( key, sphere );
+
+   sphere->mGridKey = key;
+}
+
+//-----------------------------------------------------------------------------
+
+void DecalDataFile::_removeSphereBinning( DecalSphere *sphere )
+{
+   if( sphere->mGridKey == U32_MAX )
+      mLargeSpheres.remove( sphere );
+   else
+      mSphereGrid.erase( sphere->mGridKey, sphere );
+
+   sphere->mGridKey = U32_MAX;
+}
+
+//-----------------------------------------------------------------------------
+
 void DecalDataFile::_addDecalToSpheres( DecalInstance* inst )
 {
    // First try the sphere we have last inserted an item into, if there is one.
@@ -323,20 +414,30 @@ void DecalDataFile::_addDecalToSpheres( DecalInstance* inst )
    // guess as a good candidate.
 
    if( mSphereWithLastInsertion && mSphereWithLastInsertion->tryAddItem( inst ) )
+   {
+      _updateSphereBinning( mSphereWithLastInsertion );
       return;
+   }
+
+   // Otherwise, go through the spheres near the decal and try to find an
+   // existing sphere that meets our tolerances.
 
-   // Otherwise, go through the list and try to find an existing sphere that meets
-   // our tolerances.
+   const F32 searchRadius = DecalSphere::smDistanceTolerance + inst->mSize / 2.f;
+   const Box3F searchBox( inst->mPosition - Point3F( searchRadius ), inst->mPosition + Point3F( searchRadius ) );
 
-   for( U32 i = 0; i < mSphereList.size(); i++ )
+   Vector< DecalSphere* > candidates;
+   findSpheres( searchBox, &candidates );
+
+   for( U32 i = 0; i < candidates.size(); i++ )
    {
-      DecalSphere* sphere = mSphereList[i];
+      DecalSphere* sphere = candidates[i];
       
       if( sphere == mSphereWithLastInsertion )
          continue;
 
       if( sphere->tryAddItem( inst ) )
       {
+         _updateSphereBinning( sphere );
          mSphereWithLastInsertion = sphere;
          return;
       }
@@ -350,6 +451,9 @@ void DecalDataFile::_addDecalToSpheres( DecalInstance* inst )
    mSphereWithLastInsertion = sphere;
 
    sphere->mItems.push_back( inst );
+   inst->mSphere = sphere;
+
+   _updateSphereBinning( sphere );
 }
 
 //-----------------------------------------------------------------------------
@@ -366,36 +470,44 @@ void DecalDataFile::removeDecal( DecalInstance *inst )
 
 bool DecalDataFile::_removeDecalFromSpheres( DecalInstance *inst )
 {
-   for( U32 i = 0; i < mSphereList.size(); i++ )
-   {
-      DecalSphere* sphere = mSphereList[ i ];
-      Vector< DecalInstance* > &items = sphere->mItems;
+   DecalSphere* sphere = inst->mSphere;
+   if( !sphere )
+      return false;
 
-      // Try to remove the instance from the list of this sphere.
-      // If that fails, the instance doesn't belong to this sphere
-      // so continue.
+   Vector< DecalInstance* > &items = sphere->mItems;
+   if( !items.remove( inst ) )
+      return false;
 
-      if( !items.remove( inst ) )
-         continue;
+   inst->mSphere = NULL;
 
-      // If the sphere is now empty, remove it.  Otherwise, update
-      // it's bounds.
+   // If the decal was drawn from the sphere's static buffers, they
+   // need to be rebuilt without it.
 
-      if( items.empty() )
-      {
-         if( mSphereWithLastInsertion == sphere )
-            mSphereWithLastInsertion = NULL;
+   if( inst->mInStaticBuffer )
+   {
+      inst->mInStaticBuffer = false;
+      sphere->mStaticDirty = true;
+   }
 
-         delete sphere;      
-         mSphereList.erase( i );
-      }
-      else
-         sphere->updateWorldSphere();
+   // If the sphere is now empty, remove it.  Otherwise, update
+   // it's bounds.
+
+   if( items.empty() )
+   {
+      if( mSphereWithLastInsertion == sphere )
+         mSphereWithLastInsertion = NULL;
 
-      return true;
+      _removeSphereBinning( sphere );
+      mSphereList.remove( sphere );
+      delete sphere;      
+   }
+   else
+   {
+      sphere->updateWorldSphere();
+      _updateSphereBinning( sphere );
    }
 
-   return false;
+   return true;
 }
 
 //-----------------------------------------------------------------------------
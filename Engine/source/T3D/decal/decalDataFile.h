@@ -35,6 +35,10 @@
 #include "T3D/decal/decalSphere.h"
 #endif
 
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
+
 
 class Stream;
 class DecalData;
@@ -50,6 +54,9 @@ class DecalDataFile
 
       enum { FILE_VERSION = 5 };
 
+      /// Edge length in world units of the cells of the sphere grid.
+      enum { GRID_CELL_SIZE = 128 };
+
       /// Set to true if the file is dirty and
       /// needs to be saved before being destroyed.
       bool mIsDirty;
@@ -87,6 +94,35 @@ class DecalDataFile
       bool _removeDecalFromSpheres( DecalInstance *inst );
 
       /// @}
+
+      /// @name Spatial Index
+      ///
+      /// Spheres are binned into a uniform grid on the XY plane by the
+      /// cell containing their center.  Spheres whose radius exceeds half
+      /// a cell are kept in #mLargeSpheres and returned by every query.
+      ///
+      /// @{
+
+      /// Grid cell key to the spheres with their center in that cell.
+      HashTable< U32, DecalSphere* > mSphereGrid;
+
+      /// Spheres too large to be binned by their center.
+      Vector< DecalSphere* > mLargeSpheres;
+
+      /// Return the grid key for the cell at the given cell coordinates.
+      static U32 _getGridKey( S32 x, S32 y ) { return ( U32( x & 0x7FFF ) << 16 ) | U32( y & 0x7FFF ); }
+
+      /// Return the cell coordinate containing the given world coordinate.
+      static S32 _getGridCoord( F32 value ) { return (S32)mFloor( value / F32( GRID_CELL_SIZE ) ); }
+
+      /// Insert the sphere into the grid or move it to the cell matching
+      /// its current bounds.
+      void _updateSphereBinning( DecalSphere *sphere );
+
+      /// Remove the sphere from the grid.
+      void _removeSphereBinning( DecalSphere *sphere );
+
+      /// @}
    
    public:
 
@@ -103,6 +139,10 @@ class DecalDataFile
       /// file to an empty state.
       void clear();
 
+      /// Collect the spheres that may overlap the given world box.  The
+      /// result is conservative; callers still need to cull the spheres.
+      void findSpheres( const Box3F &box, Vector< DecalSphere* > *outSpheres ) const;
+
       /// @name I/O
       /// @{
 
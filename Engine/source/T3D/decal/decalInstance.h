@@ -33,6 +33,7 @@
 
 struct DecalVertex;
 class SceneRenderState;
+class DecalSphere;
 
 /// DecalInstance represents a rendering decal in the scene.
 /// You should not allocate this yourself, add new decals to the scene
@@ -72,6 +73,18 @@ class DecalInstance
 
       GFXTexHandle *mCustomTex;
 
+      /// The DecalSphere this decal is binned into.
+      DecalSphere *mSphere;
+
+      /// True if the geometry of this decal is part of the static
+      /// buffers of #mSphere.
+      bool mInStaticBuffer;
+
+      /// Links in the DecalManager's least recently rendered list
+      /// of run-time placed decals.
+      DecalInstance *mLRUPrev;
+      DecalInstance *mLRUNext;
+
       void getWorldMatrix( MatrixF *outMat, bool flip = false );
       
       Box3F getWorldBox() const
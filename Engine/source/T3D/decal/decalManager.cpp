@@ -48,6 +48,7 @@
 #include "core/module.h"
 #include "T3D/decal/decalData.h"
 #include "console/engineAPI.h"
+#include "platform/threads/threadPoolJob.h"
 
 
 extern bool gEditingMission;
@@ -81,6 +82,9 @@ bool      DecalManager::smDecalsOn = true;
 bool      DecalManager::smDebugRender = false;
 F32       DecalManager::smDecalLifeTimeScale = 1.0f;
 bool      DecalManager::smPoolBuffers = true;
+bool      DecalManager::smStaticBuffers = true;
+S32       DecalManager::smDynamicMemoryBudget = 4096;
+S32       DecalManager::smMaxPendingClips = 32;
 const U32 DecalManager::smMaxVerts = 6000;
 const U32 DecalManager::smMaxIndices = 10000;
 
@@ -197,6 +201,16 @@ int QSORT_CALLBACK cmpDecalRenderOrder( const void *p1, const void *p2 )
    }
 }
 
+/// Get the best lights for the current camera position.
+void _getForwardLights( const Frustum &rootFrustum, LightInfo **outLights )
+{
+   LightQuery query;
+   query.init( rootFrustum.getPosition(),
+               rootFrustum.getTransform().getForwardVector(),
+               rootFrustum.getFarDist() );
+   query.getLights( outLights, 8 );
+}
+
 } // namespace {}
 
 // These numbers should be tweaked to get as many dynamically placed decals
@@ -227,6 +241,10 @@ DecalManager::DecalManager()
 
    mDirty = false;
 
+   mLRUHead = NULL;
+   mLRUTail = NULL;
+   mDynamicMemory = 0;
+
    mChunkers[0] = new FreeListChunkerUntyped( SIZE_CLASS_0 * sizeof( U8 ) );
    mChunkers[1] = new FreeListChunkerUntyped( SIZE_CLASS_1 * sizeof( U8 ) );
    mChunkers[2] = new FreeListChunkerUntyped( SIZE_CLASS_2 * sizeof( U8 ) );
@@ -261,6 +279,24 @@ void DecalManager::consoleInit()
       "If false, will just clear them at the end of a frame.\n"
       "@ingroup Decals" );
 
+   Con::addVariable( "$Decals::staticBuffers", TypeBool, &smStaticBuffers,
+      "If true, permanent decals placed in the editor are kept in static "
+      "buffers per decal sphere and only uploaded again when they change.\n"
+      "If false, they are copied into the per-frame buffers like all other decals.\n"
+      "@ingroup Decals" );
+
+   Con::addVariable( "$pref::Decals::dynamicMemoryBudget", TypeS32, &smDynamicMemoryBudget,
+      "The amount of memory in kilobytes the geometry of decals placed at run-time "
+      "may use.  Once exceeded, the least recently rendered decals are deleted.\n"
+      "A value of zero or less disables the limit.\n"
+      "@ingroup Decals" );
+
+   Con::addVariable( "$pref::Decals::maxPendingClips", TypeS32, &smMaxPendingClips,
+      "The maximum number of decals clipped against the scene on background threads "
+      "at any time.  Further decals wait until a clip finishes.\n"
+      "A value of zero clips decals on the main thread when they are first rendered.\n"
+      "@ingroup Decals" );
+
    Con::addVariable( "$Decals::debugRender", TypeBool, &smDebugRender,
       "If true, the decal spheres will be visualized when in the editor.\n\n"
       "@ingroup Decals" );
@@ -305,22 +341,135 @@ bool DecalManager::_handleGFXEvent(GFXDevice::GFXDeviceEventType event)
    return true;
 }
 
+/// Clips the geometry gathered around a decal on the thread pool.
+struct DecalManager::ClipJob : public ThreadPoolJob
+{
+   /// The decal to receive the geometry or NULL if the
+   /// clip has been cancelled.  Only touched on the main thread.
+   DecalInstance *mDecal;
+
+   /// Unclipped geometry gathered from the container.
+   ClippedPolyList mGeometry;
+
+   /// Clipper set up with the decal planes.
+   ClippedPolyList mClipper;
+
+   MatrixF mWorldToDecal;
+   F32 mHalfSize;
+   RectF mTexRect;
+   bool mSkipVertexNormals;
+
+   /// @name Results
+   /// @{
+   bool mSucceeded;
+   Vector< DecalVertex > mVerts;
+   Vector< U16 > mIndices;
+   /// @}
+
+   ClipJob( DecalInstance *decal )
+      : mDecal( decal ),
+        mSucceeded( false ) {}
+
+protected:
+
+   virtual void run()
+   {
+      // Feed the gathered geometry through the clipper.  Vertices are
+      // added first and in order so that the indices stay valid.
+
+      const S32 numVerts = mGeometry.mVertexList.size();
+      for ( S32 i = 0; i < numVerts; i++ )
+         mClipper.addPointAndNormal( mGeometry.mVertexList[i].point, mGeometry.mNormalList[i] );
+
+      for ( S32 i = 0; i < mGeometry.mPolyList.size(); i++ )
+      {
+         const ClippedPolyList::Poly &poly = mGeometry.mPolyList[i];
+
+         mClipper.begin( poly.material, poly.surfaceKey );
+         for ( U32 k = 0; k < poly.vertexCount; k++ )
+            mClipper.vertex( mGeometry.mIndexList[ poly.vertexStart + k ] );
+         mClipper.plane( poly.plane );
+         mClipper.end();
+      }
+
+      mSucceeded = DecalManager::_buildClippedGeometry( mClipper, mWorldToDecal, mHalfSize, mTexRect, mSkipVertexNormals, &mVerts, &mIndices );
+   }
+};
+
 bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts, const Point2F *clipDepth )
 {
    PROFILE_SCOPE( DecalManager_clipDecal );
 
+   // Any clip still running in the background is out of date now.
+   _cancelClipJob( decal );
+
    // Free old verts and indices.
    _freeBuffers( decal );
 
+   const DecalData *decalData = decal->mDataBlock;
+
+   MatrixF projMat;
+   Box3F box;
+   _setupClipper( decal, clipDepth, &mClipper, &projMat, &box );
+
+   PROFILE_START( DecalManager_clipDecal_buildPolyList );
+   getContainer()->buildPolyList( PLC_Decal, box, decalData->clippingMasks, &mClipper );   
+   PROFILE_END();
+
+   MatrixF worldToDecal( projMat );
+   worldToDecal.inverse();
+
+   if ( !_buildClippedGeometry(  mClipper, 
+                                 worldToDecal, 
+                                 decal->mSize * 0.5f, 
+                                 decalData->texRect[decal->mTextureRectIdx], 
+                                 decalData->skipVertexNormals, 
+                                 &mClipVerts, 
+                                 &mClipIndices ) )
+      return false;
+   
+#ifdef DECALMANAGER_DEBUG
+   mDebugPlanes.clear();
+   mDebugPlanes.merge( mClipper.mPlaneList );
+#endif
+
+   _setGeometry( decal, mClipVerts, mClipIndices );
+
+   if ( !edgeVerts )
+      return true;
+
+   Point3F tmpHullPt( 0, 0, 0 );
+   Vector<Point3F> tmpHullPts;
+
+   for ( S32 i = 0; i < mClipper.mVertexList.size(); i++ )
+   {
+      const ClippedPolyList::Vertex &vert = mClipper.mVertexList[i];
+      tmpHullPt = vert.point;
+      worldToDecal.mulP( tmpHullPt );
+      tmpHullPts.push_back( tmpHullPt );
+   }
+
+   edgeVerts->clear();
+   U32 verts = _generateConvexHull( tmpHullPts, edgeVerts );
+   edgeVerts->setSize( verts );
+
+   for ( S32 i = 0; i < edgeVerts->size(); i++ )
+      projMat.mulP( (*edgeVerts)[i] );
+
+   return true;
+}
+
+void DecalManager::_setupClipper( DecalInstance *decal, const Point2F *clipDepth, ClippedPolyList *clipper, MatrixF *outProjMat, Box3F *outBox )
+{
    F32 halfSize = decal->mSize * 0.5f;
    
    // Ugly hack for ProjectedShadow!
    F32 halfSizeZ = clipDepth ? clipDepth->x : halfSize;
    F32 negHalfSize = clipDepth ? clipDepth->y : halfSize;
-   Point3F decalHalfSize( halfSize, halfSize, halfSize );
    Point3F decalHalfSizeZ( halfSizeZ, halfSizeZ, halfSizeZ );
 
-   MatrixF projMat( true );
+   MatrixF &projMat = *outProjMat;
+   projMat.identity();
    decal->getWorldMatrix( &projMat );
 
    const VectorF &crossVec = decal->mNormal;
@@ -330,39 +479,36 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
    projMat.getColumn( 0, &newRight );
    projMat.getColumn( 1, &newFwd );   
 
-   VectorF objRight( 1.0f, 0, 0 );
-   VectorF objFwd( 0, 1.0f, 0 );
-   VectorF objUp( 0, 0, 1.0f );
-
    // See above re: decalHalfSizeZ hack.
-   mClipper.clear();
-   mClipper.mPlaneList.setSize(6);
-   mClipper.mPlaneList[0].set( ( decalPos + ( -newRight * halfSize ) ), -newRight );
-   mClipper.mPlaneList[1].set( ( decalPos + ( -newFwd * halfSize ) ), -newFwd );
-   mClipper.mPlaneList[2].set( ( decalPos + ( -crossVec * decalHalfSizeZ ) ), -crossVec );
-   mClipper.mPlaneList[3].set( ( decalPos + ( newRight * halfSize ) ), newRight );
-   mClipper.mPlaneList[4].set( ( decalPos + ( newFwd * halfSize ) ), newFwd );
-   mClipper.mPlaneList[5].set( ( decalPos + ( crossVec * negHalfSize ) ), crossVec );
-
-   mClipper.mNormal = decal->mNormal;
-
-   const DecalData *decalData = decal->mDataBlock;
-
-   mClipper.mNormalTolCosineRadians = mCos( mDegToRad( decalData->clippingAngle ) );
-
-   Box3F box( -decalHalfSizeZ, decalHalfSizeZ );
-
-   projMat.mul( box );
-
-   PROFILE_START( DecalManager_clipDecal_buildPolyList );
-   getContainer()->buildPolyList( PLC_Decal, box, decalData->clippingMasks, &mClipper );   
-   PROFILE_END();
+   clipper->clear();
+   clipper->mPlaneList.setSize(6);
+   clipper->mPlaneList[0].set( ( decalPos + ( -newRight * halfSize ) ), -newRight );
+   clipper->mPlaneList[1].set( ( decalPos + ( -newFwd * halfSize ) ), -newFwd );
+   clipper->mPlaneList[2].set( ( decalPos + ( -crossVec * decalHalfSizeZ ) ), -crossVec );
+   clipper->mPlaneList[3].set( ( decalPos + ( newRight * halfSize ) ), newRight );
+   clipper->mPlaneList[4].set( ( decalPos + ( newFwd * halfSize ) ), newFwd );
+   clipper->mPlaneList[5].set( ( decalPos + ( crossVec * negHalfSize ) ), crossVec );
+
+   clipper->mNormal = decal->mNormal;
+   clipper->mNormalTolCosineRadians = mCos( mDegToRad( decal->mDataBlock->clippingAngle ) );
+
+   outBox->set( -decalHalfSizeZ, decalHalfSizeZ );
+   projMat.mul( *outBox );
+}
 
-   mClipper.cullUnusedVerts();
-   mClipper.triangulate();
+bool DecalManager::_buildClippedGeometry( ClippedPolyList &clipper,
+                                          const MatrixF &worldToDecal,
+                                          F32 halfSize,
+                                          const RectF &texRect,
+                                          bool skipVertexNormals,
+                                          Vector<DecalVertex> *outVerts,
+                                          Vector<U16> *outIndices )
+{
+   clipper.cullUnusedVerts();
+   clipper.triangulate();
    
-   const U32 numVerts = mClipper.mVertexList.size();
-   const U32 numIndices = mClipper.mIndexList.size();
+   const U32 numVerts = clipper.mVertexList.size();
+   const U32 numIndices = clipper.mIndexList.size();
 
    if ( !numVerts || !numIndices )
       return false;
@@ -373,16 +519,13 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
         numIndices > smMaxIndices )
       return false;
 
-   if ( !decalData->skipVertexNormals )
-      mClipper.generateNormals();
-   
-#ifdef DECALMANAGER_DEBUG
-   mDebugPlanes.clear();
-   mDebugPlanes.merge( mClipper.mPlaneList );
-#endif
+   if ( !skipVertexNormals )
+      clipper.generateNormals();
+
+   Point3F decalHalfSize( halfSize, halfSize, halfSize );
 
-   decal->mVertCount = numVerts;
-   decal->mIndxCount = numIndices;
+   VectorF objRight( 1.0f, 0, 0 );
+   VectorF objFwd( 0, 1.0f, 0 );
    
    Vector<Point3F> tmpPoints;
 
@@ -392,8 +535,6 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
    
    Point3F lowerLeft(( -objFwd * decalHalfSize ) + ( objRight * decalHalfSize ));
 
-   projMat.inverse();
-
    _generateWindingOrder( lowerLeft, &tmpPoints );
 
    BiQuadToSqr quadToSquare( Point2F( lowerLeft.x, lowerLeft.y ),
@@ -404,24 +545,22 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
    Point2F uv( 0, 0 );
    Point3F vecX(0.0f, 0.0f, 0.0f);
 
-   // Allocate memory for vert and index arrays
-   _allocBuffers( decal );  
+   outVerts->setSize( numVerts );
+   outIndices->setSize( numIndices );
 
-   // Mark this so that the color will be assigned on these verts the next
-   // time it renders, since we just threw away the previous verts.
-   decal->mLastAlpha = -1;
+   DecalVertex *verts = outVerts->address();
    
    Point3F vertPoint( 0, 0, 0 );
 
-   for ( U32 i = 0; i < mClipper.mVertexList.size(); i++ )
+   for ( S32 i = 0; i < clipper.mVertexList.size(); i++ )
    {
-      const ClippedPolyList::Vertex &vert = mClipper.mVertexList[i];
+      const ClippedPolyList::Vertex &vert = clipper.mVertexList[i];
       vertPoint = vert.point;
 
       // Transform this point to
       // object space to look up the
       // UV coordinate for this vertex.
-      projMat.mulP( vertPoint );
+      worldToDecal.mulP( vertPoint );
 
       // Clamp the point to be within the quad.
       vertPoint.x = mClampF( vertPoint.x, -decalHalfSize.x, decalHalfSize.x );
@@ -430,71 +569,148 @@ bool DecalManager::clipDecal( DecalInstance *decal, Vector<Point3F> *edgeVerts,
       // Get our UV.
       uv = quadToSquare.transform( Point2F( vertPoint.x, vertPoint.y ) );
 
-      const RectF &rect = decal->mDataBlock->texRect[decal->mTextureRectIdx];
-
-      uv *= rect.extent;
-      uv += rect.point;      
+      uv *= texRect.extent;
+      uv += texRect.point;      
 
       // Set the world space vertex position.
-      decal->mVerts[i].point = vert.point;
+      verts[i].point = vert.point;
       
-      decal->mVerts[i].texCoord.set( uv.x, uv.y );
+      verts[i].texCoord.set( uv.x, uv.y );
       
-      if ( mClipper.mNormalList.empty() )
+      if ( clipper.mNormalList.empty() )
          continue;
 
-      decal->mVerts[i].normal = mClipper.mNormalList[i];
-      decal->mVerts[i].normal.normalize();
+      verts[i].normal = clipper.mNormalList[i];
+      verts[i].normal.normalize();
 
-      if( mFabs( decal->mVerts[i].normal.z ) > 0.8f ) 
-         mCross( decal->mVerts[i].normal, Point3F( 1.0f, 0.0f, 0.0f ), &vecX );
-      else if ( mFabs( decal->mVerts[i].normal.x ) > 0.8f )
-         mCross( decal->mVerts[i].normal, Point3F( 0.0f, 1.0f, 0.0f ), &vecX );
-      else if ( mFabs( decal->mVerts[i].normal.y ) > 0.8f )
-         mCross( decal->mVerts[i].normal, Point3F( 0.0f, 0.0f, 1.0f ), &vecX );
+      if( mFabs( verts[i].normal.z ) > 0.8f ) 
+         mCross( verts[i].normal, Point3F( 1.0f, 0.0f, 0.0f ), &vecX );
+      else if ( mFabs( verts[i].normal.x ) > 0.8f )
+         mCross( verts[i].normal, Point3F( 0.0f, 1.0f, 0.0f ), &vecX );
+      else if ( mFabs( verts[i].normal.y ) > 0.8f )
+         mCross( verts[i].normal, Point3F( 0.0f, 0.0f, 1.0f ), &vecX );
    
-      decal->mVerts[i].tangent = mCross( decal->mVerts[i].normal, vecX );
+      verts[i].tangent = mCross( verts[i].normal, vecX );
    }
 
+   U16 *indices = outIndices->address();
+
    U32 curIdx = 0;
-   for ( U32 j = 0; j < mClipper.mPolyList.size(); j++ )
+   for ( S32 j = 0; j < clipper.mPolyList.size(); j++ )
    {
       // Write indices for each Poly
-      ClippedPolyList::Poly *poly = &mClipper.mPolyList[j];                  
+      ClippedPolyList::Poly *poly = &clipper.mPolyList[j];                  
 
       AssertFatal( poly->vertexCount == 3, "Got non-triangle poly!" );
 
-      decal->mIndices[curIdx] = mClipper.mIndexList[poly->vertexStart];         
+      indices[curIdx] = clipper.mIndexList[poly->vertexStart];         
       curIdx++;
-      decal->mIndices[curIdx] = mClipper.mIndexList[poly->vertexStart + 1];            
+      indices[curIdx] = clipper.mIndexList[poly->vertexStart + 1];            
       curIdx++;
-      decal->mIndices[curIdx] = mClipper.mIndexList[poly->vertexStart + 2];                
+      indices[curIdx] = clipper.mIndexList[poly->vertexStart + 2];                
       curIdx++;
    } 
 
-   if ( !edgeVerts )
-      return true;
+   return true;
+}
 
-   Point3F tmpHullPt( 0, 0, 0 );
-   Vector<Point3F> tmpHullPts;
+void DecalManager::_setGeometry( DecalInstance *decal, const Vector<DecalVertex> &verts, const Vector<U16> &indices )
+{
+   _freeBuffers( decal );
+
+   decal->mVertCount = verts.size();
+   decal->mIndxCount = indices.size();
+
+   // Allocate memory for vert and index arrays
+   _allocBuffers( decal );  
+
+   dMemcpy( decal->mVerts, verts.address(), sizeof( DecalVertex ) * decal->mVertCount );
+   dMemcpy( decal->mIndices, indices.address(), sizeof( U16 ) * decal->mIndxCount );
+
+   // Mark this so that the color will be assigned on these verts the next
+   // time it renders, since we just threw away the previous verts.
+   decal->mLastAlpha = -1;
+}
+
+void DecalManager::_queueClipJob( DecalInstance *decal )
+{
+   PROFILE_SCOPE( DecalManager_queueClipJob );
+
+   _cancelClipJob( decal );
+
+   const DecalData *decalData = decal->mDataBlock;
+
+   ThreadSafeRef< ClipJob > job = new ClipJob( decal );
+
+   MatrixF projMat;
+   Box3F box;
+   _setupClipper( decal, NULL, &job->mClipper, &projMat, &box );
+
+   job->mWorldToDecal = projMat;
+   job->mWorldToDecal.inverse();
+   job->mHalfSize = decal->mSize * 0.5f;
+   job->mTexRect = decalData->texRect[decal->mTextureRectIdx];
+   job->mSkipVertexNormals = decalData->skipVertexNormals;
+
+   // Take a snapshot of the geometry around the decal.  Only back
+   // facing polys are rejected here, the clipping is left to the job.
+
+   job->mGeometry.mNormal = job->mClipper.mNormal;
+   job->mGeometry.mNormalTolCosineRadians = job->mClipper.mNormalTolCosineRadians;
+
+   PROFILE_START( DecalManager_queueClipJob_buildPolyList );
+   getContainer()->buildPolyList( PLC_Decal, box, decalData->clippingMasks, &job->mGeometry );   
+   PROFILE_END();
 
-   for ( U32 i = 0; i < mClipper.mVertexList.size(); i++ )
+   mClipJobs.push_back( job );
+   ThreadPool::GLOBAL().queueWorkItem( job );
+}
+
+bool DecalManager::_cancelClipJob( DecalInstance *decal )
+{
+   bool cancelled = false;
+   for ( S32 i = 0; i < mClipJobs.size(); i++ )
    {
-      const ClippedPolyList::Vertex &vert = mClipper.mVertexList[i];
-      tmpHullPt = vert.point;
-      projMat.mulP( tmpHullPt );
-      tmpHullPts.push_back( tmpHullPt );
+      if ( mClipJobs[i]->mDecal == decal )
+      {
+         mClipJobs[i]->mDecal = NULL;
+         cancelled = true;
+      }
    }
 
-   edgeVerts->clear();
-   U32 verts = _generateConvexHull( tmpHullPts, edgeVerts );
-   edgeVerts->setSize( verts );
+   return cancelled;
+}
 
-   projMat.inverse();
-   for ( U32 i = 0; i < edgeVerts->size(); i++ )
-      projMat.mulP( (*edgeVerts)[i] );
+void DecalManager::_processClipJobs()
+{
+   PROFILE_SCOPE( DecalManager_processClipJobs );
 
-   return true;
+   for ( S32 i = 0; i < mClipJobs.size(); i++ )
+   {
+      ClipJob *job = mClipJobs[i];
+      if ( !job->isFinished() )
+         continue;
+
+      DecalInstance *decal = job->mDecal;
+      if ( decal )
+      {
+         if ( job->mSucceeded )
+            _setGeometry( decal, job->mVerts, job->mIndices );
+         else
+         {
+            _freeBuffers( decal );
+
+            // Decals placed at run-time are deleted if they didn't get
+            // any geometry.  Editor decals are flagged to try again the
+            // next time they are modified.
+            if ( !( decal->mFlags & SaveDecal ) )
+               removeDecal( decal );
+         }
+      }
+
+      mClipJobs.erase( i );
+      i--;
+   }
 }
 
 DecalInstance* DecalManager::addDecal( const Point3F &pos,
@@ -544,6 +760,8 @@ void DecalManager::removeDecal( DecalInstance *inst )
    if ( inst->mFlags & SaveDecal )
       mDirty = true;
 
+   _cancelClipJob( inst );
+
    // Remove the decal from the instance vector.
    
 	if( inst->mId != -1 && inst->mId < mDecalInstanceVec.size() )
@@ -574,6 +792,10 @@ void DecalManager::notifyDecalModified( DecalInstance *inst )
    if ( inst->mFlags & SaveDecal )
       mDirty = true;
 
+   // A pending clip was for the old placement so clip it again.
+   if ( _cancelClipJob( inst ) )
+      inst->mFlags |= ClipDecal;
+
    if ( mData )
       mData->notifyDecalModified( inst );
 }
@@ -923,12 +1145,29 @@ void DecalManager::_allocBuffers( DecalInstance *inst )
    inst->mVerts = reinterpret_cast< DecalVertex* >( data );
    data = (U8*)data + sizeof( DecalVertex ) * inst->mVertCount;
    inst->mIndices = reinterpret_cast< U16* >( data );
+
+   // Track the geometry of run-time placed decals against the budget.
+   if ( !( inst->mFlags & ( SaveDecal | CustomDecal ) ) )
+   {
+      mDynamicMemory += sizeof( DecalVertex ) * inst->mVertCount + sizeof( U16 ) * inst->mIndxCount;
+      _linkLRU( inst );
+   }
 }
 
 void DecalManager::_freeBuffers( DecalInstance *inst )
 {
    if ( inst->mVerts != NULL )
    {
+      if ( _unlinkLRU( inst ) )
+         mDynamicMemory -= sizeof( DecalVertex ) * inst->mVertCount + sizeof( U16 ) * inst->mIndxCount;
+
+      // The static buffers of the sphere hold a copy of the geometry.
+      if ( inst->mInStaticBuffer )
+      {
+         inst->mInStaticBuffer = false;
+         inst->mSphere->mStaticDirty = true;
+      }
+
       const S32 sizeClass = _getSizeClass( inst );
       
       if ( sizeClass == -1 )
@@ -988,6 +1227,210 @@ S32 DecalManager::_getSizeClass( DecalInstance *inst ) const
    return -1;
 }
 
+void DecalManager::_linkLRU( DecalInstance *inst )
+{
+   inst->mLRUPrev = mLRUTail;
+   inst->mLRUNext = NULL;
+
+   if ( mLRUTail )
+      mLRUTail->mLRUNext = inst;
+   else
+      mLRUHead = inst;
+
+   mLRUTail = inst;
+}
+
+bool DecalManager::_unlinkLRU( DecalInstance *inst )
+{
+   if ( !inst->mLRUPrev && mLRUHead != inst )
+      return false;
+
+   if ( inst->mLRUPrev )
+      inst->mLRUPrev->mLRUNext = inst->mLRUNext;
+   else
+      mLRUHead = inst->mLRUNext;
+
+   if ( inst->mLRUNext )
+      inst->mLRUNext->mLRUPrev = inst->mLRUPrev;
+   else
+      mLRUTail = inst->mLRUPrev;
+
+   inst->mLRUPrev = NULL;
+   inst->mLRUNext = NULL;
+
+   return true;
+}
+
+void DecalManager::_touchLRU( DecalInstance *inst )
+{
+   if ( mLRUTail == inst || !_unlinkLRU( inst ) )
+      return;
+
+   _linkLRU( inst );
+}
+
+void DecalManager::_evictDynamicDecals()
+{
+   if ( smDynamicMemoryBudget <= 0 )
+      return;
+
+   PROFILE_SCOPE( DecalManager_EvictDynamicDecals );
+
+   const U32 budget = U32( smDynamicMemoryBudget ) * 1024;
+   while ( mDynamicMemory > budget && mLRUHead )
+      removeDecal( mLRUHead );
+}
+
+bool DecalManager::_isStaticDecal( const DecalInstance *inst )
+{
+   // Permanent decals never fade over time and, without a fade start
+   // size, always render at full alpha, so their vertices stay constant
+   // until they are modified or clipped again.
+
+   return   ( inst->mFlags & ( PermanentDecal | SaveDecal | CustomDecal ) ) == ( PermanentDecal | SaveDecal ) &&
+            inst->mDataBlock->fadeStartPixelSize < 0.0f;
+}
+
+void DecalManager::_updateStaticBuffers()
+{
+   PROFILE_SCOPE( DecalManager_UpdateStaticBuffers );
+
+   // Find the spheres whose static buffers are out of date because a decal
+   // became static or stopped being static since they were built.
+
+   for ( S32 i = 0; i < mDecalQueue.size(); i++ )
+   {
+      DecalInstance *dinst = mDecalQueue[i];
+      DecalSphere *sphere = dinst->mSphere;
+
+      if ( !sphere->mRenderStatic || sphere->mStaticDirty )
+         continue;
+
+      const bool isStatic = _isStaticDecal( dinst );
+      if ( isStatic == dinst->mInStaticBuffer )
+         continue;
+
+      // A static decal that would not fit into the 16-bit indices
+      // of the sphere's buffers stays in the per-frame path.
+      if ( isStatic && sphere->mStaticVertCount + dinst->mVertCount > U16_MAX )
+         continue;
+
+      sphere->mStaticDirty = true;
+   }
+
+   // Keep only the spheres that have static batches to render.  Note
+   // that removing the dynamic decals of other spheres after this
+   // may delete those spheres.
+
+   for ( S32 i = 0; i < mSphereQueue.size(); i++ )
+   {
+      DecalSphere *sphere = mSphereQueue[i];
+      if ( sphere->mRenderStatic && sphere->mStaticDirty )
+         _buildStaticBuffers( sphere );
+
+      if ( !sphere->mRenderStatic || sphere->mStaticBatches.empty() )
+      {
+         mSphereQueue.erase_fast( i );
+         i--;
+      }
+   }
+
+   // Everything that is drawn from static buffers this frame
+   // doesn't need to go through the per-frame batches.
+
+   for ( S32 i = 0; i < mDecalQueue.size(); i++ )
+   {
+      DecalInstance *dinst = mDecalQueue[i];
+      if ( dinst->mInStaticBuffer && dinst->mSphere->mRenderStatic )
+      {
+         mDecalQueue.erase_fast( i );
+         i--;
+      }
+   }
+}
+
+void DecalManager::_buildStaticBuffers( DecalSphere *sphere )
+{
+   PROFILE_SCOPE( DecalManager_BuildStaticBuffers );
+
+   sphere->clearStaticBuffers();
+   sphere->mStaticDirty = false;
+
+   // Collect the static decals with geometry, in the
+   // same order the per-frame batches would use.
+
+   Vector<DecalInstance*> items;
+   U32 vertCount = 0;
+   U32 indxCount = 0;
+
+   for ( S32 i = 0; i < sphere->mItems.size(); i++ )
+   {
+      DecalInstance *dinst = sphere->mItems[i];
+
+      if ( !_isStaticDecal( dinst ) || !dinst->mVerts || dinst->mVertCount == 0 || dinst->mIndxCount == 0 )
+         continue;
+      if ( vertCount + dinst->mVertCount > U16_MAX )
+         continue;
+
+      items.push_back( dinst );
+      vertCount += dinst->mVertCount;
+      indxCount += dinst->mIndxCount;
+   }
+
+   if ( items.empty() )
+      return;
+
+   dQsort( items.address(), items.size(), sizeof(DecalInstance*), cmpDecalRenderOrder );
+
+   sphere->mStaticVB.set( GFX, vertCount, GFXBufferTypeStatic );
+   sphere->mStaticPB.set( GFX, indxCount, 0, GFXBufferTypeStatic );
+
+   DecalVertex *vpPtr = sphere->mStaticVB.lock();
+   U16 *pbPtr;
+   sphere->mStaticPB.lock( &pbPtr );
+
+   DecalSphere::StaticBatch *batch = NULL;
+   U32 voffset = 0;
+   U32 ioffset = 0;
+
+   for ( S32 i = 0; i < items.size(); i++ )
+   {
+      DecalInstance *dinst = items[i];
+
+      if (  !batch ||
+            batch->dataBlock->getMaterial() != dinst->mDataBlock->getMaterial() ||
+            batch->priority != dinst->getRenderPriority() )
+      {
+         sphere->mStaticBatches.increment();
+         batch = &sphere->mStaticBatches.last();
+         batch->dataBlock = dinst->mDataBlock;
+         batch->priority = dinst->getRenderPriority();
+         batch->startIndex = ioffset;
+         batch->numPrimitives = 0;
+         batch->startVertex = voffset;
+         batch->numVertices = 0;
+      }
+
+      for ( U32 k = 0; k < dinst->mIndxCount; k++ )
+         pbPtr[ ioffset + k ] = dinst->mIndices[k] + voffset;
+
+      dMemcpy( vpPtr + voffset, dinst->mVerts, sizeof( DecalVertex ) * dinst->mVertCount );
+
+      ioffset += dinst->mIndxCount;
+      voffset += dinst->mVertCount;
+
+      batch->numPrimitives += dinst->mIndxCount / 3;
+      batch->numVertices += dinst->mVertCount;
+
+      dinst->mInStaticBuffer = true;
+   }
+
+   sphere->mStaticPB.unlock();
+   sphere->mStaticVB.unlock();
+
+   sphere->mStaticVertCount = vertCount;
+}
+
 void DecalManager::prepRenderImage( SceneRenderState* state )
 {
    PROFILE_SCOPE( DecalManager_RenderDecals );
@@ -1002,6 +1445,12 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
    if ( !state->isDiffusePass() )
       return;
 
+   // Pick up the decals clipped in the background and drop the oldest
+   // run-time decals if they are over budget.  This must happen before
+   // we start holding on to decals for this frame.
+   _processClipJobs();
+   _evictDynamicDecals();
+
    PROFILE_START( DecalManager_RenderDecals_SphereTreeCull );
 
    const Frustum& rootFrustum = state->getCameraFrustum();
@@ -1012,13 +1461,16 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
    SceneManager* sceneManager = state->getSceneManager();
    SceneZoneSpaceManager* zoneManager = sceneManager->getZoneManager();
    AssertFatal( zoneManager, "DecalManager::prepRenderImage - No zone manager!" );
-   const Vector<DecalSphere*> &grid = mData->getSphereList();
    const bool haveOnlyOutdoorZone = ( zoneManager->getNumActiveZones() == 1 );
+
+   // Only look at the spheres binned near the culling frustum.
+   mSphereQueue.clear();
+   mData->findSpheres( state->getCullingFrustum().getBounds(), &mSphereQueue );
    
    mDecalQueue.clear();
-   for ( U32 i = 0; i < grid.size(); i++ )
+   for ( S32 i = 0; i < mSphereQueue.size(); i++ )
    {
-      DecalSphere* decalSphere = grid[i];
+      DecalSphere* decalSphere = mSphereQueue[i];
       const SphereF& worldSphere = decalSphere->mWorldSphere;
 
       // See if this decal sphere can be culled.
@@ -1028,7 +1480,11 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
       {
          U32 outdoorZone = SceneZoneSpaceManager::RootZoneId;
          if( cullingState.isCulled( worldSphere, &outdoorZone, 1 ) )
+         {
+            mSphereQueue.erase_fast( i );
+            i--;
             continue;
+         }
       }
       else
       {
@@ -1040,13 +1496,19 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
          // Skip the sphere if it is not visible in any of its zones.
 
          if( cullingState.isCulled( worldSphere, decalSphere->mZones.address(), decalSphere->mZones.size() ) )
+         {
+            mSphereQueue.erase_fast( i );
+            i--;
             continue;
+         }
       }  
 
       // TODO: If each sphere stored its largest decal instance we
       // could do an LOD step on it here and skip adding any of the
       // decals in the sphere.
 
+      decalSphere->mRenderStatic = smStaticBuffers;
+
       mDecalQueue.merge( decalSphere->mItems );
    }
 
@@ -1060,6 +1522,9 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
    DecalInstance *dinst;
    DecalData *ddata;
 
+   // Decals to delete once we are done with the spheres of this frame.
+   Vector<DecalInstance*> removeDecals;
+
    // Loop through DecalQueue once for preRendering work.
    // 1. Update DecalInstance fade (over time)
    // 2. Clip geometry if flagged to do so.
@@ -1075,6 +1540,11 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
 
       if ( pixelSize != F32_MAX && pixelSize < ddata->fadeEndPixelSize )      
       {
+         // The static buffers of the sphere would still draw this
+         // decal, so the sphere has to use the per-frame path.
+         if ( dinst->mInStaticBuffer || _isStaticDecal( dinst ) )
+            dinst->mSphere->mRenderStatic = false;
+
          mDecalQueue.erase_fast( i );
          i--;
          continue;
@@ -1095,7 +1565,7 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
             if ( dinst->mVisibility <= 0.0f )
             {
                mDecalQueue.erase_fast( i );
-               removeDecal( dinst );               
+               removeDecals.push_back( dinst );
                i--;
                continue;
             }
@@ -1103,7 +1573,18 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
       }
 
       // Build clipped geometry for this decal if needed.
-      if ( dinst->mFlags & ClipDecal && !( dinst->mFlags & CustomDecal ) )
+      if ( dinst->mFlags & ClipDecal && !( dinst->mFlags & CustomDecal ) && smMaxPendingClips > 0 )
+      {
+         // Hand the clip to the thread pool.  The decal will show up once
+         // the clip is done.  If too many clips are pending, the flag stays
+         // set and we try again next frame.
+         if ( mClipJobs.size() < smMaxPendingClips )
+         {
+            dinst->mFlags = dinst->mFlags & ~ClipDecal;
+            _queueClipJob( dinst );
+         }
+      }
+      else if ( dinst->mFlags & ClipDecal && !( dinst->mFlags & CustomDecal ) )
       {  
          // Turn off the flag so we don't continually try to clip
          // if it fails.
@@ -1121,7 +1602,7 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
             // then we should also permanently delete the decal instance.
             if ( !(dinst->mFlags & SaveDecal) )
             {
-               removeDecal( dinst );
+               removeDecals.push_back( dinst );
             }
 
             // If this is a decal placed by the editor it will be
@@ -1175,11 +1656,19 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
 
          PROFILE_END();
       }
+
+      // Keep decals that are being looked at from being evicted.
+      _touchLRU( dinst );
    }
 
    PROFILE_END();      
 
-   if ( mDecalQueue.empty() )
+   _updateStaticBuffers();
+
+   for ( S32 i = 0; i < removeDecals.size(); i++ )
+      removeDecal( removeDecals[i] );
+
+   if ( mDecalQueue.empty() && mSphereQueue.empty() )
       return;
 
    // Sort queued decals...
@@ -1217,6 +1706,45 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
    // the prepass bin.
    baseRenderInst.sortDistSq = F32_MAX;
 
+   // Submit the static batches of the visible spheres straight
+   // from their persistent buffers.
+   U32 numStaticBatches = 0;
+   for ( S32 i = 0; i < mSphereQueue.size(); i++ )
+   {
+      DecalSphere *sphere = mSphereQueue[i];
+
+      for ( S32 j = 0; j < sphere->mStaticBatches.size(); j++ )
+      {
+         const DecalSphere::StaticBatch &batch = sphere->mStaticBatches[j];
+         BaseMatInstance *matInst = batch.dataBlock->getMaterialInstance();
+
+         if ( matInst->isForwardLit() && !baseRenderInst.lights[0] )
+            _getForwardLights( rootFrustum, baseRenderInst.lights );
+
+         MeshRenderInst *ri = renderPass->allocInst<MeshRenderInst>();
+         *ri = baseRenderInst;
+
+         ri->primBuff = &sphere->mStaticPB;
+         ri->vertBuff = &sphere->mStaticVB;
+
+         ri->matInst = matInst;
+
+         ri->prim = renderPass->allocPrim();
+         ri->prim->type = GFXTriangleList;
+         ri->prim->minIndex = batch.startVertex;
+         ri->prim->startIndex = batch.startIndex;
+         ri->prim->numPrimitives = batch.numPrimitives;
+         ri->prim->startVertex = 0;
+         ri->prim->numVertices = batch.numVertices;
+
+         ri->defaultKey = (U32)batch.priority;
+         ri->defaultKey2 = 1;
+
+         renderPass->addInst( ri );
+         numStaticBatches++;
+      }
+   }
+
    Vector<DecalBatch> batches;
    DecalBatch *currentBatch = NULL;
 
@@ -1371,13 +1899,7 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
       // Get the best lights for the current camera position
       // if the materail is forward lit and we haven't got them yet.
       if ( currentBatch.matInst->isForwardLit() && !baseRenderInst.lights[0] )
-      {
-         LightQuery query;
-         query.init( rootFrustum.getPosition(),
-                     rootFrustum.getTransform().getForwardVector(),
-                     rootFrustum.getFarDist() );
-		   query.getLights( baseRenderInst.lights, 8 );
-      }
+         _getForwardLights( rootFrustum, baseRenderInst.lights );
 
       // Submit render inst...
       MeshRenderInst *ri = renderPass->allocInst<MeshRenderInst>();
@@ -1410,7 +1932,8 @@ void DecalManager::prepRenderImage( SceneRenderState* state )
    }
 
 #ifdef TORQUE_GATHER_METRICS
-   Con::setIntVariable( "$Decal::Batches", batches.size() );
+   Con::setIntVariable( "$Decal::Batches", batches.size() + numStaticBatches );
+   Con::setIntVariable( "$Decal::StaticBatches", numStaticBatches );
    Con::setIntVariable( "$Decal::Buffers", mPBs.size() + mPBPool.size() );
    Con::setIntVariable( "$Decal::DecalsRendered", mDecalQueue.size() );
 #endif
@@ -1541,10 +2064,21 @@ void DecalManager::clearData()
          DecalSphere* sphere = grid[ i ];
          for( U32 n = 0; n < sphere->mItems.size(); ++ n )
             _freeBuffers( sphere->mItems[ n ] );
+
+         sphere->clearStaticBuffers();
       }
    }
    
+   // Results of clips still running are dropped.
+   for( S32 i = 0; i < mClipJobs.size(); ++ i )
+      mClipJobs[ i ]->mDecal = NULL;
+   mClipJobs.clear();
+
    mData = NULL;
+   mSphereQueue.clear();
+   mLRUHead = NULL;
+   mLRUTail = NULL;
+   mDynamicMemory = 0;
 	mDecalInstanceVec.clear();
 
    _freePools();   
@@ -63,6 +63,10 @@
 #include "core/dataChunker.h"
 #endif
 
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
+
 
 //#define DECALMANAGER_DEBUG
 
@@ -93,12 +97,24 @@ class DecalManager : public SceneObject
 
    protected:
       
+      struct ClipJob;
+
       /// The clipper we keep around between decal updates
       /// to avoid excessive memory allocations.
       ClippedPolyList mClipper;
 
+      /// Clipped geometry we keep around for the same reason.
+      Vector<DecalVertex> mClipVerts;
+      Vector<U16> mClipIndices;
+
+      /// Decal clips running on the thread pool.
+      Vector< ThreadSafeRef< ClipJob > > mClipJobs;
+
       Vector<DecalInstance*> mDecalQueue;
 
+      /// Decal spheres visible in the current frame.
+      Vector<DecalSphere*> mSphereQueue;
+
       StringTableEntry mDataFileName;
       Resource<DecalDataFile> mData;
       
@@ -136,6 +152,9 @@ class DecalManager : public SceneObject
       static bool smDecalsOn;
       static F32 smDecalLifeTimeScale;   
       static bool smPoolBuffers;
+      static bool smStaticBuffers;
+      static S32 smDynamicMemoryBudget;
+      static S32 smMaxPendingClips;
       static const U32 smMaxVerts;
       static const U32 smMaxIndices;
 
@@ -159,7 +178,40 @@ class DecalManager : public SceneObject
       // Rendering
       void prepRenderImage( SceneRenderState *state );
       
-      void _generateWindingOrder( const Point3F &cornerPoint, Vector<Point3F> *sortPoints );
+      static void _generateWindingOrder( const Point3F &cornerPoint, Vector<Point3F> *sortPoints );
+
+      /// @name Clipping
+      /// @{
+
+      /// Set up the clip planes for the decal and return its world
+      /// matrix and the world box to gather geometry from.
+      static void _setupClipper( DecalInstance *decal, const Point2F *clipDepth, ClippedPolyList *clipper, MatrixF *outProjMat, Box3F *outBox );
+
+      /// Triangulate the clipped geometry and generate the decal vertices and
+      /// indices from it.  Returns false if there is no usable geometry.  This
+      /// does not touch any shared state and may run on any thread.
+      static bool _buildClippedGeometry(  ClippedPolyList &clipper,
+                                          const MatrixF &worldToDecal,
+                                          F32 halfSize,
+                                          const RectF &texRect,
+                                          bool skipVertexNormals,
+                                          Vector<DecalVertex> *outVerts,
+                                          Vector<U16> *outIndices );
+
+      /// Replace the geometry of the decal.
+      void _setGeometry( DecalInstance *decal, const Vector<DecalVertex> &verts, const Vector<U16> &indices );
+
+      /// Gather the geometry around the decal and clip it on the thread pool.
+      void _queueClipJob( DecalInstance *decal );
+
+      /// Drop the result of a pending clip for the decal.  Returns true
+      /// if there was one.
+      bool _cancelClipJob( DecalInstance *decal );
+
+      /// Hand the geometry of finished clips to their decals.
+      void _processClipJobs();
+
+      /// @}
 
       // Helpers for creating and deleting the vert and index arrays
       // held by DecalInstance.
@@ -171,6 +223,47 @@ class DecalManager : public SceneObject
       /// allocating vertex and index arrays.
       S32 _getSizeClass( DecalInstance *inst ) const;
 
+      /// @name Static Decal Buffers
+      /// @{
+
+      /// Returns true if the decal never changes its geometry or alpha
+      /// on its own and can be drawn from its sphere's static buffers.
+      static bool _isStaticDecal( const DecalInstance *inst );
+
+      /// Rebuild the static buffers of the visible spheres that need it and
+      /// remove the decals drawn from them from the decal queue.
+      void _updateStaticBuffers();
+
+      /// Upload the static decals of the sphere into its static buffers.
+      void _buildStaticBuffers( DecalSphere *sphere );
+
+      /// @}
+
+      /// @name Dynamic Decal Budget
+      ///
+      /// The geometry of decals placed at run-time is tracked in least
+      /// recently rendered order so that the oldest ones can be dropped
+      /// once their memory exceeds #smDynamicMemoryBudget.
+      ///
+      /// @{
+
+      DecalInstance *mLRUHead;
+      DecalInstance *mLRUTail;
+
+      /// Bytes of vertex and index data held by decals in the LRU list.
+      U32 mDynamicMemory;
+
+      void _linkLRU( DecalInstance *inst );
+      bool _unlinkLRU( DecalInstance *inst );
+
+      /// Move a decal in the LRU list to its most recently used end.
+      void _touchLRU( DecalInstance *inst );
+
+      /// Remove least recently rendered decals until the budget is met.
+      void _evictDynamicDecals();
+
+      /// @}
+
       // Hide this from Doxygen
       /// @cond
       bool _handleGFXEvent(GFXDevice::GFXDeviceEventType event);
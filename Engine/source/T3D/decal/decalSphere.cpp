@@ -59,6 +59,7 @@ bool DecalSphere::tryAddItem( DecalInstance* inst )
    // Otherwise, go with this sphere and add the item to it.
 
    mItems.push_back( inst );
+   inst->mSphere = this;
 
    // Update the sphere bounds, if necessary.
 
@@ -107,3 +108,17 @@ void DecalSphere::updateZoning( SceneZoneSpaceManager* zoneManager )
 
    zoneManager->findZones( aabb, mZones );
 }
+
+//-----------------------------------------------------------------------------
+
+void DecalSphere::clearStaticBuffers()
+{
+   for( U32 i = 0; i < mItems.size(); ++ i )
+      mItems[ i ]->mInStaticBuffer = false;
+
+   mStaticVB = NULL;
+   mStaticPB = NULL;
+   mStaticBatches.clear();
+   mStaticVertCount = 0;
+   mStaticDirty = true;
+}
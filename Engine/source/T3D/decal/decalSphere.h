@@ -31,6 +31,18 @@
 #include "math/mSphere.h"
 #endif
 
+#ifndef _GFXVERTEXBUFFER_H_
+#include "gfx/gfxVertexBuffer.h"
+#endif
+
+#ifndef _GFXPRIMITIVEBUFFER_H_
+#include "gfx/gfxPrimitiveBuffer.h"
+#endif
+
+#ifndef _DECALDATA_H_
+#include "T3D/decal/decalData.h"
+#endif
+
 
 class DecalInstance;
 class SceneZoneSpaceManager;
@@ -46,15 +58,37 @@ class DecalSphere
       static F32 smDistanceTolerance;
       static F32 smRadiusTolerance;
 
+      /// A run of decals in #mStaticVB that share a material and
+      /// render priority and can be drawn with a single call.
+      struct StaticBatch
+      {
+         DecalData *dataBlock;
+         U8 priority;
+         U32 startIndex;
+         U32 numPrimitives;
+         U32 startVertex;
+         U32 numVertices;
+      };
+
       DecalSphere()
+         : mGridKey( U32_MAX ),
+           mStaticVertCount( 0 ),
+           mStaticDirty( true ),
+           mRenderStatic( false )
       {
          VECTOR_SET_ASSOCIATION( mItems );
          VECTOR_SET_ASSOCIATION( mZones );
+         VECTOR_SET_ASSOCIATION( mStaticBatches );
       }
       DecalSphere( const Point3F &position, F32 radius )
+         : mGridKey( U32_MAX ),
+           mStaticVertCount( 0 ),
+           mStaticDirty( true ),
+           mRenderStatic( false )
       {
          VECTOR_SET_ASSOCIATION( mItems );
          VECTOR_SET_ASSOCIATION( mZones );
+         VECTOR_SET_ASSOCIATION( mStaticBatches );
 
          mWorldSphere.center = position;
          mWorldSphere.radius = radius;
@@ -76,8 +110,41 @@ class DecalSphere
       /// World-space sphere corresponding to this DecalSphere.
       SphereF mWorldSphere;
 
+      /// Key of the DecalDataFile grid cell this sphere is binned into.
+      U32 mGridKey;
+
       ///
       bool tryAddItem( DecalInstance* inst );
+
+      /// @name Static Geometry
+      ///
+      /// Permanent, saved decals in this sphere are uploaded once into
+      /// a pair of static buffers and drawn from there until the set of
+      /// decals or their geometry changes.
+      ///
+      /// @{
+
+      GFXVertexBufferHandle< DecalVertex > mStaticVB;
+
+      GFXPrimitiveBufferHandle mStaticPB;
+
+      Vector< StaticBatch > mStaticBatches;
+
+      /// Number of vertices in #mStaticVB.
+      U32 mStaticVertCount;
+
+      /// Set when the static buffers no longer match the decals
+      /// in the sphere and must be rebuilt before use.
+      bool mStaticDirty;
+
+      /// Set by the DecalManager for the current frame if the static
+      /// buffers of this sphere can be used for rendering.
+      bool mRenderStatic;
+
+      /// Release the static buffers and mark them dirty.
+      void clearStaticBuffers();
+
+      /// @}
 };
 
 #endif // !_DECALSPHERE_H_
\ No newline at end of file
@@ -0,0 +1,238 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "T3D/gameBase/dataBlockCache.h"
+
+#include "console/simDatablock.h"
+#include "core/stream/bitStream.h"
+#include "core/stream/fileStream.h"
+#include "core/util/hashFunction.h"
+
+
+static const U32 DataBlockCacheFourCC = makeFourCCTag( 'D', 'B', 'C', 'F' );
+static const U32 DataBlockCacheVersion = 1;
+
+bool DataBlockCache::smEnabled = true;
+bool DataBlockCache::smServerManifest = true;
+String DataBlockCache::smCacheFile( "cache/dataBlocks.dbc" );
+S32 DataBlockCache::smMaxSize = 4096;
+Map<U32,DataBlockCache::ServerPayload> DataBlockCache::smServerPayloads;
+
+
+DataBlockCache::DataBlockCache()
+   :  mSession( 0 ),
+      mDataSize( 0 ),
+      mLoaded( false ),
+      mDirty( false )
+{
+}
+
+DataBlockCache* DataBlockCache::get()
+{
+   static DataBlockCache smCache;
+   if ( !smCache.mLoaded )
+      smCache._load();
+   return &smCache;
+}
+
+U64 DataBlockCache::computeHash( const char *className, const U8 *data, U32 bitCount )
+{
+   // Seed with the class name so that identical bits unpacked
+   // by different classes never share an entry.
+   U64 seed = Torque::hash( (const U8*)className, dStrlen( className ), bitCount );
+   return Torque::hash64( data, ( bitCount + 7 ) >> 3, seed );
+}
+
+const DataBlockCache::Payload& DataBlockCache::getServerPayload( SimDataBlock *dataBlock )
+{
+   ServerPayload &payload = smServerPayloads[ dataBlock->getId() ];
+   if ( payload.modifiedKey == dataBlock->getModifiedKey() )
+      return payload;
+
+   // Pack into a zeroed buffer without a string compression
+   // point so the trailing bits hash consistently and the
+   // payload can be unpacked standalone.
+   static U8 sBuffer[ MaxPayloadBits >> 3 ];
+   dMemset( sBuffer, 0, sizeof( sBuffer ) );
+   BitStream stream( sBuffer, sizeof( sBuffer ) );
+   stream.clearCompressionPoint();
+   dataBlock->packData( &stream );
+
+   payload.modifiedKey = dataBlock->getModifiedKey();
+   payload.bitCount = stream.getCurPos();
+   payload.data.setSize( ( payload.bitCount + 7 ) >> 3 );
+   dMemcpy( payload.data.address(), sBuffer, payload.data.size() );
+   payload.hash = computeHash( dataBlock->getClassName(), payload.data.address(), payload.bitCount );
+
+   return payload;
+}
+
+void DataBlockCache::removeServerPayload( U32 id )
+{
+   smServerPayloads.erase( id );
+}
+
+void DataBlockCache::clearServerPayloads()
+{
+   smServerPayloads.clear();
+}
+
+const DataBlockCache::Payload* DataBlockCache::find( U64 hash )
+{
+   Map<U32,Entry>::Iterator iter = mEntries.find( _foldHash( hash ) );
+   if ( iter == mEntries.end() || iter->value.hash != hash )
+      return NULL;
+
+   if ( iter->value.lastUse != mSession )
+   {
+      iter->value.lastUse = mSession;
+      mDirty = true;
+   }
+
+   return &iter->value;
+}
+
+bool DataBlockCache::store( const char *className, U64 hash, const U8 *data, U32 bitCount )
+{
+   if ( bitCount > MaxPayloadBits || computeHash( className, data, bitCount ) != hash )
+      return false;
+
+   Entry &entry = mEntries[ _foldHash( hash ) ];
+   mDataSize -= entry.data.size();
+
+   entry.hash = hash;
+   entry.bitCount = bitCount;
+   entry.className = className;
+   entry.lastUse = mSession;
+   entry.data.setSize( ( bitCount + 7 ) >> 3 );
+   dMemcpy( entry.data.address(), data, entry.data.size() );
+
+   mDataSize += entry.data.size();
+   mDirty = true;
+   return true;
+}
+
+void DataBlockCache::_trim()
+{
+   const U32 maxSize = getMax( smMaxSize, 0 ) * 1024;
+
+   while ( mDataSize > maxSize && !mEntries.isEmpty() )
+   {
+      Map<U32,Entry>::Iterator oldest = mEntries.begin();
+      for ( Map<U32,Entry>::Iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter )
+      {
+         if ( iter->value.lastUse < oldest->value.lastUse )
+            oldest = iter;
+      }
+
+      mDataSize -= oldest->value.data.size();
+      mEntries.erase( oldest );
+      mDirty = true;
+   }
+}
+
+void DataBlockCache::_load()
+{
+   mLoaded = true;
+   mEntries.clear();
+   mDataSize = 0;
+   mSession = 0;
+
+   FileStream *stream = FileStream::createAndOpen( smCacheFile, Torque::FS::File::Read );
+   if ( !stream )
+      return;
+
+   U32 fourCC = 0, version = 0, count = 0;
+   stream->read( &fourCC );
+   stream->read( &version );
+   if ( fourCC != DataBlockCacheFourCC || version != DataBlockCacheVersion )
+   {
+      Con::warnf( "DataBlockCache::_load - Ignoring invalid cache file '%s'.", smCacheFile.c_str() );
+      delete stream;
+      return;
+   }
+
+   stream->read( &mSession );
+   stream->read( &count );
+
+   for ( U32 i = 0; i < count && stream->getStatus() == Stream::Ok; i++ )
+   {
+      U64 hash;
+      U32 lastUse, bitCount;
+      String className;
+      stream->read( &hash );
+      stream->read( &lastUse );
+      stream->read( &className );
+      stream->read( &bitCount );
+      if ( bitCount > MaxPayloadBits )
+         break;
+
+      Vector<U8> data;
+      data.setSize( ( bitCount + 7 ) >> 3 );
+      if ( !stream->read( data.size(), data.address() ) )
+         break;
+
+      // Entries which fail verification are silently dropped.
+      if ( store( className, hash, data.address(), bitCount ) )
+         mEntries[ _foldHash( hash ) ].lastUse = lastUse;
+   }
+
+   delete stream;
+
+   // Every load starts a new session for aging entries.
+   mSession++;
+   mDirty = false;
+}
+
+void DataBlockCache::save()
+{
+   if ( !mDirty || !smEnabled )
+      return;
+
+   _trim();
+
+   FileStream *stream = FileStream::createAndOpen( smCacheFile, Torque::FS::File::Write );
+   if ( !stream )
+   {
+      Con::errorf( "DataBlockCache::save - Failed to open '%s' for writing.", smCacheFile.c_str() );
+      return;
+   }
+
+   stream->write( DataBlockCacheFourCC );
+   stream->write( DataBlockCacheVersion );
+   stream->write( mSession );
+   stream->write( (U32)mEntries.size() );
+
+   for ( Map<U32,Entry>::Iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter )
+   {
+      const Entry &entry = iter->value;
+      stream->write( entry.hash );
+      stream->write( entry.lastUse );
+      stream->write( entry.className );
+      stream->write( entry.bitCount );
+      stream->write( entry.data.size(), entry.data.address() );
+   }
+
+   delete stream;
+   mDirty = false;
+}
@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _DATABLOCKCACHE_H_
+#define _DATABLOCKCACHE_H_
+
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
+#ifndef _TORQUE_STRING_H_
+#include "core/util/str.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+
+class SimDataBlock;
+
+
+/// Content addressed store of packed datablock payloads.
+///
+/// On the server every datablock is packed once into a standalone bit
+/// stream and hashed.  Instead of streaming every datablock to a connecting
+/// client the server sends a manifest of hashes; the client looks each one
+/// up in its persistent cache and only requests the payloads it is missing.
+///
+/// Payloads are packed without string compression so the cached bits can
+/// be unpacked outside of the connection they were received on.
+///
+/// @see GameConnection::sendDataBlockManifest
+class DataBlockCache
+{
+public:
+
+   enum Constants
+   {
+      /// Largest payload that can be transmitted or cached.
+      MaxPayloadBits = 16384 * 8,
+      PayloadBitCountBits = 18,
+   };
+
+   /// A packed datablock.
+   struct Payload
+   {
+      /// Content hash of the payload, seeded with the class name.
+      U64 hash;
+
+      /// Number of valid bits in data.
+      U32 bitCount;
+
+      Vector<U8> data;
+
+      Payload() : hash( 0 ), bitCount( 0 ) {}
+   };
+
+   /// If true the client keeps received payloads in the cache
+   /// file and uses them to skip retransmission.
+   static bool smEnabled;
+
+   /// If true the server sends a manifest of payload hashes
+   /// rather than streaming every datablock.
+   static bool smServerManifest;
+
+   /// Path of the persistent client cache.
+   static String smCacheFile;
+
+   /// Maximum size of the persistent cache in kilobytes.
+   static S32 smMaxSize;
+
+   /// Returns the hash for a payload of the given class.
+   static U64 computeHash( const char *className, const U8 *data, U32 bitCount );
+
+   /// Returns the packed payload of a server datablock, packing it
+   /// again only if it was modified since the last call.
+   static const Payload& getServerPayload( SimDataBlock *dataBlock );
+
+   /// Forgets the packed payload of a server datablock.
+   static void removeServerPayload( U32 id );
+
+   /// Forgets all the packed server payloads.  This must be done
+   /// whenever datablock ids and modified keys start over.
+   static void clearServerPayloads();
+
+   /// Returns the client cache, loading it on first use.
+   static DataBlockCache* get();
+
+   /// Looks up a cached payload by hash.
+   const Payload* find( U64 hash );
+
+   /// Adds a payload to the cache.  The data is verified
+   /// against the hash and rejected if it does not match.
+   bool store( const char *className, U64 hash, const U8 *data, U32 bitCount );
+
+   /// Writes the cache out if it changed since the last save.
+   void save();
+
+protected:
+
+   struct Entry : public Payload
+   {
+      /// Class the payload was packed for.
+      String className;
+
+      /// Session in which this entry was last used.
+      U32 lastUse;
+
+      Entry() : lastUse( 0 ) {}
+   };
+
+   /// Entries keyed by the folded 32bit hash.
+   Map<U32,Entry> mEntries;
+
+   /// Current session stamp used to age out entries.
+   U32 mSession;
+
+   /// Total bytes of payload data held by the cache.
+   U32 mDataSize;
+
+   bool mLoaded;
+   bool mDirty;
+
+   struct ServerPayload : public Payload
+   {
+      /// Modified key of the datablock when it was packed.
+      S32 modifiedKey;
+
+      ServerPayload() : modifiedKey( -1 ) {}
+   };
+
+   /// Server side payloads keyed by datablock id.
+   static Map<U32,ServerPayload> smServerPayloads;
+
+   DataBlockCache();
+
+   static U32 _foldHash( U64 hash ) { return U32( hash ) ^ U32( hash >> 32 ); }
+
+   void _load();
+
+   /// Drops the least recently used entries until
+   /// the cache fits in the size budget.
+   void _trim();
+};
+
+#endif // _DATABLOCKCACHE_H_
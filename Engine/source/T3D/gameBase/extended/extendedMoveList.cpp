@@ -136,8 +136,10 @@ void ExtendedMoveList::collectMove()
       if(!mConnection->isPlayingBack() && getNextExtMove(mv))
       {
          mv.checksum=Move::ChecksumMismatch;
-         pushMove(mv);
+         // Record first, demo keyframes are taken before a move
+         // block and must not already hold the move.
          mConnection->recordBlock(GameConnection::BlockTypeMove, sizeof(ExtendedMove), &mv);
+         pushMove(mv);
       }
    }
    else
@@ -36,6 +36,8 @@
 #include "T3D/camera.h"
 #include "T3D/gameBase/gameProcess.h"
 #include "T3D/gameBase/gameConnectionEvents.h"
+#include "scene/sceneManager.h"
+#include "scene/sceneInterestGrid.h"
 #include "console/engineAPI.h"
 #include "math/mTransform.h"
 
@@ -187,6 +189,11 @@ GameConnection::GameConnection()
 
    mDataBlockModifiedKey = 0;
    mMaxDataBlockModifiedKey = 0;
+   mDataBlockManifestPos = 0;
+   mDataBlockManifestTotal = 0;
+   mDataBlockManifestSequence = 0;
+   mDataBlockManifestComplete = false;
+   mDataBlockRequestSequence = 0;
    mAuthInfo = NULL;
    mControlForceMismatch = false;
    mConnectArgc = 0;
@@ -795,6 +802,11 @@ void GameConnection::onRemove()
 
    if (mControlObject)
       mControlObject->setControllingClient(0);
+
+   // Drop our subscription to the server's interest grid.
+   if (!isConnectionToServer() && gServerSceneGraph && gServerSceneGraph->getInterestGrid())
+      gServerSceneGraph->getInterestGrid()->removeConnection(this);
+
    Parent::onRemove();
 }
 
@@ -811,9 +823,9 @@ void GameConnection::handleRecordedBlock(U32 type, U32 size, void *data)
    switch(type)
    {
       case BlockTypeMove:
-         mMoveList->pushMove(*((Move *) data));
          if(isRecording()) // put it back into the stream
             recordBlock(type, size, data);
+         mMoveList->pushMove(*((Move *) data));
          break;
       default:
          Parent::handleRecordedBlock(type, size, data);
@@ -837,6 +849,17 @@ void GameConnection::writeDemoStartBlock(ResizeBitStream *stream)
       }
    }
    stream->writeFlag(false);
+   writeDemoState(stream, false);
+   mLastControlRequestTime = Platform::getVirtualMilliseconds();
+}
+
+void GameConnection::writeDemoKeyframe(ResizeBitStream *stream)
+{
+   writeDemoState(stream, true);
+}
+
+void GameConnection::writeDemoState(ResizeBitStream *stream, bool keyframe)
+{
    stream->write(mFirstPerson);
    stream->write(mCameraPos);
    stream->write(mCameraSpeed);
@@ -846,26 +869,30 @@ void GameConnection::writeDemoStartBlock(ResizeBitStream *stream)
    stream->write(mAddYawToAbsRot);
    stream->write(mAddPitchToAbsRot);
 
-   stream->writeString(Con::getVariable("$Client::MissionFile"));
+   if(!keyframe)
+      stream->writeString(Con::getVariable("$Client::MissionFile"));
 
    mMoveList->writeDemoStartBlock(stream);
 
-   // dump all the "demo" vars associated with this connection:
-   SimFieldDictionaryIterator itr(getFieldDictionary());
-
-   SimFieldDictionary::Entry *entry;
-   while((entry = *itr) != NULL)
+   if(!keyframe)
    {
-      if(!dStrnicmp(entry->slotName, "demo", 4))
+      // dump all the "demo" vars associated with this connection:
+      SimFieldDictionaryIterator itr(getFieldDictionary());
+
+      SimFieldDictionary::Entry *entry;
+      while((entry = *itr) != NULL)
       {
-         stream->writeFlag(true);
-         stream->writeString(entry->slotName + 4);
-         stream->writeString(entry->value);
-         stream->validate();
+         if(!dStrnicmp(entry->slotName, "demo", 4))
+         {
+            stream->writeFlag(true);
+            stream->writeString(entry->slotName + 4);
+            stream->writeString(entry->value);
+            stream->validate();
+         }
+         ++itr;
       }
-      ++itr;
+      stream->writeFlag(false);
    }
-   stream->writeFlag(false);
    Parent::writeDemoStartBlock(stream);
 
    stream->validate();
@@ -899,7 +926,6 @@ void GameConnection::writeDemoStartBlock(ResizeBitStream *stream)
       mCameraObject->getClassRep()->updateNetStatWriteData( stream->getBitPosition() - beginPos);
 #endif
    }
-   mLastControlRequestTime = Platform::getVirtualMilliseconds();
 }
 
 bool GameConnection::readDemoStartBlock(BitStream *stream)
@@ -918,6 +944,16 @@ bool GameConnection::readDemoStartBlock(BitStream *stream)
          return false;
    }
 
+   return readDemoState(stream, false);
+}
+
+bool GameConnection::readDemoKeyframe(BitStream *stream)
+{
+   return readDemoState(stream, true);
+}
+
+bool GameConnection::readDemoState(BitStream *stream, bool keyframe)
+{
    stream->read(&mFirstPerson);
    stream->read(&mCameraPos);
    stream->read(&mCameraSpeed);
@@ -927,9 +963,12 @@ bool GameConnection::readDemoStartBlock(BitStream *stream)
    stream->read(&mAddYawToAbsRot);
    stream->read(&mAddPitchToAbsRot);
 
-   char buf[256];
-   stream->readString(buf);
-   Con::setVariable("$Client::MissionFile",buf);
+   if(!keyframe)
+   {
+      char buf[256];
+      stream->readString(buf);
+      Con::setVariable("$Client::MissionFile",buf);
+   }
 
    mMoveList->readDemoStartBlock(stream);
 
@@ -937,7 +976,7 @@ bool GameConnection::readDemoStartBlock(BitStream *stream)
    // they are all tagged on to the object and start with the
    // string "demo"
 
-   while(stream->readFlag())
+   while(!keyframe && stream->readFlag())
    {
       StringTableEntry slotName = StringTable->insert("demo");
       char array[256];
@@ -1513,6 +1552,166 @@ void GameConnection::preloadNextDataBlock(bool hadNewFiles)
    }
 }
 
+void GameConnection::sendDataBlockManifest(U32 startIndex)
+{
+   SimDataBlockGroup *g = Sim::getDataBlockGroup();
+   const S32 key = getDataBlockModifiedKey();
+   S32 maxKey = key;
+
+   mDataBlockRequests.clear();
+   mDataBlockRequestSequence = getDataBlockSequence();
+
+   DataBlockManifestEvent *evt = NULL;
+   for(U32 i = startIndex; i < g->size(); i++)
+   {
+      SimDataBlock *blk = (SimDataBlock *) (*g)[i];
+      if(blk->getModifiedKey() <= key)
+         continue;
+
+      maxKey = getMax(maxKey, blk->getModifiedKey());
+
+      if(!evt || evt->getEntries().size() == DataBlockManifestEvent::MaxEntries)
+      {
+         if(evt)
+            postNetEvent(evt);
+         evt = new DataBlockManifestEvent(getDataBlockSequence(), g->size());
+      }
+
+      DataBlockManifestEntry entry;
+      entry.index = i;
+      entry.id = blk->getId();
+      entry.classId = blk->getClassId(getNetClassGroup());
+      entry.hash = DataBlockCache::getServerPayload(blk).hash;
+      entry.cached = false;
+      evt->getEntries().push_back(entry);
+   }
+
+   setMaxDataBlockModifiedKey(maxKey);
+
+   if(!evt)
+      evt = new DataBlockManifestEvent(getDataBlockSequence(), g->size());
+   evt->setLast(true);
+   postNetEvent(evt);
+}
+
+void GameConnection::onDataBlockManifest(U32 sequence, U32 total, const Vector<DataBlockManifestEntry> &entries, bool last)
+{
+   // Start over for a new transmission.
+   if(sequence != mDataBlockManifestSequence || mDataBlockManifestComplete)
+   {
+      mDataBlockManifest.clear();
+      mDataBlockManifestPos = 0;
+      mDataBlockManifestSequence = sequence;
+      mDataBlockManifestComplete = false;
+   }
+
+   mDataBlockManifestTotal = total;
+   mDataBlockManifest.merge(entries);
+   if(!last)
+      return;
+
+   mDataBlockManifestComplete = true;
+
+   // Request everything we don't have cached.
+   DataBlockCache *cache = DataBlockCache::smEnabled ? DataBlockCache::get() : NULL;
+   DataBlockRequestEvent *evt = new DataBlockRequestEvent(sequence);
+   for(U32 i = 0; i < mDataBlockManifest.size(); i++)
+   {
+      DataBlockManifestEntry &entry = mDataBlockManifest[i];
+      entry.cached = cache && cache->find(entry.hash);
+      if(entry.cached)
+         continue;
+
+      if(evt->getIndices().size() == DataBlockRequestEvent::MaxIndices)
+      {
+         postNetEvent(evt);
+         evt = new DataBlockRequestEvent(sequence);
+      }
+      evt->getIndices().push_back(entry.index);
+   }
+
+   evt->setLast(true);
+   postNetEvent(evt);
+
+   loadCachedDataBlocks();
+}
+
+void GameConnection::onDataBlockPayload(U32 index, const char *className, const DataBlockCache::Payload &payload)
+{
+   if(DataBlockCache::smEnabled)
+      DataBlockCache::get()->store(className, payload.hash, payload.data.address(), payload.bitCount);
+
+   if(mDataBlockManifestPos < mDataBlockManifest.size() && mDataBlockManifest[mDataBlockManifestPos].index == index)
+      mDataBlockManifestPos++;
+}
+
+void GameConnection::loadCachedDataBlocks()
+{
+   if(!mDataBlockManifestComplete)
+      return;
+
+   while(mDataBlockManifestPos < mDataBlockManifest.size())
+   {
+      const DataBlockManifestEntry &entry = mDataBlockManifest[mDataBlockManifestPos];
+
+      // Stall until the server sends the requested payload.
+      if(!entry.cached)
+         return;
+
+      const DataBlockCache::Payload *payload = DataBlockCache::get()->find(entry.hash);
+      if(!payload)
+      {
+         setLastError("Missing cached datablock.");
+         return;
+      }
+
+      SimDataBlock *obj = SimDataBlockEvent::createDataBlock(this, entry.id, entry.classId);
+      if(!obj)
+         return;
+
+      BitStream stream((void *) payload->data.address(), payload->data.size());
+      obj->unpackData(&stream);
+
+      mDataBlockManifestPos++;
+      SimDataBlockEvent::processDataBlock(this, obj, entry.id, entry.index, mDataBlockManifestTotal);
+      if(obj)
+         delete obj;
+   }
+}
+
+void GameConnection::onDataBlockRequest(U32 sequence, const Vector<U32> &indices, bool last)
+{
+   if(sequence != getDataBlockSequence() || sequence != mDataBlockRequestSequence)
+      return;
+
+   SimDataBlockGroup *g = Sim::getDataBlockGroup();
+   for(U32 i = 0; i < indices.size(); i++)
+   {
+      if(indices[i] < g->size() && mDataBlockRequests.size() < g->size())
+         mDataBlockRequests.push_back(indices[i]);
+   }
+
+   if(!last)
+      return;
+
+   // Everything was cached so we're already done.
+   if(mDataBlockRequests.empty())
+   {
+      setDataBlockModifiedKey(getMaxDataBlockModifiedKey());
+      sendConnectionMessage(DataBlocksDone, sequence);
+      return;
+   }
+
+   const U32 count = getMin(S32(DataBlockQueueCount), mDataBlockRequests.size());
+   for(U32 i = 0; i < count; i++)
+   {
+      SimDataBlock *blk = (SimDataBlock *) (*g)[mDataBlockRequests[i]];
+      SimDataBlockEvent *evt = new SimDataBlockEvent(blk, mDataBlockRequests[i], g->size(), sequence);
+      evt->setRequestIndex(i);
+      postNetEvent(evt);
+   }
+}
+
 void GameConnection::onEndGhosting()
 {
    Parent::onEndGhosting();
@@ -1561,6 +1760,13 @@ void GameConnection::handleConnectionMessage(U32 message, U32 sequence, U32 ghos
    {
       if(message == DataBlocksDone)
       {
+         // The manifest is fully loaded by now, so keep
+         // what we received for the next connection.
+         mDataBlockManifest.clear();
+         mDataBlockManifestPos = 0;
+         if(DataBlockCache::smEnabled)
+            DataBlockCache::get()->save();
+
          mDataBlockLoadList.push_back(NULL);
          mDataBlockSequence = sequence;
          if(mDataBlockLoadList.size() == 1)
@@ -1702,6 +1908,13 @@ DefineEngineMethod( GameConnection, transmitDataBlocks, void, (S32 sequence),,
             return;
         }
 
+        // Let the client pick what it needs out of its cache.
+        if (DataBlockCache::smServerManifest)
+        {
+            object->sendDataBlockManifest(i);
+            return;
+        }
+
         // Set the maximum datablock modified key value.
         object->setMaxDataBlockModifiedKey(iKey);
 
@@ -2007,6 +2220,26 @@ DefineEngineMethod( GameConnection, delete, void, (const char* reason), (""),
 //--------------------------------------------------------------------------
 void GameConnection::consoleInit()
 {
+   Con::addVariable("$pref::Net::dataBlockCache", TypeBool, &DataBlockCache::smEnabled,
+      "@brief If true the client caches received datablocks and loads unchanged ones from the cache "
+      "instead of having the server retransmit them.\n\n"
+      "@ingroup Networking\n");
+
+   Con::addVariable("$pref::Net::dataBlockCacheFile", TypeRealString, &DataBlockCache::smCacheFile,
+      "@brief Path of the client's persistent datablock cache.\n\n"
+      "@ingroup Networking\n");
+
+   Con::addVariable("$pref::Net::dataBlockCacheSize", TypeS32, &DataBlockCache::smMaxSize,
+      "@brief Maximum size of the client's datablock cache in kilobytes.  The least recently "
+      "used datablocks are dropped when it is exceeded.\n\n"
+      "@ingroup Networking\n");
+
+   Con::addVariable("$pref::Net::dataBlockManifest", TypeBool, &DataBlockCache::smServerManifest,
+      "@brief If true the server sends a manifest of datablock hashes and only transmits the "
+      "datablocks missing from the client's cache.\n\n"
+      "@see $pref::Net::dataBlockCache\n\n"
+      "@ingroup Networking\n");
+
    Con::addVariable("$pref::Net::LagThreshold", TypeS32, &mLagThresholdMS,
       "@brief How long between received packets before the client is considered as lagging (in ms).\n\n"
 
@@ -2082,6 +2315,71 @@ DefineEngineMethod( GameConnection, playDemo, bool, (const char* demoFileName),,
    return true;
 }
 
+DefineEngineMethod( GameConnection, seekDemo, bool, (S32 tick),,
+   "@brief On the client, jump to a tick of the demo being played back.\n\n"
+
+   "The connection is restored from the nearest keyframe before the tick and the "
+   "simulation is then advanced to the tick as fast as possible.  This can also be "
+   "used to fast forward a demo, for example to analyze it without rendering.\n\n"
+
+   "@param tick The tick to jump to, counted from the start of the demo.\n"
+   "@returns True if the demo could be seeked.  Demos recorded with "
+   "$pref::Net::demoKeyframeInterval set to 0 cannot be seeked, and the seek "
+   "gives up if playback stops advancing before the tick.\n\n"
+
+   "@see GameConnection::getDemoTick(), GameConnection::getDemoLength()")
+{
+   if(!object->isPlayingBack() || tick < 0)
+      return false;
+
+   // Stop short of the end, which deletes the connection.
+   U32 target = tick;
+   if(object->getDemoTotalTicks())
+      target = getMin(target, object->getDemoTotalTicks() - 1);
+
+   // Demo blocks are only read while ticking the server connection.
+   if(GameConnection::getConnectionToServer() != object || !object->seekDemo(target))
+      return false;
+
+   // The demo may still end early if it was not stopped properly.  Give up
+   // if the client stops reading blocks, for example while it is backlogged.
+   const U32 MaxStalledSteps = 32;
+   U32 stalledSteps = 0;
+   SimObjectPtr<GameConnection> conn = object;
+   while(!conn.isNull() && conn->isPlayingBack() && conn->getDemoTick() < target)
+   {
+      const U32 lastTick = conn->getDemoTick();
+      ClientProcessList::get()->advanceTime(TickMs);
+
+      if(conn.isNull() || conn->getDemoTick() != lastTick)
+         stalledSteps = 0;
+      else if(++stalledSteps >= MaxStalledSteps)
+      {
+         Con::warnf("GameConnection::seekDemo - Playback stopped advancing at tick %d.", lastTick);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+DefineEngineMethod( GameConnection, getDemoTick, S32, (),,
+   "@brief Returns the number of ticks recorded or played back in the current demo.\n\n"
+
+   "@see GameConnection::seekDemo()")
+{
+   return object->getDemoTick();
+}
+
+DefineEngineMethod( GameConnection, getDemoLength, S32, (),,
+   "@brief Returns the length in ticks of the demo being played back, or 0 if it is "
+   "unknown because the recording was not stopped properly.\n\n"
+
+   "@see GameConnection::seekDemo()")
+{
+   return object->getDemoTotalTicks();
+}
+
 DefineEngineMethod( GameConnection, isDemoPlaying, bool, (),,
    "@brief Returns true if a previously recorded demo file is now playing.\n\n"
    
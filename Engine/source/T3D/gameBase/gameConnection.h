@@ -38,6 +38,9 @@
 #ifndef _BITVECTOR_H_
 #include "core/bitVector.h"
 #endif
+#ifndef _DATABLOCKCACHE_H_
+#include "T3D/gameBase/dataBlockCache.h"
+#endif
 
 enum GameConnectionConstants
 {
@@ -178,6 +181,57 @@ protected:
 
    Vector<SimDataBlock *> mDataBlockLoadList;
 
+public:
+
+   /// A datablock listed in the server's datablock manifest.
+   struct DataBlockManifestEntry
+   {
+      /// Index of the datablock in the server's datablock group.
+      U32 index;
+
+      SimObjectId id;
+      S32 classId;
+
+      /// Hash of the packed datablock.
+      U64 hash;
+
+      /// Client side flag set if the payload was found in the cache.
+      bool cached;
+   };
+
+protected:
+
+   /// @name Datablock Manifest
+   ///
+   /// When enabled the server sends the hashes of the datablocks it is
+   /// about to transmit and the client only requests the ones which are
+   /// not in its DataBlockCache.  Cached datablocks are loaded in manifest
+   /// order, stalling at each requested one until its payload arrives.
+   /// @{
+
+   /// Client side manifest of the current datablock transmission.
+   Vector<DataBlockManifestEntry> mDataBlockManifest;
+
+   /// Client side number of manifest entries which have been loaded.
+   U32 mDataBlockManifestPos;
+
+   /// Total datablocks in the server's datablock group.
+   U32 mDataBlockManifestTotal;
+
+   /// Sequence of the manifest being received.
+   U32 mDataBlockManifestSequence;
+
+   /// Set once the last chunk of the manifest has arrived.
+   bool mDataBlockManifestComplete;
+
+   /// Server side datablock group indices requested by the client.
+   Vector<U32> mDataBlockRequests;
+
+   /// Server side sequence of the requests being received.
+   U32 mDataBlockRequestSequence;
+
+   /// @}
+
 public:
 
    MoveList *mMoveList;
@@ -215,7 +269,15 @@ protected:
 
    void writeDemoStartBlock   (ResizeBitStream *stream);
    bool readDemoStartBlock    (BitStream *stream);
+   void writeDemoKeyframe     (ResizeBitStream *stream);
+   bool readDemoKeyframe      (BitStream *stream);
    void handleRecordedBlock   (U32 type, U32 size, void *data);
+   bool isDemoTickBlock       (U32 type) const { return type == BlockTypeMove; }
+
+   /// The camera, move and connection state shared by the start block and
+   /// keyframes.  Keyframes leave out the mission file and demo variables.
+   void writeDemoState        (ResizeBitStream *stream, bool keyframe);
+   bool readDemoState         (BitStream *stream, bool keyframe);
    /// @}
    void ghostWriteExtra(NetObject *,BitStream *);
    void ghostReadExtra(NetObject *,BitStream *, bool newGhost);
@@ -230,6 +292,29 @@ public:
    void preloadDataBlock(SimDataBlock *block);
    void fileDownloadSegmentComplete();
    void preloadNextDataBlock(bool hadNew);
+
+   /// @name Datablock Manifest
+   /// @{
+
+   /// Sends the manifest for the datablocks from the given group
+   /// index on which have been modified since the last transmission.
+   void sendDataBlockManifest(U32 startIndex);
+
+   /// Called on the client as the manifest arrives.
+   void onDataBlockManifest(U32 sequence, U32 total, const Vector<DataBlockManifestEntry> &entries, bool last);
+
+   /// Called on the client when a requested datablock arrives.
+   void onDataBlockPayload(U32 index, const char *className, const DataBlockCache::Payload &payload);
+
+   /// Loads manifest entries from the cache up to the next requested one.
+   void loadCachedDataBlocks();
+
+   /// Called on the server as the client's requests arrive.
+   void onDataBlockRequest(U32 sequence, const Vector<U32> &indices, bool last);
+
+   const Vector<U32>& getDataBlockRequests() const { return mDataBlockRequests; }
+
+   /// @}
    
    static void consoleInit();
 
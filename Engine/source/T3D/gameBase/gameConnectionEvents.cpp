@@ -41,6 +41,8 @@
 
 //--------------------------------------------------------------------------
 IMPLEMENT_CO_CLIENTEVENT_V1(SimDataBlockEvent);
+IMPLEMENT_CO_CLIENTEVENT_V1(DataBlockManifestEvent);
+IMPLEMENT_CO_SERVEREVENT_V1(DataBlockRequestEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(Sim2DAudioEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(Sim3DAudioEvent);
 IMPLEMENT_CO_CLIENTEVENT_V1(SetMissionCRCEvent);
@@ -50,6 +52,16 @@ ConsoleDocClass( SimDataBlockEvent,
 				"Not intended for game development, internal use only, but does expose onDataBlockObjectReceived.\n\n "
 				"@internal");
 
+ConsoleDocClass( DataBlockManifestEvent,
+				"@brief Use by GameConnection to send the hashes of the datablocks about to be transmitted.\n\n"
+				"Not intended for game development, internal use only.\n\n "
+				"@internal");
+
+ConsoleDocClass( DataBlockRequestEvent,
+				"@brief Use by GameConnection to request the datablocks missing from the client's cache.\n\n"
+				"Not intended for game development, internal use only.\n\n "
+				"@internal");
+
 ConsoleDocClass( Sim2DAudioEvent,
 				"@brief Use by GameConnection to send a 2D sound event over the network.\n\n"
 				"Not intended for game development, internal use only, but does expose GameConnection::play2D.\n\n "
@@ -74,6 +86,7 @@ SimDataBlockEvent::SimDataBlockEvent(SimDataBlock* obj, U32 index, U32 total, U3
    mTotal = total;
    mMissionSequence = missionSequence;
    mProcess = false;
+   mRequestIndex = -1;
 
    if(obj)
    {
@@ -117,9 +130,32 @@ void SimDataBlockEvent::notifyDelivered(NetConnection *conn, bool )
    if(gc->getDataBlockSequence() != mMissionSequence)
       return;
 
-   U32 nextIndex = mIndex + DataBlockQueueCount;
    SimDataBlockGroup *g = Sim::getDataBlockGroup();
 
+   if(mRequestIndex >= 0)
+   {
+      // Walk the list of datablocks the client requested
+      // after the manifest rather than the whole group.
+      const Vector<U32> &requests = gc->getDataBlockRequests();
+      if(mRequestIndex == S32(requests.size()) - 1)
+      {
+         gc->setDataBlockModifiedKey(gc->getMaxDataBlockModifiedKey());
+         gc->sendConnectionMessage(GameConnection::DataBlocksDone, mMissionSequence);
+      }
+
+      S32 nextRequest = mRequestIndex + DataBlockQueueCount;
+      if(S32(requests.size()) <= nextRequest || g->size() <= requests[nextRequest])
+         return;
+
+      SimDataBlock *blk = (SimDataBlock *) (*g)[requests[nextRequest]];
+      SimDataBlockEvent *evt = new SimDataBlockEvent(blk, requests[nextRequest], g->size(), mMissionSequence);
+      evt->setRequestIndex(nextRequest);
+      gc->postNetEvent(evt);
+      return;
+   }
+
+   U32 nextIndex = mIndex + DataBlockQueueCount;
+
    if(mIndex == g->size() - 1)
    {
       gc->setDataBlockModifiedKey(gc->getMaxDataBlockModifiedKey());
@@ -138,7 +174,7 @@ void SimDataBlockEvent::pack(NetConnection *conn, BitStream *bstream)
    SimDataBlock* obj;
    Sim::findObject(id,obj);
    GameConnection *gc = (GameConnection *) conn;
-   if(bstream->writeFlag(gc->getDataBlockModifiedKey() < obj->getModifiedKey()))
+   if(bstream->writeFlag(mRequestIndex >= 0 || gc->getDataBlockModifiedKey() < obj->getModifiedKey()))
    {
       if(obj->getModifiedKey() > gc->getMaxDataBlockModifiedKey())
          gc->setMaxDataBlockModifiedKey(obj->getModifiedKey());
@@ -151,13 +187,59 @@ void SimDataBlockEvent::pack(NetConnection *conn, BitStream *bstream)
       bstream->writeClassId(classId, NetClassTypeDataBlock, conn->getNetClassGroup());
       bstream->writeInt(mIndex, DataBlockObjectIdBitSize);
       bstream->writeInt(mTotal, DataBlockObjectIdBitSize + 1);
-      obj->packData(bstream);
+
+      // Requested datablocks are sent as the standalone payload
+      // so the client can cache the exact bits it was sent.
+      if(bstream->writeFlag(mRequestIndex >= 0))
+      {
+         const DataBlockCache::Payload &payload = DataBlockCache::getServerPayload(obj);
+         bstream->write(payload.hash);
+         bstream->writeInt(payload.bitCount, DataBlockCache::PayloadBitCountBits);
+         bstream->writeBits(payload.bitCount, payload.data.address());
+      }
+      else
+         obj->packData(bstream);
 #ifdef TORQUE_DEBUG_NET
       bstream->writeInt(classId ^ DebugChecksum, 32);
 #endif
    }
 }
 
+SimDataBlock* SimDataBlockEvent::createDataBlock(NetConnection *cptr, SimObjectId id, S32 classId)
+{
+   SimObject* ptr;
+   if( Sim::findObject( id, ptr ) )
+   {
+      // An object with the given ID already exists.  Make sure it has the right class.
+      
+      AbstractClassRep* classRep = AbstractClassRep::findClassRep( cptr->getNetClassGroup(), NetClassTypeDataBlock, classId );
+      if( classRep && dStrcmp( classRep->getClassName(), ptr->getClassName() ) != 0 )
+      {
+         Con::warnf( "A '%s' datablock with id: %d already existed. "
+                     "Clobbering it with new '%s' datablock from server.",
+                     ptr->getClassName(), id, classRep->getClassName() );
+         ptr->deleteObject();
+         ptr = NULL;
+      }
+   }
+   
+   if( !ptr )
+      ptr = ( SimObject* ) ConsoleObject::create( cptr->getNetClassGroup(), NetClassTypeDataBlock, classId );
+      
+   SimDataBlock *obj = dynamic_cast< SimDataBlock* >( ptr );
+   if( !obj )
+   {
+      #ifdef DEBUG_SPEW
+      Con::printf(" - SimDataBlockEvent: INVALID PACKET!  Could not create class with classID: %d", classId);
+      #endif
+      
+      delete ptr;
+      cptr->setLastError("Invalid packet in SimDataBlockEvent::unpack()");
+   }
+
+   return obj;
+}
+
 void SimDataBlockEvent::unpack(NetConnection *cptr, BitStream *bstream)
 {
    if(bstream->readFlag())
@@ -167,43 +249,32 @@ void SimDataBlockEvent::unpack(NetConnection *cptr, BitStream *bstream)
       S32 classId = bstream->readClassId(NetClassTypeDataBlock, cptr->getNetClassGroup());
       mIndex = bstream->readInt(DataBlockObjectIdBitSize);
       mTotal = bstream->readInt(DataBlockObjectIdBitSize + 1);
-      
-      SimObject* ptr;
-      if( Sim::findObject( id, ptr ) )
+
+      if(bstream->readFlag())
       {
-         // An object with the given ID already exists.  Make sure it has the right class.
-         
-         AbstractClassRep* classRep = AbstractClassRep::findClassRep( cptr->getNetClassGroup(), NetClassTypeDataBlock, classId );
-         if( classRep && dStrcmp( classRep->getClassName(), ptr->getClassName() ) != 0 )
-         {
-            Con::warnf( "A '%s' datablock with id: %d already existed. "
-                        "Clobbering it with new '%s' datablock from server.",
-                        ptr->getClassName(), id, classRep->getClassName() );
-            ptr->deleteObject();
-            ptr = NULL;
-         }
+         mRequestIndex = 0;
+         bstream->read(&mPayload.hash);
+         mPayload.bitCount = bstream->readInt(DataBlockCache::PayloadBitCountBits);
+         mPayload.data.setSize((mPayload.bitCount + 7) >> 3);
+         if(mPayload.data.size())
+            mPayload.data.last() = 0;
+         bstream->readBits(mPayload.bitCount, mPayload.data.address());
       }
       
-      if( !ptr )
-         ptr = ( SimObject* ) ConsoleObject::create( cptr->getNetClassGroup(), NetClassTypeDataBlock, classId );
-         
-      mObj = dynamic_cast< SimDataBlock* >( ptr );
+      mObj = createDataBlock(cptr, id, classId);
       if( mObj != NULL )
       {
          #ifdef DEBUG_SPEW
          Con::printf(" - SimDataBlockEvent: unpacking event of type: %s", mObj->getClassName());
          #endif
          
-         mObj->unpackData( bstream );
-      }
-      else
-      {
-         #ifdef DEBUG_SPEW
-         Con::printf(" - SimDataBlockEvent: INVALID PACKET!  Could not create class with classID: %d", classId);
-         #endif
-         
-         delete ptr;
-         cptr->setLastError("Invalid packet in SimDataBlockEvent::unpack()");
+         if(mRequestIndex >= 0)
+         {
+            BitStream payloadStream(mPayload.data.address(), mPayload.data.size());
+            mObj->unpackData(&payloadStream);
+         }
+         else
+            mObj->unpackData( bstream );
       }
 
 #ifdef TORQUE_DEBUG_NET
@@ -225,50 +296,164 @@ void SimDataBlockEvent::write(NetConnection *cptr, BitStream *bstream)
       bstream->writeClassId(classId, NetClassTypeDataBlock, cptr->getNetClassGroup());
       bstream->writeInt(mIndex, DataBlockObjectIdBitSize);
       bstream->writeInt(mTotal, DataBlockObjectIdBitSize + 1);
+      bstream->writeFlag(false);
       mObj->packData(bstream);
    }
 }
 
+void SimDataBlockEvent::processDataBlock(NetConnection *cptr, SimDataBlock *&obj, SimObjectId id, U32 index, U32 total)
+{
+   //call the console function to set the number of blocks to be sent
+   Con::executef("onDataBlockObjectReceived", Con::getIntArg(index), Con::getIntArg(total));
+
+   String &errorBuffer = NetConnection::getErrorBuffer();
+                  
+   // Register the datablock object if this is a new DB
+   // and not for a modified datablock event.
+      
+   if( !obj->isProperlyAdded() )
+   {
+      // This is a fresh datablock object.
+      // Perform preload on datablock and register
+      // the object.
+
+      GameConnection* conn = dynamic_cast< GameConnection* >( cptr );
+      if( conn )
+         conn->preloadDataBlock( obj );
+      
+      if( obj->registerObject(id) )
+      {
+         cptr->addObject( obj );
+         obj = NULL;
+      }
+   }
+   else
+   {
+      // This is an update to an existing datablock.  Preload
+      // to finish this.
+
+      obj->preload( false, errorBuffer );
+      obj = NULL;
+   }
+}
+
 void SimDataBlockEvent::process(NetConnection *cptr)
 {
    if(mProcess)
    {
-      //call the console function to set the number of blocks to be sent
-      Con::executef("onDataBlockObjectReceived", Con::getIntArg(mIndex), Con::getIntArg(mTotal));
+      GameConnection* conn = dynamic_cast< GameConnection* >( cptr );
 
-      String &errorBuffer = NetConnection::getErrorBuffer();
-                     
-      // Register the datablock object if this is a new DB
-      // and not for a modified datablock event.
-         
-      if( !mObj->isProperlyAdded() )
-      {
-         // This is a fresh datablock object.
-         // Perform preload on datablock and register
-         // the object.
+      // Keep requested payloads for the next connection and
+      // step the manifest past this datablock.
+      if( mRequestIndex >= 0 && conn )
+         conn->onDataBlockPayload( mIndex, mObj->getClassName(), mPayload );
 
-         GameConnection* conn = dynamic_cast< GameConnection* >( cptr );
-         if( conn )
-            conn->preloadDataBlock( mObj );
-         
-         if( mObj->registerObject(id) )
-         {
-            cptr->addObject( mObj );
-            mObj = NULL;
-         }
-      }
-      else
-      {
-         // This is an update to an existing datablock.  Preload
-         // to finish this.
+      processDataBlock( cptr, mObj, id, mIndex, mTotal );
 
-         mObj->preload( false, errorBuffer );
-         mObj = NULL;
-      }
+      // Any cached datablocks queued behind this one can now be loaded.
+      if( mRequestIndex >= 0 && conn )
+         conn->loadCachedDataBlocks();
    }
 }
 
 
+//----------------------------------------------------------------------------
+
+DataBlockManifestEvent::DataBlockManifestEvent(U32 missionSequence, U32 total)
+{
+   mMissionSequence = missionSequence;
+   mTotal = total;
+   mLast = false;
+}
+
+void DataBlockManifestEvent::pack(NetConnection *conn, BitStream *bstream)
+{
+   bstream->write(mMissionSequence);
+   bstream->writeInt(mTotal, DataBlockObjectIdBitSize + 1);
+   bstream->writeFlag(mLast);
+   bstream->writeRangedU32(mEntries.size(), 0, MaxEntries);
+
+   for(U32 i = 0; i < mEntries.size(); i++)
+   {
+      const Entry &entry = mEntries[i];
+      bstream->writeInt(entry.index, DataBlockObjectIdBitSize);
+      bstream->writeInt(entry.id - DataBlockObjectIdFirst, DataBlockObjectIdBitSize);
+      bstream->writeClassId(entry.classId, NetClassTypeDataBlock, conn->getNetClassGroup());
+      bstream->write(entry.hash);
+   }
+}
+
+void DataBlockManifestEvent::write(NetConnection *conn, BitStream *bstream)
+{
+   pack(conn, bstream);
+}
+
+void DataBlockManifestEvent::unpack(NetConnection *conn, BitStream *bstream)
+{
+   bstream->read(&mMissionSequence);
+   mTotal = bstream->readInt(DataBlockObjectIdBitSize + 1);
+   mLast = bstream->readFlag();
+   mEntries.setSize(bstream->readRangedU32(0, MaxEntries));
+
+   for(U32 i = 0; i < mEntries.size(); i++)
+   {
+      Entry &entry = mEntries[i];
+      entry.index = bstream->readInt(DataBlockObjectIdBitSize);
+      entry.id = bstream->readInt(DataBlockObjectIdBitSize) + DataBlockObjectIdFirst;
+      entry.classId = bstream->readClassId(NetClassTypeDataBlock, conn->getNetClassGroup());
+      bstream->read(&entry.hash);
+   }
+}
+
+void DataBlockManifestEvent::process(NetConnection *conn)
+{
+   // Demos record every datablock in full.
+   if(conn->isPlayingBack())
+      return;
+
+   static_cast<GameConnection*>(conn)->onDataBlockManifest(mMissionSequence, mTotal, mEntries, mLast);
+}
+
+
+//----------------------------------------------------------------------------
+
+DataBlockRequestEvent::DataBlockRequestEvent(U32 missionSequence)
+{
+   mMissionSequence = missionSequence;
+   mLast = false;
+}
+
+void DataBlockRequestEvent::pack(NetConnection *, BitStream *bstream)
+{
+   bstream->write(mMissionSequence);
+   bstream->writeFlag(mLast);
+   bstream->writeRangedU32(mIndices.size(), 0, MaxIndices);
+
+   for(U32 i = 0; i < mIndices.size(); i++)
+      bstream->writeInt(mIndices[i], DataBlockObjectIdBitSize);
+}
+
+void DataBlockRequestEvent::write(NetConnection *conn, BitStream *bstream)
+{
+   pack(conn, bstream);
+}
+
+void DataBlockRequestEvent::unpack(NetConnection *, BitStream *bstream)
+{
+   bstream->read(&mMissionSequence);
+   mLast = bstream->readFlag();
+   mIndices.setSize(bstream->readRangedU32(0, MaxIndices));
+
+   for(U32 i = 0; i < mIndices.size(); i++)
+      mIndices[i] = bstream->readInt(DataBlockObjectIdBitSize);
+}
+
+void DataBlockRequestEvent::process(NetConnection *conn)
+{
+   static_cast<GameConnection*>(conn)->onDataBlockRequest(mMissionSequence, mIndices, mLast);
+}
+
+
 //----------------------------------------------------------------------------
 
 
@@ -39,6 +39,10 @@
 #include "core/stream/bitStream.h"
 #endif
 
+#ifndef _DATABLOCKCACHE_H_
+#include "T3D/gameBase/dataBlockCache.h"
+#endif
+
 
 class QuitEvent : public SimEvent
 {
@@ -82,11 +86,32 @@ class SimDataBlockEvent : public NetEvent
       
       ///
       bool mProcess;
+
+      /// Position in the connection's datablock request list when this
+      /// datablock was requested by the client after a manifest, or -1
+      /// for a regular datablock transmission.
+      ///
+      /// @see GameConnection::sendDataBlockManifest
+      S32 mRequestIndex;
+
+      /// Payload hash and bits for requested datablocks.
+      DataBlockCache::Payload mPayload;
   
    public:
    
       SimDataBlockEvent(SimDataBlock* obj = NULL, U32 index = 0, U32 total = 0, U32 missionSequence = 0);
       ~SimDataBlockEvent();
+
+      /// Marks this event as answering the given datablock request.
+      void setRequestIndex(S32 requestIndex) { mRequestIndex = requestIndex; }
+
+      /// Returns the datablock with the given id, creating it if it does
+      /// not exist or does not match the class sent by the server.
+      static SimDataBlock* createDataBlock(NetConnection *cptr, SimObjectId id, S32 classId);
+
+      /// Registers or preloads a datablock that has been unpacked.  The
+      /// pointer is cleared if the connection took ownership.
+      static void processDataBlock(NetConnection *cptr, SimDataBlock *&obj, SimObjectId id, U32 index, U32 total);
       
       void pack(NetConnection *, BitStream *bstream);
       void write(NetConnection *, BitStream *bstream);
@@ -102,6 +127,91 @@ class SimDataBlockEvent : public NetEvent
       DECLARE_CATEGORY( "Game Networking" );
 };
 
+/// Lists the hashes of the datablocks the server is about to transmit.
+///
+/// Sent in chunks in place of datablock events when the manifest is
+/// enabled.  The client answers with DataBlockRequestEvents listing the
+/// datablocks missing from its cache.
+///
+/// @see GameConnection::sendDataBlockManifest
+class DataBlockManifestEvent : public NetEvent
+{
+   public:
+
+      typedef NetEvent Parent;
+
+      enum Constants
+      {
+         /// Number of manifest entries sent per event.
+         MaxEntries = 32,
+      };
+
+      typedef GameConnection::DataBlockManifestEntry Entry;
+
+   protected:
+
+      U32 mMissionSequence;
+      U32 mTotal;
+      bool mLast;
+      Vector<Entry> mEntries;
+
+   public:
+
+      DataBlockManifestEvent(U32 missionSequence = 0, U32 total = 0);
+
+      Vector<Entry>& getEntries() { return mEntries; }
+
+      /// Marks this as the final chunk of the manifest.
+      void setLast(bool last) { mLast = last; }
+
+      void pack(NetConnection *, BitStream *bstream);
+      void write(NetConnection *, BitStream *bstream);
+      void unpack(NetConnection *, BitStream *bstream);
+      void process(NetConnection *);
+
+      DECLARE_CONOBJECT( DataBlockManifestEvent );
+      DECLARE_CATEGORY( "Game Networking" );
+};
+
+/// Requests the datablocks missing from the client's cache.
+///
+/// @see DataBlockManifestEvent
+class DataBlockRequestEvent : public NetEvent
+{
+   public:
+
+      typedef NetEvent Parent;
+
+      enum Constants
+      {
+         /// Number of datablock indices requested per event.
+         MaxIndices = 64,
+      };
+
+   protected:
+
+      U32 mMissionSequence;
+      bool mLast;
+      Vector<U32> mIndices;
+
+   public:
+
+      DataBlockRequestEvent(U32 missionSequence = 0);
+
+      Vector<U32>& getIndices() { return mIndices; }
+
+      /// Marks this as the final chunk of the requests.
+      void setLast(bool last) { mLast = last; }
+
+      void pack(NetConnection *, BitStream *bstream);
+      void write(NetConnection *, BitStream *bstream);
+      void unpack(NetConnection *, BitStream *bstream);
+      void process(NetConnection *);
+
+      DECLARE_CONOBJECT( DataBlockRequestEvent );
+      DECLARE_CATEGORY( "Game Networking" );
+};
+
 class Sim2DAudioEvent: public NetEvent
 {
   private:
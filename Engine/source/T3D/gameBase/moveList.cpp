@@ -117,8 +117,10 @@ void MoveList::collectMove()
       if(!mConnection->isPlayingBack() && getNextMove(mv))
       {
          mv.checksum=Move::ChecksumMismatch;
-         pushMove(mv);
+         // Record first, demo keyframes are taken before a move
+         // block and must not already hold the move.
          mConnection->recordBlock(GameConnection::BlockTypeMove, sizeof(Move), &mv);
+         pushMove(mv);
       }
    }
    else
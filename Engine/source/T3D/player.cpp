@@ -6139,7 +6139,7 @@ U32 Player::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
 
       Point3F pos;
       getTransform().getColumn(3,&pos);
-      stream->writeCompressedPoint(pos);
+      con->writeDeltaPoint(stream, PositionDeltaSlot, pos);
       F32 len = mVelocity.len();
       if(stream->writeFlag(len > 0.02f))
       {
@@ -6236,7 +6236,7 @@ void Player::unpackUpdate(NetConnection *con, BitStream *stream)
          setState(actionState);
 
       Point3F pos,rot;
-      stream->readCompressedPoint(&pos);
+      con->readDeltaPoint(stream, PositionDeltaSlot, &pos);
       F32 speed = mVelocity.len();
       if(stream->readFlag())
       {
@@ -398,6 +398,12 @@ protected:
       NextFreeMask = Parent::NextFreeMask << 3
    };
 
+   /// Delta state slots, see NetObject::hasDeltaState().
+   enum DeltaSlots {
+      PositionDeltaSlot = Parent::NextFreeDeltaSlot,
+      NextFreeDeltaSlot = PositionDeltaSlot + 3
+   };
+
    SimObjectPtr<ParticleEmitter> mSplashEmitter[PlayerData::NUM_SPLASH_EMITTERS];
    F32 mBubbleEmitterTime;
 
@@ -760,6 +766,7 @@ public:
    void readPacketData (GameConnection *conn, BitStream *stream);
    U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
    void unpackUpdate(NetConnection *conn,           BitStream *stream);
+   bool hasDeltaState() const { return true; }
 
    virtual void prepRenderImage( SceneRenderState* state );
    virtual void renderConvex( ObjectRenderInst *ri, SceneRenderState *state, BaseMatInstance *overrideMat );   
@@ -193,6 +193,7 @@ namespace {
    const S32 sMaxWarpTicks = 3;           // Max warp duration in ticks
    const S32 sMaxPredictionTicks = 30;    // Number of ticks to predict
    const F32 sRigidShapeGravity = -20;
+   const F32 sMomentumDeltaPrecision = 0.001f; // Momentum precision for delta ghosting
 
    // Physics and collision constants
    static F32 sRestTol = 0.5;             // % of gravity energy to be at rest
@@ -1464,10 +1465,10 @@ U32 RigidShape::packUpdate(NetConnection *con, U32 mask, BitStream *stream)
    {
       stream->writeFlag(mask & ForceMoveMask);
 
-      stream->writeCompressedPoint(mRigid.linPosition);
-      mathWrite(*stream, mRigid.angPosition);
-      mathWrite(*stream, mRigid.linMomentum);
-      mathWrite(*stream, mRigid.angMomentum);
+      con->writeDeltaPoint(stream, PositionDeltaSlot, mRigid.linPosition);
+      con->writeDeltaQuat(stream, RotationDeltaSlot, mRigid.angPosition);
+      con->writeDeltaVector(stream, LinMomentumDeltaSlot, mRigid.linMomentum, sMomentumDeltaPrecision);
+      con->writeDeltaVector(stream, AngMomentumDeltaSlot, mRigid.angMomentum, sMomentumDeltaPrecision);
       stream->writeFlag(mRigid.atRest);
    }
    
@@ -1497,10 +1498,10 @@ void RigidShape::unpackUpdate(NetConnection *con, BitStream *stream)
       mDelta.warpRot[0] = mRigid.angPosition;
 
       // Read in new position and momentum values
-      stream->readCompressedPoint(&mRigid.linPosition);
-      mathRead(*stream, &mRigid.angPosition);
-      mathRead(*stream, &mRigid.linMomentum);
-      mathRead(*stream, &mRigid.angMomentum);
+      con->readDeltaPoint(stream, PositionDeltaSlot, &mRigid.linPosition);
+      con->readDeltaQuat(stream, RotationDeltaSlot, &mRigid.angPosition);
+      con->readDeltaVector(stream, LinMomentumDeltaSlot, &mRigid.linMomentum, sMomentumDeltaPrecision);
+      con->readDeltaVector(stream, AngMomentumDeltaSlot, &mRigid.angMomentum, sMomentumDeltaPrecision);
       mRigid.atRest = stream->readFlag();
       mRigid.updateVelocity();
 
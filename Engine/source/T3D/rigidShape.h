@@ -159,6 +159,15 @@ class RigidShape: public ShapeBase
       NextFreeMask = Parent::NextFreeMask << 4
    };
 
+   /// Delta state slots, see NetObject::hasDeltaState().
+   enum DeltaSlots {
+      PositionDeltaSlot    = Parent::NextFreeDeltaSlot,
+      RotationDeltaSlot    = PositionDeltaSlot + 3,
+      LinMomentumDeltaSlot = RotationDeltaSlot + 4,
+      AngMomentumDeltaSlot = LinMomentumDeltaSlot + 3,
+      NextFreeDeltaSlot    = AngMomentumDeltaSlot + 3
+   };
+
    void updateDustTrail( F32 dt );
 
 
@@ -294,6 +303,7 @@ public:
 
    U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
    void unpackUpdate(NetConnection *conn,           BitStream *stream);
+   bool hasDeltaState() const { return true; }
 
    DECLARE_CONOBJECT(RigidShape);
    DECLARE_CALLBACK( void, onEnterLiquid, ( const char* objId, const char* waterCoverage, const char* liquidType ));
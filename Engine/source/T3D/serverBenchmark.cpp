@@ -0,0 +1,450 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "T3D/serverBenchmark.h"
+
+#include "app/game.h"
+#include "core/module.h"
+#include "core/util/journal/process.h"
+#include "core/stream/fileStream.h"
+#include "console/engineAPI.h"
+#include "scene/sceneContainer.h"
+#include "collision/collision.h"
+#include "T3D/gameBase/processList.h"
+#include "T3D/aiPlayer.h"
+#include "T3D/aiClient.h"
+#include "sim/netConnection.h"
+#include "sim/netInterface.h"
+
+
+ServerBenchmark* ServerBenchmark::smInstance = NULL;
+
+/// Small helper for timing a section in milliseconds.
+class BenchmarkSectionTimer
+{
+   U32 mStart;
+
+public:
+
+   BenchmarkSectionTimer() : mStart( Platform::getRealMilliseconds() ) {}
+
+   F64 restart()
+   {
+      const U32 now = Platform::getRealMilliseconds();
+      const F64 ms = F64( now - mStart );
+      mStart = now;
+      return ms;
+   }
+};
+
+IMPLEMENT_GLOBAL_CALLBACK( onServerBenchmarkDone, void, ( F32 avgTickMs ), ( avgTickMs ),
+   "@brief Called once a benchmark started with runServerBenchmark() has run and reported.\n\n"
+   "@param avgTickMs The average wall time of a tick in milliseconds.\n"
+   "@ingroup Debugging" );
+
+MODULE_BEGIN( ServerBenchmark )
+
+   MODULE_INIT_AFTER( Process )
+   MODULE_SHUTDOWN_BEFORE( Process )
+
+   MODULE_INIT
+   {
+      Process::notify( &ServerBenchmark::processPending, PROCESS_DEFAULT_ORDER );
+   }
+
+   MODULE_SHUTDOWN
+   {
+      Process::remove( &ServerBenchmark::processPending );
+   }
+
+MODULE_END;
+
+static inline void _accumulate( ServerBenchmark::SectionStats &stats, F64 ms )
+{
+   stats.totalMs += ms;
+   if ( ms > stats.peakMs )
+      stats.peakMs = ms;
+}
+
+
+ServerBenchmark::ServerBenchmark()
+   :  mTicksRun( 0 ),
+      mRunPending( false )
+{
+   for ( U32 i = 0; i < Section_Count; i++ )
+      mSections[i].reset();
+   mTickStats.reset();
+}
+
+ServerBenchmark::~ServerBenchmark()
+{
+   _cleanup();
+}
+
+ServerBenchmark* ServerBenchmark::get()
+{
+   if ( !smInstance )
+      smInstance = new ServerBenchmark;
+   return smInstance;
+}
+
+void ServerBenchmark::destroy()
+{
+   SAFE_DELETE( smInstance );
+}
+
+const char* ServerBenchmark::getSectionName( Section section )
+{
+   static const char* sNames[ Section_Count ] =
+   {
+      "ServerProcess",
+      "ServerNet",
+      "SimEvents",
+      "ClientProcess",
+      "ClientNet",
+      "AIDirector"
+   };
+
+   return sNames[ section ];
+}
+
+void ServerBenchmark::setConfig( const Config &config )
+{
+   mConfig = config;
+   mConfig.retargetTicks = getMax( mConfig.retargetTicks, (U32)1 );
+
+   mRandom.setSeed( mConfig.seed );
+   MRandomLCG::setGlobalRandSeed( mConfig.seed );
+
+   for ( U32 i = 0; i < Section_Count; i++ )
+      mSections[i].reset();
+   mTickStats.reset();
+   mTicksRun = 0;
+}
+
+Point3F ServerBenchmark::_getRandomPoint()
+{
+   // Pick a point within the circle.
+   const F32 angle = mRandom.randF( 0.0f, M_2PI_F );
+   const F32 dist = mSqrt( mRandom.randF() ) * mConfig.radius;
+
+   Point3F pos(   mConfig.center.x + mCos( angle ) * dist,
+                  mConfig.center.y + mSin( angle ) * dist,
+                  mConfig.center.z );
+
+   // Drop it on the ground if there is any.
+   const Point3F start( pos.x, pos.y, pos.z + 1000.0f );
+   const Point3F end( pos.x, pos.y, pos.z - 1000.0f );
+
+   RayInfo ri;
+   if ( gServerContainer.castRay( start, end, StaticShapeObjectType | TerrainObjectType, &ri ) )
+      pos = ri.point;
+
+   return pos;
+}
+
+U32 ServerBenchmark::spawnBots( const char *dataBlock, U32 count )
+{
+   SimGroup *cleanup = dynamic_cast<SimGroup*>( Sim::findObject( "MissionCleanup" ) );
+
+   U32 spawned = 0;
+   for ( U32 i = 0; i < count; i++ )
+   {
+      AIPlayer *bot = dynamic_cast<AIPlayer*>( Sim::spawnObject( "AIPlayer", dataBlock ) );
+      if ( !bot )
+      {
+         Con::errorf( "ServerBenchmark::spawnBots - Failed to spawn an AIPlayer with datablock '%s'!", dataBlock );
+         break;
+      }
+
+      MatrixF mat( true );
+      mat.setPosition( _getRandomPoint() + Point3F( 0, 0, 1.0f ) );
+      bot->setTransform( mat );
+
+      if ( cleanup )
+         cleanup->addObject( bot );
+
+      mBots.push_back( bot );
+      spawned++;
+   }
+
+   return spawned;
+}
+
+U32 ServerBenchmark::addClients( const char *dataBlock, U32 count )
+{
+   SimGroup *cleanup = dynamic_cast<SimGroup*>( Sim::findObject( "MissionCleanup" ) );
+
+   U32 added = 0;
+   for ( U32 i = 0; i < count; i++ )
+   {
+      Player *player = dynamic_cast<Player*>( Sim::spawnObject( "Player", dataBlock ) );
+      if ( !player )
+      {
+         Con::errorf( "ServerBenchmark::addClients - Failed to spawn a Player with datablock '%s'!", dataBlock );
+         break;
+      }
+
+      MatrixF mat( true );
+      mat.setPosition( _getRandomPoint() + Point3F( 0, 0, 1.0f ) );
+      player->setTransform( mat );
+
+      if ( cleanup )
+         cleanup->addObject( player );
+
+      // This mirrors aiAddPlayer() but skips the script onConnect
+      // so that the game scripts don't spawn anything on their own.
+      AIClient *client = new AIClient();
+      client->registerObject();
+      client->setGhostFrom( false );
+      client->setGhostTo( false );
+      client->setSendingEvents( false );
+      client->setTranslatesStrings( true );
+      client->setEstablished();
+      Sim::getClientGroup()->addObject( client );
+
+      client->setControlObject( player );
+
+      mClients.push_back( client );
+      added++;
+   }
+
+   return added;
+}
+
+void ServerBenchmark::_retargetAI()
+{
+   for ( U32 i = 0; i < mBots.size(); i++ )
+   {
+      if ( mBots[i] )
+         mBots[i]->setMoveDestination( _getRandomPoint(), false );
+   }
+
+   for ( U32 i = 0; i < mClients.size(); i++ )
+   {
+      if ( mClients[i] )
+      {
+         mClients[i]->setMoveDestination( _getRandomPoint() );
+         mClients[i]->setMoveMode( AIClient::ModeMove );
+      }
+   }
+}
+
+void ServerBenchmark::_cleanup()
+{
+   for ( U32 i = 0; i < mClients.size(); i++ )
+   {
+      if ( !mClients[i] )
+         continue;
+
+      GameBase *control = mClients[i]->getControlObject();
+      mClients[i]->deleteObject();
+      if ( control )
+         control->deleteObject();
+   }
+   mClients.clear();
+
+   for ( U32 i = 0; i < mBots.size(); i++ )
+   {
+      if ( mBots[i] )
+         mBots[i]->deleteObject();
+   }
+   mBots.clear();
+}
+
+void ServerBenchmark::run()
+{
+   Con::printf( "ServerBenchmark - Running %d ticks with %d bots and %d clients (seed %d).",
+      mConfig.numTicks, mBots.size(), mClients.size(), mConfig.seed );
+
+   for ( U32 i = 0; i < mConfig.numTicks; i++ )
+   {
+      BenchmarkSectionTimer tickTimer;
+      BenchmarkSectionTimer timer;
+
+      if ( ( mTicksRun % mConfig.retargetTicks ) == 0 )
+         _retargetAI();
+      _accumulate( mSections[ Section_AIDirector ], timer.restart() );
+
+      // The following mirrors processTimeEvent() in the main
+      // loop with a fixed time step of exactly one tick.
+      Platform::advanceTime( TickMs );
+
+      const bool serverTicked = serverProcess( TickMs );
+      _accumulate( mSections[ Section_ServerProcess ], timer.restart() );
+
+      if ( serverTicked )
+         GNet->processServer();
+      _accumulate( mSections[ Section_ServerNet ], timer.restart() );
+
+      Sim::advanceTime( TickMs );
+      _accumulate( mSections[ Section_SimEvents ], timer.restart() );
+
+      const bool clientTicked = clientProcess( TickMs );
+      _accumulate( mSections[ Section_ClientProcess ], timer.restart() );
+
+      if ( clientTicked )
+         GNet->processClient();
+      _accumulate( mSections[ Section_ClientNet ], timer.restart() );
+
+      _accumulate( mTickStats, tickTimer.restart() );
+      mTicksRun++;
+   }
+}
+
+void ServerBenchmark::requestRun( const char *reportFile )
+{
+   mReportFile = reportFile ? reportFile : "";
+   mRunPending = true;
+}
+
+void ServerBenchmark::processPending()
+{
+   if ( !smInstance || !smInstance->mRunPending )
+      return;
+
+   smInstance->mRunPending = false;
+   smInstance->run();
+   smInstance->report( smInstance->mReportFile );
+
+   const F32 avgTickMs = smInstance->mTickStats.totalMs / getMax( smInstance->mTicksRun, (U32)1 );
+   onServerBenchmarkDone_callback( avgTickMs );
+}
+
+void ServerBenchmark::report( const char *fileName )
+{
+   const F64 ticks = getMax( mTicksRun, (U32)1 );
+
+   Con::printf( "ServerBenchmark Report: %d ticks, %d bots, %d clients, seed %d",
+      mTicksRun, mBots.size(), mClients.size(), mConfig.seed );
+   Con::printf( "%-16s %12s %10s %10s %7s", "Section", "Total ms", "Avg ms", "Peak ms", "%" );
+
+   for ( U32 i = 0; i < Section_Count; i++ )
+   {
+      const SectionStats &stats = mSections[i];
+      Con::printf( "%-16s %12.3f %10.4f %10.4f %7.2f",
+         getSectionName( (Section)i ),
+         stats.totalMs,
+         stats.totalMs / ticks,
+         stats.peakMs,
+         mTickStats.totalMs > 0.0 ? 100.0 * stats.totalMs / mTickStats.totalMs : 0.0 );
+   }
+
+   Con::printf( "%-16s %12.3f %10.4f %10.4f %7.2f", "Tick",
+      mTickStats.totalMs, mTickStats.totalMs / ticks, mTickStats.peakMs, 100.0 );
+
+   if ( !fileName || !fileName[0] )
+      return;
+
+   FileStream stream;
+   if ( !stream.open( fileName, Torque::FS::File::Write ) )
+   {
+      Con::errorf( "ServerBenchmark::report - Failed to open '%s' for writing!", fileName );
+      return;
+   }
+
+   char buffer[256];
+   stream.writeLine( (const U8*)"section,totalMs,avgMs,peakMs,ticks,bots,clients,seed" );
+
+   for ( U32 i = 0; i <= Section_Count; i++ )
+   {
+      const bool isTick = i == Section_Count;
+      const SectionStats &stats = isTick ? mTickStats : mSections[i];
+
+      dSprintf( buffer, sizeof( buffer ), "%s,%.4f,%.4f,%.4f,%d,%d,%d,%d",
+         isTick ? "Tick" : getSectionName( (Section)i ),
+         stats.totalMs,
+         stats.totalMs / ticks,
+         stats.peakMs,
+         mTicksRun,
+         mBots.size(),
+         mClients.size(),
+         mConfig.seed );
+
+      stream.writeLine( (const U8*)buffer );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+DefineEngineFunction( initServerBenchmark, void, ( U32 ticks, S32 seed, Point3F center, F32 radius, U32 retargetTicks ),
+   ( 1000, 0, Point3F::Zero, 100.0f, 96 ),
+   "@brief Prepares the server benchmark and reseeds all random generators.\n\n"
+   "Any bots or clients spawned by a previous benchmark are kept.  Use "
+   "destroyServerBenchmark() to remove them.\n\n"
+   "@param ticks The number of ticks to run.\n"
+   "@param seed The seed used for all random choices during the benchmark.\n"
+   "@param center The center of the area the AI spawn and roam in.\n"
+   "@param radius The radius of the area the AI spawn and roam in.\n"
+   "@param retargetTicks How often in ticks the AI are given new destinations.\n"
+   "@ingroup Debugging" )
+{
+   ServerBenchmark::Config config;
+   config.numTicks = ticks;
+   config.seed = seed;
+   config.center = center;
+   config.radius = radius;
+   config.retargetTicks = retargetTicks;
+
+   ServerBenchmark::get()->setConfig( config );
+}
+
+DefineEngineFunction( serverBenchmarkSpawnBots, S32, ( const char *dataBlock, U32 count ),,
+   "@brief Spawns AIPlayers for the server benchmark.\n\n"
+   "@param dataBlock The PlayerData datablock for the bots.\n"
+   "@param count The number of bots to spawn.\n"
+   "@return The number of bots spawned.\n"
+   "@ingroup Debugging" )
+{
+   return ServerBenchmark::get()->spawnBots( dataBlock, count );
+}
+
+DefineEngineFunction( serverBenchmarkAddClients, S32, ( const char *dataBlock, U32 count ),,
+   "@brief Adds simulated AIClient connections for the server benchmark.\n\n"
+   "Each client is given its own Player as a control object.\n\n"
+   "@param dataBlock The PlayerData datablock for the client players.\n"
+   "@param count The number of clients to add.\n"
+   "@return The number of clients added.\n"
+   "@ingroup Debugging" )
+{
+   return ServerBenchmark::get()->addClients( dataBlock, count );
+}
+
+DefineEngineFunction( runServerBenchmark, void, ( const char *reportFile ), ( "" ),
+   "@brief Runs the server benchmark and prints a per-subsystem timing report.\n\n"
+   "The benchmark starts from the main loop before the next frame, so that it "
+   "drives the ticks outside of any scheduled event.  The ticks are run back to "
+   "back with a fixed time step and onServerBenchmarkDone() is called once the "
+   "report is written.\n\n"
+   "@param reportFile Optional file to write the report to as comma separated values.\n"
+   "@ingroup Debugging" )
+{
+   ServerBenchmark::get()->requestRun( reportFile );
+}
+
+DefineEngineFunction( destroyServerBenchmark, void, (),,
+   "@brief Deletes the bots and clients spawned for the server benchmark.\n\n"
+   "@ingroup Debugging" )
+{
+   ServerBenchmark::destroy();
+}
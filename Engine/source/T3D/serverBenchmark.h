@@ -0,0 +1,204 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _SERVERBENCHMARK_H_
+#define _SERVERBENCHMARK_H_
+
+#ifndef _MRANDOM_H_
+#include "math/mRandom.h"
+#endif
+#ifndef _MPOINT3_H_
+#include "math/mPoint3.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+#ifndef _SIMOBJECT_H_
+#include "console/simObject.h"
+#endif
+
+class AIPlayer;
+class AIClient;
+
+
+/// A repeatable measurement of the server tick cost.
+///
+/// The benchmark is meant to be run from a dedicated server on the
+/// Null GFX device and the Null SFX provider.  Once a mission is loaded
+/// it spawns a seeded population of AIPlayers and AIClient connections
+/// and then drives the same steps as the main loop's processTimeEvent()
+/// for a fixed number of ticks of exactly TickMs each.  The wall time
+/// of every step is accumulated separately so that the report gives a
+/// per-subsystem breakdown that can be compared between builds.
+///
+/// All random choices made by the benchmark come from its own seeded
+/// generator and the global generator is reseeded before the run, so
+/// two runs with the same seed and mission perform the same work.
+///
+/// A run requested from script is started by the main loop between
+/// frames, so the ticks are never driven from within a SimEvent.
+///
+/// @see runServerBenchmark()
+class ServerBenchmark
+{
+public:
+
+   /// The steps of a tick that are timed separately.
+   enum Section
+   {
+      Section_ServerProcess,  ///< ServerProcessList::advanceTime().
+      Section_ServerNet,      ///< Ghosting and packet writes to clients.
+      Section_SimEvents,      ///< Scheduled SimEvents and script timers.
+      Section_ClientProcess,  ///< ClientProcessList::advanceTime().
+      Section_ClientNet,      ///< Packet writes to the server.
+      Section_AIDirector,     ///< Benchmark driven AI retargeting.
+
+      Section_Count
+   };
+
+   struct SectionStats
+   {
+      /// Total wall time spent in the section in milliseconds.
+      F64 totalMs;
+
+      /// The most expensive single tick in milliseconds.
+      F64 peakMs;
+
+      void reset() { totalMs = peakMs = 0.0; }
+   };
+
+   struct Config
+   {
+      /// The number of ticks to run.
+      U32 numTicks;
+
+      /// The seed for both the benchmark and global random generators.
+      S32 seed;
+
+      /// How often the AI are given a new destination.
+      U32 retargetTicks;
+
+      /// The center and radius of the area used for spawning and roaming.
+      Point3F center;
+      F32 radius;
+
+      Config()
+         :  numTicks( 1000 ),
+            seed( 0 ),
+            retargetTicks( 96 ),
+            center( Point3F::Zero ),
+            radius( 100.0f )
+      {
+      }
+   };
+
+protected:
+
+   static ServerBenchmark* smInstance;
+
+   Config mConfig;
+
+   MRandomLCG mRandom;
+
+   Vector< SimObjectPtr<AIPlayer> > mBots;
+
+   Vector< SimObjectPtr<AIClient> > mClients;
+
+   SectionStats mSections[ Section_Count ];
+
+   /// Total wall time for the whole tick in milliseconds.
+   SectionStats mTickStats;
+
+   U32 mTicksRun;
+
+   /// Set when a run was requested and is waiting for the main loop.
+   bool mRunPending;
+
+   /// The file the pending run writes its report to.
+   String mReportFile;
+
+   /// Returns a random point on the ground within the benchmark area.
+   Point3F _getRandomPoint();
+
+   /// Gives every bot and client a new random destination.
+   void _retargetAI();
+
+   /// Deletes the objects spawned for the benchmark.
+   void _cleanup();
+
+public:
+
+   ServerBenchmark();
+   ~ServerBenchmark();
+
+   /// Returns the active benchmark creating it if needed.
+   static ServerBenchmark* get();
+
+   /// Destroys the active benchmark and anything it spawned.
+   static void destroy();
+
+   /// Returns the name of the section for the report.
+   static const char* getSectionName( Section section );
+
+   /// Reseeds the random generators and resets the statistics.
+   void setConfig( const Config &config );
+
+   const Config& getConfig() const { return mConfig; }
+
+   /// Spawns AIPlayers using the PlayerData datablock.
+   /// @return The number of bots spawned.
+   U32 spawnBots( const char *dataBlock, U32 count );
+
+   /// Adds AIClient connections each controlling a freshly spawned
+   /// Player using the PlayerData datablock.
+   /// @return The number of clients added.
+   U32 addClients( const char *dataBlock, U32 count );
+
+   /// Runs the configured number of ticks.
+   ///
+   /// This advances the Sim time itself, so it must not be called from
+   /// within a SimEvent or script scheduled by one.  Use requestRun()
+   /// to have the main loop call it.
+   void run();
+
+   /// Runs the benchmark from the main loop before the next frame.  Once
+   /// it has reported the onServerBenchmarkDone() callback is called.
+   void requestRun( const char *reportFile );
+
+   bool isRunPending() const { return mRunPending; }
+
+   /// Runs and reports a pending benchmark.  This is called by
+   /// the main loop outside of any SimEvent.
+   static void processPending();
+
+   /// Prints the report to the console and optionally writes it as
+   /// comma separated values to a file.
+   void report( const char *fileName = NULL );
+
+   U32 getTicksRun() const { return mTicksRun; }
+
+   const SectionStats& getSectionStats( Section section ) const { return mSections[ section ]; }
+
+   const SectionStats& getTickStats() const { return mTickStats; }
+};
+
+#endif // _SERVERBENCHMARK_H_
@@ -158,6 +158,15 @@ class Vehicle: public ShapeBase
       NextFreeMask = Parent::NextFreeMask << 2
    };
 
+   /// Delta state slots, see NetObject::hasDeltaState().
+   enum DeltaSlots {
+      PositionDeltaSlot    = Parent::NextFreeDeltaSlot,
+      RotationDeltaSlot    = PositionDeltaSlot + 3,
+      LinMomentumDeltaSlot = RotationDeltaSlot + 4,
+      AngMomentumDeltaSlot = LinMomentumDeltaSlot + 3,
+      NextFreeDeltaSlot    = AngMomentumDeltaSlot + 3
+   };
+
    struct StateDelta {
       Move move;                    ///< Last move from server
       F32 dt;                       ///< Last interpolation time
@@ -231,6 +240,7 @@ class Vehicle: public ShapeBase
    void readPacketData (GameConnection * conn, BitStream *stream);
    U32  packUpdate  (NetConnection *conn, U32 mask, BitStream *stream);
    void unpackUpdate(NetConnection *conn,           BitStream *stream);
+   bool hasDeltaState() const { return true; }
 
    void updateLiftoffDust( F32 dt );
    void updateDamageSmoke( F32 dt );
@@ -39,6 +39,7 @@
 #include "console/stringStack.h"
 #include "util/messaging/message.h"
 #include "core/frameAllocator.h"
+#include "platform/platformSlabAllocator.h"
 
 #ifndef TORQUE_TGB_ONLY
 #include "materials/materialDefinition.h"
@@ -403,6 +404,8 @@ static void setFieldComponent( SimObject* object, StringTableEntry field, const
 
 const char *CodeBlock::exec(U32 ip, const char *functionName, Namespace *thisNamespace, U32 argc, const char **argv, bool noCalls, StringTableEntry packageName, S32 setFrame)
 {
+   SLAB_TAG_SCOPE( Console );
+
 #ifdef TORQUE_DEBUG
    U32 stackStart = STR.mStartStackSize;
 #endif
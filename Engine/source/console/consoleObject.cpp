@@ -786,6 +786,18 @@ DefineEngineFunction( dumpNetStats, void, (),,
                                        rep->mNetStatRead.min,
                                        rep->mNetStatRead.max,
                                        rep->mNetStatRead.numEvents);
+         if (rep->mNetStatDelta.numEvents)
+            Con::printf("   delta: avg (%f), min (%i), max (%i), num (%i)",
+                                       F32(rep->mNetStatDelta.total)/F32(rep->mNetStatDelta.numEvents),
+                                       rep->mNetStatDelta.min,
+                                       rep->mNetStatDelta.max,
+                                       rep->mNetStatDelta.numEvents);
+         if (rep->mNetStatDeltaFull.numEvents)
+            Con::printf("   delta (no baseline): avg (%f), min (%i), max (%i), num (%i)",
+                                       F32(rep->mNetStatDeltaFull.total)/F32(rep->mNetStatDeltaFull.numEvents),
+                                       rep->mNetStatDeltaFull.min,
+                                       rep->mNetStatDeltaFull.max,
+                                       rep->mNetStatDeltaFull.numEvents);
          S32 sum = 0;
          for (S32 i=0; i<32; i++)
             sum  += rep->mDirtyMaskFrequency[i];
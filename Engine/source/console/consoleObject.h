@@ -264,6 +264,8 @@ public:
    NetStatInstance mNetStatUnpack;
    NetStatInstance mNetStatWrite;
    NetStatInstance mNetStatRead;
+   NetStatInstance mNetStatDelta;      ///< Delta state bits of updates sent against a baseline.
+   NetStatInstance mNetStatDeltaFull;  ///< Delta state bits of updates sent without a baseline.
 
    U32 mDirtyMaskFrequency[32];
    U32 mDirtyMaskTotal[32];
@@ -274,6 +276,8 @@ public:
       mNetStatUnpack.reset();
       mNetStatWrite.reset();
       mNetStatRead.reset();
+      mNetStatDelta.reset();
+      mNetStatDeltaFull.reset();
 
       for(S32 i=0; i<32; i++)
       {
@@ -294,6 +298,14 @@ public:
          }
    }
 
+   void updateNetStatDelta(bool hasBaseline, U32 length)
+   {
+      if(hasBaseline)
+         mNetStatDelta.update(length);
+      else
+         mNetStatDeltaFull.update(length);
+   }
+
    void updateNetStatUnpack(U32 length)
    {
       mNetStatUnpack.update(length);
@@ -28,6 +28,7 @@
 #include "console/engineAPI.h"
 #include "T3D/gameBase/gameConnectionEvents.h"
 #include "T3D/gameBase/gameConnection.h"
+#include "T3D/gameBase/dataBlockCache.h"
 
 
 IMPLEMENT_CO_DATABLOCK_V1(SimDataBlock);
@@ -79,6 +80,16 @@ bool SimDataBlock::onAdd()
 
 //-----------------------------------------------------------------------------
 
+void SimDataBlock::onRemove()
+{
+   // Our id may be handed to another datablock later.
+   DataBlockCache::removeServerPayload( getId() );
+
+   Parent::onRemove();
+}
+
+//-----------------------------------------------------------------------------
+
 void SimDataBlock::assignId()
 {
    // We don't want the id assigned by the manager, but it may have
@@ -209,4 +220,8 @@ DefineConsoleFunction( deleteDataBlocks, void, (),,
    grp->deleteAllObjects();
    SimDataBlock::sNextObjectId = DataBlockObjectIdFirst;
    SimDataBlock::sNextModifiedKey = 0;
+
+   // The ids and modified keys start over, so the packed
+   // payloads of the old datablocks can't be trusted.
+   DataBlockCache::clearServerPayloads();
 }
@@ -134,6 +134,7 @@ public:
    S32 getModifiedKey() const { return modifiedKey; }
 
    bool onAdd();
+   void onRemove();
    virtual void onStaticModified(const char* slotName, const char*newValue = NULL);
    //void setLastError(const char*);
    void assignId();
@@ -0,0 +1,234 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "console/simEventPool.h"
+
+#include "core/dataChunker.h"
+#include "platform/threads/mutex.h"
+#include "console/console.h"
+#include "console/engineAPI.h"
+
+
+namespace SimEventPool
+{
+   /// The header in front of every block.  It is padded so that
+   /// the block sizes stay a multiple of 16 bytes.  The chunkers 
+   /// only guarantee 4 byte alignment of the blocks themselves.
+   struct BlockHeader
+   {
+      U32 sizeClass;
+      U32 pad[3];
+   };
+
+   /// The block sizes of the classes.  SimConsoleEvents and the
+   /// common SimEvents fall in the first few classes and the rest
+   /// are for the schedule() argument strings.
+   static const U32 smBlockSizes[ NumSizeClasses ] =
+   {
+      32, 48, 64, 96, 128, 192, 256, 384, 512, 1024
+   };
+
+   static FreeListChunkerUntyped* smChunkers[ NumSizeClasses ];
+   static SizeClassStats smStats[ NumSizeClasses + 1 ];
+   static void *smMutex = NULL;
+
+   static inline U32 _getSizeClass( dsize_t size )
+   {
+      for ( U32 i = 0; i < NumSizeClasses; i++ )
+      {
+         if ( size <= smBlockSizes[i] )
+            return i;
+      }
+
+      return FallbackClass;
+   }
+
+   static inline void _trackAlloc( SizeClassStats &stats )
+   {
+      stats.totalAllocs++;
+      stats.liveAllocs++;
+      if ( stats.liveAllocs > stats.peakAllocs )
+         stats.peakAllocs = stats.liveAllocs;
+   }
+
+   void init()
+   {
+      AssertFatal( !smMutex, "SimEventPool::init - The pool is already initialized!" );
+
+      smMutex = Mutex::createMutex();
+
+      for ( U32 i = 0; i < NumSizeClasses; i++ )
+      {
+         smChunkers[i] = new FreeListChunkerUntyped( sizeof( BlockHeader ) + smBlockSizes[i] );
+         smStats[i].blockSize = smBlockSizes[i];
+      }
+
+      smStats[ FallbackClass ].blockSize = 0;
+   }
+
+   void shutdown()
+   {
+      if ( !smMutex )
+         return;
+
+      Mutex::lockMutex( smMutex );
+
+      // If anything is still alive we cannot release the
+      // pages, so we just keep the pool around.
+      for ( U32 i = 0; i < NumSizeClasses; i++ )
+      {
+         if ( smStats[i].liveAllocs > 0 )
+         {
+            Con::warnf( "SimEventPool::shutdown - %d blocks of %d bytes are still allocated!",
+               smStats[i].liveAllocs, smStats[i].blockSize );
+            Mutex::unlockMutex( smMutex );
+            return;
+         }
+      }
+
+      for ( U32 i = 0; i < NumSizeClasses; i++ )
+      {
+         SAFE_DELETE( smChunkers[i] );
+         smStats[i].freeBlocks = 0;
+      }
+
+      Mutex::unlockMutex( smMutex );
+      Mutex::destroyMutex( smMutex );
+      smMutex = NULL;
+   }
+
+   void* alloc( dsize_t size )
+   {
+      U32 sizeClass = _getSizeClass( size );
+      BlockHeader *header;
+
+      if ( smMutex && sizeClass != FallbackClass )
+      {
+         Mutex::lockMutex( smMutex );
+
+         header = reinterpret_cast< BlockHeader* >( smChunkers[ sizeClass ]->alloc() );
+
+         SizeClassStats &stats = smStats[ sizeClass ];
+         if ( stats.freeBlocks > 0 )
+            stats.freeBlocks--;
+         _trackAlloc( stats );
+
+         Mutex::unlockMutex( smMutex );
+      }
+      else
+      {
+         sizeClass = FallbackClass;
+         header = reinterpret_cast< BlockHeader* >( dMalloc( sizeof( BlockHeader ) + size ) );
+
+         if ( smMutex )
+            Mutex::lockMutex( smMutex );
+
+         _trackAlloc( smStats[ FallbackClass ] );
+
+         if ( smMutex )
+            Mutex::unlockMutex( smMutex );
+      }
+
+      header->sizeClass = sizeClass;
+      return header + 1;
+   }
+
+   void free( void *ptr )
+   {
+      if ( !ptr )
+         return;
+
+      BlockHeader *header = reinterpret_cast< BlockHeader* >( ptr ) - 1;
+      const U32 sizeClass = header->sizeClass;
+
+      AssertFatal( sizeClass <= FallbackClass, "SimEventPool::free - Bad block header!" );
+
+      if ( smMutex )
+         Mutex::lockMutex( smMutex );
+
+      SizeClassStats &stats = smStats[ sizeClass ];
+      stats.liveAllocs--;
+
+      if ( sizeClass != FallbackClass )
+      {
+         AssertFatal( smMutex, "SimEventPool::free - Pooled block freed after shutdown!" );
+         smChunkers[ sizeClass ]->free( header );
+         stats.freeBlocks++;
+      }
+
+      if ( smMutex )
+         Mutex::unlockMutex( smMutex );
+
+      if ( sizeClass == FallbackClass )
+         dFree( header );
+   }
+
+   SizeClassStats getStats( U32 sizeClass )
+   {
+      AssertFatal( sizeClass <= FallbackClass, "SimEventPool::getStats - Bad size class!" );
+
+      if ( smMutex )
+         Mutex::lockMutex( smMutex );
+
+      SizeClassStats stats = smStats[ sizeClass ];
+
+      if ( smMutex )
+         Mutex::unlockMutex( smMutex );
+
+      return stats;
+   }
+
+   void dumpStats()
+   {
+      Con::printf( "SimEventPool Statistics:" );
+      Con::printf( "%10s %10s %10s %10s %10s %12s", "Block", "Total", "Live", "Peak", "Free", "Reserved" );
+
+      U32 totalReserved = 0;
+      for ( U32 i = 0; i <= FallbackClass; i++ )
+      {
+         const SizeClassStats stats = getStats( i );
+         const U32 reserved = ( stats.liveAllocs + stats.freeBlocks ) * ( stats.blockSize + sizeof( BlockHeader ) );
+         totalReserved += reserved;
+
+         if ( i == FallbackClass )
+            Con::printf( "%10s %10d %10d %10d %10s %12s", "heap", stats.totalAllocs, stats.liveAllocs, stats.peakAllocs, "-", "-" );
+         else
+            Con::printf( "%10d %10d %10d %10d %10d %12d", stats.blockSize, stats.totalAllocs, stats.liveAllocs, stats.peakAllocs, stats.freeBlocks, reserved );
+      }
+
+      Con::printf( "Total pooled bytes in use or free: %d", totalReserved );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+DefineEngineFunction( dumpSimEventPoolStats, void, (),,
+   "@brief Dumps the SimEvent pool allocator statistics to the console.\n\n"
+   "For each size class this prints the block size, the total number of "
+   "allocations, the number of live and peak allocations and the number of "
+   "blocks waiting on the free list.  Allocations which did not fit any size "
+   "class are listed as heap allocations.\n\n"
+   "@ingroup Console" )
+{
+   SimEventPool::dumpStats();
+}
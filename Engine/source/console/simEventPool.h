@@ -0,0 +1,97 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _SIMEVENTPOOL_H_
+#define _SIMEVENTPOOL_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+
+
+/// A size-classed pool allocator for SimEvents and their argument storage.
+///
+/// Servers can easily post thousands of schedule() events per second, each
+/// of which used to cost a heap allocation for the event and another one for
+/// its copied argument strings.  The pool keeps a free list per size class
+/// which is carved out of 16k pages, so after warm up posting and processing
+/// an event never touches the system heap.
+///
+/// Every block is prefixed by a small header which records its size class,
+/// so blocks may be freed without knowing their size.  Requests larger than
+/// the biggest size class and requests made before init() fall back to
+/// dMalloc() and are tracked in the statistics as well.
+///
+/// The pool is thread safe as events are also created on worker threads by
+/// Con::threadSafeExecute().
+///
+/// @see dumpSimEventPoolStats()
+namespace SimEventPool
+{
+   enum
+   {
+      /// The number of size classes.
+      NumSizeClasses = 10,
+
+      /// The index used for blocks which are not pooled.
+      FallbackClass = NumSizeClasses,
+   };
+
+   struct SizeClassStats
+   {
+      /// The size of the blocks in the class excluding the header.
+      U32 blockSize;
+
+      /// The number of allocations made from this class.
+      U32 totalAllocs;
+
+      /// The number of allocations currently live.
+      U32 liveAllocs;
+
+      /// The highest number of live allocations seen.
+      U32 peakAllocs;
+
+      /// The number of blocks waiting on the free list.
+      U32 freeBlocks;
+   };
+
+   /// Creates the pool.  Called from Sim::init().
+   void init();
+
+   /// Releases the pool pages if no blocks are live.  Called
+   /// from Sim::shutdown().
+   void shutdown();
+
+   /// Allocates a block of at least the given size.
+   void* alloc( dsize_t size );
+
+   /// Frees a block returned from alloc().
+   void free( void *ptr );
+
+   /// Returns the statistics for a size class or for FallbackClass.
+   SizeClassStats getStats( U32 sizeClass );
+
+   /// Prints the statistics for every size class to the console.
+   void dumpStats();
+}
+
+#endif // _SIMEVENTPOOL_H_
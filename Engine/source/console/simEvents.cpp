@@ -38,7 +38,7 @@ SimConsoleEvent::SimConsoleEvent(S32 argc, const char **argv, bool onObject)
       totalSize += dStrlen(argv[i]) + 1;
    totalSize += sizeof(char *) * argc;
 
-   mArgv = (char **) dMalloc(totalSize);
+   mArgv = (char **) SimEventPool::alloc(totalSize);
    char *argBase = (char *) &mArgv[argc];
 
    for(i = 0; i < argc; i++)
@@ -51,7 +51,7 @@ SimConsoleEvent::SimConsoleEvent(S32 argc, const char **argv, bool onObject)
 
 SimConsoleEvent::~SimConsoleEvent()
 {
-   dFree(mArgv);
+   SimEventPool::free(mArgv);
 }
 
 void SimConsoleEvent::process(SimObject* object)
@@ -31,6 +31,12 @@
 #include "core/util/delegate.h"
 #endif
 
+#ifndef _SIMEVENTPOOL_H_
+#include "console/simEventPool.h"
+#endif
+
+#include "platform/tmm_off.h"
+
 // Forward Refs
 class SimObject;
 class Semaphore;
@@ -80,6 +86,20 @@ public:
    ///
    /// @param   object  Object stored in destObject.
    virtual void process(SimObject *object)=0;
+
+   /// @name Memory Management
+   ///
+   /// All SimEvents are allocated from the SimEventPool.
+   /// @{
+
+   #ifndef TORQUE_DISABLE_MEMORY_MANAGER
+   void* operator new( size_t size TORQUE_TMM_ARGS_DECL ) { return SimEventPool::alloc( size ); }
+   #endif
+
+   void* operator new( size_t size ) { return SimEventPool::alloc( size ); }
+   void operator delete( void *ptr ) { SimEventPool::free( ptr ); }
+
+   /// @}
 };
 
 /// Implementation of schedule() function.
@@ -152,4 +172,6 @@ public:
    }
 };
 
+#include "platform/tmm_on.h"
+
 #endif // _SIMEVENTS_H_
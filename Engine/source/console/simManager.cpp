@@ -24,6 +24,7 @@
 #include "platform/threads/mutex.h"
 #include "console/simBase.h"
 #include "console/simPersistID.h"
+#include "console/simEventPool.h"
 #include "core/stringTable.h"
 #include "console/console.h"
 #include "core/stream/fileStream.h"
@@ -71,6 +72,8 @@ static void initEventQueue()
    gEventSequence = 1;
    gEventQueue = NULL;
    gEventQueueMutex = Mutex::createMutex();
+
+   SimEventPool::init();
 }
 
 static void shutdownEventQueue()
@@ -86,6 +89,8 @@ static void shutdownEventQueue()
    }
    Mutex::unlockMutex(gEventQueueMutex);
    Mutex::destroyMutex(gEventQueueMutex);
+
+   SimEventPool::shutdown();
 }
 
 //---------------------------------------------------------------------------
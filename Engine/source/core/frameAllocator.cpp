@@ -22,16 +22,166 @@
 
 #include "core/frameAllocator.h"
 #include "console/console.h"
+#include "console/engineAPI.h"
+#include "platform/platformTLS.h"
+#include "platform/threads/mutex.h"
+#include "platform/threads/thread.h"
+#include "core/util/safeDelete.h"
 
-U8*   FrameAllocator::smBuffer = NULL;
-U32   FrameAllocator::smWaterMark = 0;
-U32   FrameAllocator::smHighWaterMark = 0;
+FrameAllocator::Arena FrameAllocator::smMainArena = { NULL, 0, 0, 0, 0, NULL };
 
-#ifdef TORQUE_DEBUG
-U32   FrameAllocator::smMaxFrameAllocation = 0;
+#ifdef TORQUE_MULTITHREAD
+
+ThreadStorage* FrameAllocator::smThreadArena = NULL;
+
+/// Guards the list of arenas hanging off smMainArena.
+static void* sgArenaListMutex = NULL;
+
+FrameAllocator::Arena* FrameAllocator::_createThreadArena( const U32 frameSize )
+{
+   AssertFatal( smThreadArena, "FrameAllocator::_createThreadArena - Not initialized!" );
+
+   Arena *arena = new Arena;
+   arena->buffer = new U8[ frameSize ];
+   arena->waterMark = 0;
+   arena->size = frameSize;
+   arena->peakWaterMark = 0;
+   arena->threadId = ThreadManager::getCurrentThreadId();
+
+   Mutex::lockMutex( sgArenaListMutex );
+   arena->next = smMainArena.next;
+   smMainArena.next = arena;
+   Mutex::unlockMutex( sgArenaListMutex );
+
+   smThreadArena->set( arena );
+
+   return arena;
+}
+
+#endif
+
+void FrameAllocator::init(const U32 frameSize)
+{
+#ifdef FRAMEALLOCATOR_DEBUG_GUARD
+   AssertISV( false, "FRAMEALLOCATOR_DEBUG_GUARD has been removed because it allows non-contiguous memory allocation by the FrameAllocator, and this is *not* ok." );
+#endif
+
+   AssertFatal(smMainArena.buffer == NULL, "Error, already initialized");
+   smMainArena.buffer = new U8[frameSize];
+   smMainArena.waterMark = 0;
+   smMainArena.size = frameSize;
+   smMainArena.peakWaterMark = 0;
+   smMainArena.threadId = ThreadManager::getCurrentThreadId();
+   smMainArena.next = NULL;
+
+#ifdef TORQUE_MULTITHREAD
+   sgArenaListMutex = Mutex::createMutex();
+   smThreadArena = new ThreadStorage;
+   smThreadArena->set( &smMainArena );
+#endif
+}
+
+void FrameAllocator::destroy()
+{
+   AssertFatal(smMainArena.buffer != NULL, "Error, not initialized");
+
+#ifdef TORQUE_MULTITHREAD
+   // Any worker arenas left at this point belong to threads
+   // which are gone or are about to go, so release them all.
+   Arena *walk = smMainArena.next;
+   while ( walk )
+   {
+      Arena *next = walk->next;
+      delete [] walk->buffer;
+      delete walk;
+      walk = next;
+   }
+
+   SAFE_DELETE( smThreadArena );
+   Mutex::destroyMutex( sgArenaListMutex );
+   sgArenaListMutex = NULL;
+#endif
+
+   delete [] smMainArena.buffer;
+   smMainArena.buffer = NULL;
+   smMainArena.waterMark = 0;
+   smMainArena.size = 0;
+   smMainArena.next = NULL;
+}
 
+void FrameAllocator::initThread(const U32 frameSize)
+{
+#ifdef TORQUE_MULTITHREAD
+   if ( smThreadArena && !smThreadArena->get() )
+      _createThreadArena( frameSize );
+#endif
+}
+
+void FrameAllocator::destroyThread()
+{
+#ifdef TORQUE_MULTITHREAD
+   if ( !smThreadArena )
+      return;
+
+   Arena *arena = reinterpret_cast<Arena*>( smThreadArena->get() );
+   if ( !arena || arena == &smMainArena )
+      return;
+
+   AssertFatal( arena->waterMark == 0, "FrameAllocator::destroyThread - Arena is still in use!" );
+
+   Mutex::lockMutex( sgArenaListMutex );
+   for ( Arena *walk = &smMainArena; walk; walk = walk->next )
+   {
+      if ( walk->next == arena )
+      {
+         walk->next = arena->next;
+         break;
+      }
+   }
+   Mutex::unlockMutex( sgArenaListMutex );
+
+   smThreadArena->set( NULL );
+
+   delete [] arena->buffer;
+   delete arena;
+#endif
+}
+
+void FrameAllocator::dumpStats()
+{
+   Con::printf( "FrameAllocator Arenas:" );
+   Con::printf( "%12s %12s %12s %12s", "Thread", "Size", "WaterMark", "Peak" );
+
+#ifdef TORQUE_MULTITHREAD
+   if ( sgArenaListMutex )
+      Mutex::lockMutex( sgArenaListMutex );
+#endif
+
+   for ( const Arena *walk = &smMainArena; walk; walk = walk->next )
+   {
+      Con::printf( "%12d %12d %12d %12d%s", walk->threadId, walk->size, walk->waterMark,
+         walk->peakWaterMark, walk == &smMainArena ? " (main)" : "" );
+   }
+
+#ifdef TORQUE_MULTITHREAD
+   if ( sgArenaListMutex )
+      Mutex::unlockMutex( sgArenaListMutex );
+#endif
+}
+
+#ifdef TORQUE_DEBUG
 ConsoleFunction(getMaxFrameAllocation, S32, 1,1, "getMaxFrameAllocation();")
 {
    return FrameAllocator::getMaxFrameAllocation();
 }
 #endif
+
+DefineEngineFunction( dumpFrameAllocatorStats, void, (),,
+   "@brief Dumps the size, current watermark and peak watermark of the "
+   "FrameAllocator arena of every thread to the console.\n\n"
+   "The peak watermark is the high-water mark of the arena and can be used "
+   "to tune TORQUE_FRAME_SIZE and TORQUE_THREAD_FRAME_SIZE.\n\n"
+   "@ingroup Debugging" )
+{
+   FrameAllocator::dumpStats();
+}
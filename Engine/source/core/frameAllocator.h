@@ -26,6 +26,9 @@
 #ifndef _PLATFORM_H_
 #include "platform/platform.h"
 #endif
+#ifndef _PLATFORMTLS_H_
+#include "platform/platformTLS.h"
+#endif
 
 /// This #define is used by the FrameAllocator to align starting addresses to
 /// be byte aligned to this value. This is important on the 360 and possibly
@@ -36,6 +39,12 @@
 /// memory which is allocated and expected to be contiguous.
 #define FRAMEALLOCATOR_BYTE_ALIGNMENT 4
 
+/// The size of the frame arena given to threads other than the main
+/// thread.  See comments in torqueConfig.h.
+#ifndef TORQUE_THREAD_FRAME_SIZE
+#  define TORQUE_THREAD_FRAME_SIZE  1 << 20
+#endif
+
 /// Temporary memory pool for per-frame allocations.
 ///
 /// In the course of rendering a frame, it is often necessary to allocate
@@ -52,19 +61,59 @@
 ///   // Free frameAllocator memory
 ///   FrameAllocator::setWaterMark(waterMark);
 /// @endcode
+///
+/// Every thread has its own arena, so the FrameAllocator, FrameAllocatorMarker
+/// and FrameTemp may be used from worker threads as well.  The main thread's
+/// arena is created by init() and sized by TORQUE_FRAME_SIZE.  Other threads
+/// get an arena of TORQUE_THREAD_FRAME_SIZE bytes the first time they use the
+/// allocator, or explicitly with initThread() which the ThreadPool worker
+/// threads do on startup.  Watermarks are only meaningful on the thread they
+/// were taken from.
 class FrameAllocator
 {
-   static U8*   smBuffer;
-   static U32   smHighWaterMark;
-   static U32   smWaterMark;
+public:
 
-#ifdef TORQUE_DEBUG
-   static U32 smMaxFrameAllocation;
+   /// The bump buffer of a single thread.
+   struct Arena
+   {
+      U8*   buffer;
+      U32   waterMark;
+      U32   size;
+
+      /// The highest watermark this arena has seen.
+      U32   peakWaterMark;
+
+      U32   threadId;
+      Arena *next;
+   };
+
+protected:
+
+   /// The arena of the main thread.
+   static Arena smMainArena;
+
+#ifdef TORQUE_MULTITHREAD
+   /// The per-thread pointer to the thread's arena.
+   static ThreadStorage* smThreadArena;
+
+   /// Creates the arena for the calling thread.
+   static Arena* _createThreadArena( const U32 frameSize );
 #endif
 
+   /// Returns the arena of the calling thread.
+   inline static Arena* _getArena();
+
   public:
-   inline static void init(const U32 frameSize);
-   inline static void destroy();
+   static void init(const U32 frameSize);
+   static void destroy();
+
+   /// Creates the arena for the calling thread if it doesn't have one.
+   /// @param frameSize The size of the arena in bytes.
+   static void initThread(const U32 frameSize = TORQUE_THREAD_FRAME_SIZE);
+
+   /// Releases the arena of the calling thread.  This must be
+   /// done before a thread that used the allocator exits.
+   static void destroyThread();
 
    inline static void* alloc(const U32 allocSize);
 
@@ -72,52 +121,52 @@ class FrameAllocator
    inline static U32  getWaterMark();
    inline static U32  getHighWaterMark();
 
+   /// Returns the highest watermark seen by the calling thread's arena.
+   inline static U32  getPeakWaterMark();
+
+   /// Prints the size and peak usage of every thread's arena.
+   static void dumpStats();
+
 #ifdef TORQUE_DEBUG
-   static U32 getMaxFrameAllocation() { return smMaxFrameAllocation; }
+   static U32 getMaxFrameAllocation() { return smMainArena.peakWaterMark; }
 #endif
 };
 
-void FrameAllocator::init(const U32 frameSize)
+FrameAllocator::Arena* FrameAllocator::_getArena()
 {
-#ifdef FRAMEALLOCATOR_DEBUG_GUARD
-   AssertISV( false, "FRAMEALLOCATOR_DEBUG_GUARD has been removed because it allows non-contiguous memory allocation by the FrameAllocator, and this is *not* ok." );
+#ifdef TORQUE_MULTITHREAD
+   // Before init() and after destroy() only the main thread exists.
+   if ( !smThreadArena )
+      return &smMainArena;
+
+   Arena *arena = reinterpret_cast<Arena*>( smThreadArena->get() );
+   if ( !arena )
+      arena = _createThreadArena( TORQUE_THREAD_FRAME_SIZE );
+
+   return arena;
+#else
+   return &smMainArena;
 #endif
-
-   AssertFatal(smBuffer == NULL, "Error, already initialized");
-   smBuffer = new U8[frameSize];
-   smWaterMark = 0;
-   smHighWaterMark = frameSize;
-}
-
-void FrameAllocator::destroy()
-{
-   AssertFatal(smBuffer != NULL, "Error, not initialized");
-
-   delete [] smBuffer;
-   smBuffer = NULL;
-   smWaterMark = 0;
-   smHighWaterMark = 0;
 }
 
-
 void* FrameAllocator::alloc(const U32 allocSize)
 {
    U32 _allocSize = allocSize;
 
-   AssertFatal(smBuffer != NULL, "Error, no buffer!");
-   AssertFatal(smWaterMark + _allocSize <= smHighWaterMark, "Error alloc too large, increase frame size!");
-   smWaterMark = ( smWaterMark + ( FRAMEALLOCATOR_BYTE_ALIGNMENT - 1 ) ) & (~( FRAMEALLOCATOR_BYTE_ALIGNMENT - 1 ));
+   Arena *arena = _getArena();
+
+   AssertFatal(arena->buffer != NULL, "Error, no buffer!");
+   AssertFatal(arena->waterMark + _allocSize <= arena->size, "Error alloc too large, increase frame size!");
+   arena->waterMark = ( arena->waterMark + ( FRAMEALLOCATOR_BYTE_ALIGNMENT - 1 ) ) & (~( FRAMEALLOCATOR_BYTE_ALIGNMENT - 1 ));
 
    // Sanity check.
-   AssertFatal( !( smWaterMark & ( FRAMEALLOCATOR_BYTE_ALIGNMENT - 1 ) ), "Frame allocation is not on a specified byte boundry." );
+   AssertFatal( !( arena->waterMark & ( FRAMEALLOCATOR_BYTE_ALIGNMENT - 1 ) ), "Frame allocation is not on a specified byte boundry." );
 
-   U8* p = &smBuffer[smWaterMark];
-   smWaterMark += _allocSize;
+   U8* p = &arena->buffer[arena->waterMark];
+   arena->waterMark += _allocSize;
 
-#ifdef TORQUE_DEBUG
-   if (smWaterMark > smMaxFrameAllocation)
-      smMaxFrameAllocation = smWaterMark;
-#endif
+   if (arena->waterMark > arena->peakWaterMark)
+      arena->peakWaterMark = arena->waterMark;
 
    return p;
 }
@@ -125,18 +174,24 @@ void* FrameAllocator::alloc(const U32 allocSize)
 
 void FrameAllocator::setWaterMark(const U32 waterMark)
 {
-   AssertFatal(waterMark < smHighWaterMark, "Error, invalid waterMark");
-   smWaterMark = waterMark;
+   Arena *arena = _getArena();
+   AssertFatal(waterMark < arena->size, "Error, invalid waterMark");
+   arena->waterMark = waterMark;
 }
 
 U32 FrameAllocator::getWaterMark()
 {
-   return smWaterMark;
+   return _getArena()->waterMark;
 }
 
 U32 FrameAllocator::getHighWaterMark()
 {
-   return smHighWaterMark;
+   return _getArena()->size;
+}
+
+U32 FrameAllocator::getPeakWaterMark()
+{
+   return _getArena()->peakWaterMark;
 }
 
 /// Helper class to deal with FrameAllocator usage.
@@ -35,6 +35,12 @@ public:
    S32 mDrawCalls;
    S32 mRenderTargetChanges;
 
+   /// Number of draw calls that rendered hardware instances.
+   S32 mInstancedDrawCalls;
+
+   /// Number of instances rendered by all the instanced draw calls.
+   S32 mInstancesDrawn;
+
    GFXDeviceStatistics();
 
    void setPrefix(const String& prefix);
@@ -57,6 +63,8 @@ private:
    String vnPolyCount;
    String vnDrawCalls;
    String vnRenderTargetChanges;
+   String vnInstancedDrawCalls;
+   String vnInstancesDrawn;
 };
 
 #endif
\ No newline at end of file
@@ -469,6 +469,10 @@ void GuiTSCtrl::onRender(Point2I offset, const RectI &updateRect)
 
    renderChildControls(offset, updateRect);
    smFrameCount++;
+
+   // The scene changes every frame, so keep our area dirty for
+   // the canvas' dirty rectangle mode.
+   setUpdate();
 }
 
 //-----------------------------------------------------------------------------
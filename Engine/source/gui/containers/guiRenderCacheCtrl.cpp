@@ -0,0 +1,249 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "gui/containers/guiRenderCacheCtrl.h"
+
+#include "console/consoleTypes.h"
+#include "console/engineAPI.h"
+#include "gfx/gfxDevice.h"
+#include "gfx/gfxDrawUtil.h"
+#include "gfx/gfxTransformSaver.h"
+#include "gfx/primBuilder.h"
+
+
+IMPLEMENT_CONOBJECT( GuiRenderCacheCtrl );
+
+ConsoleDocClass( GuiRenderCacheCtrl,
+   "@brief A container that renders its children into an offscreen texture and "
+   "redraws that texture until something inside it changes.\n\n"
+
+   "The cache is rebuilt when a child calls setUpdate(), when the control is resized or "
+   "children are added or removed, when invalidateCache() is called, or every "
+   "updateInterval milliseconds if it is non-zero.  Use it around static subtrees such "
+   "as HUD panels; a subtree holding a 3D view is rebuilt every frame.\n\n"
+
+   "@tsexample\n"
+   "new GuiRenderCacheCtrl(HudPanelCache)\n"
+   "{\n"
+   "   position = \"0 0\";\n"
+   "   extent = \"256 64\";\n"
+   "   updateInterval = \"250\";\n"
+   "};\n"
+   "@endtsexample\n\n"
+
+   "@ingroup GuiContainers\n" );
+
+GuiRenderCacheCtrl::GuiRenderCacheCtrl()
+   : mCacheEnabled( true ),
+     mUpdateInterval( 0 ),
+     mCacheDirty( true ),
+     mLastCacheTime( 0 )
+{
+   mIsContainer = true;
+}
+
+void GuiRenderCacheCtrl::initPersistFields()
+{
+   addGroup( "Render Cache" );
+
+      addField( "cacheEnabled", TypeBool, Offset( mCacheEnabled, GuiRenderCacheCtrl ),
+         "If false the children are rendered directly every frame." );
+      addField( "updateInterval", TypeS32, Offset( mUpdateInterval, GuiRenderCacheCtrl ),
+         "Milliseconds between forced rebuilds of the cache, or 0 to only rebuild when "
+         "something inside the control changes." );
+
+   endGroup( "Render Cache" );
+
+   Parent::initPersistFields();
+}
+
+bool GuiRenderCacheCtrl::onWake()
+{
+   if ( !Parent::onWake() )
+      return false;
+
+   GFXTextureManager::addEventDelegate( this, &GuiRenderCacheCtrl::_onTextureEvent );
+   mCacheDirty = true;
+
+   return true;
+}
+
+void GuiRenderCacheCtrl::onSleep()
+{
+   GFXTextureManager::removeEventDelegate( this, &GuiRenderCacheCtrl::_onTextureEvent );
+
+   mCacheTex = NULL;
+   mCacheTarget = NULL;
+
+   Parent::onSleep();
+}
+
+void GuiRenderCacheCtrl::_onTextureEvent( GFXTexCallbackCode code )
+{
+   if ( code == GFXZombify )
+   {
+      mCacheTex = NULL;
+      mCacheDirty = true;
+   }
+}
+
+void GuiRenderCacheCtrl::invalidateCache()
+{
+   mCacheDirty = true;
+   setUpdate();
+}
+
+void GuiRenderCacheCtrl::onPreRender()
+{
+   Parent::onPreRender();
+
+   if ( mCacheEnabled && mUpdateInterval > 0 &&
+        ( Platform::getVirtualMilliseconds() - mLastCacheTime ) >= (U32)mUpdateInterval )
+      invalidateCache();
+}
+
+bool GuiRenderCacheCtrl::resize( const Point2I &newPosition, const Point2I &newExtent )
+{
+   const Point2I oldExtent = getExtent();
+   const bool result = Parent::resize( newPosition, newExtent );
+
+   // Moving alone just redraws the texture somewhere else.
+   if ( getExtent() != oldExtent )
+      invalidateCache();
+
+   return result;
+}
+
+void GuiRenderCacheCtrl::onChildAdded( GuiControl *child )
+{
+   Parent::onChildAdded( child );
+   invalidateCache();
+}
+
+void GuiRenderCacheCtrl::onChildRemoved( GuiControl *child )
+{
+   Parent::onChildRemoved( child );
+   invalidateCache();
+}
+
+void GuiRenderCacheCtrl::onChildUpdate( GuiControl *child )
+{
+   mCacheDirty = true;
+}
+
+void GuiRenderCacheCtrl::_updateCache()
+{
+   const Point2I &extent = getExtent();
+
+   if (  mCacheTex.isNull() ||
+         mCacheTex.getWidth() != extent.x ||
+         mCacheTex.getHeight() != extent.y )
+      mCacheTex.set( extent.x, extent.y, GFXFormatR8G8B8A8, &GFXDefaultRenderTargetProfile,
+                     avar( "%s() - mCacheTex (line %d)", __FUNCTION__, __LINE__ ) );
+
+   if ( mCacheTarget.isNull() )
+      mCacheTarget = GFX->allocRenderToTextureTarget();
+
+   if ( mCompositeSB.isNull() )
+   {
+      GFXStateBlockDesc desc;
+      desc.setCullMode( GFXCullNone );
+      desc.setZReadWrite( false );
+      desc.setBlend( true, GFXBlendOne, GFXBlendInvSrcAlpha );
+      desc.samplersDefined = true;
+      desc.samplers[0] = GFXSamplerStateDesc::getClampPoint();
+      mCompositeSB = GFX->createStateBlock( desc );
+   }
+
+   // Clear the flag first so children that call setUpdate() while
+   // rendering get picked up next frame.
+   mCacheDirty = false;
+   mLastCacheTime = Platform::getVirtualMilliseconds();
+
+   GFXTransformSaver saver;
+
+   GFX->pushActiveRenderTarget();
+   mCacheTarget->attachTexture( GFXTextureTarget::Color0, mCacheTex );
+   GFX->setActiveRenderTarget( mCacheTarget );
+   GFX->clear( GFXClearTarget, ColorI( 0, 0, 0, 0 ), 1.0f, 0 );
+
+   RectI cacheRect( Point2I( 0, 0 ), extent );
+   GFX->setClipRect( cacheRect );
+   GFX->setStateBlock( mDefaultGuiSB );
+
+   Parent::onRender( Point2I( 0, 0 ), cacheRect );
+
+   mCacheTarget->resolve();
+   GFX->popActiveRenderTarget();
+}
+
+void GuiRenderCacheCtrl::onRender( Point2I offset, const RectI &updateRect )
+{
+   const Point2I &extent = getExtent();
+   if ( !mCacheEnabled || extent.x <= 0 || extent.y <= 0 )
+   {
+      Parent::onRender( offset, updateRect );
+      return;
+   }
+
+   if ( mCacheDirty || mCacheTex.isNull() )
+   {
+      _updateCache();
+
+      // Restore what our parent set up for us.
+      GFX->setClipRect( updateRect );
+      GFX->setStateBlock( mDefaultGuiSB );
+   }
+
+   // The children were alpha blended into a transparent target,
+   // so the cached colors are already weighted by their alpha
+   // and mustn't be multiplied by it a second time.
+   GFX->setStateBlock( mCompositeSB );
+   GFX->setTexture( 0, mCacheTex );
+
+   const F32 fillConv = GFX->getFillConventionOffset();
+   const F32 left = offset.x - fillConv;
+   const F32 top = offset.y - fillConv;
+   const F32 right = offset.x + extent.x - fillConv;
+   const F32 bottom = offset.y + extent.y - fillConv;
+
+   PrimBuild::begin( GFXTriangleStrip, 4 );
+      PrimBuild::colorWhite();
+      PrimBuild::texCoord2f( 0.0f, 0.0f );
+      PrimBuild::vertex2f( left, top );
+      PrimBuild::texCoord2f( 1.0f, 0.0f );
+      PrimBuild::vertex2f( right, top );
+      PrimBuild::texCoord2f( 0.0f, 1.0f );
+      PrimBuild::vertex2f( left, bottom );
+      PrimBuild::texCoord2f( 1.0f, 1.0f );
+      PrimBuild::vertex2f( right, bottom );
+   PrimBuild::end();
+
+   GFX->setStateBlock( mDefaultGuiSB );
+}
+
+DefineEngineMethod( GuiRenderCacheCtrl, invalidateCache, void, (),,
+   "Force the cached rendering of the children to be rebuilt on the next frame." )
+{
+   object->invalidateCache();
+}
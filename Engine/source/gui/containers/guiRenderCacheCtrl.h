@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _GUIRENDERCACHECTRL_H_
+#define _GUIRENDERCACHECTRL_H_
+
+#ifndef _GUICONTROL_H_
+#include "gui/core/guiControl.h"
+#endif
+#ifndef _GFXTEXTUREHANDLE_H_
+#include "gfx/gfxTextureHandle.h"
+#endif
+#ifndef _GFXTARGET_H_
+#include "gfx/gfxTarget.h"
+#endif
+#ifndef _GFXTEXTUREMANAGER_H_
+#include "gfx/gfxTextureManager.h"
+#endif
+
+
+/// A container that renders itself and its children into an offscreen
+/// texture and draws that texture until something inside it changes.
+///
+/// The cache is rebuilt when a child marks itself dirty with setUpdate(),
+/// when the control is resized or children are added or removed, when
+/// invalidateCache() is called, or every updateInterval milliseconds if set.
+/// This suits static subtrees such as HUD panels whose children rarely
+/// change; a subtree containing a 3D view is rebuilt every frame and gains
+/// nothing.
+///
+/// @addtogroup gui_container_group Containers
+///
+/// @ingroup gui_group Gui System
+/// @{
+class GuiRenderCacheCtrl : public GuiControl
+{
+private:
+   typedef GuiControl Parent;
+
+protected:
+
+   /// If false the control renders like a plain GuiControl.
+   bool mCacheEnabled;
+
+   /// Milliseconds between forced rebuilds, 0 to only rebuild on change.
+   S32 mUpdateInterval;
+
+   GFXTexHandle mCacheTex;
+   GFXTextureTargetRef mCacheTarget;
+
+   /// Draws mCacheTex, whose colors are already multiplied
+   /// by the children's alpha, over what is behind us.
+   GFXStateBlockRef mCompositeSB;
+
+   bool mCacheDirty;
+   U32 mLastCacheTime;
+
+   /// Render this control and its children into mCacheTex.
+   void _updateCache();
+
+   /// Drops the cache when the device loses its render targets.
+   void _onTextureEvent( GFXTexCallbackCode code );
+
+public:
+
+   GuiRenderCacheCtrl();
+
+   DECLARE_CONOBJECT(GuiRenderCacheCtrl);
+   DECLARE_CATEGORY( "Gui Containers" );
+   DECLARE_DESCRIPTION( "A container that caches the rendering of its children in a texture." );
+
+   static void initPersistFields();
+
+   /// Force the cached texture to be rebuilt on the next render.
+   void invalidateCache();
+
+   // GuiControl
+   virtual bool onWake();
+   virtual void onSleep();
+   virtual void onPreRender();
+   virtual void onRender( Point2I offset, const RectI &updateRect );
+   virtual bool resize( const Point2I &newPosition, const Point2I &newExtent );
+   virtual void onChildAdded( GuiControl *child );
+   virtual void onChildRemoved( GuiControl *child );
+   virtual void onChildUpdate( GuiControl *child );
+};
+/// @}
+
+#endif // _GUIRENDERCACHECTRL_H_
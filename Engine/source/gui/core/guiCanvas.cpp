@@ -28,6 +28,8 @@
 #include "platform/profiler.h"
 #include "gfx/gfxDevice.h"
 #include "gfx/gfxDrawUtil.h"
+#include "gfx/gfxTextureManager.h"
+#include "gfx/primBuilder.h"
 #include "gui/core/guiTypes.h"
 #include "gui/core/guiControl.h"
 #include "console/consoleTypes.h"
@@ -49,6 +51,9 @@
 
 IMPLEMENT_CONOBJECT(GuiCanvas);
 
+U32 GuiCanvas::smRetainedPartialFrames = 0;
+U32 GuiCanvas::smRetainedFullFrames = 0;
+
 ConsoleDocClass( GuiCanvas,
 	"@brief A canvas on which rendering occurs.\n\n"
 
@@ -121,7 +126,9 @@ GuiCanvas::GuiCanvas(): GuiControl(),
                         mMiddleMouseLast(false),
                         mRightMouseLast(false),
                         mPlatformWindow(NULL),
-                        mLastRenderMs(0)
+                        mLastRenderMs(0),
+                        mDirtyRectRendering(false),
+                        mRetainedValid(false)
 {
    setBounds(0, 0, 640, 480);
    mAwake = true;
@@ -167,6 +174,16 @@ bool GuiCanvas::setProtectedNumFences( void *object, const char *index, const ch
    return false;
 }
 
+void GuiCanvas::consoleInit()
+{
+   Con::addVariable( "$GuiCanvas::retainedPartialFrames", TypeS32, &smRetainedPartialFrames,
+      "The number of dirty rectangle frames which repainted less than the whole canvas.\n"
+      "@internal" );
+   Con::addVariable( "$GuiCanvas::retainedFullFrames", TypeS32, &smRetainedFullFrames,
+      "The number of dirty rectangle frames which repainted the whole canvas.\n"
+      "@internal" );
+}
+
 void GuiCanvas::initPersistFields()
 {
    addGroup("Mouse Handling");
@@ -176,6 +193,10 @@ void GuiCanvas::initPersistFields()
 
    addGroup("Canvas Rendering");
    addProtectedField( "numFences", TypeS32, Offset( mNumFences, GuiCanvas ), &setProtectedNumFences, &defaultProtectedGetFn, "The number of GFX fences to use." );
+   addField( "dirtyRectRendering", TypeBool, Offset( mDirtyRectRendering, GuiCanvas ),
+      "If true the canvas keeps the rendered controls in an offscreen texture and only repaints "
+      "the regions controls mark dirty with setUpdate().  Controls that animate without calling "
+      "setUpdate() will not refresh while this is on." );
    endGroup("Canvas Rendering");
 
    Parent::initPersistFields();
@@ -249,6 +270,8 @@ bool GuiCanvas::onAdd()
    // Set up the fences
    setupFences();
 
+   GFXTextureManager::addEventDelegate( this, &GuiCanvas::_onTextureEvent );
+
    // Make sure we're able to render.
    newDevice->setAllowRender( true );
 
@@ -280,6 +303,8 @@ void GuiCanvas::onRemove()
    // And the process list
    Process::remove(this, &GuiCanvas::paint);
 
+   GFXTextureManager::removeEventDelegate( this, &GuiCanvas::_onTextureEvent );
+
    // Destroy the menu bar for this canvas (if any)
    Con::executef(this, "onDestroyMenu");
 
@@ -1498,7 +1523,10 @@ void GuiCanvas::mouseUnlock(GuiControl *lockingControl)
 
 void GuiCanvas::paint()
 {
-   resetUpdateRegions();
+   // In dirty rectangle mode only the regions controls marked with
+   // setUpdate() are repainted.
+   if ( !mDirtyRectRendering )
+      resetUpdateRegions();
 
    // inhibit explicit refreshes in the case we're swapped out
    if( mPlatformWindow && mPlatformWindow->isVisible() && GFX->allowRender())
@@ -1517,7 +1545,8 @@ void GuiCanvas::repaint(U32 elapsedMS)
       return;
 
    // Do the render.
-   resetUpdateRegions();
+   if ( !mDirtyRectRendering )
+      resetUpdateRegions();
    handlePaintEvent(mPlatformWindow->getWindowId());
 }
 
@@ -1651,9 +1680,14 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
       }
    }
 
+   // Dirty rectangles need the retained texture; screenshot tiling
+   // changes the view per tile so it always takes the full path.
+   const bool retained = mDirtyRectRendering && !( gScreenShot && gScreenShot->isPending() );
+
    // for now, just always reset the update regions - this is a
    // fix for FSAA on ATI cards
-   resetUpdateRegions();
+   if ( !retained )
+      resetUpdateRegions();
 
    PROFILE_START(CanvasRenderControls);
 
@@ -1670,7 +1704,9 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
    if(!mouseCursor)
       mouseCursor = mDefaultCursor;
 
-   if(mLastCursorEnabled && mLastCursor)
+   // The cursor is drawn over the retained texture, so it never
+   // dirties the controls underneath.
+   if(!retained && mLastCursorEnabled && mLastCursor)
    {
       Point2I spot = mLastCursor->getHotSpot();
       Point2I cext = mLastCursor->getExtent();
@@ -1678,7 +1714,7 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
       addUpdateRegion(pos - Point2I(2, 2), Point2I(cext.x + 4, cext.y + 4));
    }
 
-   if(cursorVisible && mouseCursor)
+   if(!retained && cursorVisible && mouseCursor)
    {
       Point2I spot = mouseCursor->getHotSpot();
       Point2I cext = mouseCursor->getExtent();
@@ -1714,7 +1750,8 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
    GFX->setViewport( screenRect );
    GFX->clear( GFXClearZBuffer | GFXClearStencil | GFXClearTarget, gCanvasClearColor, 1.0f, 0 );
 
-   resetUpdateRegions();
+   if ( !retained )
+      resetUpdateRegions();
 
 	// Make sure we have a clean matrix state 
    // before we start rendering anything!   
@@ -1728,25 +1765,32 @@ void GuiCanvas::renderFrame(bool preRenderOnly, bool bufferSwap /* = true */)
       gScreenShot->tileGui( size );
 
    RectI updateUnion;
-   buildUpdateUnion(&updateUnion);
-   if (updateUnion.intersect(screenRect))
+   bool renderToRetained = false;
+   if ( retained )
+      renderToRetained = _beginRetainedFrame( size, updateUnion );
+   else
+      buildUpdateUnion(&updateUnion);
+
+   const bool renderControls = updateUnion.intersect(screenRect);
+   if ( renderControls && renderToRetained && updateUnion != screenRect )
    {
-      // Render active GUI Dialogs
-      for(iterator i = begin(); i != end(); i++)
-      {
-         // Get the control
-         GuiControl *contentCtrl = static_cast<GuiControl*>(*i);
-         
-         GFX->setClipRect( updateUnion );
-         GFX->setStateBlock(mDefaultGuiSB);
-         
-         contentCtrl->onRender(contentCtrl->getPosition(), updateUnion);
-      }
+      // Only the dirty part of the retained texture is repainted.
+      PROFILE_SCOPE( GuiCanvas_RetainedPartialFrame );
+      _renderControls( updateUnion );
+   }
+   else if ( renderControls )
+      _renderControls( updateUnion );
 
-      // Fill Black if no Dialogs
-      if(this->size() == 0)
-         GFX->clear( GFXClearTarget, ColorI(0,0,0,0), 1.0f, 0 );
+   // Tooltips and the cursor go on top of the retained texture
+   // every frame.
+   if ( renderToRetained )
+   {
+      _endRetainedFrame( screenRect );
+      updateUnion = screenRect;
+   }
 
+   if ( renderControls || retained )
+   {
       // Tooltip resource
       if(bool(mMouseControl))
       {
@@ -1926,6 +1970,134 @@ void GuiCanvas::resetUpdateRegions()
    mCurUpdateRect = mOldUpdateRects[0];
 }
 
+bool GuiCanvas::_beginRetainedFrame( const Point2I &size, RectI &outUpdateUnion )
+{
+   const RectI screenRect( 0, 0, size.x, size.y );
+
+   RectI dirty = mCurUpdateRect;
+   mCurUpdateRect.point.set(0,0);
+   mCurUpdateRect.extent.set(0,0);
+
+   // If everything is dirty anyway (a full screen 3D view, for one)
+   // the copy would be pure overhead, so paint the back buffer directly.
+   if ( dirty.intersect( screenRect ) && dirty == screenRect )
+   {
+      smRetainedFullFrames++;
+      mRetainedValid = false;
+      outUpdateUnion = screenRect;
+      return false;
+   }
+
+   if (  mRetainedTex.isNull() ||
+         mRetainedTex.getWidth() != size.x ||
+         mRetainedTex.getHeight() != size.y )
+   {
+      mRetainedTex.set( size.x, size.y, GFXFormatR8G8B8A8, &GFXDefaultRenderTargetProfile,
+                        avar( "%s() - mRetainedTex (line %d)", __FUNCTION__, __LINE__ ) );
+      mRetainedValid = false;
+   }
+
+   if ( mRetainedTarget.isNull() )
+      mRetainedTarget = GFX->allocRenderToTextureTarget();
+
+   if ( mRetainedBlitSB.isNull() )
+   {
+      GFXStateBlockDesc desc;
+      desc.setCullMode( GFXCullNone );
+      desc.setZReadWrite( false );
+      desc.setBlend( false );
+      desc.samplersDefined = true;
+      desc.samplers[0] = GFXSamplerStateDesc::getClampPoint();
+      mRetainedBlitSB = GFX->createStateBlock( desc );
+   }
+
+   if ( mRetainedValid )
+   {
+      smRetainedPartialFrames++;
+      outUpdateUnion = dirty;
+   }
+   else
+   {
+      smRetainedFullFrames++;
+      outUpdateUnion = screenRect;
+   }
+
+   GFX->pushActiveRenderTarget();
+   mRetainedTarget->attachTexture( GFXTextureTarget::Color0, mRetainedTex );
+   mRetainedTarget->attachTexture( GFXTextureTarget::DepthStencil, GFXTextureTarget::sDefaultDepthStencil );
+   GFX->setActiveRenderTarget( mRetainedTarget );
+
+   // Only the repainted area loses its old contents.
+   if ( outUpdateUnion.isValidRect() )
+   {
+      GFX->setViewport( outUpdateUnion );
+      GFX->clear( GFXClearZBuffer | GFXClearStencil | GFXClearTarget, gCanvasClearColor, 1.0f, 0 );
+   }
+
+   return true;
+}
+
+void GuiCanvas::_renderControls( const RectI &updateUnion )
+{
+   // Render active GUI Dialogs
+   for(iterator i = begin(); i != end(); i++)
+   {
+      // Get the control
+      GuiControl *contentCtrl = static_cast<GuiControl*>(*i);
+      
+      GFX->setClipRect( updateUnion );
+      GFX->setStateBlock(mDefaultGuiSB);
+      
+      contentCtrl->onRender(contentCtrl->getPosition(), updateUnion);
+   }
+
+   // Fill Black if no Dialogs
+   if(this->size() == 0)
+      GFX->clear( GFXClearTarget, ColorI(0,0,0,0), 1.0f, 0 );
+}
+
+void GuiCanvas::_endRetainedFrame( const RectI &screenRect )
+{
+   mRetainedTarget->resolve();
+   GFX->popActiveRenderTarget();
+
+   mRetainedValid = true;
+
+   GFX->setClipRect( screenRect );
+   GFX->setStateBlock( mRetainedBlitSB );
+   GFX->setTexture( 0, mRetainedTex );
+
+   const F32 fillConv = GFX->getFillConventionOffset();
+   const F32 left = screenRect.point.x - fillConv;
+   const F32 top = screenRect.point.y - fillConv;
+   const F32 right = screenRect.point.x + screenRect.extent.x - fillConv;
+   const F32 bottom = screenRect.point.y + screenRect.extent.y - fillConv;
+
+   PrimBuild::begin( GFXTriangleStrip, 4 );
+      PrimBuild::colorWhite();
+      PrimBuild::texCoord2f( 0.0f, 0.0f );
+      PrimBuild::vertex2f( left, top );
+      PrimBuild::texCoord2f( 1.0f, 0.0f );
+      PrimBuild::vertex2f( right, top );
+      PrimBuild::texCoord2f( 0.0f, 1.0f );
+      PrimBuild::vertex2f( left, bottom );
+      PrimBuild::texCoord2f( 1.0f, 1.0f );
+      PrimBuild::vertex2f( right, bottom );
+   PrimBuild::end();
+
+   GFX->setStateBlock( mDefaultGuiSB );
+}
+
+void GuiCanvas::_onTextureEvent( GFXTexCallbackCode code )
+{
+   // Render targets lose their contents on a device reset.
+   if ( code == GFXZombify )
+   {
+      mRetainedTex = NULL;
+      mRetainedValid = false;
+   }
+}
+
 void GuiCanvas::setFirstResponder( GuiControl* newResponder )
 {
 	GuiControl* oldResponder = mFirstResponder;
@@ -36,6 +36,8 @@
 #include "component/interfaces/IProcessInput.h"
 #include "windowManager/platformWindowMgr.h"
 #include "gfx/gfxFence.h"
+#include "gfx/gfxTextureHandle.h"
+#include "gfx/gfxTarget.h"
 
 #ifdef TORQUE_DEMO_PURCHASE
 #ifndef _PURCHASESCREEN_H_
@@ -91,6 +93,23 @@ protected:
    RectI      mOldUpdateRects[2];
    RectI      mCurUpdateRect;
    U32        mLastRenderMs;
+
+   /// If set the controls are painted into mRetainedTex and only the dirty
+   /// regions are repainted each frame.  The texture is then copied to the
+   /// back buffer and the tooltip and cursor drawn over it.
+   bool       mDirtyRectRendering;
+
+   GFXTexHandle         mRetainedTex;
+   GFXTextureTargetRef  mRetainedTarget;
+   GFXStateBlockRef     mRetainedBlitSB;
+
+   /// False if mRetainedTex does not hold the last rendered frame.
+   bool       mRetainedValid;
+
+   /// Dirty rectangle frames that repainted only part of the canvas and
+   /// those that repainted all of it.
+   static U32 smRetainedPartialFrames;
+   static U32 smRetainedFullFrames;
    /// @}
 
    /// @name Cursor Properties
@@ -188,6 +207,20 @@ protected:
    
    void checkLockMouseMove( const GuiEvent& event );
 
+   /// Sets up a dirty rectangle frame.  Returns false if the whole screen is
+   /// dirty, in which case the controls are painted straight to the back
+   /// buffer, otherwise makes mRetainedTex the active target and returns
+   /// the area to repaint.
+   bool _beginRetainedFrame( const Point2I &size, RectI &outUpdateUnion );
+
+   /// Resolves mRetainedTex and copies it to the back buffer.
+   void _endRetainedFrame( const RectI &screenRect );
+
+   /// Renders the dialogs clipped to @a updateUnion.
+   void _renderControls( const RectI &updateUnion );
+
+   void _onTextureEvent( GFXTexCallbackCode code );
+
 public:
    DECLARE_CONOBJECT(GuiCanvas);
    DECLARE_CATEGORY( "Gui Core" );
@@ -198,6 +231,7 @@ public:
    virtual bool onAdd();
    virtual void onRemove();
 
+   static void consoleInit();
    static void initPersistFields();
 
    /// @name Rendering methods
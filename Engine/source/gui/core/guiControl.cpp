@@ -583,6 +583,11 @@ void GuiControl::renderChildControls(Point2I offset, const RectI &updateRect)
 void GuiControl::setUpdateRegion(Point2I pos, Point2I ext)
 {
    Point2I upos = localToGlobalCoord(pos);
+
+   // Let ancestors that cache their rendering know they are stale.
+   for ( GuiControl *parent = getParent(); parent; parent = parent->getParent() )
+      parent->onChildUpdate( this );
+
    GuiCanvas *root = getRoot();
    if (root)
    {
@@ -1247,7 +1252,13 @@ bool GuiControl::resize(const Point2I &newPosition, const Point2I &newExtent)
 
    // Update Position
    if ( positionChanged )
+   {
+      // Dirty the area we leave as well as the one we move to so the
+      // canvas' dirty rectangle mode doesn't leave a trail.
+      setUpdate();
       mBounds.point = newPosition;
+      setUpdate();
+   }
 
    // Update Extent
    if( extentChanged )
@@ -532,6 +532,10 @@ class GuiControl : public SimGroup
       
       /// Called when this object has a new child
       virtual void onChildAdded( GuiControl *child );
+
+      /// Called on every ancestor of a control that marks part of itself
+      /// dirty through setUpdateRegion
+      virtual void onChildUpdate( GuiControl *child ) {}
       
       /// @}
       
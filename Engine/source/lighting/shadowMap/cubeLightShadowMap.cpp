@@ -83,6 +83,53 @@ void CubeLightShadowMap::releaseTextures()
    mCubemap = NULL;
 }
 
+MatrixF CubeLightShadowMap::_calcFaceMatrix( U32 face ) const
+{
+   // Standard view that will be overridden below.
+   VectorF vLookatPt(0.0f, 0.0f, 0.0f), vUpVec(0.0f, 0.0f, 0.0f), vRight(0.0f, 0.0f, 0.0f);
+
+   switch( face )
+   {
+   case 0 : // D3DCUBEMAP_FACE_POSITIVE_X:
+      vLookatPt = VectorF(1.0f, 0.0f, 0.0f);
+      vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
+      break;
+   case 1 : // D3DCUBEMAP_FACE_NEGATIVE_X:
+      vLookatPt = VectorF(-1.0f, 0.0f, 0.0f);
+      vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
+      break;
+   case 2 : // D3DCUBEMAP_FACE_POSITIVE_Y:
+      vLookatPt = VectorF(0.0f, 1.0f, 0.0f);
+      vUpVec    = VectorF(0.0f, 0.0f,-1.0f);
+      break;
+   case 3 : // D3DCUBEMAP_FACE_NEGATIVE_Y:
+      vLookatPt = VectorF(0.0f, -1.0f, 0.0f);
+      vUpVec    = VectorF(0.0f, 0.0f, 1.0f);
+      break;
+   case 4 : // D3DCUBEMAP_FACE_POSITIVE_Z:
+      vLookatPt = VectorF(0.0f, 0.0f, 1.0f);
+      vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
+      break;
+   case 5: // D3DCUBEMAP_FACE_NEGATIVE_Z:
+      vLookatPt = VectorF(0.0f, 0.0f, -1.0f);
+      vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
+      break;
+   }
+
+   // create camera matrix
+   VectorF cross = mCross(vUpVec, vLookatPt);
+   cross.normalizeSafe();
+
+   MatrixF lightMatrix(true);
+   lightMatrix.setColumn(0, cross);
+   lightMatrix.setColumn(1, vLookatPt);
+   lightMatrix.setColumn(2, vUpVec);
+   lightMatrix.setPosition( mLight->getPosition() );
+   lightMatrix.inverse();
+
+   return lightMatrix;
+}
+
 void CubeLightShadowMap::_render(   RenderPassManager* renderPass,
                                     const SceneRenderState *diffuseState )
 {
@@ -121,51 +168,9 @@ void CubeLightShadowMap::_render(   RenderPassManager* renderPass,
 
    for( U32 i = 0; i < 6; i++ )
    {
-      // Standard view that will be overridden below.
-      VectorF vLookatPt(0.0f, 0.0f, 0.0f), vUpVec(0.0f, 0.0f, 0.0f), vRight(0.0f, 0.0f, 0.0f);
-
-      switch( i )
-      {
-      case 0 : // D3DCUBEMAP_FACE_POSITIVE_X:
-         vLookatPt = VectorF(1.0f, 0.0f, 0.0f);
-         vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
-         break;
-      case 1 : // D3DCUBEMAP_FACE_NEGATIVE_X:
-         vLookatPt = VectorF(-1.0f, 0.0f, 0.0f);
-         vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
-         break;
-      case 2 : // D3DCUBEMAP_FACE_POSITIVE_Y:
-         vLookatPt = VectorF(0.0f, 1.0f, 0.0f);
-         vUpVec    = VectorF(0.0f, 0.0f,-1.0f);
-         break;
-      case 3 : // D3DCUBEMAP_FACE_NEGATIVE_Y:
-         vLookatPt = VectorF(0.0f, -1.0f, 0.0f);
-         vUpVec    = VectorF(0.0f, 0.0f, 1.0f);
-         break;
-      case 4 : // D3DCUBEMAP_FACE_POSITIVE_Z:
-         vLookatPt = VectorF(0.0f, 0.0f, 1.0f);
-         vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
-         break;
-      case 5: // D3DCUBEMAP_FACE_NEGATIVE_Z:
-         vLookatPt = VectorF(0.0f, 0.0f, -1.0f);
-         vUpVec    = VectorF(0.0f, 1.0f, 0.0f);
-         break;
-      }
-
       GFXDEBUGEVENT_START( CubeLightShadowMap_Render_Face, ColorI::RED );
 
-      // create camera matrix
-      VectorF cross = mCross(vUpVec, vLookatPt);
-      cross.normalizeSafe();
-
-      MatrixF lightMatrix(true);
-      lightMatrix.setColumn(0, cross);
-      lightMatrix.setColumn(1, vLookatPt);
-      lightMatrix.setColumn(2, vUpVec);
-      lightMatrix.setPosition( mLight->getPosition() );
-      lightMatrix.inverse();
-
-      GFX->setWorldMatrix( lightMatrix );
+      GFX->setWorldMatrix( _calcFaceMatrix( i ) );
 
       mTarget->attachTexture(GFXTextureTarget::Color0, mCubemap, i);
       mTarget->attachTexture(GFXTextureTarget::DepthStencil, _getDepthTarget( mTexSize, mTexSize ));
@@ -200,3 +205,25 @@ void CubeLightShadowMap::_render(   RenderPassManager* renderPass,
    }
    GFX->popActiveRenderTarget();
 }
+
+void CubeLightShadowMap::queueCulls( const SceneRenderState *diffuseState )
+{
+   // Same view setup as in _render().
+   GFXFrustumSaver fsaver;
+   GFXTransformSaver saver;
+   {
+      F32 left, right, top, bottom;
+      MathUtils::makeFrustum( &left, &right, &top, &bottom, M_HALFPI_F, 1.0f, 0.1f );
+      GFX->setFrustum( left, right, bottom, top, 0.1f, mLight->getRange().x );
+   }
+
+   SceneManager* sceneManager = diffuseState->getSceneManager();
+
+   for( U32 i = 0; i < 6; i++ )
+   {
+      GFX->setWorldMatrix( _calcFaceMatrix( i ) );
+
+      const SceneCameraState cameraState = SceneCameraState::fromGFXWithViewport( diffuseState->getViewport() );
+      sceneManager->queueCull( cameraState.getFrustum(), SHADOW_TYPEMASK );
+   }
+}
@@ -43,12 +43,16 @@ public:
    virtual bool hasShadowTex() const { return mCubemap.isValid(); }
    virtual ShadowType getShadowType() const { return ShadowType_CubeMap; }
    virtual void _render( RenderPassManager* renderPass, const SceneRenderState *diffuseState );
+   virtual void queueCulls( const SceneRenderState *diffuseState );
    virtual void setShaderParameters( GFXShaderConstBuffer* params, LightingShaderConstants* lsc );
    virtual void releaseTextures();
    virtual bool setTextureStage( U32 currTexFlag, LightingShaderConstants* lsc );
 
 protected:   
 
+   /// Return the world to light view matrix for the given cubemap face.
+   MatrixF _calcFaceMatrix( U32 face ) const;
+
    /// The shadow cubemap.
    GFXCubemapHandle mCubemap;
 
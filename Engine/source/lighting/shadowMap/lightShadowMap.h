@@ -149,6 +149,12 @@ public:
    void render(   RenderPassManager* renderPass,
                   const SceneRenderState *diffuseState );
 
+   /// Queue the culls for the views that render() will draw with
+   /// the scene manager so they can run ahead on the thread pool.
+   /// Views that are not queued are culled when they render.
+   /// @see SceneManager::queueCull
+   virtual void queueCulls( const SceneRenderState *diffuseState ) {}
+
    U32 getLastUpdate() const { return mLastUpdate; }
 
    //U32 getLastVisible() const { return mLastVisible; }
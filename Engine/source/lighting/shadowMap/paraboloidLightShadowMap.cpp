@@ -138,4 +138,21 @@ void ParaboloidLightShadowMap::_render(   RenderPassManager* renderPass,
  
    mTarget->resolve();
    GFX->popActiveRenderTarget();   
+}
+
+void ParaboloidLightShadowMap::queueCulls( const SceneRenderState *diffuseState )
+{
+   GFXFrustumSaver frustSaver;
+   GFXTransformSaver saver;
+
+   // Same view setup as in _render().
+   MatrixF worldToLight = mLight->getTransform();
+   worldToLight.inverse();
+   GFX->setWorldMatrix(worldToLight);
+
+   const F32 &lightRadius = mLight->getRange().x;
+   GFX->setOrtho(-lightRadius, lightRadius, -lightRadius, lightRadius, 1.0f, lightRadius, true);
+
+   const SceneCameraState cameraState = SceneCameraState::fromGFXWithViewport( diffuseState->getViewport() );
+   diffuseState->getSceneManager()->queueCull( cameraState.getFrustum(), SHADOW_TYPEMASK );
 }
\ No newline at end of file
@@ -38,6 +38,7 @@ public:
    // LightShadowMap
    virtual ShadowType getShadowType() const;
    virtual void _render( RenderPassManager* renderPass, const SceneRenderState *diffuseState );
+   virtual void queueCulls( const SceneRenderState *diffuseState );
    virtual void setShaderParameters(GFXShaderConstBuffer* params, LightingShaderConstants* lsc);
 
 protected:
@@ -39,6 +39,7 @@ public:
    // LightShadowMap
    virtual ShadowType getShadowType() const { return ShadowType_PSSM; }
    virtual void _render( RenderPassManager* renderPass, const SceneRenderState *diffuseState );
+   virtual void queueCulls( const SceneRenderState *diffuseState );
    virtual void setShaderParameters(GFXShaderConstBuffer* params, LightingShaderConstants* lsc);
 
    /// Used to scale TSShapeInstance::smDetailAdjust to have
@@ -58,6 +59,17 @@ protected:
    Box3F _calcClipSpaceAABB(const Frustum& f, const MatrixF& transform, F32 farDist);
    void _roundProjection(const MatrixF& lightMat, const MatrixF& cropMatrix, Point3F &offset, U32 splitNum);
 
+   /// Set up the GFX state for the light's view and return the values
+   /// the split views are derived from.
+   void _calcLightView( const SceneRenderState *diffuseState, Frustum *outFullFrustum, MatrixF *outLightMatrix, MatrixF *outLightViewProj, F32 *outNear, F32 *outFar );
+
+   /// Set up the GFX projection for the given split and return the
+   /// frustum of its view.
+   void _calcSplitView( U32 split, const Frustum &fullFrustum, const MatrixF &lightMatrix, const MatrixF &lightViewProj, F32 pnear, F32 pfar, Frustum *outFrustum );
+
+   /// Return the object types rendered into the given split.
+   U32 _getSplitObjectMask( U32 split ) const;
+
    static const int MAX_SPLITS = 4;
    U32 mNumSplits;
    F32 mSplitDist[MAX_SPLITS+1];   // +1 because we store a cap
@@ -125,6 +125,10 @@ void ShadowMapPass::render(   SceneManager *sceneManager,
 {
    PROFILE_SCOPE( ShadowMapPass_Render );
 
+   // The number of maps updated last frame tells us
+   // roughly how many will fit into the budget.
+   const U32 lastUpdatedShadowMaps = smUpdatedShadowMaps;
+
    // Prep some shadow rendering stats.
    smActiveShadowMaps = 0;
    smUpdatedShadowMaps = 0;
@@ -178,6 +182,19 @@ void ShadowMapPass::render(   SceneManager *sceneManager,
 
    GFXDEBUGEVENT_SCOPE( ShadowMapPass_Render, ColorI::RED );
 
+   // Gather the objects for all the shadow maps we expect to
+   // update in one go on the thread pool.  Maps that end up
+   // rendering without a queued cull just cull inline.
+   {
+      PROFILE_SCOPE( ShadowMapPass_Render_QueueCulls );
+
+      const U32 numToCull = getMin( (U32)shadowMaps.size(), lastUpdatedShadowMaps + 1 );
+      for ( U32 i = 0; i < numToCull; i++ )
+         shadowMaps[i]->queueCulls( diffuseState );
+
+      sceneManager->runQueuedCulls();
+   }
+
    // Use a timer for tracking our shadow rendering 
    // budget to ensure a high precision results.
    mTimer->getElapsedMs();
@@ -210,6 +227,8 @@ void ShadowMapPass::render(   SceneManager *sceneManager,
          break;
    }
 
+   sceneManager->clearQueuedCulls();
+
    // Cleanup old unused textures.
    LightShadowMap::releaseUnusedTextures();
 
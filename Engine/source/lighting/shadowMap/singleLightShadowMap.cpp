@@ -106,6 +106,21 @@ void SingleLightShadowMap::_render( RenderPassManager* renderPass,
    GFX->popActiveRenderTarget();
 }
 
+void SingleLightShadowMap::queueCulls( const SceneRenderState *diffuseState )
+{
+   GFXFrustumSaver frustSaver;
+   GFXTransformSaver saver;
+
+   // Same view setup as in _render().
+   MatrixF lightMatrix;
+   calcLightMatrices( lightMatrix, diffuseState->getCameraFrustum() );
+   lightMatrix.inverse();
+   GFX->setWorldMatrix(lightMatrix);
+
+   const SceneCameraState cameraState = SceneCameraState::fromGFXWithViewport( diffuseState->getViewport() );
+   diffuseState->getSceneManager()->queueCull( cameraState.getFrustum(), SHADOW_TYPEMASK );
+}
+
 void SingleLightShadowMap::setShaderParameters(GFXShaderConstBuffer* params, LightingShaderConstants* lsc)
 {
    if ( lsc->mTapRotationTexSC->isValid() )
@@ -39,6 +39,7 @@ public:
    // LightShadowMap
    virtual ShadowType getShadowType() const { return ShadowType_Spot; }
    virtual void _render( RenderPassManager* renderPass, const SceneRenderState *diffuseState );
+   virtual void queueCulls( const SceneRenderState *diffuseState );
    virtual void setShaderParameters(GFXShaderConstBuffer* params, LightingShaderConstants* lsc);
 };
 
@@ -1207,6 +1207,10 @@ void ProcessedShaderMaterial::setBuffers( GFXVertexBufferHandleBase *vertBuffer,
    // Set the instance vb for streaming.
    GFX->setVertexBuffer( instVB, 1, 1 );
 
+   GFXDeviceStatistics *stats = GFX->getDeviceStatistics();
+   stats->mInstancedDrawCalls++;
+   stats->mInstancesDrawn += instCount;
+
    // Finally set the vertex format which defines
    // both of the streams.
    GFX->setVertexFormat( mInstancingState->getDeclFormat() );
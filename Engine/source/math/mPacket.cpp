@@ -0,0 +1,209 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "math/mPacket.h"
+
+#include "math/mBox.h"
+#include "math/mPlane.h"
+#include "core/module.h"
+
+
+U32 (*m_lineF_x_boxPacketF)( const Point3F& start, const Point3F& end, const BoxPacketF& boxes, U32 count, F32* outT ) = NULL;
+OverlapTestResult (*m_boxF_x_planePacketF)( const Box3F& box, const PlanePacketF& planes, U32 count ) = NULL;
+U32 (*m_boxPacketF_x_planesF)( const BoxPacketF& boxes, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults ) = NULL;
+U32 (*m_spherePacketF_x_planesF)( const SpherePacketF& spheres, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults ) = NULL;
+
+#if defined(TORQUE_CPU_X86)
+extern U32 m_lineF_x_boxPacketF_SSE( const Point3F& start, const Point3F& end, const BoxPacketF& boxes, U32 count, F32* outT );
+extern OverlapTestResult m_boxF_x_planePacketF_SSE( const Box3F& box, const PlanePacketF& planes, U32 count );
+extern U32 m_boxPacketF_x_planesF_SSE( const BoxPacketF& boxes, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults );
+extern U32 m_spherePacketF_x_planesF_SSE( const SpherePacketF& spheres, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults );
+#endif
+
+//------------------------------------------------------------------------------
+// C++ Implementations
+//------------------------------------------------------------------------------
+
+U32 m_lineF_x_boxPacketF_C( const Point3F& start, const Point3F& end, const BoxPacketF& boxes, U32 count, F32* outT )
+{
+   AssertFatal( count % 4 == 0, "m_lineF_x_boxPacketF - Count must be a multiple of four" );
+
+   // Keep the reciprocals finite so that a segment parallel to an
+   // axis never multiplies zero by infinity.
+   Point3F dir = end - start;
+   const F32 invX = 1.0f / ( dir.x >= 0.0f ? getMax( dir.x, 1.0e-20f ) : getMin( dir.x, -1.0e-20f ) );
+   const F32 invY = 1.0f / ( dir.y >= 0.0f ? getMax( dir.y, 1.0e-20f ) : getMin( dir.y, -1.0e-20f ) );
+   const F32 invZ = 1.0f / ( dir.z >= 0.0f ? getMax( dir.z, 1.0e-20f ) : getMin( dir.z, -1.0e-20f ) );
+
+   U32 numHits = 0;
+   for ( U32 i = 0; i < count; i++ )
+   {
+      const F32 x0 = ( boxes.minX[ i ] - start.x ) * invX;
+      const F32 x1 = ( boxes.maxX[ i ] - start.x ) * invX;
+      const F32 y0 = ( boxes.minY[ i ] - start.y ) * invY;
+      const F32 y1 = ( boxes.maxY[ i ] - start.y ) * invY;
+      const F32 z0 = ( boxes.minZ[ i ] - start.z ) * invZ;
+      const F32 z1 = ( boxes.maxZ[ i ] - start.z ) * invZ;
+
+      const F32 tNear = getMax( getMax( getMin( x0, x1 ), getMin( y0, y1 ) ), getMax( getMin( z0, z1 ), 0.0f ) );
+      const F32 tFar = getMin( getMin( getMax( x0, x1 ), getMax( y0, y1 ) ), getMin( getMax( z0, z1 ), 1.0f ) );
+
+      if ( tNear <= tFar )
+      {
+         outT[ i ] = tNear;
+         numHits++;
+      }
+      else
+         outT[ i ] = F32_MAX;
+   }
+
+   return numHits;
+}
+
+//------------------------------------------------------------------------------
+
+OverlapTestResult m_boxF_x_planePacketF_C( const Box3F& box, const PlanePacketF& planes, U32 count )
+{
+   AssertFatal( count % 4 == 0, "m_boxF_x_planePacketF - Count must be a multiple of four" );
+
+   bool allInside = true;
+
+   for ( U32 i = 0; i < count; i++ )
+   {
+      const F32 x = planes.x[ i ];
+      const F32 y = planes.y[ i ];
+      const F32 z = planes.z[ i ];
+
+      // Distance of the corner furthest along the normal.
+      const F32 pDist = ( x * ( x > 0.0f ? box.maxExtents.x : box.minExtents.x ) +
+                          y * ( y > 0.0f ? box.maxExtents.y : box.minExtents.y ) +
+                          z * ( z > 0.0f ? box.maxExtents.z : box.minExtents.z ) ) + planes.d[ i ];
+      if ( pDist <= -0.005f )
+         return GeometryOutside;
+
+      // Distance of the corner furthest against the normal.
+      const F32 nDist = ( x * ( x > 0.0f ? box.minExtents.x : box.maxExtents.x ) +
+                          y * ( y > 0.0f ? box.minExtents.y : box.maxExtents.y ) +
+                          z * ( z > 0.0f ? box.minExtents.z : box.maxExtents.z ) ) + planes.d[ i ];
+      if ( nDist < 0.005f )
+         allInside = false;
+   }
+
+   return allInside ? GeometryInside : GeometryIntersecting;
+}
+
+//------------------------------------------------------------------------------
+
+U32 m_boxPacketF_x_planesF_C( const BoxPacketF& boxes, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults )
+{
+   AssertFatal( count % 4 == 0, "m_boxPacketF_x_planesF - Count must be a multiple of four" );
+
+   U32 numVisible = 0;
+   for ( U32 i = 0; i < count; i++ )
+   {
+      const Box3F box( boxes.minX[ i ], boxes.minY[ i ], boxes.minZ[ i ],
+                       boxes.maxX[ i ], boxes.maxY[ i ], boxes.maxZ[ i ] );
+
+      S8 result = GeometryInside;
+      for ( U32 n = 0; n < numPlanes; n++ )
+      {
+         const PlaneF::Side side = planes[ n ].whichSide( box );
+         if ( side == PlaneF::Back )
+         {
+            result = GeometryOutside;
+            break;
+         }
+
+         if ( side != PlaneF::Front )
+            result = GeometryIntersecting;
+      }
+
+      outResults[ i ] = result;
+      if ( result != GeometryOutside )
+         numVisible++;
+   }
+
+   return numVisible;
+}
+
+//------------------------------------------------------------------------------
+
+U32 m_spherePacketF_x_planesF_C( const SpherePacketF& spheres, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults )
+{
+   AssertFatal( count % 4 == 0, "m_spherePacketF_x_planesF - Count must be a multiple of four" );
+
+   U32 numVisible = 0;
+   for ( U32 i = 0; i < count; i++ )
+   {
+      const Point3F center( spheres.x[ i ], spheres.y[ i ], spheres.z[ i ] );
+      const F32 radius = spheres.radius[ i ];
+
+      S8 result = GeometryInside;
+      for ( U32 n = 0; n < numPlanes; n++ )
+      {
+         const F32 dist = planes[ n ].distToPlane( center );
+         if ( dist < -radius )
+         {
+            result = GeometryOutside;
+            break;
+         }
+
+         if ( dist <= radius )
+            result = GeometryIntersecting;
+      }
+
+      outResults[ i ] = result;
+      if ( result != GeometryOutside )
+         numVisible++;
+   }
+
+   return numVisible;
+}
+
+//------------------------------------------------------------------------------
+// Initializer.
+//------------------------------------------------------------------------------
+
+MODULE_BEGIN( MathPacket )
+
+   MODULE_INIT
+   {
+      // Assign defaults (C++ versions)
+      m_lineF_x_boxPacketF = m_lineF_x_boxPacketF_C;
+      m_boxF_x_planePacketF = m_boxF_x_planePacketF_C;
+      m_boxPacketF_x_planesF = m_boxPacketF_x_planesF_C;
+      m_spherePacketF_x_planesF = m_spherePacketF_x_planesF_C;
+
+      // Find the best implementation for the current CPU
+      if ( Platform::SystemInfo.processor.properties & CPU_PROP_SSE )
+      {
+   #if defined(TORQUE_CPU_X86)
+         m_lineF_x_boxPacketF = m_lineF_x_boxPacketF_SSE;
+         m_boxF_x_planePacketF = m_boxF_x_planePacketF_SSE;
+         m_boxPacketF_x_planesF = m_boxPacketF_x_planesF_SSE;
+         m_spherePacketF_x_planesF = m_spherePacketF_x_planesF_SSE;
+   #endif
+      }
+   }
+
+MODULE_END;
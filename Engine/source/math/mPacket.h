@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _MPACKET_H_
+#define _MPACKET_H_
+
+#ifndef _MCONSTANTS_H_
+#include "math/mConstants.h"
+#endif
+
+class Point3F;
+class Box3F;
+class PlaneF;
+
+
+/// @name Packet Tests
+///
+/// Tests of one primitive against many others at once, for use by
+/// broadphase queries and culling.  The many side is passed in
+/// structure-of-arrays layout so that the SIMD implementations can
+/// test four primitives with every instruction.
+///
+/// The count passed to every packet function must be a multiple of four.
+/// Pad the arrays with primitives that never pass the test, such as
+/// boxes or spheres far away from anything.
+///
+/// The functions are installed at startup with the best implementation
+/// for the current CPU.
+///
+/// @{
+
+/// Axis aligned boxes in structure-of-arrays layout.
+struct BoxPacketF
+{
+   const F32* minX;
+   const F32* minY;
+   const F32* minZ;
+   const F32* maxX;
+   const F32* maxY;
+   const F32* maxZ;
+};
+
+/// Spheres in structure-of-arrays layout.
+struct SpherePacketF
+{
+   const F32* x;
+   const F32* y;
+   const F32* z;
+   const F32* radius;
+};
+
+/// Planes in structure-of-arrays layout.
+///
+/// Pad with the plane (0, 0, 0, 1), which has every point in front of it.
+struct PlanePacketF
+{
+   const F32* x;
+   const F32* y;
+   const F32* z;
+   const F32* d;
+};
+
+/// Collide the line segment from @a start to @a end with @a count boxes.
+///
+/// @param outT Receives, for each box, the fraction along the segment at
+///   which it enters the box, or a value greater than one if it misses.
+///   This is the same fraction that Box3F::collideLine() returns.
+/// @return Number of boxes hit.
+extern U32 (*m_lineF_x_boxPacketF)( const Point3F& start, const Point3F& end, const BoxPacketF& boxes, U32 count, F32* outT );
+
+/// Classify @a box against @a count planes as PlaneSetF::testPotentialIntersection()
+/// does.
+extern OverlapTestResult (*m_boxF_x_planePacketF)( const Box3F& box, const PlanePacketF& planes, U32 count );
+
+/// Classify @a count boxes against a set of planes as PlaneSetF::testPotentialIntersection()
+/// does.
+///
+/// @param outResults Receives an OverlapTestResult for each box.
+/// @return Number of boxes that are not GeometryOutside.
+extern U32 (*m_boxPacketF_x_planesF)( const BoxPacketF& boxes, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults );
+
+/// Classify @a count spheres against a set of planes as PlaneSetF::testPotentialIntersection()
+/// does.
+///
+/// @param outResults Receives an OverlapTestResult for each sphere.
+/// @return Number of spheres that are not GeometryOutside.
+extern U32 (*m_spherePacketF_x_planesF)( const SpherePacketF& spheres, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults );
+
+/// @}
+
+#endif // _MPACKET_H_
@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "math/mPacket.h"
+
+#if defined(TORQUE_CPU_X86)
+#include "math/mBox.h"
+#include "math/mPlane.h"
+#include <xmmintrin.h>
+
+/// Number of bits set in each four bit _mm_movemask_ps() result.
+static const U32 sLaneCount[ 16 ] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+/// Pick @a a in lanes where @a mask is set and @a b elsewhere.
+static inline __m128 _select( const __m128& mask, const __m128& a, const __m128& b )
+{
+   return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+
+//------------------------------------------------------------------------------
+
+U32 m_lineF_x_boxPacketF_SSE( const Point3F& start, const Point3F& end, const BoxPacketF& boxes, U32 count, F32* outT )
+{
+   AssertFatal( count % 4 == 0, "m_lineF_x_boxPacketF - Count must be a multiple of four" );
+
+   // Same reciprocals as the C version so the results match exactly.
+   Point3F dir = end - start;
+   const __m128 invX = _mm_set1_ps( 1.0f / ( dir.x >= 0.0f ? getMax( dir.x, 1.0e-20f ) : getMin( dir.x, -1.0e-20f ) ) );
+   const __m128 invY = _mm_set1_ps( 1.0f / ( dir.y >= 0.0f ? getMax( dir.y, 1.0e-20f ) : getMin( dir.y, -1.0e-20f ) ) );
+   const __m128 invZ = _mm_set1_ps( 1.0f / ( dir.z >= 0.0f ? getMax( dir.z, 1.0e-20f ) : getMin( dir.z, -1.0e-20f ) ) );
+
+   const __m128 startX = _mm_set1_ps( start.x );
+   const __m128 startY = _mm_set1_ps( start.y );
+   const __m128 startZ = _mm_set1_ps( start.z );
+
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one = _mm_set1_ps( 1.0f );
+   const __m128 miss = _mm_set1_ps( F32_MAX );
+
+   U32 numHits = 0;
+   for ( U32 i = 0; i < count; i += 4 )
+   {
+      const __m128 x0 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.minX + i ), startX ), invX );
+      const __m128 x1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.maxX + i ), startX ), invX );
+      const __m128 y0 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.minY + i ), startY ), invY );
+      const __m128 y1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.maxY + i ), startY ), invY );
+      const __m128 z0 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.minZ + i ), startZ ), invZ );
+      const __m128 z1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( boxes.maxZ + i ), startZ ), invZ );
+
+      const __m128 tNear = _mm_max_ps( _mm_max_ps( _mm_min_ps( x0, x1 ), _mm_min_ps( y0, y1 ) ),
+                                       _mm_max_ps( _mm_min_ps( z0, z1 ), zero ) );
+      const __m128 tFar = _mm_min_ps( _mm_min_ps( _mm_max_ps( x0, x1 ), _mm_max_ps( y0, y1 ) ),
+                                      _mm_min_ps( _mm_max_ps( z0, z1 ), one ) );
+
+      const __m128 hit = _mm_cmple_ps( tNear, tFar );
+      _mm_storeu_ps( outT + i, _select( hit, tNear, miss ) );
+      numHits += sLaneCount[ _mm_movemask_ps( hit ) ];
+   }
+
+   return numHits;
+}
+
+//------------------------------------------------------------------------------
+
+OverlapTestResult m_boxF_x_planePacketF_SSE( const Box3F& box, const PlanePacketF& planes, U32 count )
+{
+   AssertFatal( count % 4 == 0, "m_boxF_x_planePacketF - Count must be a multiple of four" );
+
+   const __m128 minX = _mm_set1_ps( box.minExtents.x );
+   const __m128 minY = _mm_set1_ps( box.minExtents.y );
+   const __m128 minZ = _mm_set1_ps( box.minExtents.z );
+   const __m128 maxX = _mm_set1_ps( box.maxExtents.x );
+   const __m128 maxY = _mm_set1_ps( box.maxExtents.y );
+   const __m128 maxZ = _mm_set1_ps( box.maxExtents.z );
+
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 backEpsilon = _mm_set1_ps( -0.005f );
+   const __m128 frontEpsilon = _mm_set1_ps( 0.005f );
+
+   __m128 allInside = _mm_cmpeq_ps( zero, zero );
+
+   for ( U32 i = 0; i < count; i += 4 )
+   {
+      const __m128 x = _mm_loadu_ps( planes.x + i );
+      const __m128 y = _mm_loadu_ps( planes.y + i );
+      const __m128 z = _mm_loadu_ps( planes.z + i );
+      const __m128 d = _mm_loadu_ps( planes.d + i );
+
+      const __m128 posX = _mm_cmpgt_ps( x, zero );
+      const __m128 posY = _mm_cmpgt_ps( y, zero );
+      const __m128 posZ = _mm_cmpgt_ps( z, zero );
+
+      // Distance of the corner furthest along the normal.
+      const __m128 pDist = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _select( posX, maxX, minX ) ),
+                                                               _mm_mul_ps( y, _select( posY, maxY, minY ) ) ),
+                                                   _mm_mul_ps( z, _select( posZ, maxZ, minZ ) ) ), d );
+      if ( _mm_movemask_ps( _mm_cmple_ps( pDist, backEpsilon ) ) )
+         return GeometryOutside;
+
+      // Distance of the corner furthest against the normal.
+      const __m128 nDist = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _select( posX, minX, maxX ) ),
+                                                               _mm_mul_ps( y, _select( posY, minY, maxY ) ) ),
+                                                   _mm_mul_ps( z, _select( posZ, minZ, maxZ ) ) ), d );
+      allInside = _mm_and_ps( allInside, _mm_cmpge_ps( nDist, frontEpsilon ) );
+   }
+
+   return _mm_movemask_ps( allInside ) == 0xF ? GeometryInside : GeometryIntersecting;
+}
+
+//------------------------------------------------------------------------------
+
+/// Turn the outside and inside lane masks of four primitives into
+/// OverlapTestResults.
+static inline void _storeResults( const __m128& outside, const __m128& inside, S8* outResults )
+{
+   const U32 outsideBits = _mm_movemask_ps( outside );
+   const U32 insideBits = _mm_movemask_ps( inside );
+
+   for ( U32 j = 0; j < 4; j++ )
+   {
+      if ( outsideBits & ( 1 << j ) )
+         outResults[ j ] = GeometryOutside;
+      else if ( insideBits & ( 1 << j ) )
+         outResults[ j ] = GeometryInside;
+      else
+         outResults[ j ] = GeometryIntersecting;
+   }
+}
+
+//------------------------------------------------------------------------------
+
+U32 m_boxPacketF_x_planesF_SSE( const BoxPacketF& boxes, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults )
+{
+   AssertFatal( count % 4 == 0, "m_boxPacketF_x_planesF - Count must be a multiple of four" );
+
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 allSet = _mm_cmpeq_ps( zero, zero );
+   const __m128 backEpsilon = _mm_set1_ps( -0.005f );
+   const __m128 frontEpsilon = _mm_set1_ps( 0.005f );
+
+   U32 numVisible = 0;
+   for ( U32 i = 0; i < count; i += 4 )
+   {
+      const __m128 minX = _mm_loadu_ps( boxes.minX + i );
+      const __m128 minY = _mm_loadu_ps( boxes.minY + i );
+      const __m128 minZ = _mm_loadu_ps( boxes.minZ + i );
+      const __m128 maxX = _mm_loadu_ps( boxes.maxX + i );
+      const __m128 maxY = _mm_loadu_ps( boxes.maxY + i );
+      const __m128 maxZ = _mm_loadu_ps( boxes.maxZ + i );
+
+      __m128 outside = zero;
+      __m128 inside = allSet;
+
+      for ( U32 n = 0; n < numPlanes; n++ )
+      {
+         const PlaneF& plane = planes[ n ];
+
+         const __m128 x = _mm_set1_ps( plane.x );
+         const __m128 y = _mm_set1_ps( plane.y );
+         const __m128 z = _mm_set1_ps( plane.z );
+         const __m128 d = _mm_set1_ps( plane.d );
+
+         // The plane is the same in every lane, so the corners are picked
+         // up front.
+         const __m128 pDist = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, plane.x > 0.0f ? maxX : minX ),
+                                                                  _mm_mul_ps( y, plane.y > 0.0f ? maxY : minY ) ),
+                                                      _mm_mul_ps( z, plane.z > 0.0f ? maxZ : minZ ) ), d );
+         const __m128 nDist = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, plane.x > 0.0f ? minX : maxX ),
+                                                                  _mm_mul_ps( y, plane.y > 0.0f ? minY : maxY ) ),
+                                                      _mm_mul_ps( z, plane.z > 0.0f ? minZ : maxZ ) ), d );
+
+         outside = _mm_or_ps( outside, _mm_cmple_ps( pDist, backEpsilon ) );
+         inside = _mm_and_ps( inside, _mm_cmpge_ps( nDist, frontEpsilon ) );
+
+         if ( _mm_movemask_ps( outside ) == 0xF )
+            break;
+      }
+
+      _storeResults( outside, inside, outResults + i );
+      numVisible += 4 - sLaneCount[ _mm_movemask_ps( outside ) ];
+   }
+
+   return numVisible;
+}
+
+//------------------------------------------------------------------------------
+
+U32 m_spherePacketF_x_planesF_SSE( const SpherePacketF& spheres, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults )
+{
+   AssertFatal( count % 4 == 0, "m_spherePacketF_x_planesF - Count must be a multiple of four" );
+
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 allSet = _mm_cmpeq_ps( zero, zero );
+
+   U32 numVisible = 0;
+   for ( U32 i = 0; i < count; i += 4 )
+   {
+      const __m128 centerX = _mm_loadu_ps( spheres.x + i );
+      const __m128 centerY = _mm_loadu_ps( spheres.y + i );
+      const __m128 centerZ = _mm_loadu_ps( spheres.z + i );
+      const __m128 radius = _mm_loadu_ps( spheres.radius + i );
+      const __m128 negRadius = _mm_sub_ps( zero, radius );
+
+      __m128 outside = zero;
+      __m128 inside = allSet;
+
+      for ( U32 n = 0; n < numPlanes; n++ )
+      {
+         const PlaneF& plane = planes[ n ];
+
+         const __m128 dist = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( plane.x ), centerX ),
+                                                                 _mm_mul_ps( _mm_set1_ps( plane.y ), centerY ) ),
+                                                     _mm_mul_ps( _mm_set1_ps( plane.z ), centerZ ) ),
+                                         _mm_set1_ps( plane.d ) );
+
+         outside = _mm_or_ps( outside, _mm_cmplt_ps( dist, negRadius ) );
+         inside = _mm_and_ps( inside, _mm_cmpgt_ps( dist, radius ) );
+
+         if ( _mm_movemask_ps( outside ) == 0xF )
+            break;
+      }
+
+      _storeResults( outside, inside, outResults + i );
+      numVisible += 4 - sLaneCount[ _mm_movemask_ps( outside ) ];
+   }
+
+   return numVisible;
+}
+
+#endif // TORQUE_CPU_X86
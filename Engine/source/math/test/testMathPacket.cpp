@@ -0,0 +1,296 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "math/mPacket.h"
+#include "math/mBox.h"
+#include "math/mPlaneSet.h"
+#include "math/mSphere.h"
+#include "math/mRandom.h"
+#include "platform/platformTimer.h"
+#include "console/console.h"
+
+
+#ifndef TORQUE_SHIPPING
+
+extern U32 m_lineF_x_boxPacketF_C( const Point3F& start, const Point3F& end, const BoxPacketF& boxes, U32 count, F32* outT );
+extern OverlapTestResult m_boxF_x_planePacketF_C( const Box3F& box, const PlanePacketF& planes, U32 count );
+extern U32 m_boxPacketF_x_planesF_C( const BoxPacketF& boxes, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults );
+extern U32 m_spherePacketF_x_planesF_C( const SpherePacketF& spheres, U32 count, const PlaneF* planes, U32 numPlanes, S8* outResults );
+
+using namespace UnitTesting;
+
+/// Random boxes, spheres and planes in the SoA layout of the packet tests.
+struct PacketTestData
+{
+   enum { NumPrimitives = 1024, NumPlanes = 8 };
+
+   F32 minX[ NumPrimitives ], minY[ NumPrimitives ], minZ[ NumPrimitives ];
+   F32 maxX[ NumPrimitives ], maxY[ NumPrimitives ], maxZ[ NumPrimitives ];
+   F32 radius[ NumPrimitives ];
+
+   PlaneF planes[ NumPlanes ];
+   F32 planeX[ NumPlanes ], planeY[ NumPlanes ], planeZ[ NumPlanes ], planeD[ NumPlanes ];
+
+   BoxPacketF boxes;
+   SpherePacketF spheres;
+   PlanePacketF planePacket;
+
+   static F32 randF( F32 range ) { return gRandGen.randF( -range, range ); }
+
+   PacketTestData()
+   {
+      for( U32 i = 0; i < NumPrimitives; ++ i )
+      {
+         const Point3F center( randF( 10.f ), randF( 10.f ), randF( 10.f ) );
+         const Point3F extents( gRandGen.randF( 0.f, 2.f ), gRandGen.randF( 0.f, 2.f ), gRandGen.randF( 0.f, 2.f ) );
+
+         minX[ i ] = center.x - extents.x;
+         minY[ i ] = center.y - extents.y;
+         minZ[ i ] = center.z - extents.z;
+         maxX[ i ] = center.x + extents.x;
+         maxY[ i ] = center.y + extents.y;
+         maxZ[ i ] = center.z + extents.z;
+         radius[ i ] = extents.x;
+      }
+
+      randomizePlanes();
+
+      BoxPacketF b = { minX, minY, minZ, maxX, maxY, maxZ };
+      SpherePacketF s = { minX, minY, minZ, radius };
+      PlanePacketF p = { planeX, planeY, planeZ, planeD };
+      boxes = b;
+      spheres = s;
+      planePacket = p;
+   }
+
+   void randomizePlanes()
+   {
+      for( U32 i = 0; i < NumPlanes; ++ i )
+      {
+         Point3F normal( randF( 1.f ), randF( 1.f ), randF( 1.f ) );
+         normal.normalizeSafe();
+
+         planes[ i ] = PlaneF( Point3F( randF( 8.f ), randF( 8.f ), randF( 8.f ) ), normal );
+         planeX[ i ] = planes[ i ].x;
+         planeY[ i ] = planes[ i ].y;
+         planeZ[ i ] = planes[ i ].z;
+         planeD[ i ] = planes[ i ].d;
+      }
+   }
+
+   Box3F getBox( U32 i ) const
+   {
+      return Box3F( minX[ i ], minY[ i ], minZ[ i ], maxX[ i ], maxY[ i ], maxZ[ i ] );
+   }
+};
+
+CreateUnitTest( TestMathPacket, "Math/Packet" )
+{
+   // Checks the installed packet functions, and the C++ versions they
+   // may replace, against the scalar Box3F and PlaneF tests.
+
+   void test_lineBoxes( PacketTestData& data )
+   {
+      F32 tC[ PacketTestData::NumPrimitives ];
+      F32 tBest[ PacketTestData::NumPrimitives ];
+
+      bool agree = true;
+      bool matchScalar = true;
+
+      for( U32 r = 0; r < 100; ++ r )
+      {
+         Point3F start( PacketTestData::randF( 10.f ), PacketTestData::randF( 10.f ), PacketTestData::randF( 10.f ) );
+         Point3F end( PacketTestData::randF( 10.f ), PacketTestData::randF( 10.f ), PacketTestData::randF( 10.f ) );
+
+         // Include segments parallel to an axis.
+         if( r % 4 == 0 )
+            end.x = start.x;
+
+         const U32 hitsC = m_lineF_x_boxPacketF_C( start, end, data.boxes, PacketTestData::NumPrimitives, tC );
+         const U32 hitsBest = m_lineF_x_boxPacketF( start, end, data.boxes, PacketTestData::NumPrimitives, tBest );
+         agree &= ( hitsC == hitsBest );
+
+         for( U32 i = 0; i < PacketTestData::NumPrimitives; ++ i )
+         {
+            agree &= ( tC[ i ] == tBest[ i ] );
+
+            F32 t;
+            Point3F normal;
+            const bool hit = data.getBox( i ).collideLine( start, end, &t, &normal );
+            matchScalar &= ( hit == ( tC[ i ] <= 1.f ) );
+            if( hit && tC[ i ] <= 1.f )
+               matchScalar &= mIsEqual( t, tC[ i ], 1.0e-4f );
+         }
+      }
+
+      test( agree, "Line/box packet results differ between implementations!" );
+      test( matchScalar, "Line/box packet results differ from Box3F::collideLine!" );
+   }
+
+   void test_planes( PacketTestData& data )
+   {
+      S8 resultsC[ PacketTestData::NumPrimitives ];
+      S8 resultsBest[ PacketTestData::NumPrimitives ];
+
+      bool agree = true;
+      bool matchScalar = true;
+
+      for( U32 r = 0; r < 20; ++ r )
+      {
+         data.randomizePlanes();
+         const PlaneSetF planeSet( data.planes, PacketTestData::NumPlanes );
+
+         // Boxes.
+
+         U32 visibleC = m_boxPacketF_x_planesF_C( data.boxes, PacketTestData::NumPrimitives, data.planes, PacketTestData::NumPlanes, resultsC );
+         U32 visibleBest = m_boxPacketF_x_planesF( data.boxes, PacketTestData::NumPrimitives, data.planes, PacketTestData::NumPlanes, resultsBest );
+         agree &= ( visibleC == visibleBest );
+
+         for( U32 i = 0; i < PacketTestData::NumPrimitives; ++ i )
+         {
+            const Box3F box = data.getBox( i );
+            const OverlapTestResult expected = planeSet.testPotentialIntersection( box );
+
+            agree &= ( resultsC[ i ] == resultsBest[ i ] );
+            matchScalar &= ( resultsC[ i ] == expected );
+            matchScalar &= ( m_boxF_x_planePacketF_C( box, data.planePacket, PacketTestData::NumPlanes ) == expected );
+            matchScalar &= ( m_boxF_x_planePacketF( box, data.planePacket, PacketTestData::NumPlanes ) == expected );
+         }
+
+         // Spheres.
+
+         visibleC = m_spherePacketF_x_planesF_C( data.spheres, PacketTestData::NumPrimitives, data.planes, PacketTestData::NumPlanes, resultsC );
+         visibleBest = m_spherePacketF_x_planesF( data.spheres, PacketTestData::NumPrimitives, data.planes, PacketTestData::NumPlanes, resultsBest );
+         agree &= ( visibleC == visibleBest );
+
+         for( U32 i = 0; i < PacketTestData::NumPrimitives; ++ i )
+         {
+            const SphereF sphere( Point3F( data.minX[ i ], data.minY[ i ], data.minZ[ i ] ), data.radius[ i ] );
+
+            agree &= ( resultsC[ i ] == resultsBest[ i ] );
+            matchScalar &= ( resultsC[ i ] == planeSet.testPotentialIntersection( sphere ) );
+         }
+      }
+
+      test( agree, "Plane packet results differ between implementations!" );
+      test( matchScalar, "Plane packet results differ from PlaneSetF::testPotentialIntersection!" );
+   }
+
+   void run()
+   {
+      PacketTestData* data = new PacketTestData;
+
+      test_lineBoxes( *data );
+      test_planes( *data );
+
+      delete data;
+   }
+};
+
+CreateUnitTest( TestMathPacketPerformance, "Math/PacketPerformance" )
+{
+   // Times the scalar tests against the installed packet functions on the
+   // same data and prints the results to the console.
+
+   enum { NumIterations = 200 };
+
+   PlatformTimer* mTimer;
+
+   void report( const char* name, S32 scalarMs, S32 packetMs )
+   {
+      Con::printf( "   %-24s scalar: %5dms  packet: %5dms  (%.2fx)", name, scalarMs, packetMs,
+                   packetMs > 0 ? F32( scalarMs ) / F32( packetMs ) : 0.f );
+   }
+
+   void run()
+   {
+      PacketTestData* data = new PacketTestData;
+      const U32 count = PacketTestData::NumPrimitives;
+      const PlaneSetF planeSet( data->planes, PacketTestData::NumPlanes );
+
+      F32* t = new F32[ count ];
+      S8* results = new S8[ count ];
+
+      const Point3F start( -10.f, -10.f, -10.f );
+      const Point3F end( 10.f, 10.f, 10.f );
+
+      // Volatile sink so the scalar loops cannot be optimized away.
+      volatile U32 sink = 0;
+
+      mTimer = PlatformTimer::create();
+      Con::printf( "Math packet tests, %d x %d primitives:", NumIterations, count );
+
+      // Line against boxes.
+
+      mTimer->reset();
+      for( U32 n = 0; n < NumIterations; ++ n )
+         for( U32 i = 0; i < count; ++ i )
+            sink += data->getBox( i ).collideLine( start, end );
+      const S32 lineScalar = mTimer->getElapsedMs();
+
+      mTimer->reset();
+      for( U32 n = 0; n < NumIterations; ++ n )
+         sink += m_lineF_x_boxPacketF( start, end, data->boxes, count, t );
+      report( "line x boxes", lineScalar, mTimer->getElapsedMs() );
+
+      // Boxes against planes.
+
+      mTimer->reset();
+      for( U32 n = 0; n < NumIterations; ++ n )
+         for( U32 i = 0; i < count; ++ i )
+            sink += planeSet.testPotentialIntersection( data->getBox( i ) );
+      const S32 boxScalar = mTimer->getElapsedMs();
+
+      mTimer->reset();
+      for( U32 n = 0; n < NumIterations; ++ n )
+         sink += m_boxPacketF_x_planesF( data->boxes, count, data->planes, PacketTestData::NumPlanes, results );
+      report( "boxes x planes", boxScalar, mTimer->getElapsedMs() );
+
+      mTimer->reset();
+      for( U32 n = 0; n < NumIterations; ++ n )
+         for( U32 i = 0; i < count; ++ i )
+            sink += m_boxF_x_planePacketF( data->getBox( i ), data->planePacket, PacketTestData::NumPlanes );
+      report( "box x plane packet", boxScalar, mTimer->getElapsedMs() );
+
+      // Spheres against planes.
+
+      mTimer->reset();
+      for( U32 n = 0; n < NumIterations; ++ n )
+         for( U32 i = 0; i < count; ++ i )
+            sink += planeSet.testPotentialIntersection( SphereF( Point3F( data->minX[ i ], data->minY[ i ], data->minZ[ i ] ), data->radius[ i ] ) );
+      const S32 sphereScalar = mTimer->getElapsedMs();
+
+      mTimer->reset();
+      for( U32 n = 0; n < NumIterations; ++ n )
+         sink += m_spherePacketF_x_planesF( data->spheres, count, data->planes, PacketTestData::NumPlanes, results );
+      report( "spheres x planes", sphereScalar, mTimer->getElapsedMs() );
+
+      delete mTimer;
+      delete [] results;
+      delete [] t;
+      delete data;
+   }
+};
+
+#endif // !TORQUE_SHIPPING
@@ -23,6 +23,7 @@
 #include <stdio.h>
 
 #include "navMesh.h"
+#include "navPathQuery.h"
 #include <DetourDebugDraw.h>
 #include <RecastDebugDraw.h>
 
@@ -40,6 +41,8 @@
 #include "core/stream/bitStream.h"
 #include "math/mathIO.h"
 
+#include "platform/threads/threadPoolJob.h"
+
 extern bool gEditingMission;
 
 IMPLEMENT_CO_NETOBJECT_V1(NavMesh);
@@ -69,14 +72,18 @@ NavMesh::NavMesh()
    mMergeRegionArea = 20;
    mTileSize = 10.0f;
    mMaxPolysPerTile = 128;
+   mMaxConcurrentTiles = 4;
 
    mAlwaysRender = false;
 
    mBuilding = false;
+   mBuildStart = 0;
 }
 
 NavMesh::~NavMesh()
 {
+   cancelTileJobs();
+   NavPathQueryManager::onMeshFreed(nm);
    dtFreeNavMesh(nm);
    nm = NULL;
 }
@@ -167,6 +174,8 @@ void NavMesh::initPersistFields()
       "Any regions with a span count smaller than this value will, if possible, be merged with larger regions.");
    addFieldV("maxPolysPerTile", TypeS32, Offset(mMaxPolysPerTile, NavMesh), &NaturalNumber,
       "The maximum number of polygons allowed in a tile.");
+   addFieldV("maxConcurrentTiles", TypeS32, Offset(mMaxConcurrentTiles, NavMesh), &NaturalNumber,
+      "The maximum number of tiles built on worker threads at the same time.");
 
    endGroup("NavMesh Advanced Options");
 
@@ -203,6 +212,8 @@ bool NavMesh::onAdd()
 
 void NavMesh::onRemove()
 {
+   cancelBuild();
+
    removeFromScene();
 
    Parent::onRemove();
@@ -225,6 +236,7 @@ bool NavMesh::build(bool background, bool saveIntermediates)
 
    mBuilding = true;
 
+   NavPathQueryManager::onMeshFreed(nm);
    dtFreeNavMesh(nm);
    // Allocate a new navmesh.
    nm = dtAllocNavMesh();
@@ -251,12 +263,19 @@ bool NavMesh::build(bool background, bool saveIntermediates)
       return false;
    }
 
+   beginBuildStats();
+
    updateTiles(true);
 
    if(!background)
    {
-      while(mDirtyTiles.size())
-         buildNextTile();
+      while(mBuilding)
+      {
+         updateBuild();
+         // Give the worker threads some time to finish their tiles.
+         if(mBuildJobs.size())
+            Platform::sleep(1);
+      }
    }
 
    return true;
@@ -271,6 +290,7 @@ DefineEngineMethod(NavMesh, build, bool, (bool background, bool save), (true, fa
 void NavMesh::cancelBuild()
 {
    while(mDirtyTiles.size()) mDirtyTiles.pop();
+   cancelTileJobs();
    mBuilding = false;
 }
 
@@ -339,6 +359,7 @@ void NavMesh::updateTiles(bool dirty)
 
    mTiles.clear();
    while(mDirtyTiles.size()) mDirtyTiles.pop();
+   cancelTileJobs();
 
    const Box3F &box = DTStoRC(getWorldBox());
    if(box.isEmpty())
@@ -379,51 +400,82 @@ void NavMesh::updateTiles(bool dirty)
 
 void NavMesh::processTick(const Move *move)
 {
-   buildNextTile();
+   updateBuild();
 }
 
-void NavMesh::buildNextTile()
+/// Milliseconds elapsed since a given real time.
+static F64 getElapsedMs(U32 start)
 {
-   if(mDirtyTiles.size())
-   {
-      // Pop a single dirty tile and process it.
-      U32 i = mDirtyTiles.front();
-      mDirtyTiles.pop();
-      const Tile &tile = mTiles[i];
-      // Intermediate data for tile build.
-      TileData tempdata;
-      // Generate navmesh for this tile.
-      U32 dataSize = 0;
-      unsigned char* data = buildTileData(tile, tempdata, dataSize);
-      if(data)
-      {
-         // Remove any previous data.
-         nm->removeTile(nm->getTileRefAt(tile.x, tile.y, 0), 0, 0);
-         // Add new data (navmesh owns and deletes the data).
-         dtStatus status = nm->addTile(data, dataSize, DT_TILE_FREE_DATA, 0, 0);
-         int success = 1;
-         if(dtStatusFailed(status))
-         {
-            success = 0;
-            dtFree(data);
-         }
-      }
-      // Did we just build the last tile?
-      if(!mDirtyTiles.size())
-      {
-         mBuilding = false;
-      }
-      setMaskBits(BuildFlag);
-   }
+   return F64(Platform::getRealMilliseconds() - start);
 }
 
-static void buildCallback(SceneObject* object,void *key)
+/// Runs the Recast pipeline for a single tile on a worker thread. The job
+/// owns copies of everything it reads, so it never touches the NavMesh and
+/// may safely outlive it.
+struct NavMesh::TileBuildJob : public ThreadPoolJob
 {
-   SceneContainer::CallbackInfo* info = reinterpret_cast<SceneContainer::CallbackInfo*>(key);
-   object->buildPolyList(info->context,info->polyList,info->boundingBox,info->boundingSphere);
-}
+   /// Index of the tile in the NavMesh's tile list.
+   U32 index;
+   /// Copy of the tile being built.
+   Tile tile;
+   /// Copy of the NavMesh's Recast config.
+   rcConfig cfg;
+   /// Actor dimensions in world units.
+   F32 walkableHeight, walkableRadius, walkableClimb;
+   /// Input geometry and intermediate Recast data.
+   TileData data;
+
+   /// Detour tile data, owned by the job until collected.
+   unsigned char *navData;
+   U32 navDataSize;
+   /// Description of the stage that failed, if any.
+   const char *error;
+   /// Time spent running the pipeline (ms).
+   F64 buildTime;
+
+   /// Set by the main thread when the result is no longer wanted.
+   volatile U32 cancelled;
+
+   TileBuildJob(U32 _index, const Tile &_tile, const rcConfig &_cfg,
+                F32 height, F32 radius, F32 climb)
+      : index(_index), tile(_tile), cfg(_cfg),
+        walkableHeight(height), walkableRadius(radius), walkableClimb(climb),
+        navData(NULL), navDataSize(0), error(NULL), buildTime(0.0),
+        cancelled(0)
+   {
+   }
+
+   ~TileBuildJob()
+   {
+      dtFree(navData);
+   }
+
+   void cancel()
+   {
+      dCompareAndSwap(cancelled, 0, 1);
+   }
+
+protected:
+   virtual bool isCancellationRequested()
+   {
+      return dAtomicRead(cancelled) != 0;
+   }
+
+   virtual void run()
+   {
+      const U32 start = Platform::getRealMilliseconds();
+      error = buildTileData();
+      // Intermediate data is not needed on the main thread.
+      data.freeAll();
+      buildTime = getElapsedMs(start);
+   }
 
-unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dataSize)
+   /// Generates navmesh data for the tile. Returns a description of the
+   /// failure, or NULL on success.
+   const char *buildTileData();
+};
+
+const char *NavMesh::TileBuildJob::buildTileData()
 {
    // Push out tile boundaries a bit.
    F32 tileBmin[3], tileBmax[3];
@@ -434,18 +486,6 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    tileBmax[0] += cfg.borderSize * cfg.cs;
    tileBmax[2] += cfg.borderSize * cfg.cs;
 
-   // Parse objects from level into RC-compatible format.
-   Box3F box = RCtoDTS(tileBmin, tileBmax);
-   SceneContainer::CallbackInfo info;
-   info.context = PLC_Navigation;
-   info.boundingBox = box;
-   info.polyList = &data.geom;
-   getContainer()->findObjects(box, StaticObjectType, buildCallback, &info);
-
-   // Check for no geometry.
-   if(!data.geom.getVertCount())
-      return false;
-
    // Figure out voxel dimensions of this tile.
    U32 width = 0, height = 0;
    width = cfg.tileSize + cfg.borderSize * 2;
@@ -457,22 +497,13 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    // Create a heightfield to voxelise our input geometry.
    data.hf = rcAllocHeightfield();
    if(!data.hf)
-   {
-      Con::errorf("Out of memory (rcHeightField) for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Out of memory (rcHeightField)";
    if(!rcCreateHeightfield(&ctx, *data.hf, width, height, tileBmin, tileBmax, cfg.cs, cfg.ch))
-   {
-      Con::errorf("Could not generate rcHeightField for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Could not generate rcHeightField";
 
    unsigned char *areas = new unsigned char[data.geom.getTriCount()];
    if(!areas)
-   {
-      Con::errorf("Out of memory (area flags) for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Out of memory (area flags)";
    dMemset(areas, 0, data.geom.getTriCount() * sizeof(unsigned char));
 
    // Filter triangles by angle and rasterize.
@@ -485,6 +516,12 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
 
    delete[] areas;
 
+   // Input geometry is no longer needed.
+   data.geom.clear();
+
+   if(cancellationPoint())
+      return NULL;
+
    // Filter out areas with low ceilings and other stuff.
    rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *data.hf);
    rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.hf);
@@ -492,20 +529,11 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
 
    data.chf = rcAllocCompactHeightfield();
    if(!data.chf)
-   {
-      Con::errorf("Out of memory (rcCompactHeightField) for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Out of memory (rcCompactHeightField)";
    if(!rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.hf, *data.chf))
-   {
-      Con::errorf("Could not generate rcCompactHeightField for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Could not generate rcCompactHeightField";
    if(!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *data.chf))
-   {
-      Con::errorf("Could not erode walkable area for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Could not erode walkable area";
 
    //--------------------------
    // Todo: mark areas here.
@@ -514,74 +542,50 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
       //rcMarkConvexPolyArea(m_NULL, vols[i].verts, vols[i].nverts, vols[i].hmin, vols[i].hmax, (unsigned char)vols[i].area, *m_chf);
    //--------------------------
 
+   if(cancellationPoint())
+      return NULL;
+
    if(false)
    {
       if(!rcBuildRegionsMonotone(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
-      {
-         Con::errorf("Could not build regions for NavMesh %s", getIdString());
-         return NULL;
-      }
+         return "Could not build regions";
    }
    else
    {
       if(!rcBuildDistanceField(&ctx, *data.chf))
-      {
-         Con::errorf("Could not build distance field for NavMesh %s", getIdString());
-         return NULL;
-      }
+         return "Could not build distance field";
       if(!rcBuildRegions(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
-      {
-         Con::errorf("Could not build regions for NavMesh %s", getIdString());
-         return NULL;
-      }
+         return "Could not build regions";
    }
 
+   if(cancellationPoint())
+      return NULL;
+
    data.cs = rcAllocContourSet();
    if(!data.cs)
-   {
-      Con::errorf("Out of memory (rcContourSet) for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Out of memory (rcContourSet)";
    if(!rcBuildContours(&ctx, *data.chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *data.cs))
-   {
-      Con::errorf("Could not construct rcContourSet for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Could not construct rcContourSet";
    if(data.cs->nconts <= 0)
-   {
-      Con::errorf("No contours in rcContourSet for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "No contours in rcContourSet";
 
    data.pm = rcAllocPolyMesh();
    if(!data.pm)
-   {
-      Con::errorf("Out of memory (rcPolyMesh) for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Out of memory (rcPolyMesh)";
    if(!rcBuildPolyMesh(&ctx, *data.cs, cfg.maxVertsPerPoly, *data.pm))
-   {
-      Con::errorf("Could not construct rcPolyMesh for NavMesh %s", getIdString());
+      return "Could not construct rcPolyMesh";
+
+   if(cancellationPoint())
       return NULL;
-   }
 
    data.pmd = rcAllocPolyMeshDetail();
    if(!data.pmd)
-   {
-      Con::errorf("Out of memory (rcPolyMeshDetail) for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Out of memory (rcPolyMeshDetail)";
    if(!rcBuildPolyMeshDetail(&ctx, *data.pm, *data.chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *data.pmd))
-   {
-      Con::errorf("Could not construct rcPolyMeshDetail for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Could not construct rcPolyMeshDetail";
 
    if(data.pm->nverts >= 0xffff)
-   {
-      Con::errorf("Too many vertices in rcPolyMesh for NavMesh %s", getIdString());
-      return NULL;
-   }
+      return "Too many vertices in rcPolyMesh";
    for(U32 i = 0; i < data.pm->npolys; i++)
    {
       if(data.pm->areas[i] == RC_WALKABLE_AREA)
@@ -593,8 +597,8 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
          data.pm->flags[i] |= SwimFlag;
    }
 
-   unsigned char* navData = 0;
-   int navDataSize = 0;
+   unsigned char* tileData = 0;
+   int tileDataSize = 0;
 
    dtNavMeshCreateParams params;
    dMemset(&params, 0, sizeof(params));
@@ -613,9 +617,9 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    params.detailTris = data.pmd->tris;
    params.detailTriCount = data.pmd->ntris;
 
-   params.walkableHeight = mWalkableHeight;
-   params.walkableRadius = mWalkableRadius;
-   params.walkableClimb = mWalkableClimb;
+   params.walkableHeight = walkableHeight;
+   params.walkableRadius = walkableRadius;
+   params.walkableClimb = walkableClimb;
    params.tileX = tile.x;
    params.tileY = tile.y;
    params.tileLayer = 0;
@@ -625,16 +629,174 @@ unsigned char *NavMesh::buildTileData(const Tile &tile, TileData &data, U32 &dat
    params.ch = cfg.ch;
    params.buildBvTree = true;
 
-   if(!dtCreateNavMeshData(&params, &navData, &navDataSize))
+   if(!dtCreateNavMeshData(&params, &tileData, &tileDataSize))
+      return "Could not create dtNavMeshData";
+
+   navData = tileData;
+   navDataSize = tileDataSize;
+
+   return NULL;
+}
+
+void NavMesh::updateBuild()
+{
+   if(!nm)
+      return;
+
+   // Add any tiles the workers have finished.
+   collectTiles();
+
+   // Keep the workers busy up to our concurrency limit.
+   while(mDirtyTiles.size() && mBuildJobs.size() < mMaxConcurrentTiles)
    {
-      Con::errorf("Could not create dtNavMeshData for tile (%d, %d) of NavMesh %s",
-         tile.x, tile.y, getIdString());
-      return NULL;
+      U32 i = mDirtyTiles.front();
+      mDirtyTiles.pop();
+      dispatchTile(i);
    }
 
-   dataSize = navDataSize;
+   // Did we just build the last tile?
+   if(mBuilding && !mDirtyTiles.size() && !mBuildJobs.size())
+   {
+      mBuilding = false;
+      mBuildStats.totalTime = getElapsedMs(mBuildStart);
+      Con::printf("NavMesh %s built %d tiles (%d empty, %d failed) in %.1fms; gather %.1fms, recast %.1fms (slowest tile %.1fms)",
+         getIdString(), mBuildStats.tilesBuilt, mBuildStats.tilesEmpty, mBuildStats.tilesFailed,
+         mBuildStats.totalTime, mBuildStats.gatherTime, mBuildStats.workerTime, mBuildStats.maxTileTime);
+      setMaskBits(BuildFlag);
+   }
+}
 
-   return navData;
+bool NavMesh::dispatchTile(U32 index)
+{
+   const Tile &tile = mTiles[index];
+
+   // A newer build of this tile supersedes any that is still running.
+   for(U32 i = 0; i < mBuildJobs.size(); i++)
+   {
+      if(mBuildJobs[i]->index == index)
+      {
+         mBuildJobs[i]->cancel();
+         mBuildJobs.erase(i);
+         break;
+      }
+   }
+
+   TileBuildJobRef job = new TileBuildJob(index, tile, cfg,
+      mWalkableHeight, mWalkableRadius, mWalkableClimb);
+
+   // Scene queries are not thread-safe, so gather geometry here.
+   const U32 start = Platform::getRealMilliseconds();
+   gatherTileGeometry(tile, job->data.geom);
+   mBuildStats.gatherTime += getElapsedMs(start);
+
+   // Check for no geometry.
+   if(!job->data.geom.getVertCount())
+   {
+      // Remove any previous data.
+      NavPathQueryManager::lockMesh(nm);
+      nm->removeTile(nm->getTileRefAt(tile.x, tile.y, 0), 0, 0);
+      NavPathQueryManager::onMeshChanged(nm);
+      mBuildStats.tilesEmpty++;
+      mBuildStats.totalTime = getElapsedMs(mBuildStart);
+      setMaskBits(BuildFlag);
+      return false;
+   }
+
+   mBuildJobs.push_back(job);
+   ThreadPool::GLOBAL().queueWorkItem(job);
+   return true;
+}
+
+void NavMesh::collectTiles()
+{
+   bool changed = false;
+   for(U32 i = 0; i < mBuildJobs.size();)
+   {
+      TileBuildJob *job = mBuildJobs[i];
+      if(!job->isFinished())
+      {
+         i++;
+         continue;
+      }
+
+      // Path queries must not read the mesh while we modify it.
+      if(!changed)
+      {
+         NavPathQueryManager::lockMesh(nm);
+         changed = true;
+      }
+
+      const Tile &tile = job->tile;
+      mBuildStats.workerTime += job->buildTime;
+      mBuildStats.maxTileTime = getMax(mBuildStats.maxTileTime, job->buildTime);
+
+      if(job->navData)
+      {
+         // Remove any previous data.
+         nm->removeTile(nm->getTileRefAt(tile.x, tile.y, 0), 0, 0);
+         // Add new data (navmesh owns and deletes the data).
+         dtStatus status = nm->addTile(job->navData, job->navDataSize, DT_TILE_FREE_DATA, 0, 0);
+         if(dtStatusFailed(status))
+         {
+            Con::errorf("Could not add tile (%d, %d) to NavMesh %s",
+               tile.x, tile.y, getIdString());
+            mBuildStats.tilesFailed++;
+         }
+         else
+         {
+            job->navData = NULL;
+            mBuildStats.tilesBuilt++;
+         }
+      }
+      else
+      {
+         Con::errorf("%s for tile (%d, %d) of NavMesh %s",
+            job->error ? job->error : "Unknown error", tile.x, tile.y, getIdString());
+         mBuildStats.tilesFailed++;
+      }
+
+      mBuildStats.totalTime = getElapsedMs(mBuildStart);
+      mBuildJobs.erase(i);
+      setMaskBits(BuildFlag);
+   }
+
+   if(changed)
+      NavPathQueryManager::onMeshChanged(nm);
+}
+
+void NavMesh::cancelTileJobs()
+{
+   // The pool still holds references to running jobs; they exit at their
+   // next cancellation point and free their own data.
+   for(U32 i = 0; i < mBuildJobs.size(); i++)
+      mBuildJobs[i]->cancel();
+   mBuildJobs.clear();
+}
+
+static void buildCallback(SceneObject* object,void *key)
+{
+   SceneContainer::CallbackInfo* info = reinterpret_cast<SceneContainer::CallbackInfo*>(key);
+   object->buildPolyList(info->context,info->polyList,info->boundingBox,info->boundingSphere);
+}
+
+void NavMesh::gatherTileGeometry(const Tile &tile, RecastPolyList &geom)
+{
+   // Push out tile boundaries a bit.
+   F32 tileBmin[3], tileBmax[3];
+   rcVcopy(tileBmin, tile.bmin);
+   rcVcopy(tileBmax, tile.bmax);
+   tileBmin[0] -= cfg.borderSize * cfg.cs;
+   tileBmin[2] -= cfg.borderSize * cfg.cs;
+   tileBmax[0] += cfg.borderSize * cfg.cs;
+   tileBmax[2] += cfg.borderSize * cfg.cs;
+
+   // Parse objects from level into RC-compatible format.
+   Box3F box = RCtoDTS(tileBmin, tileBmax);
+   SceneContainer::CallbackInfo info;
+   info.context = PLC_Navigation;
+   info.boundingBox = box;
+   info.polyList = &geom;
+   getContainer()->findObjects(box, StaticObjectType, buildCallback, &info);
 }
 
 /// This method should never be called in a separate thread to the rendering
@@ -653,6 +815,8 @@ void NavMesh::buildTiles(const Box3F &box)
       if(!tile.box.isOverlapped(box))
          continue;
       // Mark as dirty.
+      if(mDirtyTiles.empty() && mBuildJobs.empty())
+         beginBuildStats();
       mDirtyTiles.push(i);
    }
 }
@@ -667,10 +831,30 @@ void NavMesh::buildTile(const U32 &tile)
 {
    if(tile < mTiles.size())
    {
+      if(mDirtyTiles.empty() && mBuildJobs.empty())
+         beginBuildStats();
       mDirtyTiles.push(tile);
    }
 }
 
+void NavMesh::beginBuildStats()
+{
+   mBuildStats.clear();
+   mBuildStart = Platform::getRealMilliseconds();
+}
+
+DefineEngineMethod(NavMesh, getBuildStats, const char*, (),,
+   "@brief Get statistics for the most recent build.\n\n"
+   "@return A string of the form \"built empty failed totalMs gatherMs workerMs maxTileMs\".")
+{
+   const NavMesh::BuildStats &stats = object->getBuildStats();
+   char *ret = Con::getReturnBuffer(128);
+   dSprintf(ret, 128, "%d %d %d %g %g %g %g",
+      stats.tilesBuilt, stats.tilesEmpty, stats.tilesFailed,
+      stats.totalTime, stats.gatherTime, stats.workerTime, stats.maxTileTime);
+   return ret;
+}
+
 void NavMesh::renderToDrawer()
 {
    dd.clear();
@@ -834,7 +1018,10 @@ bool NavMesh::load()
    }
 
    if(nm)
+   {
+      NavPathQueryManager::onMeshFreed(nm);
       dtFreeNavMesh(nm);
+   }
    nm = dtAllocNavMesh();
    if(!nm)
    {
@@ -28,6 +28,7 @@
 #include "torqueRecast.h"
 #include "scene/sceneObject.h"
 #include "recastPolyList.h"
+#include "platform/threads/threadSafeRefCount.h"
 
 #include "duDebugDrawTorque.h"
 
@@ -43,6 +44,7 @@
 class NavMesh : public SceneObject {
    typedef SceneObject Parent;
    friend class NavPath;
+   friend class NavPathQuery;
 
 public:
    /// @name NavMesh build
@@ -65,6 +67,33 @@ public:
    /// Instantly rebuild a specific tile.
    void buildTile(const U32 &tile);
 
+   /// Timings and tile counts gathered over the most recent build.
+   struct BuildStats {
+      /// Tiles successfully added to the navmesh.
+      U32 tilesBuilt;
+      /// Tiles that contained no geometry.
+      U32 tilesEmpty;
+      /// Tiles whose Recast pipeline failed.
+      U32 tilesFailed;
+      /// Wall-clock time from the start of the build to the last tile (ms).
+      F64 totalTime;
+      /// Main-thread time spent gathering tile geometry (ms).
+      F64 gatherTime;
+      /// Summed worker-thread time spent in the Recast pipeline (ms).
+      F64 workerTime;
+      /// Longest single-tile worker time (ms).
+      F64 maxTileTime;
+      BuildStats() { clear(); }
+      void clear()
+      {
+         tilesBuilt = tilesEmpty = tilesFailed = 0;
+         totalTime = gatherTime = workerTime = maxTileTime = 0.0;
+      }
+   };
+
+   /// Return the statistics of the most recent build.
+   const BuildStats &getBuildStats() const { return mBuildStats; }
+
    /// Data file to store this nav mesh in. (From engine executable dir.)
    StringTableEntry mFileName;
 
@@ -90,6 +119,9 @@ public:
    U32 mMaxPolysPerTile;
    /// @}
 
+   /// Maximum number of tiles being built on worker threads at once.
+   U32 mMaxConcurrentTiles;
+
    /// @}
 
    /// Return the index of the tile included by this point.
@@ -162,8 +194,9 @@ private:
    /// mesh. Returns true if successful. Stores the created mesh in tnm.
    bool generateMesh();
 
-   /// Builds the next tile in the dirty list.
-   void buildNextTile();
+   /// Dispatches dirty tiles to worker threads and adds finished tiles to
+   /// the navmesh.
+   void updateBuild();
 
    /// @name Tiles
    /// @{
@@ -213,6 +246,11 @@ private:
          rcFreeContourSet(cs);
          rcFreePolyMesh(pm);
          rcFreePolyMeshDetail(pmd);
+         hf = NULL;
+         chf = NULL;
+         cs = NULL;
+         pm = NULL;
+         pmd = NULL;
       }
       ~TileData()
       {
@@ -229,8 +267,24 @@ private:
    /// Update tile dimensions.
    void updateTiles(bool dirty = false);
 
-   /// Generates navmesh data for a single tile.
-   unsigned char *buildTileData(const Tile &tile, TileData &data, U32 &dataSize);
+   /// Collects the input geometry for a tile. Must run on the main thread.
+   void gatherTileGeometry(const Tile &tile, RecastPolyList &geom);
+
+   /// Worker thread job that runs the Recast pipeline for a single tile.
+   struct TileBuildJob;
+   typedef ThreadSafeRef<TileBuildJob> TileBuildJobRef;
+
+   /// Jobs queued or running on the thread pool.
+   Vector<TileBuildJobRef> mBuildJobs;
+
+   /// Start a worker job for a tile. Returns false if the tile was empty.
+   bool dispatchTile(U32 index);
+
+   /// Add the results of finished jobs to the navmesh.
+   void collectTiles();
+
+   /// Cancel and forget all in-flight jobs.
+   void cancelTileJobs();
 
    /// @}
 
@@ -259,6 +313,15 @@ private:
    /// A simple flag to say we are building.
    bool mBuilding;
 
+   /// Statistics for the current or last build.
+   BuildStats mBuildStats;
+
+   /// Real time in milliseconds the current batch of tiles was started.
+   U32 mBuildStart;
+
+   /// Reset the statistics if no tiles are pending.
+   void beginBuildStats();
+
    /// @}
 
    /// @name Rendering
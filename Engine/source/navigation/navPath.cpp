@@ -40,6 +40,10 @@ extern bool gEditingMission;
 
 IMPLEMENT_CO_NETOBJECT_V1(NavPath);
 
+IMPLEMENT_CALLBACK(NavPath, onPlanComplete, void, (bool success), (success),
+   "@brief Called when a path planned with replan(true) has finished.\n\n"
+   "@param success True if every leg of the path was found.\n");
+
 NavPath::NavPath() :
    mFrom(0.0f, 0.0f, 0.0f),
    mTo(0.0f, 0.0f, 0.0f)
@@ -59,15 +63,11 @@ NavPath::NavPath() :
 
    mAlwaysRender = false;
    mXray = false;
-
-   mQuery = dtAllocNavMeshQuery();
 }
 
 NavPath::~NavPath()
 {
-   // Required for Detour.
-   dtFreeNavMeshQuery(mQuery);
-   mQuery = NULL;
+   cancelPlan();
 }
 
 bool NavPath::setProtectedMesh(void *obj, const char *index, const char *data)
@@ -223,6 +223,8 @@ bool NavPath::onAdd()
 
 void NavPath::onRemove()
 {
+   cancelPlan();
+
    Parent::onRemove();
 
    // Remove from simulation.
@@ -237,10 +239,6 @@ bool NavPath::init()
    if(!(mFromSet && mToSet) && !(!mWaypoints.isNull() && mWaypoints->size()))
       return false;
 
-   // Initialise query in Detour.
-   if(dtStatusFailed(mQuery->init(mMesh->getNavMesh(), MaxPathLen)))
-      return false;
-
    mPoints.clear();
    mVisitPoints.clear();
    mLength = 0.0f;
@@ -319,145 +317,93 @@ void NavPath::resize()
    Parent::setTransform(mat);
 }
 
-bool NavPath::plan()
+bool NavPath::plan(bool async, F32 priority)
 {
+   cancelPlan();
+
    if(!init())
       return false;
 
-   visitNext();
-   while(update());
+   // Each leg of the journey is an independent query. Visit points are
+   // stored in reverse order.
+   for(S32 i = mVisitPoints.size() - 1; i > 0; i--)
+      mLegs.push_back(new NavPathQuery(mMesh, mVisitPoints[i], mVisitPoints[i-1], priority));
 
-   if(!finalise())
-      return false;
+   if(async)
+   {
+      for(U32 i = 0; i < mLegs.size(); i++)
+      {
+         mLegs[i]->mOnComplete.bind(this, &NavPath::onLegComplete);
+         NAVQUERIES->submit(mLegs[i]);
+      }
+      return true;
+   }
 
-   resize();
+   for(U32 i = 0; i < mLegs.size(); i++)
+      NAVQUERIES->findPath(mLegs[i]);
 
-   return true;
+   return finishPlan();
 }
 
-bool NavPath::visitNext()
+void NavPath::cancelPlan()
 {
-   U32 s = mVisitPoints.size();
-   if(s < 2)
-      return false;
-
-   // Current leg of journey.
-   Point3F start = mVisitPoints[s-1];
-   Point3F end = mVisitPoints[s-2];
-
-   // Convert to Detour-friendly coordinates and data structures.
-   F32 from[] = {start.x, start.z, -start.y};
-   F32 to[] =   {end.x,   end.z,   -end.y};
-   F32 extents[] = {1.0f, 1.0f, 1.0f};
-   dtPolyRef startRef, endRef;
-
-   if(dtStatusFailed(mQuery->findNearestPoly(from, extents, &mFilter, &startRef, from)) || !startRef)
-   {
-      Con::errorf("No NavMesh polygon near visit point (%g, %g, %g) of NavPath %s",
-         start.x, start.y, start.z, getIdString());
-      return false;
-   }
+   for(U32 i = 0; i < mLegs.size(); i++)
+      mLegs[i]->cancel();
+   mLegs.clear();
+}
 
-   if(dtStatusFailed(mQuery->findNearestPoly(to, extents, &mFilter, &endRef, to)) || !startRef)
+void NavPath::onLegComplete(NavPathQuery *query)
+{
+   for(U32 i = 0; i < mLegs.size(); i++)
    {
-      Con::errorf("No NavMesh polygon near visit point (%g, %g, %g) of NavPath %s",
-         end.x, end.y, end.z, getIdString());
-      return false;
+      if(!mLegs[i]->isDone())
+         return;
    }
 
-   // Init sliced pathfind.
-   mStatus = mQuery->initSlicedFindPath(startRef, endRef, from, to, &mFilter);
-   if(dtStatusFailed(mStatus))
-      return false;
-
-   return true;
+   onPlanComplete_callback(finishPlan());
 }
 
-bool NavPath::update()
+bool NavPath::finishPlan()
 {
-   // StatusInProgress means a query is underway.
-   if(dtStatusInProgress(mStatus))
-      mStatus = mQuery->updateSlicedFindPath(INT_MAX, NULL);
-   // StatusSucceeded means the query found its destination.
-   if(dtStatusSucceed(mStatus))
-   {
-      // Finalize the path. Need to use the static path length cap again.
-      dtPolyRef path[MaxPathLen];
-      S32 pathLen;
-      mStatus = mQuery->finalizeSlicedFindPath(path, &pathLen, MaxPathLen);
-      // Apparently stuff can go wrong during finalizing, so check the status again.
-      if(dtStatusSucceed(mStatus) && pathLen)
-      {
-         // These next few blocks are straight from Detour example code.
-         F32 straightPath[MaxPathLen * 3];
-         S32 straightPathLen;
-         dtPolyRef straightPathPolys[MaxPathLen];
-         U8 straightPathFlags[MaxPathLen];
-
-         U32 s = mVisitPoints.size();
-         Point3F start = mVisitPoints[s-1];
-         Point3F end = mVisitPoints[s-2];
-         F32 from[] = {start.x, start.z, -start.y};
-         F32 to[] =   {end.x,   end.z,   -end.y};
-
-         // Straightens out the path.
-         mQuery->findStraightPath(from, to, path, pathLen,
-            straightPath, straightPathFlags,
-            straightPathPolys, &straightPathLen, MaxPathLen);
-
-         // Convert Detour point path to list of Torque points.
-         s = mPoints.size();
-         mPoints.increment(straightPathLen);
-         for(U32 i = 0; i < straightPathLen; i++)
-         {
-            F32 *f = straightPath + i * 3;
-            mPoints[s + i] = RCtoDTS(f);
-            // Accumulate length if we're not the first vertex.
-            if(s > 0 || i > 0)
-               mLength += (mPoints[s+i] - mPoints[s+i-1]).len();
-         }
+   mPoints.clear();
+   mLength = 0.0f;
 
-         if(isServerObject())
-            setMaskBits(PathMask);
-      }
-      else
-         return false;
-      // Check to see where we still need to visit.
-      if(mVisitPoints.size() > 1)
+   bool success = mLegs.size() > 0;
+   for(U32 i = 0; i < mLegs.size(); i++)
+   {
+      const NavPathQuery *leg = mLegs[i];
+      if(!leg->isSuccess())
       {
-         //Next leg of the journey.
-         mVisitPoints.pop_back();
-         return visitNext();
+         const Point3F &from = leg->getFrom();
+         const Point3F &to = leg->getTo();
+         Con::errorf("%s between visit points (%g, %g, %g) and (%g, %g, %g) of NavPath %s",
+            leg->getError() ? leg->getError() : "No path",
+            from.x, from.y, from.z, to.x, to.y, to.z, getIdString());
+         success = false;
+         break;
       }
-      else
+
+      // Append this leg's points to the path.
+      const Vector<Point3F> &points = leg->getPoints();
+      U32 s = mPoints.size();
+      mPoints.increment(points.size());
+      for(U32 j = 0; j < points.size(); j++)
       {
-         // Finished!
-         return false;
+         mPoints[s + j] = points[j];
+         // Accumulate length if we're not the first vertex.
+         if(s > 0 || j > 0)
+            mLength += (mPoints[s+j] - mPoints[s+j-1]).len();
       }
    }
-   else if(dtStatusFailed(mStatus))
-   {
-      // Something went wrong in planning.
-      return false;
-   }
-   return true;
-}
+   mLegs.clear();
 
-bool NavPath::finalise()
-{
-   // Stop ticking.
-   setProcessTick(false);
+   if(isServerObject())
+      setMaskBits(PathMask);
 
    // Reset world bounds and stuff.
    resize();
 
-   return dtStatusSucceed(mStatus);
-}
-
-void NavPath::processTick(const Move *move)
-{
-   if(dtStatusInProgress(mStatus))
-      update();
+   return success;
 }
 
 Point3F NavPath::getNode(S32 idx)
@@ -600,10 +546,25 @@ void NavPath::unpackUpdate(NetConnection *conn, BitStream *stream)
    }
 }
 
-DefineEngineMethod(NavPath, replan, bool, (),,
-   "@brief Find a path using the already-specified path properties.")
+DefineEngineMethod(NavPath, replan, bool, (bool async, F32 priority), (false, 1.0f),
+   "@brief Find a path using the already-specified path properties.\n\n"
+   "@param async Plan the path on worker threads. onPlanComplete is called when it is done.\n"
+   "@param priority Priority of the path's queries relative to other asynchronous queries.\n"
+   "@return True if the path was found, or was submitted for planning.")
+{
+   return object->plan(async, priority);
+}
+
+DefineEngineMethod(NavPath, cancelPlan, void, (),,
+   "@brief Abandon an asynchronous plan in progress.")
+{
+   object->cancelPlan();
+}
+
+DefineEngineMethod(NavPath, isPlanning, bool, (),,
+   "@brief Return true if an asynchronous plan is in progress.")
 {
-   return object->plan();
+   return object->isPlanning();
 }
 
 DefineEngineMethod(NavPath, getCount, S32, (),,
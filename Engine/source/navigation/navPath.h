@@ -26,12 +26,10 @@
 #include "scene/sceneObject.h"
 #include "scene/simPath.h"
 #include "navMesh.h"
-#include <DetourNavMeshQuery.h>
+#include "navPathQuery.h"
 
 class NavPath: public SceneObject {
    typedef SceneObject Parent;
-   /// Maximum size of Detour path.
-   static const U32 MaxPathLen = 1024;
 
 public:
    /// @name NavPath
@@ -59,15 +57,18 @@ public:
    bool mXray;
 
    /// Plan the path.
-   bool plan();
+   /// @param[in] async    Plan on worker threads and call onPlanComplete
+   ///                     when done, rather than blocking.
+   /// @param[in] priority Priority of the path queries when planning
+   ///                     asynchronously.
+   /// @return True if the path was found, or the queries were submitted.
+   bool plan(bool async = false, F32 priority = 1.0f);
 
-   /// Updated a sliced plan.
-   /// @return True if we need to keep updating, false if we can stop.
-   bool update();
+   /// Abandon an asynchronous plan in progress.
+   void cancelPlan();
 
-   /// Finalise a sliced plan.
-   /// @return True if the plan was successful overall.
-   bool finalise();
+   /// Is an asynchronous plan in progress?
+   bool isPlanning() const { return mLegs.size() > 0; }
 
    /// @}
 
@@ -107,14 +108,10 @@ public:
    void renderSimple(ObjectRenderInst *ri, SceneRenderState *state, BaseMatInstance *overrideMat);
 
    DECLARE_CONOBJECT(NavPath);
+   DECLARE_CALLBACK(void, onPlanComplete, (bool success));
 
    /// @}
 
-   /// @name ProcessObject
-   /// @{
-   void processTick(const Move *move);
-   /// @}
-
    NavPath();
    ~NavPath();
 
@@ -128,16 +125,16 @@ private:
    /// Create appropriate data structures and stuff.
    bool init();
 
-   /// 'Visit' the most recent two points on our visit list.
-   bool visitNext();
+   /// Queries for each leg of the journey between visit points, in order.
+   Vector<NavPathQueryRef> mLegs;
+
+   /// Called when an asynchronous leg query finishes.
+   void onLegComplete(NavPathQuery *query);
+
+   /// Join the planned legs into our point list.
+   /// @return True if every leg was planned successfully.
+   bool finishPlan();
 
-   /// Detour path query.
-   dtNavMeshQuery *mQuery;
-   /// Current status of our Detour query.
-   dtStatus mStatus;
-   /// Filter that provides the movement costs for paths.
-   dtQueryFilter mFilter;
-   
    /// List of points the path should visit (waypoints, if you will).
    Vector<Point3F> mVisitPoints;
    /// List of points in the final path.
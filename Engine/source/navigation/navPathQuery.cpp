@@ -0,0 +1,598 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "navPathQuery.h"
+#include "navMesh.h"
+
+#include "console/consoleTypes.h"
+#include "console/engineAPI.h"
+#include "core/module.h"
+#include "core/util/journal/process.h"
+#include "platform/profiler.h"
+#include "platform/threads/threadPoolJob.h"
+
+/// Maximum number of polygons in a path corridor.
+static const S32 MaxPathLen = 1024;
+
+/// Size of the Detour node pool of each query object.
+static const S32 MaxQueryNodes = 2048;
+
+S32 NavPathQueryManager::smNumWorkers = 4;
+S32 NavPathQueryManager::smIterationsPerSlice = 256;
+S32 NavPathQueryManager::smCacheSize = 64;
+
+MODULE_BEGIN( NavPathQueryManager )
+
+   MODULE_INIT_AFTER( Sim )
+   MODULE_SHUTDOWN_AFTER( Sim )
+
+   MODULE_INIT
+   {
+      ManagedSingleton< NavPathQueryManager >::createSingleton();
+
+      Con::addVariable( "$Nav::PathQueryWorkers", TypeS32, &NavPathQueryManager::smNumWorkers,
+         "@brief Number of path queries planned concurrently on worker threads.\n" );
+      Con::addVariable( "$Nav::PathQueryIterations", TypeS32, &NavPathQueryManager::smIterationsPerSlice,
+         "@brief Detour search iterations a worker runs on a path query each frame.\n" );
+      Con::addVariable( "$Nav::PathCacheSize", TypeS32, &NavPathQueryManager::smCacheSize,
+         "@brief Number of recent start/end tile pairs whose paths are cached.\n" );
+   }
+
+   MODULE_SHUTDOWN
+   {
+      ManagedSingleton< NavPathQueryManager >::deleteSingleton();
+   }
+
+MODULE_END;
+
+//-----------------------------------------------------------------------------
+// NavPathQuery
+//-----------------------------------------------------------------------------
+
+NavPathQuery::NavPathQuery(NavMesh *mesh, const Point3F &from, const Point3F &to, F32 priority)
+   : mNavMesh(mesh ? mesh->getNavMesh() : NULL),
+     mFrom(from),
+     mTo(to),
+     mPriority(priority),
+     mSequence(0),
+     mCancelled(0),
+     mStatus(Pending),
+     mStarted(false),
+     mFinished(false),
+     mStartRef(0),
+     mEndRef(0),
+     mDetourStatus(0),
+     mError(NULL),
+     mLength(0.0f),
+     mCached(false)
+{
+   // Convert to Detour-friendly coordinates.
+   const Point3F start = DTStoRC(from);
+   const Point3F end = DTStoRC(to);
+   rcVcopy(mStartPos, start);
+   rcVcopy(mEndPos, end);
+
+   mStartTile[0] = mStartTile[1] = mEndTile[0] = mEndTile[1] = -1;
+   if(mNavMesh)
+   {
+      mNavMesh->calcTileLoc(mStartPos, &mStartTile[0], &mStartTile[1]);
+      mNavMesh->calcTileLoc(mEndPos, &mEndTile[0], &mEndTile[1]);
+   }
+}
+
+NavPathQuery::~NavPathQuery()
+{
+}
+
+void NavPathQuery::cancel()
+{
+   dCompareAndSwap(mCancelled, 0, 1);
+}
+
+//-----------------------------------------------------------------------------
+// Planning
+//-----------------------------------------------------------------------------
+
+void NavPathQueryManager::_fail(NavPathQuery *query, const char *error)
+{
+   query->mError = error;
+   query->mPoints.clear();
+   query->mFinished = true;
+}
+
+void NavPathQueryManager::_plan(dtNavMeshQuery *dtQuery, NavPathQuery *query, S32 maxIterations)
+{
+   if(query->mFinished)
+      return;
+
+   if(dAtomicRead(query->mCancelled))
+   {
+      query->mFinished = true;
+      return;
+   }
+
+   if(!query->mNavMesh)
+   {
+      _fail(query, "NavMesh has not been built");
+      return;
+   }
+
+   if(!query->mStarted)
+   {
+      query->mStarted = true;
+
+      if(dtStatusFailed(dtQuery->init(query->mNavMesh, MaxQueryNodes)))
+      {
+         _fail(query, "Could not initialise dtNavMeshQuery");
+         return;
+      }
+
+      // Find the polygons nearest our endpoints.
+      F32 extents[] = {1.0f, 1.0f, 1.0f};
+      if(dtStatusFailed(dtQuery->findNearestPoly(query->mStartPos, extents, &query->mFilter,
+            &query->mStartRef, query->mStartPos)) || !query->mStartRef)
+      {
+         _fail(query, "No NavMesh polygon near start point");
+         return;
+      }
+      if(dtStatusFailed(dtQuery->findNearestPoly(query->mEndPos, extents, &query->mFilter,
+            &query->mEndRef, query->mEndPos)) || !query->mEndRef)
+      {
+         _fail(query, "No NavMesh polygon near end point");
+         return;
+      }
+
+      // If a recent path between the same tiles passes through both our
+      // polygons, its corridor is good enough for us.
+      const Vector<dtPolyRef> &cached = query->mCachedCorridor;
+      S32 first = -1, last = -1;
+      for(S32 i = 0; i < cached.size(); i++)
+      {
+         if(first < 0 && cached[i] == query->mStartRef)
+            first = i;
+         if(first >= 0 && cached[i] == query->mEndRef)
+         {
+            last = i;
+            break;
+         }
+      }
+      if(first >= 0 && last >= first)
+      {
+         query->mCorridor.set(cached.address() + first, last - first + 1);
+         query->mCached = true;
+      }
+      else
+      {
+         // Init sliced pathfind.
+         query->mDetourStatus = dtQuery->initSlicedFindPath(query->mStartRef, query->mEndRef,
+            query->mStartPos, query->mEndPos, &query->mFilter);
+         if(dtStatusFailed(query->mDetourStatus))
+         {
+            _fail(query, "Could not start path search");
+            return;
+         }
+      }
+      query->mCachedCorridor.clear();
+   }
+
+   if(!query->mCached)
+   {
+      // StatusInProgress means a query is underway.
+      if(dtStatusInProgress(query->mDetourStatus))
+         query->mDetourStatus = dtQuery->updateSlicedFindPath(maxIterations, NULL);
+      if(dtStatusInProgress(query->mDetourStatus))
+         return;
+      if(dtStatusFailed(query->mDetourStatus))
+      {
+         _fail(query, "Path search failed");
+         return;
+      }
+
+      // Finalize the path. Need to use the static path length cap again.
+      dtPolyRef path[MaxPathLen];
+      S32 pathLen = 0;
+      query->mDetourStatus = dtQuery->finalizeSlicedFindPath(path, &pathLen, MaxPathLen);
+      // Apparently stuff can go wrong during finalizing, so check the status again.
+      if(dtStatusFailed(query->mDetourStatus) || !pathLen)
+      {
+         _fail(query, "Could not finalise path");
+         return;
+      }
+      query->mCorridor.set(path, pathLen);
+   }
+
+   // Straighten out the path.
+   F32 straightPath[MaxPathLen * 3];
+   S32 straightPathLen = 0;
+   dtPolyRef straightPathPolys[MaxPathLen];
+   U8 straightPathFlags[MaxPathLen];
+   dtQuery->findStraightPath(query->mStartPos, query->mEndPos,
+      query->mCorridor.address(), query->mCorridor.size(),
+      straightPath, straightPathFlags,
+      straightPathPolys, &straightPathLen, MaxPathLen);
+
+   // Convert Detour point path to list of Torque points.
+   query->mPoints.setSize(straightPathLen);
+   query->mLength = 0.0f;
+   for(S32 i = 0; i < straightPathLen; i++)
+   {
+      query->mPoints[i] = RCtoDTS(straightPath + i * 3);
+      if(i > 0)
+         query->mLength += (query->mPoints[i] - query->mPoints[i-1]).len();
+   }
+
+   query->mFinished = true;
+}
+
+//-----------------------------------------------------------------------------
+// NavPathQueryManager
+//-----------------------------------------------------------------------------
+
+/// Advances a single query by one slice on a worker thread.
+struct NavPathQueryManager::SliceJob : public ThreadPoolJob
+{
+   dtNavMeshQuery *dtQuery;
+   NavPathQueryRef query;
+   S32 maxIterations;
+
+   SliceJob(dtNavMeshQuery *_dtQuery, NavPathQuery *_query, S32 _maxIterations)
+      : dtQuery(_dtQuery), query(_query), maxIterations(_maxIterations)
+   {
+   }
+
+protected:
+   virtual void run()
+   {
+      _plan(dtQuery, query, maxIterations);
+   }
+};
+
+NavPathQueryManager::NavPathQueryManager()
+   : mNextSequence(0),
+     mCacheClock(0)
+{
+   VECTOR_SET_ASSOCIATION(mQueue);
+   VECTOR_SET_ASSOCIATION(mWorkers);
+   VECTOR_SET_ASSOCIATION(mCache);
+
+   mMainQuery = dtAllocNavMeshQuery();
+
+   Process::notify(this, &NavPathQueryManager::_process, PROCESS_DEFAULT_ORDER);
+}
+
+NavPathQueryManager::~NavPathQueryManager()
+{
+   Process::remove(this, &NavPathQueryManager::_process);
+
+   _waitForWorkers();
+
+   for(S32 i = 0; i < mWorkers.size(); i++)
+   {
+      if(mWorkers[i].active)
+         mWorkers[i].active->cancel();
+      dtFreeNavMeshQuery(mWorkers[i].query);
+   }
+   mWorkers.clear();
+
+   for(S32 i = 0; i < mQueue.size(); i++)
+      mQueue[i]->cancel();
+   mQueue.clear();
+
+   dtFreeNavMeshQuery(mMainQuery);
+   mMainQuery = NULL;
+}
+
+void NavPathQueryManager::submit(NavPathQuery *query)
+{
+   AssertFatal(query && !query->mStarted, "NavPathQueryManager::submit - Query has already been planned!");
+
+   query->mSequence = mNextSequence++;
+   mStats.submitted++;
+
+   // Keep the queue sorted so the most important, oldest query is last.
+   S32 i = 0;
+   for(; i < mQueue.size(); i++)
+   {
+      const NavPathQuery *other = mQueue[i];
+      if(other->mPriority > query->mPriority ||
+         (other->mPriority == query->mPriority && other->mSequence < query->mSequence))
+         break;
+   }
+   mQueue.insert(i, query);
+}
+
+bool NavPathQueryManager::findPath(NavPathQuery *query)
+{
+   AssertFatal(query && !query->mStarted, "NavPathQueryManager::findPath - Query has already been planned!");
+
+   query->mSequence = mNextSequence++;
+   mStats.submitted++;
+
+   _lookupCache(query);
+   _plan(mMainQuery, query, S32_MAX);
+   _complete(query);
+
+   return query->isSuccess();
+}
+
+void NavPathQueryManager::_process()
+{
+   PROFILE_SCOPE(NavPathQueryManager_Process);
+
+   _updateWorkers();
+
+   for(S32 i = 0; i < mWorkers.size(); i++)
+   {
+      Worker &worker = mWorkers[i];
+
+      // Collect the slice we started last frame.
+      if(worker.job)
+      {
+         if(!worker.job->isFinished())
+            continue;
+         _collect(worker);
+      }
+
+      // Pick up the next query if we're idle.
+      while(!worker.active && mQueue.size())
+      {
+         NavPathQueryRef query = mQueue.last();
+         mQueue.pop_back();
+         if(dAtomicRead(query->mCancelled))
+         {
+            _complete(query);
+            continue;
+         }
+         _lookupCache(query);
+         worker.active = query;
+      }
+
+      if(worker.active)
+      {
+         worker.job = new SliceJob(worker.query, worker.active, getMax(smIterationsPerSlice, 1));
+         ThreadPool::GLOBAL().queueWorkItem(worker.job);
+         mStats.slices++;
+      }
+   }
+}
+
+void NavPathQueryManager::_updateWorkers()
+{
+   const S32 numWorkers = getMax(smNumWorkers, 1);
+
+   while(mWorkers.size() < numWorkers)
+   {
+      mWorkers.increment();
+      mWorkers.last().query = dtAllocNavMeshQuery();
+   }
+
+   // Only idle slots can be retired.
+   while(mWorkers.size() > numWorkers && !mWorkers.last().active && !mWorkers.last().job)
+   {
+      dtFreeNavMeshQuery(mWorkers.last().query);
+      mWorkers.pop_back();
+   }
+}
+
+void NavPathQueryManager::_waitForWorkers()
+{
+   for(S32 i = 0; i < mWorkers.size(); i++)
+   {
+      if(mWorkers[i].job)
+         mWorkers[i].job->waitForFinish();
+   }
+}
+
+void NavPathQueryManager::_collect(Worker &worker)
+{
+   worker.job = NULL;
+
+   if(worker.active && worker.active->mFinished)
+   {
+      NavPathQueryRef query = worker.active;
+      worker.active = NULL;
+      _complete(query);
+   }
+}
+
+void NavPathQueryManager::_complete(NavPathQuery *query)
+{
+   query->mCachedCorridor.clear();
+
+   if(dAtomicRead(query->mCancelled))
+   {
+      query->mStatus = NavPathQuery::Cancelled;
+      return;
+   }
+
+   if(query->mPoints.size())
+   {
+      query->mStatus = NavPathQuery::Succeeded;
+      mStats.succeeded++;
+      if(query->mCached)
+         mStats.cacheHits++;
+      else
+         _storeCache(query);
+   }
+   else
+   {
+      query->mStatus = NavPathQuery::Failed;
+      mStats.failed++;
+   }
+
+   if(!query->mOnComplete.empty())
+      query->mOnComplete(query);
+}
+
+void NavPathQueryManager::_lookupCache(NavPathQuery *query)
+{
+   if(!query->mNavMesh)
+      return;
+
+   for(S32 i = 0; i < mCache.size(); i++)
+   {
+      CacheEntry &entry = mCache[i];
+      if(entry.mesh == query->mNavMesh &&
+         entry.startTile[0] == query->mStartTile[0] && entry.startTile[1] == query->mStartTile[1] &&
+         entry.endTile[0] == query->mEndTile[0] && entry.endTile[1] == query->mEndTile[1])
+      {
+         entry.lastUsed = ++mCacheClock;
+         query->mCachedCorridor = entry.corridor;
+         return;
+      }
+   }
+}
+
+void NavPathQueryManager::_storeCache(NavPathQuery *query)
+{
+   if(smCacheSize <= 0)
+   {
+      mCache.clear();
+      return;
+   }
+
+   // Don't remember partial paths.
+   if(!query->mCorridor.size() || query->mCorridor.last() != query->mEndRef)
+      return;
+
+   // Reuse the entry for this tile pair if we have one.
+   CacheEntry *entry = NULL;
+   for(S32 i = 0; i < mCache.size(); i++)
+   {
+      CacheEntry &e = mCache[i];
+      if(e.mesh == query->mNavMesh &&
+         e.startTile[0] == query->mStartTile[0] && e.startTile[1] == query->mStartTile[1] &&
+         e.endTile[0] == query->mEndTile[0] && e.endTile[1] == query->mEndTile[1])
+      {
+         entry = &e;
+         break;
+      }
+   }
+
+   if(!entry)
+   {
+      if(mCache.size() < smCacheSize)
+      {
+         mCache.increment();
+         entry = &mCache.last();
+      }
+      else
+      {
+         // Evict the least recently used pair.
+         while(mCache.size() > smCacheSize)
+            mCache.pop_back();
+         entry = &mCache[0];
+         for(S32 i = 1; i < mCache.size(); i++)
+         {
+            if(mCache[i].lastUsed < entry->lastUsed)
+               entry = &mCache[i];
+         }
+      }
+   }
+
+   entry->mesh = query->mNavMesh;
+   entry->startTile[0] = query->mStartTile[0];
+   entry->startTile[1] = query->mStartTile[1];
+   entry->endTile[0] = query->mEndTile[0];
+   entry->endTile[1] = query->mEndTile[1];
+   entry->corridor = query->mCorridor;
+   entry->lastUsed = ++mCacheClock;
+}
+
+void NavPathQueryManager::_flushCache(const dtNavMesh *mesh)
+{
+   for(S32 i = 0; i < mCache.size();)
+   {
+      if(mCache[i].mesh == mesh)
+         mCache.erase_fast(i);
+      else
+         i++;
+   }
+}
+
+void NavPathQueryManager::lockMesh(const dtNavMesh *mesh)
+{
+   NavPathQueryManager *manager = ManagedSingleton<NavPathQueryManager>::instanceOrNull();
+   if(manager && mesh)
+      manager->_waitForWorkers();
+}
+
+void NavPathQueryManager::onMeshChanged(const dtNavMesh *mesh)
+{
+   NavPathQueryManager *manager = ManagedSingleton<NavPathQueryManager>::instanceOrNull();
+   if(manager && mesh)
+      manager->_flushCache(mesh);
+}
+
+void NavPathQueryManager::onMeshFreed(const dtNavMesh *mesh)
+{
+   NavPathQueryManager *manager = ManagedSingleton<NavPathQueryManager>::instanceOrNull();
+   if(!manager || !mesh)
+      return;
+
+   manager->_waitForWorkers();
+   manager->_flushCache(mesh);
+
+   // Fail everything that still refers to the mesh.
+   Vector<NavPathQueryRef> failed;
+   for(S32 i = 0; i < manager->mWorkers.size(); i++)
+   {
+      Worker &worker = manager->mWorkers[i];
+      if(worker.job)
+         manager->_collect(worker);
+      if(worker.active && worker.active->mNavMesh == mesh)
+      {
+         failed.push_back(worker.active);
+         worker.active = NULL;
+      }
+   }
+   for(S32 i = 0; i < manager->mQueue.size();)
+   {
+      if(manager->mQueue[i]->mNavMesh == mesh)
+      {
+         failed.push_back(manager->mQueue[i]);
+         manager->mQueue.erase(i);
+      }
+      else
+         i++;
+   }
+
+   for(S32 i = 0; i < failed.size(); i++)
+   {
+      NavPathQuery *query = failed[i];
+      query->mNavMesh = NULL;
+      _fail(query, "NavMesh was rebuilt or deleted");
+      manager->_complete(query);
+   }
+}
+
+DefineEngineFunction(getNavPathQueryStats, const char*, (),,
+   "@brief Get statistics for the path query service.\n\n"
+   "@return A string of the form \"submitted succeeded failed cacheHits slices queued\".")
+{
+   const NavPathQueryManager::Stats &stats = NAVQUERIES->getStats();
+   char *ret = Con::getReturnBuffer(128);
+   dSprintf(ret, 128, "%d %d %d %d %d %d",
+      stats.submitted, stats.succeeded, stats.failed,
+      stats.cacheHits, stats.slices, NAVQUERIES->getQueueSize());
+   return ret;
+}
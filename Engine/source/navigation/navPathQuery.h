@@ -0,0 +1,280 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _NAVPATHQUERY_H_
+#define _NAVPATHQUERY_H_
+
+#include "torqueRecast.h"
+#include "math/mPoint3.h"
+#include "core/util/tVector.h"
+#include "core/util/delegate.h"
+#include "core/util/tSingleton.h"
+#include "platform/threads/threadSafeRefCount.h"
+
+#include <DetourNavMesh.h>
+#include <DetourNavMeshQuery.h>
+
+class NavMesh;
+
+/// @class NavPathQuery
+/// A request for a path between two points on a NavMesh. Queries are
+/// submitted to the NavPathQueryManager, which plans them on worker threads
+/// and calls mOnComplete on the main thread once they finish.
+/// @see NavPathQueryManager
+class NavPathQuery : public ThreadSafeRefCount<NavPathQuery> {
+   friend class NavPathQueryManager;
+
+public:
+   enum Status {
+      /// Waiting in the queue or being planned.
+      Pending,
+      /// A path was found. It may be partial if the goal is unreachable.
+      Succeeded,
+      /// No path could be found.
+      Failed,
+      /// The query was cancelled or its NavMesh went away.
+      Cancelled,
+   };
+
+   typedef Delegate<void(NavPathQuery*)> CompletionDelegate;
+
+   /// Create a query from one world-space point to another.
+   /// @param[in] mesh     NavMesh to plan on. Must have been built or loaded.
+   /// @param[in] from     Start position.
+   /// @param[in] to       Goal position.
+   /// @param[in] priority Queries with higher priority are planned first.
+   NavPathQuery(NavMesh *mesh, const Point3F &from, const Point3F &to, F32 priority = 1.0f);
+   ~NavPathQuery();
+
+   /// Called on the main thread when the query finishes, unless cancelled.
+   CompletionDelegate mOnComplete;
+
+   /// Filter that provides the movement costs for the path.
+   dtQueryFilter mFilter;
+
+   /// Abandon the query. mOnComplete will not be called.
+   void cancel();
+
+   /// @name Results
+   /// @{
+
+   Status getStatus() const { return mStatus; }
+   bool isDone() const { return mStatus != Pending; }
+   bool isSuccess() const { return mStatus == Succeeded; }
+
+   /// World-space points of the straightened path.
+   const Vector<Point3F> &getPoints() const { return mPoints; }
+
+   /// Length of the path in world units.
+   F32 getLength() const { return mLength; }
+
+   /// Was this path taken from the cache of recent tile pairs?
+   bool isCached() const { return mCached; }
+
+   /// Reason the query failed, or NULL.
+   const char *getError() const { return mError; }
+
+   /// @}
+
+   const Point3F &getFrom() const { return mFrom; }
+   const Point3F &getTo() const { return mTo; }
+   F32 getPriority() const { return mPriority; }
+
+private:
+   /// Detour mesh to plan on.
+   const dtNavMesh *mNavMesh;
+   /// Request parameters.
+   Point3F mFrom, mTo;
+   F32 mPriority;
+   /// Submission order, used to keep equal priorities first-come first-served.
+   U32 mSequence;
+   /// Set from any thread to abandon the query.
+   volatile U32 mCancelled;
+
+   /// Current status, only changed on the main thread.
+   Status mStatus;
+
+   /// @name Planning state
+   /// Only touched by the thread currently planning the query.
+   /// @{
+
+   /// Has the sliced query been started?
+   bool mStarted;
+   /// Has planning finished, successfully or not?
+   bool mFinished;
+   /// Detour start and end positions and polygons.
+   F32 mStartPos[3], mEndPos[3];
+   dtPolyRef mStartRef, mEndRef;
+   /// Status of the Detour sliced query.
+   dtStatus mDetourStatus;
+   /// Tiles containing the start and end points.
+   S32 mStartTile[2], mEndTile[2];
+   /// Polygon corridor offered by the cache, if any.
+   Vector<dtPolyRef> mCachedCorridor;
+   /// Polygon corridor of the final path.
+   Vector<dtPolyRef> mCorridor;
+   /// Reason for failure, if any.
+   const char *mError;
+
+   /// @}
+
+   Vector<Point3F> mPoints;
+   F32 mLength;
+   bool mCached;
+};
+
+typedef ThreadSafeRef<NavPathQuery> NavPathQueryRef;
+
+/// @class NavPathQueryManager
+/// Plans NavPathQuery requests on the global thread pool. Each worker slot
+/// owns a dtNavMeshQuery and advances one query at a time using Detour's
+/// sliced pathfinding, so a single long path never holds up the queue and
+/// the main thread only ever collects results.
+///
+/// NavMeshes call lockMesh() before modifying their dtNavMesh. Workers are
+/// only started from the manager's per-frame update, so once lockMesh()
+/// returns no worker touches the mesh until the next frame.
+class NavPathQueryManager {
+public:
+   NavPathQueryManager();
+   ~NavPathQueryManager();
+
+   /// For ManagedSingleton.
+   static const char* getSingletonName() { return "NavPathQueryManager"; }
+
+   /// Queue a query for planning on a worker thread.
+   void submit(NavPathQuery *query);
+
+   /// Plan a query to completion on the calling thread. Calls the query's
+   /// callback before returning.
+   /// @return True if a path was found.
+   bool findPath(NavPathQuery *query);
+
+   /// Number of queries waiting for a worker.
+   U32 getQueueSize() const { return mQueue.size(); }
+
+   /// @name NavMesh notifications
+   /// @{
+
+   /// Wait for workers to release a mesh so that it can be modified.
+   static void lockMesh(const dtNavMesh *mesh);
+
+   /// Drop cached paths for a mesh whose tiles have changed.
+   static void onMeshChanged(const dtNavMesh *mesh);
+
+   /// Cancel all queries on a mesh that is about to be freed.
+   static void onMeshFreed(const dtNavMesh *mesh);
+
+   /// @}
+
+   /// Running totals since startup.
+   struct Stats {
+      U32 submitted;
+      U32 succeeded;
+      U32 failed;
+      U32 cacheHits;
+      U32 slices;
+      Stats() { dMemset(this, 0, sizeof(*this)); }
+   };
+
+   const Stats &getStats() const { return mStats; }
+
+   /// @name Tuning
+   /// @{
+
+   /// Number of worker slots, i.e. queries planned concurrently.
+   static S32 smNumWorkers;
+   /// Detour iterations run by a worker per slice.
+   static S32 smIterationsPerSlice;
+   /// Number of tile pairs kept in the path cache.
+   static S32 smCacheSize;
+
+   /// @}
+
+protected:
+   struct SliceJob;
+   typedef ThreadSafeRef<SliceJob> SliceJobRef;
+
+   /// A worker slot with its own Detour query object.
+   struct Worker {
+      dtNavMeshQuery *query;
+      /// Query being planned by this slot.
+      NavPathQueryRef active;
+      /// Slice currently on the thread pool, if any.
+      SliceJobRef job;
+   };
+
+   /// Corridor of a recently planned path between two tiles.
+   struct CacheEntry {
+      const dtNavMesh *mesh;
+      S32 startTile[2], endTile[2];
+      Vector<dtPolyRef> corridor;
+      U32 lastUsed;
+   };
+
+   Vector<NavPathQueryRef> mQueue;
+   Vector<Worker> mWorkers;
+   Vector<CacheEntry> mCache;
+
+   /// Query object used by findPath on the main thread.
+   dtNavMeshQuery *mMainQuery;
+
+   U32 mNextSequence;
+   U32 mCacheClock;
+   Stats mStats;
+
+   /// Per-frame update: collect finished slices and start new ones.
+   void _process();
+
+   /// Make sure we have smNumWorkers slots.
+   void _updateWorkers();
+
+   /// Wait for all slices on the thread pool to finish.
+   void _waitForWorkers();
+
+   /// Handle a worker whose slice has finished.
+   void _collect(Worker &worker);
+
+   /// Convert a finished query's results and call its callback.
+   void _complete(NavPathQuery *query);
+
+   /// Copy a cached corridor into a query, if one exists for its tiles.
+   void _lookupCache(NavPathQuery *query);
+
+   /// Remember the corridor of a successful query.
+   void _storeCache(NavPathQuery *query);
+
+   /// Drop all cached corridors for a mesh.
+   void _flushCache(const dtNavMesh *mesh);
+
+   /// Finish a query unsuccessfully.
+   static void _fail(NavPathQuery *query, const char *error);
+
+   /// Advance a query by up to maxIterations Detour iterations.
+   /// Safe to call on any thread.
+   static void _plan(dtNavMeshQuery *dtQuery, NavPathQuery *query, S32 maxIterations);
+};
+
+/// Returns the NavPathQueryManager singleton.
+#define NAVQUERIES ManagedSingleton<NavPathQueryManager>::instance()
+
+#endif
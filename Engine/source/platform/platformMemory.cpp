@@ -21,6 +21,7 @@
 //-----------------------------------------------------------------------------
 
 #include "platform/platformMemory.h"
+#include "platform/platformSlabAllocator.h"
 #include "console/dynamicTypes.h"
 #include "console/engineAPI.h"
 #include "core/stream/fileStream.h"
@@ -1574,6 +1575,9 @@ static void* realloc(void* mem, dsize_t size, const char* fileName, const U32 li
 
 dsize_t getMemoryUsed()
 {
+#ifdef TORQUE_SLAB_ALLOCATOR
+   return SlabAllocator::getBytesInUse();
+#else
    U32 size = 0;
 
    PageRecord* walk;
@@ -1585,6 +1589,7 @@ dsize_t getMemoryUsed()
    }
 
    return size;
+#endif
 }
 
 #ifdef TORQUE_DEBUG_GUARD
@@ -1672,7 +1677,11 @@ DefineEngineFunction( dumpMemSnapshot, void, ( const char* fileName ),,
 
 dsize_t getMemoryAllocated()
 {
+#ifdef TORQUE_SLAB_ALLOCATOR
+   return SlabAllocator::getBytesMapped();
+#else
    return 0;
+#endif
 }
 
 void getMemoryInfo( void* ptr, Info& info )
@@ -1715,7 +1724,59 @@ void setMinimumAllocUnit(U32 allocUnit)
 
 //---------------------------------------------------------------------------
 
+#if defined(TORQUE_SLAB_ALLOCATOR)
+
+// Serve everything from the size-class slab allocator.  File and line are
+// dropped; use SlabAllocator::TagScope for per subsystem accounting.
+
 #if !defined(TORQUE_DISABLE_MEMORY_MANAGER)
+void* FN_CDECL operator new(dsize_t size, const char* fileName, const U32 line)
+{
+   return SlabAllocator::alloc(size);
+}
+
+void* FN_CDECL operator new[](dsize_t size, const char* fileName, const U32 line)
+{
+   return SlabAllocator::alloc(size);
+}
+#endif
+
+void* FN_CDECL operator new(dsize_t size)
+{
+   return SlabAllocator::alloc(size);
+}
+
+void* FN_CDECL operator new[](dsize_t size)
+{
+   return SlabAllocator::alloc(size);
+}
+
+void FN_CDECL operator delete(void* mem)
+{
+   SlabAllocator::free(mem);
+}
+
+void FN_CDECL operator delete[](void* mem)
+{
+   SlabAllocator::free(mem);
+}
+
+void* dMalloc_r(dsize_t in_size, const char* fileName, const dsize_t line)
+{
+   return SlabAllocator::alloc(in_size);
+}
+
+void dFree(void* in_pFree)
+{
+   SlabAllocator::free(in_pFree);
+}
+
+void* dRealloc_r(void* in_pResize, dsize_t in_size, const char* fileName, const dsize_t line)
+{
+   return SlabAllocator::realloc(in_pResize, in_size);
+}
+
+#elif !defined(TORQUE_DISABLE_MEMORY_MANAGER)
 
 // Manage our own memory, add overloaded memory operators and functions
 
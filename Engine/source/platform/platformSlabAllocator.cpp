@@ -0,0 +1,786 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "platform/platformSlabAllocator.h"
+
+#include "platform/platformTLS.h"
+#include "platform/platformIntrinsics.h"
+#include "core/strings/stringFunctions.h"
+#include "console/engineAPI.h"
+
+#include <stddef.h>
+
+#if defined(TORQUE_OS_WIN32)
+#  include "platformWin32/platformWin32.h"
+#elif defined(TORQUE_OS_LINUX) || defined(TORQUE_OS_MAC)
+#  include <sys/mman.h>
+#  define TORQUE_SLAB_USE_MMAP
+#endif
+
+// Everything in here sits below operator new.
+#ifdef new
+#undef new
+#endif
+
+namespace SlabAllocator
+{
+
+enum
+{
+   SlabMagic         = 0x51ABB10C,
+   LargeMagic        = 0x1A26EB10,
+   LargeHeaderSize   = 64,
+   MinCachedBlocks   = 4,
+   MaxCachedBlocks   = 128,
+   CacheBytesPerClass = 32 * 1024,
+};
+
+static const U32 sgClassSizes[ NumSizeClasses ] =
+{
+   16,    32,    48,    64,    80,    96,    112,   128,
+   160,   192,   224,   256,   320,   384,   448,   512,
+   640,   768,   896,   1024,  1280,  1536,  1792,  2048,
+   2560,  3072,  3584,  4096,  5120,  6144,  7168,  8192,
+   10240, 12288, 14336, 16384
+};
+
+/// Minimal lock for the central pools.  The platform mutex allocates with
+/// operator new so it cannot be used down here.
+struct SpinLock
+{
+   volatile U32 mLocked;
+
+   void lock()
+   {
+      while( !dCompareAndSwap( mLocked, 0, 1 ) )
+         while( mLocked ) {}
+   }
+
+   void unlock()
+   {
+      dCompareAndSwap( mLocked, 1, 0 );
+   }
+};
+
+struct SpinLockScope
+{
+   SpinLock& mLock;
+   SpinLockScope( SpinLock& lock ) : mLock( lock ) { mLock.lock(); }
+   ~SpinLockScope() { mLock.unlock(); }
+};
+
+struct FreeBlock
+{
+   FreeBlock* next;
+};
+
+/// Header at the start of every SlabSize aligned slab.  The per block tag
+/// array follows it and the blocks themselves start at blocksOffset.
+struct Slab
+{
+   U32 magic;
+   U32 classIndex;
+   void* osBase;
+   dsize_t osSize;
+   FreeBlock* freeList;
+   U32 numFree;
+   Slab* prev;
+   Slab* next;
+   U8* blocks;
+   U8 tags[ 1 ];
+};
+
+/// Header at the start of a block mapped for a single large allocation.
+struct LargeBlock
+{
+   U32 magic;
+   U32 tag;
+   void* osBase;
+   dsize_t osSize;
+   dsize_t size;
+};
+
+struct SizeClass
+{
+   SpinLock lock;
+   U32 blockSize;
+   U32 blocksPerSlab;
+   U32 blocksOffset;
+   U32 cacheLimit;
+   U32 batchSize;
+
+   /// Slabs with at least one free block.
+   Slab* partial;
+   U32 numSlabs;
+   U32 numEmptySlabs;
+   U32 freeBlocks;
+};
+
+/// Per-thread block cache and accounting.
+struct ThreadCache
+{
+   FreeBlock* lists[ NumSizeClasses ];
+   U32 counts[ NumSizeClasses ];
+   U64 classAllocs[ NumSizeClasses ];
+
+   S64 tagBytes[ MaxTags ];
+   S64 tagAllocs[ MaxTags ];
+   U64 tagTotal[ MaxTags ];
+
+   U32 tag;
+   ThreadCache* prev;
+   ThreadCache* next;
+};
+
+static bool sgInitialized = false;
+static SpinLock sgGlobalLock;
+static SizeClass sgClasses[ NumSizeClasses ];
+static U8 sgClassLookup[ ( MaxSmallSize >> 4 ) + 1 ];
+
+static ThreadStorage* sgThreadCache = NULL;
+static U8 sgThreadCacheStorage[ sizeof( ThreadStorage ) + 16 ];
+
+/// All live thread caches plus the totals of the ones that have been
+/// flushed, both under sgGlobalLock.
+static ThreadCache* sgCacheList = NULL;
+static ThreadCache sgRetired;
+
+static const char* sgTagNames[ MaxTags ];
+static U32 sgNumTags = 0;
+
+static volatile U32 sgSlabCount = 0;
+static volatile U32 sgLargeCount = 0;
+static volatile U32 sgLargeKBytes = 0;
+
+//-----------------------------------------------------------------------------
+//    OS pages.
+//-----------------------------------------------------------------------------
+
+/// Map @a size bytes aligned to SlabSize so block headers can be found by
+/// masking the pointer.
+static U8* osMap( dsize_t size, void*& outBase, dsize_t& outSize )
+{
+#if defined( TORQUE_OS_WIN32 )
+   // VirtualAlloc reservations are already 64k aligned.
+   outSize = size;
+   outBase = VirtualAlloc( NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+   return ( U8* ) outBase;
+#elif defined( TORQUE_SLAB_USE_MMAP )
+   dsize_t mapSize = size + SlabSize;
+   U8* base = ( U8* ) mmap( NULL, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0 );
+   if( base == ( U8* ) MAP_FAILED )
+      return NULL;
+
+   // Trim to an aligned window.
+   U8* aligned = ( U8* ) ( ( ( MEM_ADDRESS ) base + SlabSize - 1 ) & ~( MEM_ADDRESS ) ( SlabSize - 1 ) );
+   if( aligned != base )
+      munmap( base, aligned - base );
+   dsize_t tail = ( base + mapSize ) - ( aligned + size );
+   if( tail )
+      munmap( aligned + size, tail );
+
+   outBase = aligned;
+   outSize = size;
+   return aligned;
+#else
+   outSize = size + SlabSize;
+   outBase = dRealMalloc( outSize );
+   if( !outBase )
+      return NULL;
+   return ( U8* ) ( ( ( MEM_ADDRESS ) outBase + SlabSize - 1 ) & ~( MEM_ADDRESS ) ( SlabSize - 1 ) );
+#endif
+}
+
+static void osUnmap( void* base, dsize_t size )
+{
+#if defined( TORQUE_OS_WIN32 )
+   VirtualFree( base, 0, MEM_RELEASE );
+#elif defined( TORQUE_SLAB_USE_MMAP )
+   munmap( base, size );
+#else
+   dRealFree( base );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+//    Setup.
+//-----------------------------------------------------------------------------
+
+static void init()
+{
+   SpinLockScope lock( sgGlobalLock );
+   if( sgInitialized )
+      return;
+
+   U32 index = 0;
+   for( U32 i = 0; i <= ( MaxSmallSize >> 4 ); ++ i )
+   {
+      while( sgClassSizes[ index ] < ( i << 4 ) )
+         ++ index;
+      sgClassLookup[ i ] = index;
+   }
+
+   for( U32 i = 0; i < NumSizeClasses; ++ i )
+   {
+      SizeClass& sc = sgClasses[ i ];
+      sc.blockSize = sgClassSizes[ i ];
+
+      // One tag byte per block follows the header.
+      const U32 headerSize = ( U32 ) offsetof( Slab, tags );
+      U32 count = ( SlabSize - headerSize ) / ( sc.blockSize + 1 );
+      while( ( ( headerSize + count + 15 ) & ~15 ) + count * sc.blockSize > SlabSize )
+         -- count;
+
+      sc.blocksPerSlab = count;
+      sc.blocksOffset = ( headerSize + count + 15 ) & ~15;
+      sc.cacheLimit = getMax( ( U32 ) MinCachedBlocks, getMin( ( U32 ) MaxCachedBlocks, CacheBytesPerClass / sc.blockSize ) );
+      sc.batchSize = getMax( ( U32 ) 1, sc.cacheLimit / 2 );
+   }
+
+   sgTagNames[ DefaultTag ] = "General";
+   sgNumTags = 1;
+
+   sgThreadCache = constructInPlace( ( ThreadStorage* ) ( ( ( MEM_ADDRESS ) sgThreadCacheStorage + 15 ) & ~( MEM_ADDRESS ) 15 ) );
+
+   sgInitialized = true;
+}
+
+static ThreadCache* createThreadCache()
+{
+   ThreadCache* cache = ( ThreadCache* ) dRealMalloc( sizeof( ThreadCache ) );
+   dMemset( cache, 0, sizeof( ThreadCache ) );
+   sgThreadCache->set( cache );
+
+   SpinLockScope lock( sgGlobalLock );
+   cache->next = sgCacheList;
+   if( sgCacheList )
+      sgCacheList->prev = cache;
+   sgCacheList = cache;
+
+   return cache;
+}
+
+static inline ThreadCache* getThreadCache()
+{
+   if( !sgInitialized )
+      init();
+
+   ThreadCache* cache = ( ThreadCache* ) sgThreadCache->get();
+   if( !cache )
+      cache = createThreadCache();
+   return cache;
+}
+
+static inline U32 getSizeClass( dsize_t size )
+{
+   return sgClassLookup[ ( size + 15 ) >> 4 ];
+}
+
+static inline Slab* getSlab( void* ptr )
+{
+   return ( Slab* ) ( ( MEM_ADDRESS ) ptr & ~( MEM_ADDRESS ) ( SlabSize - 1 ) );
+}
+
+//-----------------------------------------------------------------------------
+//    Central pools.
+//-----------------------------------------------------------------------------
+
+static inline void linkPartial( SizeClass& sc, Slab* slab )
+{
+   slab->prev = NULL;
+   slab->next = sc.partial;
+   if( sc.partial )
+      sc.partial->prev = slab;
+   sc.partial = slab;
+}
+
+static inline void unlinkPartial( SizeClass& sc, Slab* slab )
+{
+   if( slab->prev )
+      slab->prev->next = slab->next;
+   else
+      sc.partial = slab->next;
+   if( slab->next )
+      slab->next->prev = slab->prev;
+   slab->prev = slab->next = NULL;
+}
+
+/// Map a new slab for @a classIndex.  Called with the class locked.
+static Slab* createSlab( U32 classIndex )
+{
+   SizeClass& sc = sgClasses[ classIndex ];
+
+   void* osBase;
+   dsize_t osSize;
+   U8* mem = osMap( SlabSize, osBase, osSize );
+   if( !mem )
+      return NULL;
+
+   Slab* slab = ( Slab* ) mem;
+   slab->magic = SlabMagic;
+   slab->classIndex = classIndex;
+   slab->osBase = osBase;
+   slab->osSize = osSize;
+   slab->blocks = mem + sc.blocksOffset;
+   slab->numFree = sc.blocksPerSlab;
+
+   // Thread the free list front to back so fresh slabs hand out
+   // ascending addresses.
+   FreeBlock* head = NULL;
+   for( S32 i = sc.blocksPerSlab - 1; i >= 0; -- i )
+   {
+      FreeBlock* block = ( FreeBlock* ) ( slab->blocks + i * sc.blockSize );
+      block->next = head;
+      head = block;
+   }
+   slab->freeList = head;
+
+   linkPartial( sc, slab );
+   sc.numSlabs ++;
+   sc.numEmptySlabs ++;
+   sc.freeBlocks += sc.blocksPerSlab;
+   dFetchAndAdd( sgSlabCount, 1 );
+
+   return slab;
+}
+
+/// Move up to batchSize blocks of @a classIndex into @a cache.
+static bool refill( ThreadCache* cache, U32 classIndex )
+{
+   SizeClass& sc = sgClasses[ classIndex ];
+   SpinLockScope lock( sc.lock );
+
+   U32 count = 0;
+   while( count < sc.batchSize )
+   {
+      Slab* slab = sc.partial;
+      if( !slab )
+      {
+         slab = createSlab( classIndex );
+         if( !slab )
+            break;
+      }
+
+      if( slab->numFree == sc.blocksPerSlab )
+         sc.numEmptySlabs --;
+
+      while( slab->freeList && count < sc.batchSize )
+      {
+         FreeBlock* block = slab->freeList;
+         slab->freeList = block->next;
+         slab->numFree --;
+
+         block->next = cache->lists[ classIndex ];
+         cache->lists[ classIndex ] = block;
+         count ++;
+      }
+
+      if( !slab->freeList )
+         unlinkPartial( sc, slab );
+   }
+
+   sc.freeBlocks -= count;
+   cache->counts[ classIndex ] += count;
+   return count != 0;
+}
+
+/// Return @a count blocks from the front of @a cache's list to their slabs.
+static void release( ThreadCache* cache, U32 classIndex, U32 count )
+{
+   SizeClass& sc = sgClasses[ classIndex ];
+   SpinLockScope lock( sc.lock );
+
+   for( U32 i = 0; i < count; ++ i )
+   {
+      FreeBlock* block = cache->lists[ classIndex ];
+      cache->lists[ classIndex ] = block->next;
+
+      Slab* slab = getSlab( block );
+      if( !slab->freeList )
+         linkPartial( sc, slab );
+
+      block->next = slab->freeList;
+      slab->freeList = block;
+      slab->numFree ++;
+
+      if( slab->numFree == sc.blocksPerSlab )
+      {
+         // Keep one empty slab around per class to avoid map/unmap
+         // ping-pong on the boundary.
+         if( sc.numEmptySlabs )
+         {
+            unlinkPartial( sc, slab );
+            sc.numSlabs --;
+            sc.freeBlocks -= sc.blocksPerSlab - 1;
+            dFetchAndAdd( sgSlabCount, ( U32 ) -1 );
+            osUnmap( slab->osBase, slab->osSize );
+            continue;
+         }
+         sc.numEmptySlabs ++;
+      }
+      sc.freeBlocks ++;
+   }
+
+   cache->counts[ classIndex ] -= count;
+}
+
+//-----------------------------------------------------------------------------
+//    Large blocks.
+//-----------------------------------------------------------------------------
+
+static void* allocLarge( ThreadCache* cache, dsize_t size )
+{
+   const dsize_t pageMask = 4095;
+   dsize_t mapSize = ( size + LargeHeaderSize + pageMask ) & ~pageMask;
+
+   void* osBase;
+   dsize_t osSize;
+   U8* mem = osMap( mapSize, osBase, osSize );
+   if( !mem )
+      return NULL;
+
+   LargeBlock* block = ( LargeBlock* ) mem;
+   block->magic = LargeMagic;
+   block->tag = cache->tag;
+   block->osBase = osBase;
+   block->osSize = osSize;
+   block->size = mapSize - LargeHeaderSize;
+
+   cache->tagBytes[ block->tag ] += block->size;
+   cache->tagAllocs[ block->tag ] ++;
+   cache->tagTotal[ block->tag ] ++;
+
+   dFetchAndAdd( sgLargeCount, 1 );
+   dFetchAndAdd( sgLargeKBytes, ( U32 ) ( osSize >> 10 ) );
+
+   return mem + LargeHeaderSize;
+}
+
+static void freeLarge( ThreadCache* cache, LargeBlock* block )
+{
+   cache->tagBytes[ block->tag ] -= block->size;
+   cache->tagAllocs[ block->tag ] --;
+
+   dFetchAndAdd( sgLargeCount, ( U32 ) -1 );
+   dFetchAndAdd( sgLargeKBytes, ( U32 ) -( S32 ) ( block->osSize >> 10 ) );
+
+   block->magic = 0;
+   osUnmap( block->osBase, block->osSize );
+}
+
+//-----------------------------------------------------------------------------
+//    Public interface.
+//-----------------------------------------------------------------------------
+
+void* alloc( dsize_t size )
+{
+   ThreadCache* cache = getThreadCache();
+
+   if( size > MaxSmallSize )
+      return allocLarge( cache, size );
+
+   const U32 classIndex = getSizeClass( size );
+   if( !cache->lists[ classIndex ] && !refill( cache, classIndex ) )
+      return NULL;
+
+   FreeBlock* block = cache->lists[ classIndex ];
+   cache->lists[ classIndex ] = block->next;
+   cache->counts[ classIndex ] --;
+   cache->classAllocs[ classIndex ] ++;
+
+   const U32 blockSize = sgClassSizes[ classIndex ];
+   Slab* slab = getSlab( block );
+   slab->tags[ ( ( U8* ) block - slab->blocks ) / blockSize ] = cache->tag;
+
+   cache->tagBytes[ cache->tag ] += blockSize;
+   cache->tagAllocs[ cache->tag ] ++;
+   cache->tagTotal[ cache->tag ] ++;
+
+   return block;
+}
+
+void free( void* ptr )
+{
+   if( !ptr )
+      return;
+
+   ThreadCache* cache = getThreadCache();
+
+   Slab* slab = getSlab( ptr );
+   if( slab->magic != SlabMagic )
+   {
+      LargeBlock* large = ( LargeBlock* ) slab;
+      AssertFatal( large->magic == LargeMagic && ( U8* ) ptr == ( U8* ) large + LargeHeaderSize,
+         "SlabAllocator::free - Pointer was not allocated by the slab allocator!" );
+      freeLarge( cache, large );
+      return;
+   }
+
+   const U32 classIndex = slab->classIndex;
+   const U32 blockSize = sgClassSizes[ classIndex ];
+   const U32 tag = slab->tags[ ( ( U8* ) ptr - slab->blocks ) / blockSize ];
+
+   cache->tagBytes[ tag ] -= blockSize;
+   cache->tagAllocs[ tag ] --;
+
+   FreeBlock* block = ( FreeBlock* ) ptr;
+   block->next = cache->lists[ classIndex ];
+   cache->lists[ classIndex ] = block;
+
+   if( ++ cache->counts[ classIndex ] > sgClasses[ classIndex ].cacheLimit )
+      release( cache, classIndex, sgClasses[ classIndex ].batchSize );
+}
+
+dsize_t getUsableSize( void* ptr )
+{
+   Slab* slab = getSlab( ptr );
+   if( slab->magic == SlabMagic )
+      return sgClassSizes[ slab->classIndex ];
+
+   return ( ( LargeBlock* ) slab )->size;
+}
+
+void* realloc( void* ptr, dsize_t size )
+{
+   if( !ptr )
+      return alloc( size );
+
+   if( !size )
+   {
+      free( ptr );
+      return NULL;
+   }
+
+   // Stay put if the block is big enough and not wastefully so.
+   const dsize_t usable = getUsableSize( ptr );
+   if( size <= usable && size > usable / 2 )
+      return ptr;
+
+   void* newPtr = alloc( size );
+   if( newPtr )
+   {
+      dMemcpy( newPtr, ptr, size < usable ? size : usable );
+      free( ptr );
+   }
+   return newPtr;
+}
+
+void flushThreadCache()
+{
+   if( !sgInitialized )
+      return;
+
+   ThreadCache* cache = ( ThreadCache* ) sgThreadCache->get();
+   if( !cache )
+      return;
+
+   for( U32 i = 0; i < NumSizeClasses; ++ i )
+      if( cache->counts[ i ] )
+         release( cache, i, cache->counts[ i ] );
+
+   SpinLockScope lock( sgGlobalLock );
+
+   for( U32 i = 0; i < NumSizeClasses; ++ i )
+      sgRetired.classAllocs[ i ] += cache->classAllocs[ i ];
+   for( U32 i = 0; i < MaxTags; ++ i )
+   {
+      sgRetired.tagBytes[ i ] += cache->tagBytes[ i ];
+      sgRetired.tagAllocs[ i ] += cache->tagAllocs[ i ];
+      sgRetired.tagTotal[ i ] += cache->tagTotal[ i ];
+   }
+
+   if( cache->prev )
+      cache->prev->next = cache->next;
+   else
+      sgCacheList = cache->next;
+   if( cache->next )
+      cache->next->prev = cache->prev;
+
+   sgThreadCache->set( NULL );
+   dRealFree( cache );
+}
+
+U32 registerTag( const char* name )
+{
+   if( !sgInitialized )
+      init();
+
+   SpinLockScope lock( sgGlobalLock );
+
+   for( U32 i = 0; i < sgNumTags; ++ i )
+      if( dStrcmp( sgTagNames[ i ], name ) == 0 )
+         return i;
+
+   if( sgNumTags == MaxTags )
+      return DefaultTag;
+
+   // Tag names are expected to be string literals.
+   sgTagNames[ sgNumTags ] = name;
+   return sgNumTags ++;
+}
+
+U32 setThreadTag( U32 tag )
+{
+   AssertFatal( tag < MaxTags, "SlabAllocator::setThreadTag - Invalid tag!" );
+
+   ThreadCache* cache = getThreadCache();
+   U32 prevTag = cache->tag;
+   cache->tag = tag;
+   return prevTag;
+}
+
+U32 getNumTags()
+{
+   return sgNumTags;
+}
+
+void getTagStats( U32 tag, TagStats& outStats )
+{
+   AssertFatal( tag < MaxTags, "SlabAllocator::getTagStats - Invalid tag!" );
+
+   if( !sgInitialized )
+      init();
+
+   SpinLockScope lock( sgGlobalLock );
+
+   outStats.name = tag < sgNumTags ? sgTagNames[ tag ] : "";
+   outStats.liveBytes = sgRetired.tagBytes[ tag ];
+   outStats.liveAllocs = sgRetired.tagAllocs[ tag ];
+   outStats.totalAllocs = sgRetired.tagTotal[ tag ];
+
+   for( ThreadCache* cache = sgCacheList; cache; cache = cache->next )
+   {
+      outStats.liveBytes += cache->tagBytes[ tag ];
+      outStats.liveAllocs += cache->tagAllocs[ tag ];
+      outStats.totalAllocs += cache->tagTotal[ tag ];
+   }
+}
+
+void getSizeClassStats( U32 index, SizeClassStats& outStats )
+{
+   AssertFatal( index < NumSizeClasses, "SlabAllocator::getSizeClassStats - Invalid size class!" );
+
+   if( !sgInitialized )
+      init();
+
+   SizeClass& sc = sgClasses[ index ];
+
+   outStats.blockSize = sc.blockSize;
+   outStats.cachedBlocks = 0;
+   outStats.totalAllocs = 0;
+
+   {
+      SpinLockScope lock( sgGlobalLock );
+
+      outStats.totalAllocs = sgRetired.classAllocs[ index ];
+      for( ThreadCache* cache = sgCacheList; cache; cache = cache->next )
+      {
+         outStats.cachedBlocks += cache->counts[ index ];
+         outStats.totalAllocs += cache->classAllocs[ index ];
+      }
+   }
+
+   SpinLockScope lock( sc.lock );
+
+   outStats.numSlabs = sc.numSlabs;
+   outStats.freeBlocks = sc.freeBlocks;
+
+   const U32 capacity = sc.numSlabs * sc.blocksPerSlab;
+   const U32 unused = sc.freeBlocks + outStats.cachedBlocks;
+   outStats.usedBlocks = capacity > unused ? capacity - unused : 0;
+}
+
+dsize_t getBytesMapped()
+{
+   return ( dsize_t ) dAtomicRead( sgSlabCount ) * SlabSize + ( ( dsize_t ) dAtomicRead( sgLargeKBytes ) << 10 );
+}
+
+dsize_t getBytesInUse()
+{
+   dsize_t total = 0;
+   for( U32 i = 0; i < NumSizeClasses; ++ i )
+   {
+      SizeClassStats stats;
+      getSizeClassStats( i, stats );
+      total += ( dsize_t ) stats.usedBlocks * stats.blockSize;
+   }
+
+   return total + ( ( dsize_t ) dAtomicRead( sgLargeKBytes ) << 10 );
+}
+
+void dumpStats()
+{
+   Con::printf( "SlabAllocator size classes:" );
+   Con::printf( "   %6s %6s %9s %9s %9s %12s %6s", "Size", "Slabs", "Used", "Cached", "Free", "Allocs", "Frag" );
+
+   dsize_t totalUsed = 0;
+   dsize_t totalSlack = 0;
+   for( U32 i = 0; i < NumSizeClasses; ++ i )
+   {
+      SizeClassStats stats;
+      getSizeClassStats( i, stats );
+      if( !stats.numSlabs && !stats.totalAllocs )
+         continue;
+
+      // Fragmentation is the share of mapped slab memory not handed out.
+      const dsize_t mapped = ( dsize_t ) stats.numSlabs * SlabSize;
+      const dsize_t used = ( dsize_t ) stats.usedBlocks * stats.blockSize;
+      const F32 frag = mapped ? 100.0f * F32( mapped - used ) / F32( mapped ) : 0.0f;
+
+      totalUsed += used;
+      totalSlack += mapped - used;
+
+      Con::printf( "   %6d %6d %9d %9d %9d %12.0f %5.1f%%",
+         stats.blockSize, stats.numSlabs, stats.usedBlocks, stats.cachedBlocks,
+         stats.freeBlocks, F64( stats.totalAllocs ), frag );
+   }
+
+   Con::printf( "   Large blocks: %d (%d KB)", dAtomicRead( sgLargeCount ), dAtomicRead( sgLargeKBytes ) );
+   Con::printf( "   Slabs: %d (%d KB), in use %d KB, slack %d KB",
+      dAtomicRead( sgSlabCount ), dAtomicRead( sgSlabCount ) * ( SlabSize >> 10 ),
+      U32( totalUsed >> 10 ), U32( totalSlack >> 10 ) );
+
+   Con::printf( "SlabAllocator tags:" );
+   Con::printf( "   %-24s %12s %10s %12s", "Tag", "Live KB", "Live", "Allocs" );
+
+   const U32 numTags = getNumTags();
+   for( U32 i = 0; i < numTags; ++ i )
+   {
+      TagStats stats;
+      getTagStats( i, stats );
+      Con::printf( "   %-24s %12.1f %10.0f %12.0f", stats.name,
+         F64( stats.liveBytes ) / 1024.0, F64( stats.liveAllocs ), F64( stats.totalAllocs ) );
+   }
+}
+
+} // namespace SlabAllocator
+
+DefineEngineFunction( dumpSlabAllocatorStats, void, (),,
+   "@brief Dumps slab allocator usage.\n\n"
+   "Prints, for every size class, the number of slabs, used, cached and free blocks "
+   "and the share of slab memory not handed out, followed by the live memory "
+   "attributed to each registered allocation tag.\n\n"
+   "@ingroup Debugging" )
+{
+   SlabAllocator::dumpStats();
+}
@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _PLATFORMSLABALLOCATOR_H_
+#define _PLATFORMSLABALLOCATOR_H_
+
+#ifndef _TORQUE_TYPES_H_
+#include "platform/types.h"
+#endif
+
+// Debug guards need the per-block headers of the tree heap in
+// platformMemory.cpp, so they always win over the slab backend.
+#if defined(TORQUE_SLAB_ALLOCATOR) && defined(TORQUE_DEBUG_GUARD)
+#  undef TORQUE_SLAB_ALLOCATOR
+#endif
+
+/// Size-class slab allocator.
+///
+/// Small requests (up to MaxSmallSize) are rounded up to one of a fixed set of
+/// size classes and carved out of 64k slabs.  Each thread keeps a small cache
+/// of free blocks per class so that the common alloc/free pair never touches
+/// a lock; caches are refilled from, and flushed back to, a central per-class
+/// pool in batches.  Requests above MaxSmallSize are mapped directly from the
+/// OS (mmap/VirtualAlloc) and returned to it on free.
+///
+/// Every block carries a one byte tag so live memory can be attributed to a
+/// subsystem.  Tags are registered by name and selected per thread with
+/// SlabAllocator::TagScope.
+///
+/// The allocator is always compiled in; defining TORQUE_SLAB_ALLOCATOR routes
+/// the global operator new/delete and dMalloc/dFree/dRealloc through it.
+namespace SlabAllocator
+{
+   enum Constants
+   {
+      SlabSize       = 64 * 1024,
+      MaxSmallSize   = 16 * 1024,
+      NumSizeClasses = 36,
+      MaxTags        = 64,
+
+      /// Tag used for allocations made outside any TagScope.
+      DefaultTag     = 0,
+   };
+
+   struct SizeClassStats
+   {
+      U32 blockSize;
+
+      /// Number of slabs currently owned by this class.
+      U32 numSlabs;
+
+      /// Blocks handed out to callers.
+      U32 usedBlocks;
+
+      /// Blocks sitting in thread caches.  Read without locking the
+      /// owning threads, so only approximate while they are running.
+      U32 cachedBlocks;
+
+      /// Blocks free inside the class' slabs.
+      U32 freeBlocks;
+
+      U64 totalAllocs;
+   };
+
+   /// Per tag accounting.  Counters are kept per thread and summed on
+   /// request, so they are only approximate while other threads allocate.
+   struct TagStats
+   {
+      const char* name;
+      S64 liveBytes;
+      S64 liveAllocs;
+      U64 totalAllocs;
+   };
+
+   void* alloc( dsize_t size );
+   void  free( void* ptr );
+   void* realloc( void* ptr, dsize_t size );
+
+   /// Return the number of bytes actually usable at @a ptr.
+   dsize_t getUsableSize( void* ptr );
+
+   /// Return all blocks cached by the calling thread to the central pool.
+   /// Threads started through Thread do this when they exit; call it
+   /// before any other thread exits.
+   void flushThreadCache();
+
+   /// Register a subsystem tag and return its id, or the id it was already
+   /// registered with.  Returns DefaultTag once MaxTags is exhausted.
+   U32 registerTag( const char* name );
+
+   /// Set the tag for allocations made by the calling thread and return
+   /// the previous one.
+   U32 setThreadTag( U32 tag );
+
+   U32 getNumTags();
+   void getTagStats( U32 tag, TagStats& outStats );
+   void getSizeClassStats( U32 index, SizeClassStats& outStats );
+
+   /// Bytes currently requested from the OS for slabs and large blocks.
+   dsize_t getBytesMapped();
+
+   /// Bytes currently handed out to callers (rounded up to block sizes).
+   dsize_t getBytesInUse();
+
+   /// Print per class usage, fragmentation and per tag accounting.
+   void dumpStats();
+
+   /// Attribute allocations made by the calling thread to @a tag for the
+   /// lifetime of the scope.
+   class TagScope
+   {
+   public:
+      TagScope( U32 tag ) { mPrevTag = setThreadTag( tag ); }
+      ~TagScope() { setThreadTag( mPrevTag ); }
+   protected:
+      U32 mPrevTag;
+   };
+}
+
+/// Attribute the allocations made by the calling thread for the rest of
+/// the enclosing block to the tag called @a name, registering it the first
+/// time the scope is entered.
+#define SLAB_TAG_SCOPE( name ) \
+   static const U32 _slabTag##name = SlabAllocator::registerTag( #name ); \
+   SlabAllocator::TagScope _slabTagScope##name( _slabTag##name )
+
+#endif // _PLATFORMSLABALLOCATOR_H_
@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "platform/platformSlabAllocator.h"
+
+using namespace UnitTesting;
+
+CreateUnitTest( TestSlabAllocator, "Platform/SlabAllocator" )
+{
+   void run()
+   {
+      // Small blocks round up to their size class and stay 16 byte aligned.
+      void* small = SlabAllocator::alloc( 100 );
+      test( small != NULL, "Small allocation failed!" );
+      test( SlabAllocator::getUsableSize( small ) == 112, "100 bytes should land in the 112 byte class!" );
+      test( ( ( MEM_ADDRESS ) small & 15 ) == 0, "Small block is not 16 byte aligned!" );
+
+      // Large blocks go straight to the OS.
+      const dsize_t largeSize = SlabAllocator::MaxSmallSize * 4 + 1;
+      U8* large = ( U8* ) SlabAllocator::alloc( largeSize );
+      test( large != NULL, "Large allocation failed!" );
+      test( SlabAllocator::getUsableSize( large ) >= largeSize, "Large block is too small!" );
+      dMemset( large, 0xAB, largeSize );
+
+      // Realloc across the small/large boundary keeps the contents.
+      dMemset( small, 0x5A, 100 );
+      U8* grown = ( U8* ) SlabAllocator::realloc( small, SlabAllocator::MaxSmallSize * 2 );
+      bool intact = true;
+      for( U32 i = 0; i < 100; ++ i )
+         intact &= ( grown[ i ] == 0x5A );
+      test( intact, "Realloc lost the block contents!" );
+
+      SlabAllocator::free( grown );
+      SlabAllocator::free( large );
+
+      // Tagged allocations are attributed to the tag and released with it.
+      const U32 tag = SlabAllocator::registerTag( "UnitTest" );
+      test( tag == SlabAllocator::registerTag( "UnitTest" ), "Registering a tag twice should return the same id!" );
+
+      SlabAllocator::TagStats before;
+      SlabAllocator::getTagStats( tag, before );
+
+      void* blocks[ 64 ];
+      {
+         SlabAllocator::TagScope scope( tag );
+         for( U32 i = 0; i < 64; ++ i )
+            blocks[ i ] = SlabAllocator::alloc( 48 );
+      }
+
+      SlabAllocator::TagStats during;
+      SlabAllocator::getTagStats( tag, during );
+      test( during.liveBytes - before.liveBytes == 64 * 48, "Tag should account for 64 live 48 byte blocks!" );
+      test( during.liveAllocs - before.liveAllocs == 64, "Tag should account for 64 live allocations!" );
+
+      // Freeing outside the scope still credits the owning tag.
+      for( U32 i = 0; i < 64; ++ i )
+         SlabAllocator::free( blocks[ i ] );
+
+      SlabAllocator::TagStats after;
+      SlabAllocator::getTagStats( tag, after );
+      test( after.liveBytes == before.liveBytes, "Freed blocks should no longer count against the tag!" );
+      test( after.totalAllocs - before.totalAllocs == 64, "Tag lifetime allocation count is off!" );
+   }
+};
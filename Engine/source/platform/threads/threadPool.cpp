@@ -25,6 +25,7 @@
 #include "platform/platformCPUCount.h"
 #include "core/strings/stringFunctions.h"
 #include "core/util/tSingleton.h"
+#include "core/frameAllocator.h"
 
 
 //#define DEBUG_SPEW
@@ -249,6 +250,9 @@ void ThreadPool::WorkerThread::run( void* arg )
    XSetThreadProcessor( GetCurrentThread(), sCoreAssignment );
    sCoreAssignment = sCoreAssignment < 6 ? sCoreAssignment + 1 : 2;
 #endif
+
+   // Give the work items their own scratch memory.
+   FrameAllocator::initThread();
       
    while( 1 )
    {
@@ -257,6 +261,7 @@ void ThreadPool::WorkerThread::run( void* arg )
 #ifdef DEBUG_SPEW
          Platform::outputDebugString( "[ThreadPool::WorkerThread] thread '%i' exits", getId() );
 #endif
+         FrameAllocator::destroyThread();
          dFetchAndAdd( mPool->mNumThreads, ( U32 ) -1 );
          return;
       }
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _THREADPOOLJOB_H_
+#define _THREADPOOLJOB_H_
+
+#ifndef _THREADPOOL_H_
+#  include "platform/threads/threadPool.h"
+#endif
+#ifndef _PLATFORMINTRINSICS_H_
+#  include "platform/platformIntrinsics.h"
+#endif
+#ifndef _TVECTOR_H_
+#  include "core/util/tVector.h"
+#endif
+
+
+/// @file
+/// Work items which the main thread polls for or waits on.
+
+
+/// A work item which flags when it has finished running.
+///
+/// The owner keeps a reference to the job so it can check on it with
+/// isFinished() from the main thread or block on it with waitForFinish().
+class ThreadPoolJob : public ThreadPool::WorkItem
+{
+   public:
+
+      typedef ThreadPool::WorkItem Parent;
+
+      ThreadPoolJob( ThreadPool::Context* context = 0 )
+         : Parent( context ),
+           mFinished( 0 ) {}
+
+      /// Return true once run() has returned.
+      bool isFinished() { return dAtomicRead( mFinished ) != 0; }
+
+      /// Spin until the job has finished.  Only use this for short jobs
+      /// the caller cannot do without.
+      void waitForFinish()
+      {
+         while( !isFinished() )
+            Platform::sleep( 0 );
+      }
+
+   protected:
+
+      /// The work to do on the worker thread.
+      virtual void run() = 0;
+
+      virtual void execute()
+      {
+         run();
+         dCompareAndSwap( mFinished, 0, 1 );
+      }
+
+   private:
+
+      volatile U32 mFinished;
+};
+
+
+/// A set of jobs split off from work done on the calling thread.
+///
+/// The usual pattern is to queue all but the first part of the work,
+/// do the first part inline and then wait() for the rest.  The group
+/// waits on destruction as the jobs normally point at data owned by
+/// the caller.
+///
+/// @param T A ThreadPoolJob subclass.
+template< class T >
+class ThreadPoolJobGroup
+{
+   public:
+
+      ~ThreadPoolJobGroup() { wait(); }
+
+      void reserve( U32 count ) { mJobs.reserve( count ); }
+
+      /// Queue the job on the global thread pool.
+      T* queue( T* job )
+      {
+         mJobs.push_back( job );
+         ThreadPool::GLOBAL().queueWorkItem( job );
+         return job;
+      }
+
+      /// Wait for all the queued jobs to finish.
+      void wait()
+      {
+         for( U32 i = 0; i < mJobs.size(); ++ i )
+            mJobs[ i ]->waitForFinish();
+      }
+
+      U32 size() const { return mJobs.size(); }
+      bool empty() const { return mJobs.empty(); }
+      T* operator []( U32 index ) const { return mJobs[ index ]; }
+
+   protected:
+
+      Vector< ThreadSafeRef< T > > mJobs;
+};
+
+#endif // _THREADPOOLJOB_H_
@@ -26,6 +26,7 @@
 #include "platform/threads/thread.h"
 #include "platform/threads/semaphore.h"
 #include "platform/platformIntrinsics.h"
+#include "platform/platformSlabAllocator.h"
 #include "core/util/safeDelete.h"
 
 #include <process.h> // [tom, 4/20/2006] for _beginthread()
@@ -86,6 +87,10 @@ static unsigned int __stdcall ThreadRunHandler(void * arg)
    if( autoDelete )
       delete mData->mThread; // Safe as we own the data.
 
+   // Hand the blocks cached by this thread back to the shared
+   // slabs now that nothing else will run on it.
+   SlabAllocator::flushThreadCache();
+
    _endthreadex( 0 );
    return 0;
 }
@@ -24,6 +24,7 @@
 #include "platform/threads/thread.h"
 #include "platform/threads/semaphore.h"
 #include "platform/threads/mutex.h"
+#include "platform/platformSlabAllocator.h"
 #include <stdlib.h>
 
 class PlatformThreadData
@@ -68,7 +69,11 @@ static void *ThreadRunHandler(void * arg)
    
    if( autoDelete )
       delete thread;
-      
+
+   // Hand the blocks cached by this thread back to the shared
+   // slabs now that nothing else will run on it.
+   SlabAllocator::flushThreadCache();
+
    // return value for pthread lib's benefit
    return NULL;
    // the end of this function is where the created pthread will die.
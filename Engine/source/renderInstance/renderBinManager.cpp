@@ -27,6 +27,7 @@
 #include "materials/matInstance.h"
 #include "scene/sceneManager.h"
 #include "console/engineAPI.h"
+#include "ts/instancingMatHook.h"
 
 
 IMPLEMENT_CONOBJECT(RenderBinManager);
@@ -60,6 +61,11 @@ void RenderBinManager::initPersistFields()
    addField("processAddOrder", TypeF32, Offset(mProcessAddOrder, RenderBinManager),
       "Defines the order for adding instances in relation to other bins." );
 
+   Con::addVariable( "$pref::Render::minInstancingBatch", TypeS32, &smMinInstancingBatch,
+      "Runs of at least this many meshes sharing geometry and material are automatically "
+      "drawn with hardware instancing.  Zero disables automatic instancing.\n"
+      "@ingroup RenderBin" );
+
    Parent::initPersistFields();
 }
 
@@ -112,6 +118,9 @@ void RenderBinManager::setRenderPass( RenderPassManager *rpm )
    }
 }
 
+Vector< RenderBinManager::MainSortElem > RenderBinManager::smSortScratch( __FILE__, __LINE__ );
+S32 RenderBinManager::smMinInstancingBatch = 4;
+
 void RenderBinManager::addElement( RenderInst *inst )
 {   
    internalAddElement(inst);
@@ -135,7 +144,94 @@ void RenderBinManager::clear()
 
 void RenderBinManager::sort()
 {
-   dQsort( mElementList.address(), mElementList.size(), sizeof(MainSortElem), cmpKeyFunc);
+   _sortElements( mElementList );
+}
+
+void RenderBinManager::_sortElements( Vector< MainSortElem > &elements )
+{
+   PROFILE_SCOPE( RenderBinManager_sortElements );
+
+   const U32 count = elements.size();
+   if ( count < 2 )
+      return;
+
+   if ( count < smRadixSortMinElements )
+   {
+      MainSortElem *list = elements.address();
+      for ( U32 i = 1; i < count; i++ )
+      {
+         const MainSortElem elem = list[i];
+
+         U32 j = i;
+         for ( ; j > 0 && _isSortedBefore( elem, list[j-1] ); j-- )
+            list[j] = list[j-1];
+
+         list[j] = elem;
+      }
+
+      return;
+   }
+
+   // Build the histograms for all the passes at once.  The
+   // first four passes go over key2 and the last four over the
+   // inverted key so that it ends up sorted in descending order.
+   U32 counts[8][256];
+   dMemset( counts, 0, sizeof( counts ) );
+
+   const MainSortElem *list = elements.address();
+   for ( U32 i = 0; i < count; i++ )
+   {
+      const U32 key2 = list[i].key2;
+      const U32 key = ~list[i].key;
+
+      counts[0][ key2 & 0xFF ]++;
+      counts[1][ ( key2 >> 8 ) & 0xFF ]++;
+      counts[2][ ( key2 >> 16 ) & 0xFF ]++;
+      counts[3][ key2 >> 24 ]++;
+      counts[4][ key & 0xFF ]++;
+      counts[5][ ( key >> 8 ) & 0xFF ]++;
+      counts[6][ ( key >> 16 ) & 0xFF ]++;
+      counts[7][ key >> 24 ]++;
+   }
+
+   smSortScratch.setSize( count );
+
+   MainSortElem *src = elements.address();
+   MainSortElem *dst = smSortScratch.address();
+
+   for ( U32 pass = 0; pass < 8; pass++ )
+   {
+      const U32 shift = ( pass & 3 ) * 8;
+      const bool isKey = pass >= 4;
+
+      // If every element has the same byte here this
+      // pass would not change the order, so skip it.
+      const U32 firstDigit = ( ( isKey ? ~src[0].key : src[0].key2 ) >> shift ) & 0xFF;
+      if ( counts[pass][firstDigit] == count )
+         continue;
+
+      U32 offsets[256];
+      U32 offset = 0;
+      for ( U32 i = 0; i < 256; i++ )
+      {
+         offsets[i] = offset;
+         offset += counts[pass][i];
+      }
+
+      for ( U32 i = 0; i < count; i++ )
+      {
+         const U32 digit = ( ( isKey ? ~src[i].key : src[i].key2 ) >> shift ) & 0xFF;
+         dst[ offsets[digit]++ ] = src[i];
+      }
+
+      MainSortElem *temp = src;
+      src = dst;
+      dst = temp;
+   }
+
+   // Make sure the result ends up in the list.
+   if ( src != elements.address() )
+      dMemcpy( elements.address(), src, sizeof( MainSortElem ) * count );
 }
 
 S32 FN_CDECL RenderBinManager::cmpKeyFunc(const void* p1, const void* p2)
@@ -148,6 +244,51 @@ S32 FN_CDECL RenderBinManager::cmpKeyFunc(const void* p1, const void* p2)
    return ( test1 == 0 ) ? S32(mse1->key2) - S32(mse2->key2) : test1;
 }
 
+U32 RenderBinManager::_findInstancingRun( const Vector< MainSortElem > &elements, U32 start, BaseMatInstance *&mat ) const
+{
+   const U32 count = elements.size();
+
+#ifndef TORQUE_OS_MAC
+
+   if ( smMinInstancingBatch <= 0 || !mat || mat->isInstanced() )
+      return count;
+
+   MeshRenderInst *ri = static_cast<MeshRenderInst*>( elements[start].inst );
+
+   // The instances share everything but the per-instance
+   // data, so textures cannot change within the run.
+   U32 end = start + 1;
+   for ( ; end < count; end++ )
+   {
+      MeshRenderInst *nextRI = static_cast<MeshRenderInst*>( elements[end].inst );
+
+      if (  newPassNeeded( ri, nextRI ) ||
+            ri->matInst != nextRI->matInst ||
+            ri->miscTex != nextRI->miscTex ||
+            ri->lightmap != nextRI->lightmap ||
+            ri->cubemap != nextRI->cubemap ||
+            ri->reflectTex != nextRI->reflectTex )
+         break;
+   }
+
+   if ( end - start < (U32)smMinInstancingBatch )
+      return count;
+
+   // The hook gives up on materials it cannot instance.
+   BaseMatInstance *instancingMat = InstancingMaterialHook::getInstancingMat( mat );
+   if ( !instancingMat )
+      return count;
+
+   mat = instancingMat;
+   return end;
+
+#else
+
+   return count;
+
+#endif
+}
+
 void RenderBinManager::setupSGData( MeshRenderInst *ri, SceneData &data )
 {
    PROFILE_SCOPE( RenderBinManager_setupSGData );
@@ -79,6 +79,7 @@ public:
    RenderPassManager* getRenderPass() const { return mRenderPass; }
 
    /// QSort callback function
+   /// @note The bins sort with _sortElements() which uses the same order.
    static S32 FN_CDECL cmpKeyFunc(const void* p1, const void* p2);
 
    DECLARE_CONOBJECT(RenderBinManager);
@@ -95,6 +96,27 @@ protected:
       U32 key2;
    };
 
+   /// Lists shorter than this are insertion sorted as
+   /// the radix passes do not pay off for them.
+   static const U32 smRadixSortMinElements = 64;
+
+   /// Scratch space for _sortElements() shared by all bins.
+   static Vector< MainSortElem > smSortScratch;
+
+   /// Returns true if @ a goes before @a b in sorted order, i.e.
+   /// descending by key and then ascending by key2.
+   static bool _isSortedBefore( const MainSortElem &a, const MainSortElem &b )
+   {
+      return a.key > b.key || ( a.key == b.key && a.key2 < b.key2 );
+   }
+
+   /// Stable sort of the elements into _isSortedBefore() order.
+   ///
+   /// This is a LSD radix sort over the bytes of key2 and key
+   /// which skips the passes for bytes that are the same in
+   /// all the elements.
+   static void _sortElements( Vector< MainSortElem > &elements );
+
    void setRenderPass( RenderPassManager *rpm );
 
    /// Called from derived bins to add additional
@@ -124,6 +146,20 @@ protected:
    /// MeshRenderInst requires a new batch/pass.
    inline bool newPassNeeded( MeshRenderInst *ri, MeshRenderInst* nextRI ) const;
 
+   /// Runs of at least this many mesh instances that share mesh and
+   /// material are drawn with hardware instancing.  Zero disables it.
+   static S32 smMinInstancingBatch;
+
+   /// Looks for a run of mesh instances starting at @a start in @a elements
+   /// which draw the same geometry with the same material and textures.  If
+   /// it is at least smMinInstancingBatch long and the material can be
+   /// instanced, @a mat is swapped for its instancing version so the run
+   /// renders with a single draw call.
+   ///
+   /// @return The end of the run if @a mat was swapped or the size of
+   ///   @a elements if not.
+   U32 _findInstancingRun( const Vector< MainSortElem > &elements, U32 start, BaseMatInstance *&mat ) const;
+
    /// Inlined utility function which gets the material from the 
    /// RenderInst if available, otherwise, return NULL.
    inline BaseMatInstance* getMaterial( RenderInst *inst ) const;
@@ -128,6 +128,9 @@ void RenderMeshMgr::render(SceneRenderState * state)
       setupSGData( ri, sgData );
       BaseMatInstance *mat = ri->matInst;
 
+      // Merge runs of the same mesh into instanced draw calls.
+      const U32 batchEnd = _findInstancingRun( mElementList, j, mat );
+
       // If we have an override delegate then give it a 
       // chance to swap the material with another.
       if ( mMatOverrideDelegate )
@@ -150,7 +153,7 @@ void RenderMeshMgr::render(SceneRenderState * state)
 
       while( mat && mat->setupPass(state, sgData ) )
       {
-         for( a=j; a<binSize; a++ )
+         for( a=j; a<batchEnd; a++ )
          {
             MeshRenderInst *passRI = static_cast<MeshRenderInst*>(mElementList[a].inst);
 
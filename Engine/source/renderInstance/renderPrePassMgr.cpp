@@ -251,8 +251,8 @@ void RenderPrePassMgr::sort()
 {
    PROFILE_SCOPE( RenderPrePassMgr_sort );
    Parent::sort();
-   dQsort( mTerrainElementList.address(), mTerrainElementList.size(), sizeof(MainSortElem), cmpKeyFunc);
-   dQsort( mObjectElementList.address(), mObjectElementList.size(), sizeof(MainSortElem), cmpKeyFunc);
+   _sortElements( mTerrainElementList );
+   _sortElements( mObjectElementList );
 }
 
 void RenderPrePassMgr::clear()
@@ -337,8 +337,12 @@ void RenderPrePassMgr::render( SceneRenderState *state )
    {
       MeshRenderInst *ri = static_cast<MeshRenderInst*>( itr->inst );
 
+      // Merge runs of the same mesh into instanced draw calls.
+      BaseMatInstance *baseMat = ri->matInst;
+      const U32 batchEnd = _findInstancingRun( mElementList, itr - mElementList.begin(), baseMat );
+
       // Get the prepass material.
-      BaseMatInstance *mat = getPrePassMaterial( ri->matInst );
+      BaseMatInstance *mat = getPrePassMaterial( baseMat );
 
       // Set up SG data proper like and flag it 
       // as a pre-pass render
@@ -349,7 +353,7 @@ void RenderPrePassMgr::render( SceneRenderState *state )
       while ( mat->setupPass( state, sgData ) )
       {
          meshItr = itr;
-         for ( ; meshItr != mElementList.end(); meshItr++ )
+         for ( ; meshItr != mElementList.begin() + batchEnd; meshItr++ )
          {
             MeshRenderInst *passRI = static_cast<MeshRenderInst*>( meshItr->inst );
 
@@ -247,6 +247,37 @@ class SceneContainer
 
       bool collideBox(const Point3F &start, const Point3F &end, U32 mask, RayInfo* info);
 
+      /// A ray cast as part of a batch.
+      /// @see castRayBatch
+      struct BatchRay
+      {
+         Point3F start;
+         Point3F end;
+
+         /// Object type mask of the objects to test against.
+         U32 mask;
+
+         /// Object excluded from the test, e.g. the one casting the ray.  May be NULL.
+         SceneObject* exempt;
+      };
+
+      /// Cast many rays against collision geometry at once.
+      ///
+      /// Rays are grouped by container bin so that each group gathers its
+      /// candidate objects only once.  Every ray is then tested against the
+      /// world boxes of its group's candidates, with large batches spread
+      /// over the thread pool.  Object castRay() calls are only made for the
+      /// boxes a ray passes through and always run on the calling thread.
+      ///
+      /// @param rays Rays to cast.
+      /// @param numRays Number of rays.
+      /// @param outHits Receives, for each ray, whether it hit anything.
+      /// @param outInfos Optional; receives the hit details for each ray.
+      /// @param anyHit Stop at the first hit along each ray rather than
+      ///   searching for the nearest.  Enough for line-of-sight tests.
+      /// @return Number of rays that hit something.
+      U32 castRayBatch( const BatchRay* rays, U32 numRays, bool* outHits, RayInfo* outInfos = NULL, bool anyHit = false );
+
       /// @}
 
       /// @name Poly list
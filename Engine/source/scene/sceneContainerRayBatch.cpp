@@ -0,0 +1,449 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "scene/sceneContainer.h"
+
+#include "scene/sceneObject.h"
+#include "collision/collision.h"
+#include "math/mPacket.h"
+#include "platform/profiler.h"
+#include "platform/threads/threadPoolJob.h"
+#include "platform/threads/threadSafeRefCount.h"
+#include "core/strings/stringUnit.h"
+#include "console/engineAPI.h"
+
+
+/// Most rays gathered into one group.  Rays in a group share one
+/// candidate object list, so larger groups mean fewer bin walks but
+/// more box tests for each ray.
+static const U32 RayBatchMaxGroupSize = 32;
+
+/// Fewest rays handed to a single thread pool job.  Smaller batches
+/// are tested entirely on the calling thread.
+static const U32 RayBatchMinRaysPerJob = 64;
+
+/// Position of the empty boxes used to pad candidate lists.  It is far
+/// enough away that no ray can reach it.
+static const F32 RayBatchFarAway = 1.0e30f;
+
+
+/// The candidate objects of each ray group, with their world boxes laid
+/// out for m_lineF_x_boxPacketF.
+struct RayBatchData
+{
+   struct Group
+   {
+      U32 firstRay;
+      U32 numRays;
+      U32 firstCandidate;
+
+      /// Always a multiple of four.
+      U32 numCandidates;
+   };
+
+   const SceneContainer::BatchRay* rays;
+
+   /// Indices into #rays, sorted by group.
+   Vector< U32 > order;
+
+   Vector< Group > groups;
+
+   /// Candidate world boxes of all groups.
+   Vector< F32 > minX, minY, minZ;
+   Vector< F32 > maxX, maxY, maxZ;
+
+   /// The candidate objects; NULL for padding.
+   Vector< SceneObject* > objects;
+
+   void addCandidate( SceneObject* object, const Box3F& box )
+   {
+      minX.push_back( box.minExtents.x );
+      minY.push_back( box.minExtents.y );
+      minZ.push_back( box.minExtents.z );
+      maxX.push_back( box.maxExtents.x );
+      maxY.push_back( box.maxExtents.y );
+      maxZ.push_back( box.maxExtents.z );
+      objects.push_back( object );
+   }
+};
+
+/// A ray passing through the world box of a candidate object.
+struct RayBatchHit
+{
+   U32 ray;
+   U32 candidate;
+
+   /// Where along the ray it enters the box.
+   F32 t;
+};
+
+static S32 QSORT_CALLBACK _rayBatchHitCompare( const void* a, const void* b )
+{
+   const F32 ta = ( ( const RayBatchHit* ) a )->t;
+   const F32 tb = ( ( const RayBatchHit* ) b )->t;
+   return ta < tb ? -1 : ( ta > tb ? 1 : 0 );
+}
+
+/// Test the rays of groups [groupBegin, groupEnd) against the world
+/// boxes of their candidates.  The hits of each ray are contiguous.
+static void _rayBatchTestGroups( const RayBatchData& data, U32 groupBegin, U32 groupEnd, Vector< RayBatchHit >& outHits )
+{
+   Vector< F32 > t;
+
+   for ( U32 g = groupBegin; g < groupEnd; g++ )
+   {
+      const RayBatchData::Group& group = data.groups[ g ];
+
+      BoxPacketF boxes;
+      boxes.minX = data.minX.address() + group.firstCandidate;
+      boxes.minY = data.minY.address() + group.firstCandidate;
+      boxes.minZ = data.minZ.address() + group.firstCandidate;
+      boxes.maxX = data.maxX.address() + group.firstCandidate;
+      boxes.maxY = data.maxY.address() + group.firstCandidate;
+      boxes.maxZ = data.maxZ.address() + group.firstCandidate;
+
+      t.setSize( group.numCandidates );
+
+      for ( U32 r = 0; r < group.numRays; r++ )
+      {
+         const U32 rayIndex = data.order[ group.firstRay + r ];
+         const SceneContainer::BatchRay& ray = data.rays[ rayIndex ];
+
+         if ( !m_lineF_x_boxPacketF( ray.start, ray.end, boxes, group.numCandidates, t.address() ) )
+            continue;
+
+         for ( U32 i = 0; i < group.numCandidates; i++ )
+         {
+            if ( t[ i ] > 1.0f )
+               continue;
+
+            outHits.increment();
+            RayBatchHit& hit = outHits.last();
+            hit.ray = rayIndex;
+            hit.candidate = group.firstCandidate + i;
+            hit.t = t[ i ];
+         }
+      }
+   }
+}
+
+/// Box tests for a run of ray groups on the thread pool.
+struct RayBatchJob : public ThreadPoolJob
+{
+   const RayBatchData* mData;
+   U32 mGroupBegin;
+   U32 mGroupEnd;
+
+   Vector< RayBatchHit > mHits;
+
+   RayBatchJob( const RayBatchData* data, U32 groupBegin, U32 groupEnd )
+      : mData( data ),
+        mGroupBegin( groupBegin ),
+        mGroupEnd( groupEnd ) {}
+
+protected:
+
+   virtual void run() { _rayBatchTestGroups( *mData, mGroupBegin, mGroupEnd, mHits ); }
+};
+
+//-----------------------------------------------------------------------------
+
+U32 SceneContainer::castRayBatch( const BatchRay* rays, U32 numRays, bool* outHits, RayInfo* outInfos, bool anyHit )
+{
+   PROFILE_SCOPE( SceneContainer_castRayBatch );
+
+   for ( U32 i = 0; i < numRays; i++ )
+      outHits[ i ] = false;
+
+   if ( !numRays )
+      return 0;
+
+   RayBatchData data;
+   data.rays = rays;
+
+   // Counting sort the rays by the bin holding their midpoint, so rays
+   // close together end up in the same group.
+   {
+      PROFILE_SCOPE( SceneContainer_castRayBatch_Group );
+
+      Vector< U32 > keys( numRays );
+      keys.setSize( numRays );
+
+      Vector< U32 > counts( csmNumBins * csmNumBins + 1 );
+      counts.setSize( csmNumBins * csmNumBins + 1 );
+      dMemset( counts.address(), 0, counts.memSize() );
+
+      for ( U32 i = 0; i < numRays; i++ )
+      {
+         const Point3F mid = ( rays[ i ].start + rays[ i ].end ) * 0.5f;
+
+         U32 binX, binY, dummy;
+         getBinRange( mid.x, mid.x, binX, dummy );
+         getBinRange( mid.y, mid.y, binY, dummy );
+
+         keys[ i ] = ( binY % csmNumBins ) * csmNumBins + ( binX % csmNumBins );
+         counts[ keys[ i ] + 1 ]++;
+      }
+
+      for ( U32 i = 1; i < counts.size(); i++ )
+         counts[ i ] += counts[ i - 1 ];
+
+      data.order.setSize( numRays );
+      for ( U32 i = 0; i < numRays; i++ )
+         data.order[ counts[ keys[ i ] ]++ ] = i;
+
+      // Split the sorted rays into groups and gather the candidates
+      // for each.
+      Vector< SceneObject* > candidates;
+
+      for ( U32 i = 0; i < numRays; )
+      {
+         data.groups.increment();
+         RayBatchData::Group& group = data.groups.last();
+         group.firstRay = i;
+         group.firstCandidate = data.objects.size();
+
+         const U32 key = keys[ data.order[ i ] ];
+         Box3F box = Box3F::Invalid;
+         U32 mask = 0;
+
+         while ( i < numRays && keys[ data.order[ i ] ] == key && i - group.firstRay < RayBatchMaxGroupSize )
+         {
+            const BatchRay& ray = rays[ data.order[ i ] ];
+            box.extend( ray.start );
+            box.extend( ray.end );
+            mask |= ray.mask;
+            i++;
+         }
+
+         group.numRays = i - group.firstRay;
+
+         candidates.clear();
+         findObjectList( box, mask, &candidates );
+
+         for ( U32 j = 0; j < candidates.size(); j++ )
+         {
+            SceneObject* object = candidates[ j ];
+            if ( object->isGlobalBounds() )
+               data.addCandidate( object, Box3F( -RayBatchFarAway, -RayBatchFarAway, -RayBatchFarAway, RayBatchFarAway, RayBatchFarAway, RayBatchFarAway ) );
+            else
+               data.addCandidate( object, object->getWorldBox() );
+         }
+
+         const Point3F farAway( RayBatchFarAway, RayBatchFarAway, RayBatchFarAway );
+         while ( ( data.objects.size() - group.firstCandidate ) % 4 )
+            data.addCandidate( NULL, Box3F( farAway, farAway ) );
+
+         group.numCandidates = data.objects.size() - group.firstCandidate;
+      }
+   }
+
+   // Test the rays against the candidate boxes.  Large batches are cut
+   // into runs of groups with the first run done here while the thread
+   // pool takes the others.
+   Vector< RayBatchHit > localHits;
+   ThreadPoolJobGroup< RayBatchJob > jobs;
+   {
+      PROFILE_SCOPE( SceneContainer_castRayBatch_Boxes );
+
+      U32 localEnd = data.groups.size();
+      U32 runBegin = 0;
+      U32 runRays = 0;
+
+      for ( U32 g = 0; g < data.groups.size(); g++ )
+      {
+         runRays += data.groups[ g ].numRays;
+         if ( runRays < RayBatchMinRaysPerJob || g + 1 == data.groups.size() )
+            continue;
+
+         if ( localEnd == data.groups.size() )
+            localEnd = g + 1;
+         else
+            jobs.queue( new RayBatchJob( &data, runBegin, g + 1 ) );
+
+         runBegin = g + 1;
+         runRays = 0;
+      }
+
+      // Whatever is left over after the last full run.
+      if ( runBegin > 0 && runBegin < data.groups.size() )
+         jobs.queue( new RayBatchJob( &data, runBegin, data.groups.size() ) );
+
+      _rayBatchTestGroups( data, 0, localEnd, localHits );
+
+      jobs.wait();
+   }
+
+   // Run the narrow phase for the boxes each ray passes through,
+   // nearest first.  Object castRay() implementations are not thread
+   // safe so this stays on the calling thread.
+   PROFILE_SCOPE( SceneContainer_castRayBatch_Objects );
+
+   U32 numHits = 0;
+
+   for ( S32 run = -1; run < ( S32 ) jobs.size(); run++ )
+   {
+      Vector< RayBatchHit >& hits = run < 0 ? localHits : jobs[ run ]->mHits;
+
+      for ( U32 first = 0; first < hits.size(); )
+      {
+         const U32 rayIndex = hits[ first ].ray;
+         const BatchRay& ray = rays[ rayIndex ];
+
+         U32 last = first + 1;
+         while ( last < hits.size() && hits[ last ].ray == rayIndex )
+            last++;
+
+         dQsort( hits.address() + first, last - first, sizeof( RayBatchHit ), _rayBatchHitCompare );
+
+         F32 currentT = 2.0f;
+         RayInfo info;
+
+         for ( U32 i = first; i < last; i++ )
+         {
+            if ( hits[ i ].t > currentT )
+               break;
+
+            SceneObject* ptr = data.objects[ hits[ i ].candidate ];
+            if ( !ptr || ptr == ray.exempt || !( ptr->getTypeMask() & ray.mask ) || !ptr->isCollisionEnabled() )
+               continue;
+
+            Point3F xformedStart, xformedEnd;
+            ptr->mWorldToObj.mulP( ray.start, &xformedStart );
+            ptr->mWorldToObj.mulP( ray.end, &xformedEnd );
+            xformedStart.convolveInverse( ptr->mObjScale );
+            xformedEnd.convolveInverse( ptr->mObjScale );
+
+            RayInfo ri;
+            if ( ptr->castRay( xformedStart, xformedEnd, &ri ) && ri.t < currentT )
+            {
+               info = ri;
+               currentT = ri.t;
+
+               if ( anyHit )
+                  break;
+            }
+         }
+
+         first = last;
+
+         if ( currentT == 2.0f )
+            continue;
+
+         outHits[ rayIndex ] = true;
+         numHits++;
+
+         if ( !outInfos )
+            continue;
+
+         info.point.interpolate( ray.start, ray.end, info.t );
+         info.distance = ( ray.start - info.point ).len();
+
+         // Bump the normal into worldspace.
+         PlaneF fakePlane;
+         fakePlane.x = info.normal.x;
+         fakePlane.y = info.normal.y;
+         fakePlane.z = info.normal.z;
+         fakePlane.d = 0;
+
+         PlaneF result;
+         mTransformPlane( info.object->getTransform(), info.object->getScale(), fakePlane, &result );
+         info.normal = result;
+
+         outInfos[ rayIndex ] = info;
+      }
+   }
+
+   return numHits;
+}
+
+//-----------------------------------------------------------------------------
+
+DefineEngineFunction( containerRayCastBatch, const char*,
+   ( const char* rays, U32 mask, SceneObject *pExempt, bool useClientContainer ), ( NULL, false ),
+   "@brief Cast many rays at once, checking for collision against items matching mask.\n\n"
+
+   "Gives the same results as calling containerRayCast() for each ray but shares the "
+   "work of finding candidate objects between nearby rays.\n"
+
+   "@param rays Newline separated list of rays, each given as \"startX startY startZ endX endY endZ\".\n"
+   "@param mask A bitmask corresponding to the type of objects to check for\n"
+   "@param pExempt An optional ID for a single object that ignored for these raycasts\n"
+   "@param useClientContainer Optionally indicates the search should be within the "
+   "client container.\n"
+
+   "@returns A newline separated list with one line for each ray, in the same format "
+   "as the result of containerRayCast().\n"
+
+   "@see containerRayCast\n"
+   "@ingroup Game")
+{
+   SceneContainer* pContainer = useClientContainer ? &gClientContainer : &gServerContainer;
+
+   const U32 numRays = StringUnit::getUnitCount( rays, "\n" );
+   if ( !numRays )
+      return "";
+
+   Vector< SceneContainer::BatchRay > batch( numRays );
+   batch.setSize( numRays );
+
+   for ( U32 i = 0; i < numRays; i++ )
+   {
+      SceneContainer::BatchRay& ray = batch[ i ];
+      dSscanf( StringUnit::getUnit( rays, i, "\n" ), "%g %g %g %g %g %g",
+               &ray.start.x, &ray.start.y, &ray.start.z,
+               &ray.end.x, &ray.end.y, &ray.end.z );
+      ray.mask = mask;
+      ray.exempt = pExempt;
+   }
+
+   Vector< bool > hits( numRays );
+   hits.setSize( numRays );
+   Vector< RayInfo > infos( numRays );
+   infos.setSize( numRays );
+
+   pContainer->castRayBatch( batch.address(), numRays, hits.address(), infos.address() );
+
+   const U32 lineSize = 256;
+   char *returnBuffer = Con::getReturnBuffer( numRays * lineSize );
+   U32 length = 0;
+
+   for ( U32 i = 0; i < numRays; i++ )
+   {
+      if ( i > 0 )
+         returnBuffer[ length++ ] = '\n';
+
+      if ( hits[ i ] )
+      {
+         const RayInfo& rinfo = infos[ i ];
+         length += dSprintf( returnBuffer + length, lineSize, "%d %g %g %g %g %g %g %g",
+                             rinfo.object->getId(), rinfo.point.x, rinfo.point.y, rinfo.point.z,
+                             rinfo.normal.x, rinfo.normal.y, rinfo.normal.z, rinfo.distance );
+      }
+      else
+         returnBuffer[ length++ ] = '0';
+   }
+
+   returnBuffer[ length ] = '\0';
+   return returnBuffer;
+}
@@ -0,0 +1,500 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "scene/sceneInterestGrid.h"
+
+#include "scene/sceneObject.h"
+#include "sim/netConnection.h"
+#include "console/engineAPI.h"
+#include "platform/profiler.h"
+
+
+bool SceneInterestGrid::smEnabled = true;
+F32 SceneInterestGrid::smCellSize = 64.0f;
+Map<StringTableEntry,F32> SceneInterestGrid::smClassDistances;
+U32 SceneInterestGrid::smGeneration = 0;
+
+/// Objects with a class visible distance covering more cells
+/// than this are tested by every connection instead.
+static const S32 MaxReacherCells = 1024;
+
+
+SceneInterestGrid::SceneInterestGrid()
+   :  mGeneration( smGeneration ),
+      mCellSize( getMax( smCellSize, 1.0f ) )
+{
+}
+
+SceneInterestGrid::~SceneInterestGrid()
+{
+   for ( Map<U32,Cell*>::Iterator iter = mCells.begin(); iter != mCells.end(); ++iter )
+      delete iter->value;
+   for ( Map<U32,Entry*>::Iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter )
+      delete iter->value;
+   for ( Map<U32,Subscriber*>::Iterator iter = mSubscribers.begin(); iter != mSubscribers.end(); ++iter )
+      delete iter->value;
+}
+
+void SceneInterestGrid::setClassVisibleDistance( const char *className, F32 distance )
+{
+   StringTableEntry name = StringTable->insert( className );
+   if ( distance > 0.0f )
+      smClassDistances[ name ] = distance;
+   else
+      smClassDistances.erase( name );
+
+   // Every grid needs to place its objects again.
+   smGeneration++;
+}
+
+F32 SceneInterestGrid::_getClassVisibleDistance( SceneObject *object )
+{
+   if ( smClassDistances.isEmpty() )
+      return 0.0f;
+
+   for ( AbstractClassRep *rep = object->getClassRep(); rep; rep = rep->getParentClass() )
+   {
+      Map<StringTableEntry,F32>::Iterator iter = smClassDistances.find( rep->getClassName() );
+      if ( iter != smClassDistances.end() )
+         return iter->value;
+   }
+
+   return 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+
+S32 SceneInterestGrid::_getCellCoord( F32 value ) const
+{
+   // Clamp so that the coordinates fit the cell keys.
+   F32 coord = mFloor( value / mCellSize );
+   return S32( mClampF( coord, -32768.0f, 32767.0f ) );
+}
+
+RectI SceneInterestGrid::_getCellRect( const Point3F &center, F32 radius ) const
+{
+   Point2I minCell( _getCellCoord( center.x - radius ), _getCellCoord( center.y - radius ) );
+   Point2I maxCell( _getCellCoord( center.x + radius ), _getCellCoord( center.y + radius ) );
+   return RectI( minCell, maxCell - minCell + Point2I( 1, 1 ) );
+}
+
+SceneInterestGrid::Cell* SceneInterestGrid::_getCell( S32 x, S32 y )
+{
+   Cell *&cell = mCells[ _getCellKey( x, y ) ];
+   if ( !cell )
+      cell = new Cell;
+   return cell;
+}
+
+SceneInterestGrid::Cell* SceneInterestGrid::_findCell( S32 x, S32 y )
+{
+   Map<U32,Cell*>::Iterator iter = mCells.find( _getCellKey( x, y ) );
+   return iter != mCells.end() ? iter->value : NULL;
+}
+
+void SceneInterestGrid::_validate()
+{
+   if ( mGeneration != smGeneration || mCellSize != getMax( smCellSize, 1.0f ) )
+      _rebuild();
+}
+
+void SceneInterestGrid::_rebuild()
+{
+   mGeneration = smGeneration;
+   mCellSize = getMax( smCellSize, 1.0f );
+
+   for ( Map<U32,Cell*>::Iterator iter = mCells.begin(); iter != mCells.end(); ++iter )
+      delete iter->value;
+   mCells.clear();
+   mOverflow.clear();
+
+   // Subscribers start over on their next scope.
+   for ( Map<U32,Subscriber*>::Iterator iter = mSubscribers.begin(); iter != mSubscribers.end(); ++iter )
+   {
+      iter->value->subscribed = false;
+      iter->value->interest.clear();
+   }
+
+   for ( Map<U32,Entry*>::Iterator iter = mEntries.begin(); iter != mEntries.end(); ++iter )
+   {
+      Entry *entry = iter->value;
+      entry->visibleDistance = _getClassVisibleDistance( entry->object );
+      _placeObject( entry );
+      _insertObject( entry );
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneInterestGrid::_placeObject( Entry *entry ) const
+{
+   SceneObject *object = entry->object;
+   const SphereF &sphere = object->getWorldSphere();
+
+   entry->cells = RectI( 0, 0, 0, 0 );
+
+   if ( object->isGlobalBounds() || sphere.radius > mCellSize )
+      entry->type = Overflow;
+   else if ( entry->visibleDistance > 0.0f )
+   {
+      entry->type = Reacher;
+      entry->cells = _getCellRect( sphere.center, entry->visibleDistance + sphere.radius );
+
+      if ( entry->cells.extent.x * entry->cells.extent.y > MaxReacherCells )
+      {
+         entry->type = Overflow;
+         entry->cells = RectI( 0, 0, 0, 0 );
+      }
+   }
+   else
+   {
+      entry->type = Resident;
+      entry->cells = RectI( _getCellCoord( sphere.center.x ), _getCellCoord( sphere.center.y ), 1, 1 );
+   }
+}
+
+void SceneInterestGrid::_insertObject( Entry *entry )
+{
+   const U32 id = entry->object->getId();
+   const RectI &cells = entry->cells;
+
+   switch ( entry->type )
+   {
+      case Resident:
+      {
+         Cell *cell = _getCell( cells.point.x, cells.point.y );
+         cell->residents.push_back( entry );
+
+         for ( U32 i = 0; i < cell->subscribers.size(); i++ )
+            cell->subscribers[i]->interest[ id ] = entry;
+         break;
+      }
+
+      case Reacher:
+         for ( S32 y = cells.point.y; y < cells.point.y + cells.extent.y; y++ )
+         {
+            for ( S32 x = cells.point.x; x < cells.point.x + cells.extent.x; x++ )
+            {
+               Cell *cell = _getCell( x, y );
+               cell->reachers.push_back( entry );
+
+               for ( U32 i = 0; i < cell->cameras.size(); i++ )
+                  cell->cameras[i]->interest[ id ] = entry;
+            }
+         }
+         break;
+
+      case Overflow:
+         mOverflow.push_back( entry );
+         break;
+   }
+}
+
+void SceneInterestGrid::_extractObject( Entry *entry )
+{
+   const U32 id = entry->object->getId();
+   const RectI &cells = entry->cells;
+
+   switch ( entry->type )
+   {
+      case Resident:
+      {
+         Cell *cell = _findCell( cells.point.x, cells.point.y );
+         if ( !cell )
+            break;
+
+         cell->residents.remove( entry );
+
+         for ( U32 i = 0; i < cell->subscribers.size(); i++ )
+            cell->subscribers[i]->interest.erase( id );
+         break;
+      }
+
+      case Reacher:
+         for ( S32 y = cells.point.y; y < cells.point.y + cells.extent.y; y++ )
+         {
+            for ( S32 x = cells.point.x; x < cells.point.x + cells.extent.x; x++ )
+            {
+               Cell *cell = _findCell( x, y );
+               if ( !cell )
+                  continue;
+
+               cell->reachers.remove( entry );
+
+               for ( U32 i = 0; i < cell->cameras.size(); i++ )
+                  cell->cameras[i]->interest.erase( id );
+            }
+         }
+         break;
+
+      case Overflow:
+         mOverflow.remove( entry );
+         break;
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneInterestGrid::addObject( SceneObject *object )
+{
+   _validate();
+
+   const U32 id = object->getId();
+   if ( mEntries.contains( id ) )
+   {
+      updateObject( object );
+      return;
+   }
+
+   Entry *entry = new Entry;
+   entry->object = object;
+   entry->visibleDistance = _getClassVisibleDistance( object );
+   _placeObject( entry );
+
+   mEntries.insert( id, entry );
+   _insertObject( entry );
+}
+
+void SceneInterestGrid::removeObject( SceneObject *object )
+{
+   Map<U32,Entry*>::Iterator iter = mEntries.find( object->getId() );
+   if ( iter == mEntries.end() )
+      return;
+
+   Entry *entry = iter->value;
+   _extractObject( entry );
+   mEntries.erase( iter );
+   delete entry;
+}
+
+void SceneInterestGrid::updateObject( SceneObject *object )
+{
+   Map<U32,Entry*>::Iterator iter = mEntries.find( object->getId() );
+   if ( iter == mEntries.end() )
+      return;
+
+   Entry *entry = iter->value;
+
+   Entry placed = *entry;
+   _placeObject( &placed );
+
+   // Most moves stay within the same cells.
+   if ( placed.type == entry->type && placed.cells == entry->cells )
+      return;
+
+   _extractObject( entry );
+   entry->type = placed.type;
+   entry->cells = placed.cells;
+   _insertObject( entry );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneInterestGrid::_subscribe( Subscriber *subscriber, const RectI &cells, const Point2I &camera )
+{
+   const RectI oldCells = subscriber->subscribed ? subscriber->cells : RectI( 0, 0, 0, 0 );
+
+   // Leave the cells no longer covered.
+   for ( S32 y = oldCells.point.y; y < oldCells.point.y + oldCells.extent.y; y++ )
+   {
+      for ( S32 x = oldCells.point.x; x < oldCells.point.x + oldCells.extent.x; x++ )
+      {
+         if ( cells.pointInRect( Point2I( x, y ) ) )
+            continue;
+
+         Cell *cell = _findCell( x, y );
+         if ( !cell )
+            continue;
+
+         cell->subscribers.remove( subscriber );
+         for ( U32 i = 0; i < cell->residents.size(); i++ )
+            subscriber->interest.erase( cell->residents[i]->object->getId() );
+      }
+   }
+
+   // Enter the newly covered cells.
+   for ( S32 y = cells.point.y; y < cells.point.y + cells.extent.y; y++ )
+   {
+      for ( S32 x = cells.point.x; x < cells.point.x + cells.extent.x; x++ )
+      {
+         if ( oldCells.pointInRect( Point2I( x, y ) ) )
+            continue;
+
+         Cell *cell = _getCell( x, y );
+         cell->subscribers.push_back( subscriber );
+         for ( U32 i = 0; i < cell->residents.size(); i++ )
+            subscriber->interest[ cell->residents[i]->object->getId() ] = cell->residents[i];
+      }
+   }
+
+   // Move the camera between cells.
+   if ( !subscriber->subscribed || camera != subscriber->camera )
+   {
+      if ( subscriber->subscribed )
+      {
+         Cell *cell = _findCell( subscriber->camera.x, subscriber->camera.y );
+         if ( cell )
+         {
+            cell->cameras.remove( subscriber );
+            for ( U32 i = 0; i < cell->reachers.size(); i++ )
+               subscriber->interest.erase( cell->reachers[i]->object->getId() );
+         }
+      }
+
+      Cell *cell = _getCell( camera.x, camera.y );
+      cell->cameras.push_back( subscriber );
+      for ( U32 i = 0; i < cell->reachers.size(); i++ )
+         subscriber->interest[ cell->reachers[i]->object->getId() ] = cell->reachers[i];
+   }
+
+   subscriber->cells = cells;
+   subscriber->camera = camera;
+   subscriber->subscribed = true;
+}
+
+void SceneInterestGrid::_unsubscribe( Subscriber *subscriber )
+{
+   if ( subscriber->subscribed )
+   {
+      const RectI &cells = subscriber->cells;
+      for ( S32 y = cells.point.y; y < cells.point.y + cells.extent.y; y++ )
+      {
+         for ( S32 x = cells.point.x; x < cells.point.x + cells.extent.x; x++ )
+         {
+            Cell *cell = _findCell( x, y );
+            if ( cell )
+               cell->subscribers.remove( subscriber );
+         }
+      }
+
+      Cell *cell = _findCell( subscriber->camera.x, subscriber->camera.y );
+      if ( cell )
+         cell->cameras.remove( subscriber );
+   }
+
+   subscriber->interest.clear();
+   subscriber->subscribed = false;
+}
+
+static inline void _scopeEntry( NetConnection *connection, SceneObject *object, const Point3F &pos, F32 scopeDist )
+{
+   if ( !object->isScopeable() )
+      return;
+
+   // Same tests as the container based scoping, a box query with sides
+   // of the scoping distance followed by the sphere check.
+   Box3F area( scopeDist );
+   area.setCenter( pos );
+   if ( !object->isGlobalBounds() && !object->getWorldBox().isOverlapped( area ) )
+      return;
+
+   const SphereF &sphere = object->getWorldSphere();
+   F32 difSq = ( sphere.center - pos ).lenSquared();
+   if ( difSq < scopeDist * scopeDist || mSqrt( difSq ) - sphere.radius < scopeDist )
+      connection->objectInScope( object );
+}
+
+void SceneInterestGrid::scope( CameraScopeQuery *query, NetConnection *connection )
+{
+   PROFILE_SCOPE( SceneInterestGrid_scope );
+
+   _validate();
+
+   Subscriber *&subscriber = mSubscribers[ connection->getId() ];
+   if ( !subscriber )
+      subscriber = new Subscriber;
+
+   // The id may have been reused by a new connection.
+   if ( subscriber->connection != connection )
+   {
+      _unsubscribe( subscriber );
+      subscriber->connection = connection;
+   }
+
+   // The query box extends half the visible distance either side of the
+   // camera.  Residents are no larger than a cell so cover one extra cell
+   // to catch those overlapping the edge.
+   const F32 visibleDistance = query->visibleDistance;
+   RectI cells = _getCellRect( query->pos, visibleDistance * 0.5f + mCellSize );
+   Point2I camera( _getCellCoord( query->pos.x ), _getCellCoord( query->pos.y ) );
+
+   if ( !subscriber->subscribed || cells != subscriber->cells || camera != subscriber->camera )
+      _subscribe( subscriber, cells, camera );
+
+   // Now distance test only the objects we're interested in.
+   for ( Map<U32,Entry*>::Iterator iter = subscriber->interest.begin(); iter != subscriber->interest.end(); ++iter )
+   {
+      Entry *entry = iter->value;
+      F32 scopeDist = entry->visibleDistance > 0.0f ? entry->visibleDistance : visibleDistance;
+      _scopeEntry( connection, entry->object, query->pos, scopeDist );
+   }
+
+   for ( U32 i = 0; i < mOverflow.size(); i++ )
+   {
+      Entry *entry = mOverflow[i];
+      F32 scopeDist = entry->visibleDistance > 0.0f ? entry->visibleDistance : visibleDistance;
+      _scopeEntry( connection, entry->object, query->pos, scopeDist );
+   }
+}
+
+void SceneInterestGrid::removeConnection( NetConnection *connection )
+{
+   Map<U32,Subscriber*>::Iterator iter = mSubscribers.find( connection->getId() );
+   if ( iter == mSubscribers.end() )
+      return;
+
+   Subscriber *subscriber = iter->value;
+   _unsubscribe( subscriber );
+   mSubscribers.erase( iter );
+   delete subscriber;
+}
+
+//-----------------------------------------------------------------------------
+
+DefineEngineFunction( setClassVisibleDistance, void, ( const char *className, F32 distance ),,
+   "@brief Overrides the distance at which objects of a class and its subclasses are "
+   "scoped to clients.\n\n"
+
+   "By default objects are scoped within the visible distance of the client's camera.  "
+   "This can be used to, for example, keep large vehicles in scope further away or drop "
+   "small effects sooner.\n\n"
+
+   "@param className The name of the class.\n"
+   "@param distance The scoping distance in meters, or 0 to remove the override.\n\n"
+
+   "@tsexample\n"
+      "setClassVisibleDistance( \"FlyingVehicle\", 2000 );\n"
+   "@endtsexample\n\n"
+
+   "@see $pref::Net::interestGrid\n\n"
+
+   "@ingroup Networking")
+{
+   if ( !AbstractClassRep::findClassRep( className ) )
+   {
+      Con::errorf( "setClassVisibleDistance - Unknown class '%s'.", className );
+      return;
+   }
+
+   SceneInterestGrid::setClassVisibleDistance( className, distance );
+}
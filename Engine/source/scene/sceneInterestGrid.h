@@ -0,0 +1,197 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _SCENEINTERESTGRID_H_
+#define _SCENEINTERESTGRID_H_
+
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+#ifndef _MRECT_H_
+#include "math/mRect.h"
+#endif
+#ifndef _MPOINT3_H_
+#include "math/mPoint3.h"
+#endif
+#ifndef _SIMOBJECT_H_
+#include "console/simObject.h"
+#endif
+
+class SceneObject;
+class NetConnection;
+struct CameraScopeQuery;
+
+
+/// Server side interest management for ghost scoping.
+///
+/// The grid divides the world into square cells on the XY plane.  Every
+/// connection subscribes to the cells covered by the same box around its
+/// camera that the container query used, with sides of the visible distance,
+/// and keeps a set of the objects it is interested in.  As objects
+/// move between cells and cameras move between cells the sets are updated
+/// with enter and leave events, so scoping a connection no longer queries
+/// the container.  Each packet only the objects in the set are box and
+/// distance tested and scoped, exactly as the container query did.
+///
+/// Classes can override the visible distance of their objects.  Such
+/// objects are inserted into every cell within their distance and found
+/// through the cell holding the camera instead.  Objects larger than a cell
+/// or with global bounds are tested against every connection.
+///
+/// @see SceneManager::scopeScene
+class SceneInterestGrid
+{
+public:
+
+   /// If false SceneManager::scopeScene queries the container directly.
+   static bool smEnabled;
+
+   /// Width of the grid cells in meters.
+   static F32 smCellSize;
+
+   /// Overrides the visible distance for objects of the class and its
+   /// subclasses.  A distance of zero or less removes the override.
+   static void setClassVisibleDistance( const char *className, F32 distance );
+
+   SceneInterestGrid();
+   ~SceneInterestGrid();
+
+   /// Adds an object to the grid.
+   void addObject( SceneObject *object );
+
+   /// Removes an object, sending leave events to all its subscribers.
+   void removeObject( SceneObject *object );
+
+   /// Moves an object between cells if it changed cells.
+   void updateObject( SceneObject *object );
+
+   /// Updates the subscription of the connection for the query
+   /// and scopes all the objects it is interested in.
+   void scope( CameraScopeQuery *query, NetConnection *connection );
+
+   /// Drops the subscription of the connection.
+   void removeConnection( NetConnection *connection );
+
+protected:
+
+   enum ObjectType
+   {
+      /// Held in the cell containing its center.
+      Resident,
+
+      /// Has a class visible distance and is held in
+      /// every cell within that distance.
+      Reacher,
+
+      /// Too large for a cell and tested by every connection.
+      Overflow,
+   };
+
+   struct Entry;
+   struct Subscriber;
+
+   struct Cell
+   {
+      Vector<Entry*> residents;
+      Vector<Entry*> reachers;
+
+      /// Connections whose visible area covers this cell.
+      Vector<Subscriber*> subscribers;
+
+      /// Connections whose camera is in this cell.
+      Vector<Subscriber*> cameras;
+   };
+
+   struct Entry
+   {
+      SceneObject *object;
+      ObjectType type;
+
+      /// Cells the object is held in.
+      RectI cells;
+
+      /// Class visible distance or zero.
+      F32 visibleDistance;
+   };
+
+   struct Subscriber
+   {
+      SimObjectPtr<NetConnection> connection;
+
+      /// Cells covered by the camera's visible area.
+      RectI cells;
+
+      /// Cell holding the camera.
+      Point2I camera;
+
+      /// True once cells and camera are set.
+      bool subscribed;
+
+      /// Objects this connection is interested in, by id.
+      Map<U32,Entry*> interest;
+
+      Subscriber() : subscribed( false ) {}
+   };
+
+   /// Class visible distance overrides by class name.
+   static Map<StringTableEntry,F32> smClassDistances;
+
+   /// Bumped whenever the grid needs to be rebuilt.
+   static U32 smGeneration;
+
+   U32 mGeneration;
+   F32 mCellSize;
+
+   Map<U32,Cell*> mCells;
+   Map<U32,Entry*> mEntries;
+   Map<U32,Subscriber*> mSubscribers;
+   Vector<Entry*> mOverflow;
+
+   static U32 _getCellKey( S32 x, S32 y ) { return ( U32( x & 0xFFFF ) << 16 ) | U32( y & 0xFFFF ); }
+   S32 _getCellCoord( F32 value ) const;
+   RectI _getCellRect( const Point3F &center, F32 radius ) const;
+
+   Cell* _getCell( S32 x, S32 y );
+   Cell* _findCell( S32 x, S32 y );
+
+   /// Rebuilds the grid if the cell size or class overrides changed.
+   void _validate();
+
+   /// Returns the class visible distance for the object or zero.
+   static F32 _getClassVisibleDistance( SceneObject *object );
+
+   /// Computes the type and cells of the entry from its object.
+   void _placeObject( Entry *entry ) const;
+
+   void _insertObject( Entry *entry );
+   void _extractObject( Entry *entry );
+
+   void _subscribe( Subscriber *subscriber, const RectI &cells, const Point2I &camera );
+   void _unsubscribe( Subscriber *subscriber );
+
+   void _rebuild();
+};
+
+#endif // _SCENEINTERESTGRID_H_
@@ -24,6 +24,7 @@
 #include "scene/sceneManager.h"
 
 #include "scene/sceneObject.h"
+#include "scene/sceneInterestGrid.h"
 #include "scene/zones/sceneTraversalState.h"
 #include "scene/sceneRenderState.h"
 #include "scene/zones/sceneRootZone.h"
@@ -34,6 +35,8 @@
 #include "gfx/gfxDrawUtil.h"
 #include "gfx/gfxDebugEvent.h"
 #include "console/engineAPI.h"
+#include "platform/threads/threadPoolJob.h"
+#include "platform/platformSlabAllocator.h"
 #include "sim/netConnection.h"
 #include "T3D/gameBase/gameConnection.h"
 
@@ -84,6 +87,16 @@ MODULE_BEGIN( Scene )
       Con::addVariable( "$Scene::occluderMinHeightPercentage", TypeF32, &SceneCullingState::smOccluderMinHeightPercentage,
          "TODO\n\n"
          "@ingroup Rendering" );
+
+      Con::addVariable( "$pref::Net::interestGrid", TypeBool, &SceneInterestGrid::smEnabled,
+         "If true, the server scopes objects to clients through an incrementally updated grid of "
+         "interest cells instead of querying the scene for every client on every packet.\n\n"
+         "@ingroup Networking" );
+
+      Con::addVariable( "$pref::Net::interestCellSize", TypeF32, &SceneInterestGrid::smCellSize,
+         "Width in meters of the cells in the server's interest grid.  Objects larger than a cell "
+         "are tested against every client.\n\n"
+         "@ingroup Networking" );
    }
    
    MODULE_SHUTDOWN
@@ -103,6 +116,71 @@ SceneManager* gClientSceneGraph = NULL;
 SceneManager* gServerSceneGraph = NULL;
 
 
+/// A cull queued with SceneManager::queueCull().
+struct SceneManager::QueuedCull
+{
+   /// Culling frustum of the view.  Kept updated so the planes can
+   /// be read from the thread pool.
+   Frustum frustum;
+
+   /// Object types to gather.
+   U32 objectMask;
+
+   /// Objects in the zones that are not fully outside of #frustum.
+   Vector< SceneObject* > objects;
+
+   /// Scratch space for the zone query.
+   Vector< S8 > cullResults;
+};
+
+/// Runs the zone query for a queued cull on the thread pool.
+///
+/// The global pool is shared with long running background jobs, so the
+/// render thread doesn't wait for a worker to pick the cull up.  Whichever
+/// of the two claims it first does the work.
+struct QueuedCullJob : public ThreadPoolJob
+{
+   const SceneZoneSpaceManager* mZoneManager;
+   SceneManager::QueuedCull* mCull;
+
+   /// Set once a thread has taken the cull.
+   volatile U32 mClaimed;
+
+   QueuedCullJob( const SceneZoneSpaceManager* zoneManager, SceneManager::QueuedCull* cull )
+      : mZoneManager( zoneManager ),
+        mCull( cull ),
+        mClaimed( 0 ) {}
+
+   /// Run the cull on the calling thread unless a worker has
+   /// already started it.  Returns true if we ran it.
+   bool runIfUnclaimed()
+   {
+      if( !dCompareAndSwap( mClaimed, 0, 1 ) )
+         return false;
+
+      runCull( mZoneManager, mCull );
+      return true;
+   }
+
+   static void runCull( const SceneZoneSpaceManager* zoneManager, SceneManager::QueuedCull* cull )
+   {
+      cull->objects.clear();
+      zoneManager->findObjects(
+         cull->frustum.getBounds(),
+         cull->frustum.getPlanes(),
+         cull->frustum.getNumPlanes(),
+         cull->objectMask,
+         &cull->objects,
+         &cull->cullResults
+      );
+   }
+
+protected:
+
+   virtual void run() { runIfUnclaimed(); }
+};
+
+
 //-----------------------------------------------------------------------------
 
 SceneManager::SceneManager( bool isClient )
@@ -115,9 +193,12 @@ SceneManager::SceneManager( bool isClient )
      mVisibleDistance( 500.f ),
      mNearClip( 0.1f ),
      mAmbientLightColor( ColorF( 0.1f, 0.1f, 0.1f, 1.0f ) ),
-     mZoneManager( NULL )
+     mZoneManager( NULL ),
+     mInterestGrid( NULL ),
+     mNumQueuedCulls( 0 )
 {
    VECTOR_SET_ASSOCIATION( mBatchQueryList );
+   VECTOR_SET_ASSOCIATION( mQueuedCulls );
 
    // For the client, create a zone manager.
 
@@ -129,6 +210,8 @@ SceneManager::SceneManager( bool isClient )
 
       addObjectToScene( mZoneManager->getRootZone() );
    }
+   else
+      mInterestGrid = new SceneInterestGrid;
 }
 
 //-----------------------------------------------------------------------------
@@ -136,6 +219,10 @@ SceneManager::SceneManager( bool isClient )
 SceneManager::~SceneManager()
 {   
    SAFE_DELETE( mZoneManager );
+   SAFE_DELETE( mInterestGrid );
+
+   for( U32 i = 0; i < mQueuedCulls.size(); ++ i )
+      delete mQueuedCulls[ i ];
 
    if( mLightManager )
       mLightManager->deactivate();   
@@ -187,6 +274,7 @@ void SceneManager::renderScene( ScenePassType passType, U32 objectMask )
 void SceneManager::renderScene( SceneRenderState* renderState, U32 objectMask, SceneZoneSpace* baseObject, U32 baseZone )
 {
    PROFILE_SCOPE( SceneGraph_renderScene );
+   SLAB_TAG_SCOPE( Rendering );
 
    // Get the lights for rendering the scene.
 
@@ -424,15 +512,33 @@ void SceneManager::_renderScene( SceneRenderState* state, U32 objectMask, SceneZ
 
    PROFILE_START( Scene_cullObjects );
 
-   //TODO: We should split the codepaths here based on whether the outdoor zone has visible space.
-   //    If it has, we should use the container query-based path.
-   //    If it hasn't, we should fill the object list directly from the zone lists which will usually
-   //       include way fewer objects.
-   
-   // Gather all objects that intersect the scene render box.
+   // Gather all objects that intersect the scene render box.  Outside of the
+   // editor, go through the packed zone bounds and reject everything outside
+   // the culling frustum right away.  The editor needs the full box query as
+   // objects may render visualizations even if they are otherwise culled.
 
    mBatchQueryList.clear();
-   getContainer()->findObjectList( queryBox, objectMask, &mBatchQueryList );
+   const QueuedCull* queuedCull = _findQueuedCull( state->getCullingFrustum(), objectMask );
+   if( queuedCull )
+   {
+      // The zones have already been queried for the frustum.  What is
+      // left is to clip the results to the traversed area.
+
+      const U32 numObjects = queuedCull->objects.size();
+      for( U32 i = 0; i < numObjects; ++ i )
+      {
+         SceneObject* object = queuedCull->objects[ i ];
+         if( object->isGlobalBounds() || object->getWorldBox().isOverlapped( queryBox ) )
+            mBatchQueryList.push_back( object );
+      }
+   }
+   else if( getZoneManager() && !gEditingMission )
+   {
+      const Frustum& cullingFrustum = state->getCullingFrustum();
+      getZoneManager()->findObjects( queryBox, cullingFrustum.getPlanes(), cullingFrustum.getNumPlanes(), objectMask, &mBatchQueryList );
+   }
+   else
+      getContainer()->findObjectList( queryBox, objectMask, &mBatchQueryList );
 
    // Cull the list.
 
@@ -512,6 +618,89 @@ void SceneManager::_renderScene( SceneRenderState* state, U32 objectMask, SceneZ
 
 //-----------------------------------------------------------------------------
 
+void SceneManager::queueCull( const Frustum& frustum, U32 objectMask )
+{
+   // The editor gathers objects with the container so
+   // there is nothing to prepare.
+
+   if( !getZoneManager() || gEditingMission )
+      return;
+
+   if( mNumQueuedCulls == mQueuedCulls.size() )
+      mQueuedCulls.push_back( new QueuedCull );
+
+   QueuedCull* cull = mQueuedCulls[ mNumQueuedCulls ++ ];
+
+   // Match what SceneCullingState does to the camera frustum and
+   // force the plane update here on the main thread.
+
+   cull->frustum = frustum;
+   cull->frustum.bakeProjectionOffset();
+   cull->frustum.update();
+
+   cull->objectMask = objectMask;
+   cull->objects.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneManager::runQueuedCulls()
+{
+   if( !mNumQueuedCulls )
+      return;
+
+   PROFILE_SCOPE( SceneManager_runQueuedCulls );
+
+   // The zone queries need the packed zone bounds to be current.
+
+   SceneZoneSpaceManager* zoneManager = getZoneManager();
+   zoneManager->updateZoningState();
+
+   // Hand all but the first cull to the thread pool and do the
+   // first one ourselves.  Then do any culls that no worker has
+   // started, so we only wait on the ones already in progress.
+
+   Vector< ThreadSafeRef< QueuedCullJob > > jobs;
+   jobs.reserve( mNumQueuedCulls - 1 );
+
+   for( U32 i = 1; i < mNumQueuedCulls; ++ i )
+   {
+      jobs.push_back( new QueuedCullJob( zoneManager, mQueuedCulls[ i ] ) );
+      ThreadPool::GLOBAL().queueWorkItem( jobs.last() );
+   }
+
+   QueuedCullJob::runCull( zoneManager, mQueuedCulls[ 0 ] );
+
+   // A job we ran ourselves is left for its worker to skip
+   // whenever the pool gets to it.
+   for( S32 i = 0; i < jobs.size(); ++ i )
+   {
+      if( !jobs[ i ]->runIfUnclaimed() )
+         jobs[ i ]->waitForFinish();
+   }
+}
+
+//-----------------------------------------------------------------------------
+
+const SceneManager::QueuedCull* SceneManager::_findQueuedCull( const Frustum& frustum, U32 objectMask ) const
+{
+   if( !mNumQueuedCulls || gEditingMission )
+      return NULL;
+
+   for( U32 i = 0; i < mNumQueuedCulls; ++ i )
+   {
+      const QueuedCull* cull = mQueuedCulls[ i ];
+      if( cull->objectMask == objectMask &&
+          cull->frustum.isOrtho() == frustum.isOrtho() &&
+          dMemcmp( cull->frustum.getPlanes(), frustum.getPlanes(), sizeof( PlaneF ) * Frustum::getNumPlanes() ) == 0 )
+         return cull;
+   }
+
+   return NULL;
+}
+
+//-----------------------------------------------------------------------------
+
 struct ScopingInfo
 {
    Point3F        scopePoint;
@@ -556,6 +745,15 @@ void SceneManager::scopeScene( CameraScopeQuery* query, NetConnection* netConnec
    //
    // So, we perform a simple box query on the area covered by the camera query
    // and then scope in everything that is in range.
+   //
+   // With the interest grid, the box query is replaced by the set of objects in
+   // the grid cells around the camera which is kept up to date as things move.
+
+   if( mInterestGrid && SceneInterestGrid::smEnabled )
+   {
+      mInterestGrid->scope( query, netConnection );
+      return;
+   }
    
    // Set up scoping info.
 
@@ -596,6 +794,11 @@ bool SceneManager::addObjectToScene( SceneObject* object )
 
       if( getZoneManager() )
          getZoneManager()->registerObject( object );
+
+      // Track the object for scoping.
+
+      if( mInterestGrid )
+         mInterestGrid->addObject( object );
    }
 
    // Notify the object.
@@ -622,6 +825,11 @@ void SceneManager::removeObjectFromScene( SceneObject* obj )
    if( getZoneManager() )
       getZoneManager()->unregisterObject( obj );
 
+   // Remove the object from the interest grid.
+
+   if( mInterestGrid )
+      mInterestGrid->removeObject( obj );
+
    // Clear out the reference to us.
 
    obj->mSceneManager = NULL;
@@ -640,6 +848,11 @@ void SceneManager::notifyObjectDirty( SceneObject* object )
 
    if( getZoneManager() )
       getZoneManager()->notifyObjectChanged( object );
+
+   // Move the object between interest cells.
+
+   if( mInterestGrid )
+      mInterestGrid->updateObject( object );
 }
 
 //-----------------------------------------------------------------------------
@@ -67,6 +67,7 @@ class SceneCameraState;
 class SceneZoneSpace;
 class NetConnection;
 class RenderPassManager;
+class SceneInterestGrid;
 
 
 /// The type of scene pass.
@@ -109,6 +110,9 @@ class SceneManager
       /// A signal used to notify of render passes.
       typedef Signal< void( SceneManager*, const SceneRenderState* ) > RenderSignal;
 
+      /// A cull queued with queueCull().
+      struct QueuedCull;
+
       /// If true use the last stored locked frustum for culling
       /// the diffuse render pass.
       /// @see smLockedDiffuseFrustum
@@ -125,6 +129,10 @@ class SceneManager
       /// Manager for the zones in this scene.
       SceneZoneSpaceManager* mZoneManager;
 
+      /// Interest management for ghost scoping.
+      /// @note Only server scenes have an interest grid.
+      SceneInterestGrid* mInterestGrid;
+
       // NonClipProjection is the projection matrix without oblique frustum clipping
       // applied to it (in reflections)
       MatrixF mNonClipProj;
@@ -194,6 +202,22 @@ class SceneManager
 
       /// @}
 
+      /// @name Culling Prepass
+      /// @{
+
+      /// Culls queued through queueCull().  Entries are reused from frame
+      /// to frame; only the first mNumQueuedCulls of them are live.
+      Vector< QueuedCull* > mQueuedCulls;
+
+      /// Number of live entries in mQueuedCulls.
+      U32 mNumQueuedCulls;
+
+      /// Return the queued cull that was run for the given culling frustum
+      /// and object mask or NULL if there is none.
+      const QueuedCull* _findQueuedCull( const Frustum& frustum, U32 objectMask ) const;
+
+      /// @}
+
    public:
 
       SceneManager( bool isClient );
@@ -207,6 +231,10 @@ class SceneManager
       const SceneZoneSpaceManager* getZoneManager() const { return mZoneManager; }
       SceneZoneSpaceManager* getZoneManager() { return mZoneManager; }
 
+      /// Return the interest grid used to scope objects to connections.
+      /// @note Only server scenes have an interest grid.
+      SceneInterestGrid* getInterestGrid() { return mInterestGrid; }
+
       /// @name SceneObject Management
       /// @{
 
@@ -245,6 +273,26 @@ class SceneManager
       /// Returns the currently active scene state or NULL if no state is currently active.
       SceneRenderState* getCurrentRenderState() const { return mCurrentRenderState; }
 
+      /// Queue gathering the objects matching @ objectMask inside @a frustum
+      /// for a view that will be rendered later in the frame.
+      ///
+      /// All queued culls are run in one go by runQueuedCulls(), split between
+      /// the thread pool and the calling thread.
+      /// When a view with the same culling frustum and object mask is rendered
+      /// afterwards, its object list is taken from the queued cull instead of
+      /// being gathered from the zones on the spot.  This is used to cull all
+      /// shadow maps of a frame in parallel.
+      ///
+      /// @note Only the zone query runs ahead; the final culling (zones, occluders,
+      ///   terrain occlusion) and prepRenderImage() still happen when the view renders.
+      void queueCull( const Frustum& frustum, U32 objectMask );
+
+      /// Run all culls queued with queueCull().
+      void runQueuedCulls();
+
+      /// Drop all queued culls and their results.
+      void clearQueuedCulls() { mNumQueuedCulls = 0; }
+
       static RenderSignal& getPreRenderSignal() 
       { 
          static RenderSignal theSignal;
@@ -199,6 +199,10 @@ class SceneObject : public NetObject, private SceneContainer::Link, public Proce
       {
          /// ID of zone.
          U32 zone;
+
+         /// Index of the object in the zone's packed bounds.
+         /// @see SceneZoneSpaceManager::ZoneObjectBounds
+         U32 boundsIndex;
       };
 
       /// Iterator over the zones that the object is assigned to.
@@ -28,6 +28,7 @@
 #include "scene/sceneContainer.h"
 #include "scene/zones/sceneRootZone.h"
 #include "scene/zones/sceneZoneSpace.h"
+#include "math/mPacket.h"
 
 
 // Uncomment to enable verification code for debugging.  This slows the
@@ -52,6 +53,8 @@ SceneZoneSpaceManager::SceneZoneSpaceManager( SceneContainer* container )
 {
    VECTOR_SET_ASSOCIATION( mZoneSpaces );
    VECTOR_SET_ASSOCIATION( mZoneLists );
+   VECTOR_SET_ASSOCIATION( mZoneBounds );
+   VECTOR_SET_ASSOCIATION( mCullResults );
    VECTOR_SET_ASSOCIATION( mZoneSpacesQueryList );
    VECTOR_SET_ASSOCIATION( mDirtyObjects );
    VECTOR_SET_ASSOCIATION( mDirtyZoneSpaces );
@@ -64,6 +67,10 @@ SceneZoneSpaceManager::~SceneZoneSpaceManager()
    // Delete root zone.
    SAFE_DELETE( mRootZone );
 
+   // Delete the packed bounds of any zones still around.
+   for( U32 i = 0; i < mZoneBounds.size(); ++ i )
+      delete mZoneBounds[ i ];
+
    mNumTotalAllocatedZones = 0;
    mNumActiveZones = 0; 
 }
@@ -87,6 +94,7 @@ void SceneZoneSpaceManager::registerZones( SceneZoneSpace* object, U32 numZones
    // Add an entry to each list that points back to the zone space.
 
    mZoneLists.increment( numZones );
+   mZoneBounds.increment( numZones );
    for( U32 i = zoneRangeStart; i < mNumTotalAllocatedZones; ++ i )
    {
       SceneObject::ZoneRef* zoneRef = smZoneRefChunker.alloc();
@@ -98,6 +106,7 @@ void SceneZoneSpaceManager::registerZones( SceneZoneSpace* object, U32 numZones
       zoneRef->zone      = i;
 
       mZoneLists[ i ] = zoneRef;
+      mZoneBounds[ i ] = new ZoneObjectBounds;
    }
 
    // Add space to list.
@@ -151,6 +160,8 @@ void SceneZoneSpaceManager::unregisterZones( SceneZoneSpace* object )
 
       smZoneRefChunker.free( mZoneLists[ j ] );
       mZoneLists[ j ] = NULL;
+
+      SAFE_DELETE( mZoneBounds[ j ] );
    }
 
    // Destroy the connections the zone space has.
@@ -222,6 +233,9 @@ void SceneZoneSpaceManager::_compactZonesCheck()
    Vector< SceneObject::ZoneRef* > newZoneLists;
    newZoneLists.setSize( mNumActiveZones );
 
+   Vector< ZoneObjectBounds* > newZoneBounds;
+   newZoneBounds.setSize( mNumActiveZones );
+
    for( U32 i = 0; i < numZoneSpaces; ++ i )
    {
       SceneZoneSpace* space = mZoneSpaces[ i ];
@@ -246,6 +260,7 @@ void SceneZoneSpaceManager::_compactZonesCheck()
          // Relocate list.
 
          newZoneLists[ newZoneId ] = mZoneLists[ oldZoneId ];
+         newZoneBounds[ newZoneId ] = mZoneBounds[ oldZoneId ];
 
          // Update entries.
 
@@ -256,6 +271,7 @@ void SceneZoneSpaceManager::_compactZonesCheck()
 
    mNumTotalAllocatedZones = nextZoneId;
    mZoneLists = newZoneLists;
+   mZoneBounds = newZoneBounds;
 
    AssertFatal( mNumTotalAllocatedZones == mNumActiveZones, "SceneZoneSpaceManager::_compactZonesCheck - Error during compact; mismatch between active and allocated zones" );
 }
@@ -406,6 +422,7 @@ void SceneZoneSpaceManager::_rezoneObject( SceneObject* object )
 
    if( mNumActiveZones == 1 || object->isGlobalBounds() || object->getTypeMask() & OUTDOOR_OBJECT_TYPEMASK )
    {
+      _updateZoneBounds( object );
       object->mZoneRefDirty = false;
       return;
    }
@@ -425,6 +442,7 @@ void SceneZoneSpaceManager::_rezoneObject( SceneObject* object )
           object->mZoneRefHead &&
           object->mZoneRefHead->zone == RootZoneId )
       {
+         _updateZoneBounds( object );
          object->mZoneRefDirty = false;
          return;
       }
@@ -700,6 +718,7 @@ void SceneZoneSpaceManager::_zoneRemove( SceneObject* obj )
       if( remove->nextInBin )
          remove->nextInBin->prevInBin = remove->prevInBin;
 
+      mZoneBounds[ remove->zone ]->remove( remove );
       smZoneRefChunker.free( remove );
    }
 
@@ -738,6 +757,10 @@ void SceneZoneSpaceManager::_addToZoneList( U32 zoneId, SceneObject* object )
    newRef->nextInObj = object->mZoneRefHead;
    object->mZoneRefHead = newRef;
    object->mNumCurrZones ++;
+
+   // Add the object to the zone's packed bounds.
+
+   mZoneBounds[ zoneId ]->add( newRef );
 }
 
 //-----------------------------------------------------------------------------
@@ -787,6 +810,7 @@ void SceneZoneSpaceManager::_clearZoneList( U32 zoneId )
    }
 
    list->nextInBin = NULL;
+   mZoneBounds[ zoneId ]->clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -831,6 +855,176 @@ void SceneZoneSpaceManager::_queryZoneSpaces( const Box3F& area ) const
 
 //-----------------------------------------------------------------------------
 
+void SceneZoneSpaceManager::_updateZoneBounds( SceneObject* object )
+{
+   for( SceneObject::ZoneRef* ref = object->mZoneRefHead; ref != NULL; ref = ref->nextInObj )
+      mZoneBounds[ ref->zone ]->update( ref );
+}
+
+//-----------------------------------------------------------------------------
+
+U32 SceneZoneSpaceManager::findObjects( const Box3F& area, const PlaneF* planes, U32 numPlanes, U32 typeMask, Vector< SceneObject* >* outFound, Vector< S8 >* cullResults ) const
+{
+   PROFILE_SCOPE( SceneZoneSpaceManager_findObjects );
+
+   if( !cullResults )
+      cullResults = &mCullResults;
+
+   const U32 numFoundBefore = outFound->size();
+
+   for( U32 zoneId = 0; zoneId < mNumTotalAllocatedZones; ++ zoneId )
+   {
+      const ZoneObjectBounds* bounds = mZoneBounds[ zoneId ];
+      if( !bounds || bounds->refs.empty() )
+         continue;
+
+      // Test all the boxes in the zone against the planes.
+
+      BoxPacketF boxes;
+      boxes.minX = bounds->minX.address();
+      boxes.minY = bounds->minY.address();
+      boxes.minZ = bounds->minZ.address();
+      boxes.maxX = bounds->maxX.address();
+      boxes.maxY = bounds->maxY.address();
+      boxes.maxZ = bounds->maxZ.address();
+
+      const U32 numPadded = bounds->minX.size();
+      cullResults->setSize( numPadded );
+
+      if( !m_boxPacketF_x_planesF( boxes, numPadded, planes, numPlanes, cullResults->address() ) )
+         continue;
+
+      // Collect the objects that passed.
+
+      const U32 numObjects = bounds->refs.size();
+      for( U32 i = 0; i < numObjects; ++ i )
+      {
+         if( ( *cullResults )[ i ] == GeometryOutside || !( bounds->typeMasks[ i ] & typeMask ) )
+            continue;
+
+         // Objects in more than one zone are only reported for the first
+         // zone on their list.
+
+         SceneObject::ZoneRef* ref = bounds->refs[ i ];
+         SceneObject* object = ref->object;
+         if( object->mZoneRefHead != ref )
+            continue;
+
+         if( !object->isCollisionEnabled() )
+            continue;
+
+         if( !object->isGlobalBounds() && !object->getWorldBox().isOverlapped( area ) )
+            continue;
+
+         outFound->push_back( object );
+      }
+   }
+
+   return outFound->size() - numFoundBefore;
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneZoneSpaceManager::ZoneObjectBounds::add( SceneObject::ZoneRef* ref )
+{
+   ref->boundsIndex = refs.size();
+
+   refs.push_back( ref );
+   typeMasks.increment();
+   _pad();
+
+   _set( ref->boundsIndex, ref->object );
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneZoneSpaceManager::ZoneObjectBounds::remove( SceneObject::ZoneRef* ref )
+{
+   const U32 index = ref->boundsIndex;
+   const U32 last = refs.size() - 1;
+
+   AssertFatal( index <= last && refs[ index ] == ref, "SceneZoneSpaceManager::ZoneObjectBounds::remove - Object not in zone bounds" );
+
+   // Move the last object into the hole.
+
+   if( index != last )
+   {
+      minX[ index ] = minX[ last ];
+      minY[ index ] = minY[ last ];
+      minZ[ index ] = minZ[ last ];
+      maxX[ index ] = maxX[ last ];
+      maxY[ index ] = maxY[ last ];
+      maxZ[ index ] = maxZ[ last ];
+      typeMasks[ index ] = typeMasks[ last ];
+      refs[ index ] = refs[ last ];
+      refs[ index ]->boundsIndex = index;
+   }
+
+   refs.decrement();
+   typeMasks.decrement();
+   _pad();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneZoneSpaceManager::ZoneObjectBounds::clear()
+{
+   refs.clear();
+   typeMasks.clear();
+   _pad();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneZoneSpaceManager::ZoneObjectBounds::_set( U32 index, SceneObject* object )
+{
+   // Give global bounds objects a box that no plane can reject.
+
+   static const F32 sGlobalExtent = 1.0e30f;
+
+   if( object->isGlobalBounds() )
+   {
+      minX[ index ] = minY[ index ] = minZ[ index ] = - sGlobalExtent;
+      maxX[ index ] = maxY[ index ] = maxZ[ index ] = sGlobalExtent;
+   }
+   else
+   {
+      const Box3F& box = object->getWorldBox();
+
+      minX[ index ] = box.minExtents.x;
+      minY[ index ] = box.minExtents.y;
+      minZ[ index ] = box.minExtents.z;
+      maxX[ index ] = box.maxExtents.x;
+      maxY[ index ] = box.maxExtents.y;
+      maxZ[ index ] = box.maxExtents.z;
+   }
+
+   typeMasks[ index ] = object->getTypeMask();
+}
+
+//-----------------------------------------------------------------------------
+
+void SceneZoneSpaceManager::ZoneObjectBounds::_pad()
+{
+   // Resize the box arrays to the next multiple of four and zero the
+   // padding so the packet tests never see garbage.
+
+   const U32 numObjects = refs.size();
+   const U32 numPadded = ( numObjects + 3 ) & ~3;
+
+   minX.setSize( numPadded );
+   minY.setSize( numPadded );
+   minZ.setSize( numPadded );
+   maxX.setSize( numPadded );
+   maxY.setSize( numPadded );
+   maxZ.setSize( numPadded );
+
+   for( U32 i = numObjects; i < numPadded; ++ i )
+      minX[ i ] = minY[ i ] = minZ[ i ] = maxX[ i ] = maxY[ i ] = maxZ[ i ] = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+
 void SceneZoneSpaceManager::dumpZoneStates( bool update )
 {
    if( update )
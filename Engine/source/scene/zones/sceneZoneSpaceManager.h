@@ -158,6 +158,41 @@ class SceneZoneSpaceManager
       /// Vector used repeatedly for zone space queries on the container.
       mutable Vector< SceneObject* > mZoneSpacesQueryList;
 
+      /// Packed world boxes and type masks of the objects in a zone.
+      ///
+      /// These are kept in step with the zone lists so that visibility
+      /// queries can test all the objects of a zone with the packet
+      /// functions in math/mPacket.h rather than walking the list.  The
+      /// box arrays are padded to a multiple of four.
+      struct ZoneObjectBounds
+      {
+         Vector< F32 > minX, minY, minZ;
+         Vector< F32 > maxX, maxY, maxZ;
+         Vector< U32 > typeMasks;
+         Vector< SceneObject::ZoneRef* > refs;
+
+         /// Append the object of the given zone link.
+         void add( SceneObject::ZoneRef* ref );
+
+         /// Remove the object of the given zone link.
+         void remove( SceneObject::ZoneRef* ref );
+
+         /// Refresh the box and type mask of the object of the given link.
+         void update( SceneObject::ZoneRef* ref ) { _set( ref->boundsIndex, ref->object ); }
+
+         /// Remove all objects.
+         void clear();
+
+         void _set( U32 index, SceneObject* object );
+         void _pad();
+      };
+
+      /// Packed bounds for each zone in the scene.  Parallel to #mZoneLists.
+      Vector< ZoneObjectBounds* > mZoneBounds;
+
+      /// Vector used repeatedly for the results of findObjects().
+      mutable Vector< S8 > mCullResults;
+
       /// Allocator for ZoneRefs.
       static ClassChunker< SceneObject::ZoneRef > smZoneRefChunker;
 
@@ -217,6 +252,9 @@ class SceneZoneSpaceManager
       /// Fill #mZoneSpacesQueryList with all ZoneObjectType objects in the given area.
       void _queryZoneSpaces( const Box3F& area ) const;
 
+      /// Refresh the packed bounds of the given object in all of its zones.
+      void _updateZoneBounds( SceneObject* object );
+
    public:
 
       SceneZoneSpaceManager( SceneContainer* container );
@@ -305,6 +343,28 @@ class SceneZoneSpaceManager
       ///   manager fully contains @a area, the outdoor zone will not be added to the list).
       U32 findZones( const Box3F& area, Vector< U32 >& outZones ) const;
 
+      /// Find all objects whose world box overlaps the given area and is not
+      /// fully behind any of the given planes.
+      ///
+      /// This tests the packed bounds of each zone in batches rather than
+      /// walking the container bins, which makes it a good deal faster than
+      /// SceneContainer::findObjectList() for culling large scenes.  Like the
+      /// container query, objects with collision disabled are skipped.
+      ///
+      /// @note The zoning state must be up to date.
+      ///
+      /// @param area AABB of scene space to query.
+      /// @param planes Planes that objects must not be fully behind, e.g. frustum planes.
+      /// @param numPlanes Number of planes.
+      /// @param typeMask Object types to find.
+      /// @param outFound Objects found are added to this vector.
+      /// @param cullResults Scratch space for the plane tests.  If NULL, a vector kept by
+      ///   the manager is used which means the call must not run concurrently with other
+      ///   findObjects() calls.  Pass a vector of your own to query from several threads at once.
+      ///
+      /// @return Number of objects that have been added to @a outFound.
+      U32 findObjects( const Box3F& area, const PlaneF* planes, U32 numPlanes, U32 typeMask, Vector< SceneObject* >* outFound, Vector< S8 >* cullResults = NULL ) const;
+
       static ZoningChangedSignal& getZoningChangedSignal()
       {
          static ZoningChangedSignal sSignal;
@@ -26,13 +26,19 @@
 #include "sim/netConnection.h"
 #include "core/stream/bitStream.h"
 #include "core/stream/fileStream.h"
+#include "core/stream/memStream.h"
+#include "core/util/safeDelete.h"
 #ifndef TORQUE_TGB_ONLY
 #include "scene/pathManager.h"
 #endif
 #include "console/consoleTypes.h"
 #include "sim/netInterface.h"
+#include "sim/netPacketCoder.h"
 #include "console/engineAPI.h"
 #include <stdarg.h>
+#include "zlib/zlib.h"
+#include "platform/threads/threadPoolJob.h"
+#include "platform/platformSlabAllocator.h"
 
 
 IMPLEMENT_SCOPE( NetAPI, Net,, "Networking functionality." );
@@ -46,9 +52,16 @@ S32 gNetBitsSent = 0;
 extern S32 gNetBitsReceived;
 U32 gGhostUpdates = 0;
 
+static const U32 DemoFourCC = makeFourCCTag('T', 'D', 'M', 'O');
+static const U32 DemoVersion = 3;
+
+U32 NetConnection::smDemoKeyframeInterval = 320;
+
 enum NetConnectionConstants {
    PingTimeout = 4500, ///< milliseconds
    DefaultPingRetryCount = 15,
+   PacketCodingBitCountBits = 14, ///< Enough for Net::MaxPacketDataSize bytes.
+   DemoSegmentGrowSize = 64 * 1024,
 };
 
 SimObjectPtr<NetConnection> NetConnection::mServerConnection;
@@ -294,6 +307,40 @@ void NetConnection::consoleInit()
 
       "@ingroup Networking");
 
+   Con::addVariable("$pref::Net::deltaGhosting", TypeBool, &smDeltaGhosting,
+      "@brief If true the server sends the position and motion of players, vehicles and other "
+      "ghosts which support it as deltas from the last state acknowledged by the client.\n\n"
+
+      "@see NetConnection::writeDeltaInt()\n\n"
+
+      "@ingroup Networking");
+
+   Con::addVariable("$pref::Net::packetCoding", TypeBool, &NetPacketCoder::smEnabled,
+      "@brief If true connections range code their packets when both sides have the same "
+      "packet model loaded for the connection's class group.\n\n"
+
+      "Packets are only sent coded when that makes them smaller.  Local connections are "
+      "never coded.\n\n"
+
+      "@see loadNetPacketModel()\n\n"
+
+      "@ingroup Networking");
+
+   Con::addVariable("$Net::trainPacketModels", TypeBool, &NetPacketCoder::smTraining,
+      "@brief If true the payloads of outgoing packets are gathered into the training "
+      "statistics used by saveNetPacketModel().\n\n"
+
+      "@ingroup Networking");
+
+   Con::addVariable("$pref::Net::demoKeyframeInterval", TypeS32, &smDemoKeyframeInterval,
+      "@brief The number of ticks between the keyframes written to recorded demos.\n\n"
+
+      "Keyframed demos are compressed and can be seeked with GameConnection::seekDemo().  "
+      "Set to 0 to record demos in the older format which can only be played from the start.  "
+      "The default is 320 ticks, about 10 seconds.\n\n"
+
+      "@ingroup Networking");
+
    Con::addVariable("$Stats::netGhostUpdates", TypeS32, &gGhostUpdates,
       "@brief The total number of ghosts added, removed, and/or updated on the client "
       "during the last packet process operation.\n\n"
@@ -360,6 +407,7 @@ NetConnection::NetConnection()
    mNetClassGroup = NetClassGroupGame;
    AssertFatal(mNetClassGroup >= NetClassGroupGame && mNetClassGroup < NetClassGroupsCount,
             "Invalid net event class type.");
+   mPacketCoding = false;
 
    mSimulatedPing = 0;
    mSimulatedPacketLoss = 0;
@@ -417,9 +465,20 @@ NetConnection::NetConnection()
 
    mGhostsActive = 0;
 
+   mDeltaHistory = NULL;
+   mDeltaBaseline = NULL;
+   mDeltaState = NULL;
+   mDeltaBits = 0;
+
    mMissionPathsSent = false;
    mDemoWriteStream = NULL;
    mDemoReadStream = NULL;
+   mDemoSegmentWriteStream = NULL;
+   mDemoSegmentReadStream = NULL;
+   mDemoSegment = 0;
+   mDemoTick = 0;
+   mDemoTotalTicks = 0;
+   mDemoHeaderPos = 0;
 
    mPingSendCount = 0;
    mPingRetryCount = DefaultPingRetryCount;
@@ -446,11 +505,25 @@ NetConnection::~NetConnection()
 
    delete[] mLocalGhosts;
    delete[] mGhostLookupTable;
+
+   if(mGhostRefs)
+   {
+      for(S32 i = 0; i < MaxGhostCount; i++)
+         delete[] mGhostRefs[i].deltaBaseline;
+   }
    delete[] mGhostRefs;
+
+   if(mDeltaHistory)
+   {
+      for(S32 i = 0; i < MaxGhostCount; i++)
+         delete mDeltaHistory[i];
+   }
+   delete[] mDeltaHistory;
    delete[] mGhostArray;
    delete mStringTable;
-   if(mDemoWriteStream)
-      delete mDemoWriteStream;
+   // Finish the demo so its keyframe index is written.
+   stopRecording();
+   delete mDemoSegmentReadStream;
    if(mDemoReadStream)
       delete mDemoReadStream;
 }
@@ -748,7 +821,29 @@ void NetConnection::handlePacket(BitStream *bstream)
          mCurRate.changed = true;
       }
    }
-   readPacket(bstream);
+
+   if(bstream->readFlag())
+   {
+      // The rest of the packet is range coded.
+      U32 bitCount = bstream->readInt(PacketCodingBitCountBits);
+      U32 byteCount = (bitCount + 7) >> 3;
+
+      // The coded bytes start on the next byte boundary.
+      U32 codedStart = bstream->getPosition();
+      U32 codedSize = bstream->getReadByteSize();
+      if(byteCount <= Net::MaxPacketDataSize && codedSize <= Net::MaxPacketDataSize)
+      {
+         U8 buffer[Net::MaxPacketDataSize];
+         NetPacketCoder::decode(mNetClassGroup, bstream->getBuffer() + codedStart, codedSize, buffer, byteCount);
+
+         BitStream payload(buffer, byteCount);
+         readPacket(&payload);
+      }
+      else
+         setLastError("Invalid coded packet.");
+   }
+   else
+      readPacket(bstream);
 
    if(mErrorBuffer.isNotEmpty())
       connectionError(mErrorBuffer);
@@ -789,6 +884,8 @@ public:
 
 void NetConnection::checkPacketSend(bool force)
 {
+   SLAB_TAG_SCOPE( Networking );
+
    U32 curTime = Platform::getVirtualMilliseconds();
    U32 delay = isConnectionToServer() ? gPacketUpdateDelayToServer : mCurRate.updateDelay;
 
@@ -840,9 +937,16 @@ void NetConnection::checkPacketSend(bool force)
    U32 start = stream->getCurPos();
 #endif
 
+   U32 codingFlagPos = stream->getCurPos();
+   stream->writeFlag(false);
+   U32 payloadStart = stream->getCurPos();
+
    DEBUG_LOG(("PKLOG %d START", getId()) );
    writePacket(stream, note);
    DEBUG_LOG(("PKLOG %d END - %d", getId(), stream->getCurPos() - start) );
+
+   if(mPacketCoding || NetPacketCoder::smTraining)
+      codePacket(stream, codingFlagPos, payloadStart);
    if(mSimulatedPacketLoss && Platform::getRandom() < mSimulatedPacketLoss)
    {
       //Con::printf("NET  %d: SENDDROP - %d", getId(), mLastSendSeq);
@@ -856,6 +960,44 @@ void NetConnection::checkPacketSend(bool force)
    sendPacket(stream);
 }
 
+void NetConnection::codePacket(BitStream *stream, U32 flagPos, U32 payloadStart)
+{
+   U32 payloadEnd = stream->getCurPos();
+   U32 bitCount = payloadEnd - payloadStart;
+   U32 byteCount = (bitCount + 7) >> 3;
+
+   // Copy the payload out to a byte aligned buffer.
+   U8 payload[Net::MaxPacketDataSize];
+   dMemset(payload, 0, byteCount);
+   BitStream reader(stream->getBuffer(), Net::MaxPacketDataSize);
+   reader.setCurPos(payloadStart);
+   reader.readBits(bitCount, payload);
+
+   if(NetPacketCoder::smTraining)
+      NetPacketCoder::train(mNetClassGroup, payload, byteCount);
+
+   if(!mPacketCoding)
+      return;
+
+   // The coded bytes follow the bit count on a byte boundary
+   // and must end up smaller than the raw payload.
+   U32 codedStart = (flagPos + 1 + PacketCodingBitCountBits + 7) & ~7;
+   if(payloadEnd <= codedStart + 8)
+      return;
+
+   U8 coded[Net::MaxPacketDataSize];
+   U32 maxCodedSize = (payloadEnd - codedStart - 1) >> 3;
+   U32 codedSize = NetPacketCoder::encode(mNetClassGroup, payload, byteCount, coded, maxCodedSize);
+   if(!codedSize)
+      return;
+
+   stream->setCurPos(flagPos);
+   stream->writeFlag(true);
+   stream->writeInt(bitCount, PacketCodingBitCountBits);
+   stream->setCurPos(codedStart);
+   stream->writeBits(codedSize << 3, coded);
+}
+
 Net::Error NetConnection::sendPacket(BitStream *stream)
 {
    //Con::printf("NET  %d: SEND - %d", getId(), mLastSendSeq);
@@ -977,6 +1119,25 @@ bool NetConnection::startDemoRecord(const char *fileName)
       return false;
 
    mDemoWriteStream = fs;
+   mDemoTick = 0;
+   mDemoKeyframes.clear();
+
+   if(smDemoKeyframeInterval)
+   {
+      mDemoWriteStream->write(DemoFourCC);
+      mDemoWriteStream->write(DemoVersion);
+      mDemoWriteStream->write(mProtocolVersion);
+
+      // The index offset and length are filled in when recording stops.
+      mDemoHeaderPos = mDemoWriteStream->getPosition();
+      mDemoWriteStream->write(U32(0));
+      mDemoWriteStream->write(U32(0));
+
+      // The start block is the first keyframe.
+      startDemoSegment();
+      return true;
+   }
+
    mDemoWriteStream->write(mProtocolVersion);
    ResizeBitStream bs;
 
@@ -988,6 +1149,95 @@ bool NetConnection::startDemoRecord(const char *fileName)
    return true;
 }
 
+struct NetConnection::DemoSegmentJob : public ThreadPoolJob
+{
+   /// Index of the segment's keyframe.
+   U32 keyframe;
+   /// The recorded blocks, owned by the job.
+   MemStream *raw;
+   Vector<U8> compressed;
+
+   DemoSegmentJob(U32 _keyframe, MemStream *_raw)
+      : keyframe(_keyframe), raw(_raw)
+   {
+   }
+
+   ~DemoSegmentJob()
+   {
+      delete raw;
+   }
+
+protected:
+   virtual void run()
+   {
+      const U32 rawSize = raw->getStreamSize();
+      uLongf compressedSize = compressBound(rawSize);
+      compressed.setSize(compressedSize);
+      compress2((Bytef *) compressed.address(), &compressedSize, (const Bytef *) raw->getBuffer(), rawSize, Z_DEFAULT_COMPRESSION);
+      compressed.setSize(compressedSize);
+   }
+};
+
+void NetConnection::startDemoSegment()
+{
+   flushDemoSegment();
+
+   // The offset is filled in when the segment is written.
+   DemoKeyframe keyframe;
+   keyframe.tick = mDemoTick;
+   keyframe.offset = 0;
+   mDemoKeyframes.push_back(keyframe);
+
+   mDemoSegmentWriteStream = new MemStream(DemoSegmentGrowSize);
+
+   // Only the first keyframe carries the whole start block.
+   ResizeBitStream bs;
+   if(mDemoKeyframes.size() == 1)
+      writeDemoStartBlock(&bs);
+   else
+      writeDemoKeyframe(&bs);
+   U32 size = bs.getPosition() + 1;
+   mDemoSegmentWriteStream->write(size);
+   mDemoSegmentWriteStream->write(size, bs.getBuffer());
+}
+
+void NetConnection::flushDemoSegment()
+{
+   if(!mDemoSegmentWriteStream)
+      return;
+
+   DemoSegmentJobRef job = new DemoSegmentJob(mDemoKeyframes.size() - 1, mDemoSegmentWriteStream);
+   mDemoSegmentWriteStream = NULL;
+
+   mDemoSegmentJobs.push_back(job);
+   ThreadPool::GLOBAL().queueWorkItem(job);
+
+   // Write out whatever finished since the last segment.
+   writeDemoSegments(false);
+}
+
+void NetConnection::writeDemoSegments(bool wait)
+{
+   while(mDemoSegmentJobs.size())
+   {
+      DemoSegmentJob *job = mDemoSegmentJobs.first();
+      if(wait)
+         job->waitForFinish();
+      else if(!job->isFinished())
+         break;
+
+      DemoKeyframe &keyframe = mDemoKeyframes[job->keyframe];
+      keyframe.offset = mDemoWriteStream->getPosition();
+
+      mDemoWriteStream->write(keyframe.tick);
+      mDemoWriteStream->write(U32(job->raw->getStreamSize()));
+      mDemoWriteStream->write(U32(job->compressed.size()));
+      mDemoWriteStream->write(job->compressed.size(), job->compressed.address());
+
+      mDemoSegmentJobs.pop_front();
+   }
+}
+
 bool NetConnection::replayDemoRecord(const char *fileName)
 {
    Stream *fs;
@@ -995,7 +1245,47 @@ bool NetConnection::replayDemoRecord(const char *fileName)
       return false;
 
    mDemoReadStream = fs;
-   mDemoReadStream->read(&mProtocolVersion);
+   mDemoTick = 0;
+   mDemoTotalTicks = 0;
+   mDemoKeyframes.clear();
+
+   U32 fourCC;
+   mDemoReadStream->read(&fourCC);
+   if(fourCC == DemoFourCC)
+   {
+      U32 version, indexOffset;
+      mDemoReadStream->read(&version);
+      if(version != DemoVersion)
+         return false;
+
+      mDemoReadStream->read(&mProtocolVersion);
+      mDemoReadStream->read(&indexOffset);
+      mDemoReadStream->read(&mDemoTotalTicks);
+      mDemoHeaderPos = mDemoReadStream->getPosition();
+
+      if(indexOffset)
+      {
+         U32 count;
+         mDemoReadStream->setPosition(indexOffset);
+         mDemoReadStream->read(&count);
+         mDemoKeyframes.setSize(count);
+         for(U32 i = 0; i < count; i++)
+         {
+            mDemoReadStream->read(&mDemoKeyframes[i].tick);
+            mDemoReadStream->read(&mDemoKeyframes[i].offset);
+         }
+      }
+      else
+         scanDemoSegments();
+
+      if(mDemoKeyframes.empty() || !readDemoSegment(0, true))
+         return false;
+
+      return readDemoBlockHeader();
+   }
+
+   // Legacy demos start with the protocol version.
+   mProtocolVersion = fourCC;
    U32 size;
    mDemoReadStream->read(&size);
    U8 *block = new U8[size];
@@ -1007,23 +1297,185 @@ bool NetConnection::replayDemoRecord(const char *fileName)
    if(!res)
       return false;
 
-   // prep for first block read
+   return readDemoBlockHeader();
+}
+
+void NetConnection::scanDemoSegments()
+{
+   // Walk the segment headers up to the first truncated one.
+   U32 offset = mDemoHeaderPos;
+   U32 fileSize = mDemoReadStream->getStreamSize();
+   while(offset < fileSize && mDemoReadStream->setPosition(offset))
+   {
+      DemoKeyframe keyframe;
+      U32 rawSize, compressedSize;
+      keyframe.offset = offset;
+      mDemoReadStream->read(&keyframe.tick);
+      mDemoReadStream->read(&rawSize);
+      mDemoReadStream->read(&compressedSize);
+
+      offset = mDemoReadStream->getPosition() + compressedSize;
+      if(mDemoReadStream->getStatus() != Stream::Ok || offset > fileSize)
+         break;
+
+      mDemoKeyframes.push_back(keyframe);
+   }
+}
+
+bool NetConnection::readDemoSegment(S32 index, bool readKeyframe)
+{
+   U32 tick, rawSize, compressedSize;
+   mDemoReadStream->setPosition(mDemoKeyframes[index].offset);
+   mDemoReadStream->read(&tick);
+   mDemoReadStream->read(&rawSize);
+   mDemoReadStream->read(&compressedSize);
+
+   U8 *compressed = new U8[compressedSize];
+   bool ok = mDemoReadStream->read(compressedSize, compressed);
+
+   uLongf size = rawSize;
+   mDemoSegmentData.setSize(rawSize);
+   ok = ok && uncompress((Bytef *) mDemoSegmentData.address(), &size, (const Bytef *) compressed, compressedSize) == Z_OK && size == rawSize;
+   delete[] compressed;
+
+   delete mDemoSegmentReadStream;
+   mDemoSegmentReadStream = NULL;
+
+   if(!ok)
+   {
+      Con::errorf("NetConnection::readDemoSegment - Segment %d of the demo is corrupt.", index);
+      return false;
+   }
+
+   mDemoSegmentReadStream = new MemStream(rawSize, mDemoSegmentData.address(), true, false);
+   mDemoSegment = index;
+
+   // Every segment starts with a keyframe.
+   U32 keyframeSize;
+   mDemoSegmentReadStream->read(&keyframeSize);
+   if(!readKeyframe)
+      return mDemoSegmentReadStream->setPosition(mDemoSegmentReadStream->getPosition() + keyframeSize);
+
+   BitStream bs((U8 *) mDemoSegmentData.address() + mDemoSegmentReadStream->getPosition(), keyframeSize);
+   if(!(index ? readDemoKeyframe(&bs) : readDemoStartBlock(&bs)))
+      return false;
+
+   mDemoTick = tick;
+   return mDemoSegmentReadStream->setPosition(mDemoSegmentReadStream->getPosition() + keyframeSize);
+}
+
+bool NetConnection::readDemoBlockHeader()
+{
+   Stream *stream = mDemoReadStream;
+   if(mDemoSegmentReadStream)
+   {
+      // Move on to the next segment, skipping its keyframe.
+      if(mDemoSegmentReadStream->getPosition() >= mDemoSegmentReadStream->getStreamSize())
+      {
+         if(mDemoSegment + 1 >= mDemoKeyframes.size() || !readDemoSegment(mDemoSegment + 1, false))
+            return false;
+      }
+      stream = mDemoSegmentReadStream;
+   }
+
+   // prep for next block read
    // type/size stored in U16: [type:4][size:12]
    U16 typeSize;
-   mDemoReadStream->read(&typeSize);
+   stream->read(&typeSize);
 
    mDemoNextBlockType = typeSize >> 12;
    mDemoNextBlockSize = typeSize & 0xFFF;
 
-   if(mDemoReadStream->getStatus() != Stream::Ok)
+   return stream->getStatus() == Stream::Ok;
+}
+
+bool NetConnection::seekDemo(U32 tick)
+{
+   if(!mDemoSegmentReadStream || mDemoKeyframes.empty())
       return false;
+
+   // Find the last keyframe at or before the tick.
+   S32 keyframe = 0;
+   for(S32 i = 1; i < mDemoKeyframes.size(); i++)
+   {
+      if(mDemoKeyframes[i].tick > tick)
+         break;
+      keyframe = i;
+   }
+
+   // Play on if that is no further from the tick.
+   if(tick >= mDemoTick && keyframe <= mDemoSegment)
+      return true;
+
+   resetDemoPlayback();
+   if(!readDemoSegment(keyframe, true) || !readDemoBlockHeader())
+   {
+      stopDemoPlayback();
+      return false;
+   }
+
    return true;
 }
 
+void NetConnection::resetDemoPlayback()
+{
+   onEndGhosting();
+
+   // Drop all the ghosts, they will be recreated from the keyframe.
+   for(S32 i = 0; i < MaxGhostCount && mLocalGhosts; i++)
+   {
+      if(mLocalGhosts[i])
+      {
+         mLocalGhosts[i]->deleteObject();
+         mLocalGhosts[i] = NULL;
+      }
+   }
+   while(mGhostAlwaysSaveList.size())
+   {
+      delete mGhostAlwaysSaveList[0].ghost;
+      mGhostAlwaysSaveList.pop_front();
+   }
+   for(S32 i = 0; i < MaxGhostCount && mDeltaHistory; i++)
+      SAFE_DELETE(mDeltaHistory[i]);
+
+   // Drop the events waiting on earlier ones.
+   while(mWaitSeqEvents)
+   {
+      NetEventNote *temp = mWaitSeqEvents;
+      mWaitSeqEvents = temp->mNextEvent;
+
+      temp->mEvent->decRef();
+      mEventNoteChunker.free(temp);
+   }
+
+   // And the packets in flight.
+   while(mNotifyQueueHead)
+      handleNotify(true);
+}
+
 void NetConnection::stopRecording()
 {
    if(mDemoWriteStream)
    {
+      if(mDemoSegmentWriteStream)
+      {
+         flushDemoSegment();
+         writeDemoSegments(true);
+
+         // Append the keyframe index and point the header at it.
+         U32 indexOffset = mDemoWriteStream->getPosition();
+         mDemoWriteStream->write(U32(mDemoKeyframes.size()));
+         for(U32 i = 0; i < mDemoKeyframes.size(); i++)
+         {
+            mDemoWriteStream->write(mDemoKeyframes[i].tick);
+            mDemoWriteStream->write(mDemoKeyframes[i].offset);
+         }
+
+         mDemoWriteStream->setPosition(mDemoHeaderPos);
+         mDemoWriteStream->write(indexOffset);
+         mDemoWriteStream->write(mDemoTick);
+      }
+
       delete mDemoWriteStream;
       mDemoWriteStream = NULL;
    }
@@ -1038,11 +1490,21 @@ void NetConnection::recordBlock(U32 type, U32 size, void *data)
 
    if(mDemoWriteStream)
    {
+      if(isDemoTickBlock(type))
+      {
+         // Take keyframes between ticks.
+         if(mDemoSegmentWriteStream && mDemoTick - mDemoKeyframes.last().tick >= smDemoKeyframeInterval)
+            startDemoSegment();
+         mDemoTick++;
+      }
+
+      Stream *stream = mDemoSegmentWriteStream ? (Stream *) mDemoSegmentWriteStream : mDemoWriteStream;
+
       // store type/size in U16: [type:4][size:12]
       U16 typeSize = (type << 12) | size;
-      mDemoWriteStream->write(typeSize);
+      stream->write(typeSize);
       if(size)
-         mDemoWriteStream->write(size, data);
+         stream->write(size, data);
    }
 }
 
@@ -1076,16 +1538,15 @@ bool NetConnection::processNextBlock()
    U8 buffer[Net::MaxPacketDataSize];
 
    // read in and handle
-   if(mDemoReadStream->read(mDemoNextBlockSize, buffer))
+   Stream *stream = mDemoSegmentReadStream ? (Stream *) mDemoSegmentReadStream : mDemoReadStream;
+   if(stream->read(mDemoNextBlockSize, buffer))
+   {
+      if(isDemoTickBlock(mDemoNextBlockType))
+         mDemoTick++;
       handleRecordedBlock(mDemoNextBlockType, mDemoNextBlockSize, buffer);
+   }
 
-   U16 typeSize;
-   mDemoReadStream->read(&typeSize);
-
-   mDemoNextBlockType = typeSize >> 12;
-   mDemoNextBlockSize = typeSize & 0xFFF;
-
-   if(mDemoReadStream->getStatus() != Stream::Ok)
+   if(!readDemoBlockHeader())
    {
       stopDemoPlayback();
       return false;
@@ -1293,6 +1754,9 @@ void NetConnection::writeConnectRequest(BitStream *stream)
 {
    stream->write(mNetClassGroup);
    stream->write(U32(AbstractClassRep::getClassCRC(mNetClassGroup)));
+
+   if(stream->writeFlag(NetPacketCoder::smEnabled))
+      stream->write(NetPacketCoder::getModelCRC(mNetClassGroup));
 }
 
 bool NetConnection::readConnectRequest(BitStream *stream, const char **errorString)
@@ -1301,22 +1765,33 @@ bool NetConnection::readConnectRequest(BitStream *stream, const char **errorStri
    stream->read(&classGroup);
    stream->read(&classCRC);
 
-   if(classGroup == mNetClassGroup && classCRC == AbstractClassRep::getClassCRC(mNetClassGroup))
-      return true;
+   if(classGroup != mNetClassGroup || classCRC != AbstractClassRep::getClassCRC(mNetClassGroup))
+   {
+      *errorString = "CHR_INVALID";
+      return false;
+   }
 
-   *errorString = "CHR_INVALID";
-   return false;
+   // Packets are only coded when both sides want it and
+   // have the same model.  Local connections never code.
+   U32 modelCRC = 0;
+   bool clientCoding = stream->readFlag();
+   if(clientCoding)
+      stream->read(&modelCRC);
+
+   mPacketCoding = clientCoding && NetPacketCoder::smEnabled && !isLocalConnection() &&
+                   modelCRC == NetPacketCoder::getModelCRC(mNetClassGroup);
+   return true;
 }
 
 void NetConnection::writeConnectAccept(BitStream *stream)
 {
-   TORQUE_UNUSED(stream);
+   stream->writeFlag(mPacketCoding);
 }
 
 bool NetConnection::readConnectAccept(BitStream *stream, const char **errorString)
 {
-   TORQUE_UNUSED(stream);
    TORQUE_UNUSED(errorString);
+   mPacketCoding = stream->readFlag();
    return true;
 }
 
@@ -39,13 +39,18 @@
 #ifndef _H_CONNECTIONSTRINGTABLE
 #include "sim/connectionStringTable.h"
 #endif
+#ifndef _THREADSAFEREFCOUNT_H_
+#include "platform/threads/threadSafeRefCount.h"
+#endif
 
 class NetConnection;
 class NetObject;
 class BitStream;
 class ResizeBitStream;
 class Stream;
+class MemStream;
 class Point3F;
+class QuatF;
 
 struct GhostInfo;
 struct SubPacketRef; // defined in NetConnection subclass
@@ -424,6 +429,8 @@ public:
       GhostInfo *ghost;          ///< Reference to the GhostInfo we're from.
       GhostRef *nextRef;         ///< Next GhostRef in this packet.
       GhostRef *nextUpdateChain; ///< Next update we sent for this ghost.
+      S32 *deltaState;           ///< Delta state sent in this update, or NULL.
+      U32 deltaId;               ///< Id of deltaState.
    };
 
    enum Constants
@@ -478,6 +485,11 @@ private:
 
    U32 mNetClassGroup;  ///< The NetClassGroup of this connection.
 
+   /// True if packet payloads may be range coded, as negotiated
+   /// during the connection handshake.
+   /// @see NetPacketCoder
+   bool mPacketCoding;
+
    /// @name Statistics
    /// @{
 
@@ -621,6 +633,10 @@ public:
 
    void checkPacketSend(bool force);
 
+   /// Replaces the payload written after flagPos with its range coded
+   /// form if that is smaller, and feeds it to the model training.
+   void codePacket(BitStream *stream, U32 flagPos, U32 payloadStart);
+
    bool missionPathsSent() const          { return mMissionPathsSent; }
    void setMissionPathsSent(const bool s) { mMissionPathsSent = s; }
 
@@ -821,9 +837,51 @@ public:
       GhostIdBitSize = 12,
       MaxGhostCount = 1 << GhostIdBitSize, //4096,
       GhostLookupTableSize = 1 << GhostIdBitSize, //4096
-      GhostIndexBitSize = 4 // number of bits GhostIdBitSize-3 fits into
+      GhostIndexBitSize = 4, // number of bits GhostIdBitSize-3 fits into
+      DeltaSlotCount = 16,   ///< Quantized values in a ghost's delta state.
+      DeltaHistorySize = 8,  ///< Delta states the client keeps per ghost.
+      DeltaIdBitSize = 4,    ///< Bits for delta state ids, enough for twice DeltaHistorySize.
+   };
+
+   /// If true, ghosts which support it send their delta state as
+   /// differences from the last state acknowledged by the client.
+   static bool smDeltaGhosting;
+
+protected:
+
+   /// Delta states received for a ghost, indexed by id modulo DeltaHistorySize.
+   struct DeltaHistory
+   {
+      bool valid[DeltaHistorySize];
+      U32 ids[DeltaHistorySize];
+      S32 states[DeltaHistorySize][DeltaSlotCount];
    };
 
+   /// Client side delta history per ghost index, allocated on demand.
+   DeltaHistory **mDeltaHistory;
+
+   /// Baseline of the ghost currently being packed or unpacked.
+   const S32 *mDeltaBaseline;
+
+   /// Delta state being built for the ghost currently being packed or
+   /// unpacked, or NULL if the delta helpers should write whole values.
+   S32 *mDeltaState;
+
+   /// Bits written by the delta helpers for the current ghost.
+   U32 mDeltaBits;
+
+   /// Returns the client side delta history for a ghost index.
+   DeltaHistory* getDeltaHistory(U32 index);
+
+   /// Writes the delta state id and baseline for a ghost update and
+   /// sets up the delta helpers to encode against the baseline.
+   void ghostWriteDeltaHeader(BitStream *bstream, GhostInfo *ghost, GhostRef *ref);
+
+   /// Reads the header written by ghostWriteDeltaHeader().
+   bool ghostReadDeltaHeader(BitStream *bstream, U32 index, bool newGhost);
+
+public:
+
    U32 getGhostsActive() { return mGhostsActive;};
 
    /// Are we ghosting to someone?
@@ -928,6 +986,41 @@ public:
    /// before performing an operation.
    static Signal<void()> smGhostAlwaysDone;
 
+   /// @name Delta Compression
+   ///
+   /// Ghosts which return true from NetObject::hasDeltaState() write their
+   /// high frequency state through these methods in packUpdate() and
+   /// unpackUpdate().  When delta ghosting is enabled each value is quantized
+   /// and sent as the difference from the last state the client acknowledged,
+   /// which costs a single bit for unchanged values.  Outside of ghost packets,
+   /// such as ghost always events and demo start blocks, values are written
+   /// whole.
+   ///
+   /// Each value occupies a slot in the ghost's delta state.  Pack and unpack
+   /// must use the same slots and classes must not reuse their parent's slots.
+   /// @{
+
+   void writeDeltaInt(BitStream *stream, U32 slot, S32 value);
+   S32 readDeltaInt(BitStream *stream, U32 slot);
+
+   void writeDeltaFloat(BitStream *stream, U32 slot, F32 value, F32 precision);
+   F32 readDeltaFloat(BitStream *stream, U32 slot, F32 precision);
+
+   /// Writes a position, using three slots starting at the given one.
+   /// Whole positions are written with BitStream::writeCompressedPoint().
+   void writeDeltaPoint(BitStream *stream, U32 slot, const Point3F &point, F32 precision = 0.001f);
+   void readDeltaPoint(BitStream *stream, U32 slot, Point3F *point, F32 precision = 0.001f);
+
+   /// Writes a vector, using three slots starting at the given one.
+   void writeDeltaVector(BitStream *stream, U32 slot, const Point3F &vec, F32 precision);
+   void readDeltaVector(BitStream *stream, U32 slot, Point3F *vec, F32 precision);
+
+   /// Uses four slots starting at the given one.
+   void writeDeltaQuat(BitStream *stream, U32 slot, const QuatF &quat);
+   void readDeltaQuat(BitStream *stream, U32 slot, QuatF *quat);
+
+   /// @}
+
    /// @}
 public:
 //----------------------------------------------------------------
@@ -1006,7 +1099,86 @@ private:
 
    U32 mDemoRealStartTime;
 
+   /// A keyframe in a keyframed demo.
+   struct DemoKeyframe
+   {
+      U32 tick;   ///< Demo tick at which the keyframe was taken.
+      U32 offset; ///< File offset of the segment starting with the keyframe.
+   };
+
+   /// Index of the keyframes in the demo being recorded or played.
+   Vector<DemoKeyframe> mDemoKeyframes;
+
+   /// Blocks recorded since the last keyframe.  NULL if
+   /// recording in the legacy format.
+   MemStream *mDemoSegmentWriteStream;
+
+   /// Blocks of the segment being played back.  NULL
+   /// if playing back a legacy demo.
+   MemStream *mDemoSegmentReadStream;
+
+   /// Decompressed contents of the segment being played back.
+   Vector<U8> mDemoSegmentData;
+
+   /// Index of the segment being played back.
+   S32 mDemoSegment;
+
+   /// Ticks recorded or played back so far.
+   U32 mDemoTick;
+
+   /// Length of the demo in ticks or zero if unknown.
+   U32 mDemoTotalTicks;
+
+   /// File position of the header fields patched when recording stops.
+   U32 mDemoHeaderPos;
+
+   /// Compresses a finished segment on the thread pool.
+   struct DemoSegmentJob;
+   typedef ThreadSafeRef<DemoSegmentJob> DemoSegmentJobRef;
+
+   /// Segments being compressed, oldest first.  They are written
+   /// to the demo file in this order once they are done.
+   Vector<DemoSegmentJobRef> mDemoSegmentJobs;
+
+   /// Hands the current segment off for compression and starts a
+   /// new one with a keyframe of the connection state.
+   void startDemoSegment();
+
+   /// Hands the current segment off for compression.
+   void flushDemoSegment();
+
+   /// Writes the compressed segments to the demo file.  If wait is
+   /// false it stops at the first one which is still being compressed.
+   void writeDemoSegments(bool wait);
+
+   /// Loads and decompresses a segment of the demo being played.
+   /// If readKeyframe is true the connection state is restored from
+   /// the keyframe, otherwise the keyframe is skipped.
+   bool readDemoSegment(S32 index, bool readKeyframe);
+
+   /// Reads the type and size of the next block, moving on
+   /// to the next segment at the end of the current one.
+   bool readDemoBlockHeader();
+
+   /// Builds the keyframe index by walking the segments of a demo
+   /// which was not closed properly.
+   void scanDemoSegments();
+
+protected:
+   /// Returns true for the block type which advances demo time.
+   /// Keyframes are only taken right before such blocks, so they
+   /// must be recorded before their contents are applied.
+   virtual bool isDemoTickBlock(U32 type) const { return false; }
+
+   /// Drops the ghosts and pending packets and events of a demo
+   /// being played back before restoring state from a keyframe.
+   virtual void resetDemoPlayback();
+
 public:
+   /// Number of ticks between keyframes in recorded demos.  Zero
+   /// records demos in the legacy unkeyframed format.
+   static U32 smDemoKeyframeInterval;
+
    enum DemoBlockTypes {
       BlockTypePacket,
       BlockTypeSendPacket,
@@ -1036,7 +1208,27 @@ public:
 
    virtual void writeDemoStartBlock(ResizeBitStream *stream);
    virtual bool readDemoStartBlock(BitStream *stream);
+
+   /// Keyframes after the first hold the state restored when seeking.
+   /// They are taken every few seconds while recording so subclasses
+   /// should leave out anything the start block already set up for
+   /// good, like datablocks.  Defaults to the whole start block.
+   virtual void writeDemoKeyframe(ResizeBitStream *stream) { writeDemoStartBlock(stream); }
+   virtual bool readDemoKeyframe(BitStream *stream) { return readDemoStartBlock(stream); }
    virtual void demoPlaybackComplete();
+
+   /// Restores the demo being played back to the last keyframe at or
+   /// before the tick, unless playing on from the current position
+   /// gets there sooner.  The caller advances the simulation the rest
+   /// of the way.  Returns false if the demo has no keyframes.
+   bool seekDemo(U32 tick);
+
+   /// Returns the number of ticks recorded or played back so far.
+   U32 getDemoTick() const { return mDemoTick; }
+
+   /// Returns the length in ticks of the demo being played
+   /// back or zero if it is unknown.
+   U32 getDemoTotalTicks() const { return mDemoTotalTicks; }
 /// @}
 };
 
@@ -1077,6 +1269,16 @@ public:  // required for MSVC
    U32 index;
    U32 arrayIndex;
 
+   /// @name Delta Compression
+   /// @{
+
+   S32 *deltaBaseline;           ///< Last delta state acknowledged by the client, allocated on demand.
+   U32 deltaBaselineId;          ///< Id of deltaBaseline.
+   bool deltaBaselineValid;      ///< Is deltaBaseline usable for the current ghost?
+   U32 deltaSendId;              ///< Id of the next delta state to send.
+
+   /// @}
+
    /// Flags relating to the state of the object.
    enum Flags
    {
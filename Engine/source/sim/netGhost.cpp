@@ -30,10 +30,18 @@
 #include "console/console.h"
 #include "console/consoleTypes.h"
 #include "console/engineAPI.h"
+#include "math/mathIO.h"
 
 #define DebugChecksum 0xF00DBAAD
 
 Signal<void()>    NetConnection::smGhostAlwaysDone;
+bool              NetConnection::smDeltaGhosting = false;
+
+/// Baseline used for ghosts without an acknowledged delta state.
+static const S32 sZeroDeltaState[NetConnection::DeltaSlotCount] = { 0 };
+
+/// Precision of quaternion components in delta states.
+static const F32 sDeltaQuatPrecision = 1.0f / 32768.0f;
 
 extern U32 gGhostUpdates;
 
@@ -184,6 +192,10 @@ void NetConnection::setGhostFrom(bool ghostFrom)
          mGhostRefs[i].obj = NULL;
          mGhostRefs[i].index = i;
          mGhostRefs[i].updateMask = 0;
+         mGhostRefs[i].deltaBaseline = NULL;
+         mGhostRefs[i].deltaBaselineId = 0;
+         mGhostRefs[i].deltaBaselineValid = false;
+         mGhostRefs[i].deltaSendId = 0;
       }
       mGhostLookupTable = new GhostInfo *[GhostLookupTableSize];
       for(i = 0; i < GhostLookupTableSize; i++)
@@ -254,6 +266,7 @@ void NetConnection::ghostPacketDropped(PacketNotify *notify)
          packRef->ghost->flags &= ~GhostInfo::KillingGhost;
       }
 
+      delete[] packRef->deltaState;
       delete packRef;
       packRef = temp;
    }
@@ -290,6 +303,16 @@ void NetConnection::ghostPacketReceived(PacketNotify *notify)
       else if(packRef->ghostInfoFlags & GhostInfo::KillingGhost)
          freeGhostInfo(packRef->ghost);
 
+      // the client has this delta state now, so
+      // future updates can be encoded against it
+      if(packRef->deltaState)
+      {
+         delete[] packRef->ghost->deltaBaseline;
+         packRef->ghost->deltaBaseline = packRef->deltaState;
+         packRef->ghost->deltaBaselineId = packRef->deltaId;
+         packRef->ghost->deltaBaselineValid = true;
+      }
+
       delete packRef;
       packRef = temp;
    }
@@ -327,6 +350,8 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
    if(!bstream->writeFlag(mGhosting))
       return;
 
+   const bool deltaGhosting = bstream->writeFlag(smDeltaGhosting);
+
    // fill a packet (or two) with ghosting data
 
    // first step is to check all our polled ghosts:
@@ -440,6 +465,8 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
 
       upd->ghost = walk;
       upd->ghostInfoFlags = 0;
+      upd->deltaState = NULL;
+      upd->deltaId = 0;
 
       if(walk->flags & GhostInfo::KillGhost)
       {
@@ -468,6 +495,9 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
             walk->flags &= ~GhostInfo::NotYetGhosted;
             walk->flags |= GhostInfo::Ghosting;
             upd->ghostInfoFlags = GhostInfo::Ghosting;
+
+            // a new ghost on the client has no delta history
+            walk->deltaBaselineValid = false;
          }
 #ifdef TORQUE_DEBUG_NET
          else {
@@ -476,6 +506,9 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
             bstream->writeInt(classId ^ DebugChecksum, 32);
          }
 #endif
+         if(deltaGhosting && walk->obj->hasDeltaState())
+            ghostWriteDeltaHeader(bstream, walk, upd);
+
          // update the object
 #ifdef TORQUE_NET_STATS
          U32 beginSize = bstream->getBitPosition();
@@ -483,7 +516,11 @@ void NetConnection::ghostWritePacket(BitStream *bstream, PacketNotify *notify)
          U32 retMask = walk->obj->packUpdate(this, updateMask, bstream);
 #ifdef TORQUE_NET_STATS
          walk->obj->getClassRep()->updateNetStatPack(updateMask, bstream->getBitPosition() - beginSize);
+         if(mDeltaState)
+            walk->obj->getClassRep()->updateNetStatDelta(mDeltaBaseline != sZeroDeltaState, mDeltaBits);
 #endif
+         mDeltaState = NULL;
+         mDeltaBaseline = NULL;
          DEBUG_LOG(("PKLOG %d GHOST %d: %s", getId(), bstream->getBitPosition() - 16 - startPos, walk->obj->getClassName()));
 
          AssertFatal((retMask & (~updateMask)) == 0, "Cannot set new bits in packUpdate return");
@@ -522,6 +559,8 @@ void NetConnection::ghostReadPacket(BitStream *bstream)
    if(!bstream->readFlag())
       return;
 
+   const bool deltaGhosting = bstream->readFlag();
+
    S32 idSize;
    idSize = bstream->readInt( GhostIndexBitSize);
    idSize += 3;
@@ -583,10 +622,15 @@ void NetConnection::ghostReadPacket(BitStream *bstream)
             // give derived classes a chance to prepare ghost for reading
             ghostPreRead(mLocalGhosts[index],true);
 
+            if(deltaGhosting && obj->hasDeltaState() && !ghostReadDeltaHeader(bstream, index, true))
+               return;
+
 #ifdef TORQUE_NET_STATS
             U32 beginSize = bstream->getBitPosition();
 #endif
             mLocalGhosts[index]->unpackUpdate(this, bstream);
+            mDeltaState = NULL;
+            mDeltaBaseline = NULL;
 #ifdef TORQUE_NET_STATS
             mLocalGhosts[index]->getClassRep()->updateNetStatUnpack(bstream->getBitPosition() - beginSize);
 #endif
@@ -632,10 +676,15 @@ void NetConnection::ghostReadPacket(BitStream *bstream)
             // give derived classes a chance to prepare ghost for reading
             ghostPreRead(mLocalGhosts[index],false);
 
+            if(deltaGhosting && mLocalGhosts[index]->hasDeltaState() && !ghostReadDeltaHeader(bstream, index, false))
+               return;
+
 #ifdef TORQUE_NET_STATS
             U32 beginSize = bstream->getBitPosition();
 #endif
             mLocalGhosts[index]->unpackUpdate(this, bstream);
+            mDeltaState = NULL;
+            mDeltaBaseline = NULL;
 #ifdef TORQUE_NET_STATS
             mLocalGhosts[index]->getClassRep()->updateNetStatUnpack(bstream->getBitPosition() - beginSize);
 #endif
@@ -1247,6 +1296,30 @@ void NetConnection::ghostWriteStartBlock(ResizeBitStream *stream)
          stream->validate();
       }
    }
+
+   // finally, write the delta history so that recorded packets
+   // can be decoded against states received before recording.
+   for(U32 i = 0; i < MaxGhostCount && mDeltaHistory; i++)
+   {
+      if(!mLocalGhosts[i] || !mDeltaHistory[i])
+         continue;
+
+      stream->writeFlag(true);
+      stream->writeInt(i, GhostIdBitSize);
+
+      const DeltaHistory *history = mDeltaHistory[i];
+      for(U32 j = 0; j < DeltaHistorySize; j++)
+      {
+         if(!stream->writeFlag(history->valid[j]))
+            continue;
+
+         stream->writeInt(history->ids[j], DeltaIdBitSize);
+         for(U32 k = 0; k < DeltaSlotCount; k++)
+            stream->write(history->states[j][k]);
+      }
+      stream->validate();
+   }
+   stream->writeFlag(false);
 }
 
 void NetConnection::ghostReadStartBlock(BitStream *stream)
@@ -1289,6 +1362,229 @@ void NetConnection::ghostReadStartBlock(BitStream *stream)
          addObject(mLocalGhosts[i]);
       }
    }
+
+   while(stream->readFlag())
+   {
+      DeltaHistory *history = getDeltaHistory(stream->readInt(GhostIdBitSize));
+      for(U32 j = 0; j < DeltaHistorySize; j++)
+      {
+         history->valid[j] = stream->readFlag();
+         if(!history->valid[j])
+            continue;
+
+         history->ids[j] = stream->readInt(DeltaIdBitSize);
+         for(U32 k = 0; k < DeltaSlotCount; k++)
+            stream->read(&history->states[j][k]);
+      }
+   }
    // MARKF - TODO - looks like we could have memory leaks here
    // if there are errors.
 }
+
+//-----------------------------------------------------------------------------
+
+NetConnection::DeltaHistory* NetConnection::getDeltaHistory(U32 index)
+{
+   if(!mDeltaHistory)
+   {
+      mDeltaHistory = new DeltaHistory *[MaxGhostCount];
+      dMemset(mDeltaHistory, 0, sizeof(DeltaHistory *) * MaxGhostCount);
+   }
+
+   if(!mDeltaHistory[index])
+   {
+      mDeltaHistory[index] = new DeltaHistory;
+      dMemset(mDeltaHistory[index]->valid, 0, sizeof(mDeltaHistory[index]->valid));
+   }
+
+   return mDeltaHistory[index];
+}
+
+void NetConnection::ghostWriteDeltaHeader(BitStream *bstream, GhostInfo *ghost, GhostRef *ref)
+{
+   // The baseline is only usable while the client still has it in its
+   // history, which holds the last DeltaHistorySize states it received.
+   const bool hasBaseline = ghost->deltaBaselineValid &&
+                            ghost->deltaSendId - ghost->deltaBaselineId < DeltaHistorySize;
+
+   const U32 idMask = (1 << DeltaIdBitSize) - 1;
+   bstream->writeInt(ghost->deltaSendId & idMask, DeltaIdBitSize);
+   if(bstream->writeFlag(hasBaseline))
+      bstream->writeInt(ghost->deltaBaselineId & idMask, DeltaIdBitSize);
+
+   // Slots which packUpdate doesn't write keep their baseline values.
+   mDeltaBaseline = hasBaseline ? ghost->deltaBaseline : sZeroDeltaState;
+   ref->deltaState = new S32[DeltaSlotCount];
+   ref->deltaId = ghost->deltaSendId++;
+   dMemcpy(ref->deltaState, mDeltaBaseline, sizeof(S32) * DeltaSlotCount);
+
+   mDeltaState = ref->deltaState;
+   mDeltaBits = 0;
+}
+
+bool NetConnection::ghostReadDeltaHeader(BitStream *bstream, U32 index, bool newGhost)
+{
+   DeltaHistory *history = getDeltaHistory(index);
+   if(newGhost)
+      dMemset(history->valid, 0, sizeof(history->valid));
+
+   U32 id = bstream->readInt(DeltaIdBitSize);
+   mDeltaBaseline = sZeroDeltaState;
+   if(bstream->readFlag())
+   {
+      U32 baselineId = bstream->readInt(DeltaIdBitSize);
+      U32 baselineSlot = baselineId % DeltaHistorySize;
+      if(!history->valid[baselineSlot] || history->ids[baselineSlot] != baselineId)
+      {
+         setLastError("Invalid packet. (missing delta baseline)");
+         return false;
+      }
+      mDeltaBaseline = history->states[baselineSlot];
+   }
+
+   U32 slot = id % DeltaHistorySize;
+   history->valid[slot] = true;
+   history->ids[slot] = id;
+   mDeltaState = history->states[slot];
+   if(mDeltaState != mDeltaBaseline)
+      dMemcpy(mDeltaState, mDeltaBaseline, sizeof(S32) * DeltaSlotCount);
+
+   return true;
+}
+
+void NetConnection::writeDeltaInt(BitStream *stream, U32 slot, S32 value)
+{
+   AssertFatal(slot < DeltaSlotCount, "NetConnection::writeDeltaInt - Invalid delta slot.");
+
+   S32 base = 0;
+   if(mDeltaState)
+   {
+      base = mDeltaBaseline[slot];
+      mDeltaState[slot] = value;
+   }
+
+   // Zig-zag encode the difference so small negative
+   // steps cost as little as small positive ones.
+   U32 startPos = stream->getBitPosition();
+   U32 delta = U32(value) - U32(base);
+   U32 zigzag = (delta << 1) ^ (0U - (delta >> 31));
+   if(stream->writeFlag(zigzag != 0))
+   {
+      U32 bits = getBinLog2(zigzag) + 1;
+      stream->writeInt(bits - 1, 5);
+      stream->writeInt(zigzag, bits);
+   }
+   mDeltaBits += stream->getBitPosition() - startPos;
+}
+
+S32 NetConnection::readDeltaInt(BitStream *stream, U32 slot)
+{
+   AssertFatal(slot < DeltaSlotCount, "NetConnection::readDeltaInt - Invalid delta slot.");
+
+   U32 zigzag = 0;
+   if(stream->readFlag())
+   {
+      U32 bits = stream->readInt(5) + 1;
+      zigzag = U32(stream->readInt(bits));
+   }
+
+   U32 delta = (zigzag >> 1) ^ (0U - (zigzag & 1));
+   if(!mDeltaState)
+      return S32(delta);
+
+   S32 value = S32(U32(mDeltaBaseline[slot]) + delta);
+   mDeltaState[slot] = value;
+   return value;
+}
+
+static inline S32 quantizeDeltaValue(F32 value, F32 precision)
+{
+   return S32(mClampF(mFloor(value / precision + 0.5f), -1073741824.0f, 1073741824.0f));
+}
+
+void NetConnection::writeDeltaFloat(BitStream *stream, U32 slot, F32 value, F32 precision)
+{
+   if(mDeltaState)
+      writeDeltaInt(stream, slot, quantizeDeltaValue(value, precision));
+   else
+      stream->write(value);
+}
+
+F32 NetConnection::readDeltaFloat(BitStream *stream, U32 slot, F32 precision)
+{
+   if(mDeltaState)
+      return readDeltaInt(stream, slot) * precision;
+
+   F32 value;
+   stream->read(&value);
+   return value;
+}
+
+void NetConnection::writeDeltaPoint(BitStream *stream, U32 slot, const Point3F &point, F32 precision)
+{
+   if(!mDeltaState)
+   {
+      stream->writeCompressedPoint(point, precision);
+      return;
+   }
+
+   writeDeltaInt(stream, slot, quantizeDeltaValue(point.x, precision));
+   writeDeltaInt(stream, slot + 1, quantizeDeltaValue(point.y, precision));
+   writeDeltaInt(stream, slot + 2, quantizeDeltaValue(point.z, precision));
+}
+
+void NetConnection::readDeltaPoint(BitStream *stream, U32 slot, Point3F *point, F32 precision)
+{
+   if(!mDeltaState)
+   {
+      stream->readCompressedPoint(point, precision);
+      return;
+   }
+
+   point->x = readDeltaInt(stream, slot) * precision;
+   point->y = readDeltaInt(stream, slot + 1) * precision;
+   point->z = readDeltaInt(stream, slot + 2) * precision;
+}
+
+void NetConnection::writeDeltaVector(BitStream *stream, U32 slot, const Point3F &vec, F32 precision)
+{
+   writeDeltaFloat(stream, slot, vec.x, precision);
+   writeDeltaFloat(stream, slot + 1, vec.y, precision);
+   writeDeltaFloat(stream, slot + 2, vec.z, precision);
+}
+
+void NetConnection::readDeltaVector(BitStream *stream, U32 slot, Point3F *vec, F32 precision)
+{
+   vec->x = readDeltaFloat(stream, slot, precision);
+   vec->y = readDeltaFloat(stream, slot + 1, precision);
+   vec->z = readDeltaFloat(stream, slot + 2, precision);
+}
+
+void NetConnection::writeDeltaQuat(BitStream *stream, U32 slot, const QuatF &quat)
+{
+   if(!mDeltaState)
+   {
+      mathWrite(*stream, quat);
+      return;
+   }
+
+   writeDeltaInt(stream, slot, quantizeDeltaValue(quat.x, sDeltaQuatPrecision));
+   writeDeltaInt(stream, slot + 1, quantizeDeltaValue(quat.y, sDeltaQuatPrecision));
+   writeDeltaInt(stream, slot + 2, quantizeDeltaValue(quat.z, sDeltaQuatPrecision));
+   writeDeltaInt(stream, slot + 3, quantizeDeltaValue(quat.w, sDeltaQuatPrecision));
+}
+
+void NetConnection::readDeltaQuat(BitStream *stream, U32 slot, QuatF *quat)
+{
+   if(!mDeltaState)
+   {
+      mathRead(*stream, quat);
+      return;
+   }
+
+   quat->x = readDeltaInt(stream, slot) * sDeltaQuatPrecision;
+   quat->y = readDeltaInt(stream, slot + 1) * sDeltaQuatPrecision;
+   quat->z = readDeltaInt(stream, slot + 2) * sDeltaQuatPrecision;
+   quat->w = readDeltaInt(stream, slot + 3) * sDeltaQuatPrecision;
+   quat->normalize();
+}
@@ -26,6 +26,7 @@
 #include "core/stream/bitStream.h"
 #include "math/mRandom.h"
 #include "core/util/journal/journal.h"
+#include "platform/platformSlabAllocator.h"
 
 #ifdef GGC_PLUGIN
 #include "GGCNatTunnel.h" 
@@ -83,6 +84,7 @@ NetConnection *NetInterface::findPendingConnection(const NetAddress *address, U3
 
 void NetInterface::processPacketReceiveEvent(NetAddress srcAddress, RawData packetData)
 {
+   SLAB_TAG_SCOPE( Networking );
 
    U32 dataSize = packetData.size;
    BitStream pStream(packetData.data, dataSize);
@@ -348,6 +348,28 @@ public:
    /// @param   stream  stream to read from
    virtual void unpackUpdate(NetConnection * conn, BitStream *stream);
 
+   /// Returns true if packUpdate() writes state through the delta helpers
+   /// on NetConnection, such as NetConnection::writeDeltaPoint().
+   ///
+   /// Those values are sent as differences from the last state the client
+   /// acknowledged when delta ghosting is enabled.
+   ///
+   /// Subclasses allocate their slots after their parent's, the same
+   /// way they allocate mask bits:
+   ///
+   /// @code
+   /// enum DeltaSlots {
+   ///    PositionDeltaSlot = Parent::NextFreeDeltaSlot,
+   ///    NextFreeDeltaSlot = PositionDeltaSlot + 3
+   /// };
+   /// @endcode
+   virtual bool hasDeltaState() const { return false; }
+
+   /// Delta state slots used by this class.
+   enum DeltaSlots {
+      NextFreeDeltaSlot = 0
+   };
+
    /// Queries the object about information used to determine scope.
    ///
    /// Something that is 'in scope' is somehow interesting to the client.
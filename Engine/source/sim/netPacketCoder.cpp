@@ -0,0 +1,472 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "sim/netPacketCoder.h"
+
+#include "console/engineAPI.h"
+#include "core/crc.h"
+#include "core/stream/fileStream.h"
+#include "math/mMathFn.h"
+
+
+static const U32 NetPacketModelFourCC = makeFourCCTag( 'N', 'P', 'C', 'M' );
+static const U32 NetPacketModelVersion = 1;
+
+/// Range below which the coder shifts out a byte.
+static const U32 RangeTop = 1 << 24;
+
+bool NetPacketCoder::smEnabled = false;
+bool NetPacketCoder::smTraining = false;
+NetPacketCoder::Model NetPacketCoder::smModels[NetClassGroupsCount];
+
+
+//-----------------------------------------------------------------------------
+
+namespace
+{
+   struct RangeEncoder
+   {
+      U64 low;
+      U32 range;
+      U8 cache;
+      U32 cacheSize;
+
+      U8 *out;
+      U32 outPos;
+      U32 outSize;
+      bool first;
+
+      RangeEncoder( U8 *buffer, U32 size )
+         :  low( 0 ),
+            range( 0xFFFFFFFF ),
+            cache( 0 ),
+            cacheSize( 1 ),
+            out( buffer ),
+            outPos( 0 ),
+            outSize( size ),
+            first( true )
+      {
+      }
+
+      void putByte( U8 b )
+      {
+         // The first byte out of the coder is always zero
+         // so we skip it and the decoder assumes it.
+         if ( first )
+         {
+            first = false;
+            return;
+         }
+
+         // Once we overflow we keep counting so the caller
+         // can tell the packet did not fit.
+         if ( outPos < outSize )
+            out[outPos] = b;
+         outPos++;
+      }
+
+      void shiftLow()
+      {
+         if ( U32( low ) < 0xFF000000 || U32( low >> 32 ) != 0 )
+         {
+            U8 temp = cache;
+            do
+            {
+               putByte( U8( temp + U8( low >> 32 ) ) );
+               temp = 0xFF;
+            }
+            while ( --cacheSize != 0 );
+
+            cache = U8( low >> 24 );
+         }
+
+         cacheSize++;
+         low = ( low & 0x00FFFFFF ) << 8;
+      }
+
+      void encodeBit( U16 &prob, U32 bit )
+      {
+         U32 bound = ( range >> NetPacketCoder::ProbBits ) * prob;
+         if ( bit == 0 )
+         {
+            range = bound;
+            prob += ( NetPacketCoder::ProbOne - prob ) >> NetPacketCoder::AdaptShift;
+         }
+         else
+         {
+            low += bound;
+            range -= bound;
+            prob -= prob >> NetPacketCoder::AdaptShift;
+         }
+
+         while ( range < RangeTop )
+         {
+            range <<= 8;
+            shiftLow();
+         }
+      }
+
+      void flush()
+      {
+         for ( U32 i = 0; i < 5; i++ )
+            shiftLow();
+
+         // Trailing zeros are implied by the decoder.
+         if ( outPos <= outSize )
+         {
+            while ( outPos > 0 && out[outPos - 1] == 0 )
+               outPos--;
+         }
+      }
+   };
+
+   struct RangeDecoder
+   {
+      U32 code;
+      U32 range;
+
+      const U8 *in;
+      U32 inPos;
+      U32 inSize;
+
+      RangeDecoder( const U8 *buffer, U32 size )
+         :  code( 0 ),
+            range( 0xFFFFFFFF ),
+            in( buffer ),
+            inPos( 0 ),
+            inSize( size )
+      {
+         for ( U32 i = 0; i < 4; i++ )
+            code = ( code << 8 ) | getByte();
+      }
+
+      U8 getByte()
+      {
+         return inPos < inSize ? in[inPos++] : 0;
+      }
+
+      U32 decodeBit( U16 &prob )
+      {
+         U32 bit;
+         U32 bound = ( range >> NetPacketCoder::ProbBits ) * prob;
+         if ( code < bound )
+         {
+            range = bound;
+            prob += ( NetPacketCoder::ProbOne - prob ) >> NetPacketCoder::AdaptShift;
+            bit = 0;
+         }
+         else
+         {
+            code -= bound;
+            range -= bound;
+            prob -= prob >> NetPacketCoder::AdaptShift;
+            bit = 1;
+         }
+
+         while ( range < RangeTop )
+         {
+            range <<= 8;
+            code = ( code << 8 ) | getByte();
+         }
+
+         return bit;
+      }
+   };
+}
+
+
+//-----------------------------------------------------------------------------
+
+NetPacketCoder::Model::Model()
+   : counts( NULL )
+{
+   reset();
+}
+
+NetPacketCoder::Model::~Model()
+{
+   delete [] counts;
+}
+
+void NetPacketCoder::Model::reset()
+{
+   for ( U32 i = 0; i < ContextCount; i++ )
+      for ( U32 j = 0; j < TreeSize; j++ )
+         probs[i][j] = ProbOne / 2;
+
+   delete [] counts;
+   counts = NULL;
+
+   updateCRC();
+}
+
+void NetPacketCoder::Model::updateCRC()
+{
+   // Hash the probabilities as little endian so the
+   // result does not depend on the host byte order.
+   U8 bytes[ContextCount * TreeSize * 2];
+   U32 pos = 0;
+   for ( U32 i = 0; i < ContextCount; i++ )
+   {
+      for ( U32 j = 0; j < TreeSize; j++ )
+      {
+         bytes[pos++] = U8( probs[i][j] );
+         bytes[pos++] = U8( probs[i][j] >> 8 );
+      }
+   }
+
+   crc = CRC::calculateCRC( bytes, sizeof( bytes ) );
+}
+
+//-----------------------------------------------------------------------------
+
+U32 NetPacketCoder::encode( U32 group, const U8 *inBuffer, U32 inSize, U8 *outBuffer, U32 outSize )
+{
+   AssertFatal( group < NetClassGroupsCount, "NetPacketCoder::encode - Bad class group!" );
+
+   // Work on a copy so the model only adapts within this packet.
+   U16 probs[ContextCount][TreeSize];
+   dMemcpy( probs, smModels[group].probs, sizeof( probs ) );
+
+   RangeEncoder rc( outBuffer, outSize );
+   U32 context = 0;
+
+   for ( U32 i = 0; i < inSize; i++ )
+   {
+      U16 *tree = probs[context];
+      U32 node = 1;
+      for ( S32 b = 7; b >= 0; b-- )
+      {
+         U32 bit = ( inBuffer[i] >> b ) & 1;
+         rc.encodeBit( tree[node], bit );
+         node = ( node << 1 ) | bit;
+      }
+
+      context = inBuffer[i] >> 4;
+   }
+
+   rc.flush();
+
+   return rc.outPos <= outSize ? rc.outPos : 0;
+}
+
+void NetPacketCoder::decode( U32 group, const U8 *inBuffer, U32 inSize, U8 *outBuffer, U32 outSize )
+{
+   AssertFatal( group < NetClassGroupsCount, "NetPacketCoder::decode - Bad class group!" );
+
+   U16 probs[ContextCount][TreeSize];
+   dMemcpy( probs, smModels[group].probs, sizeof( probs ) );
+
+   RangeDecoder rc( inBuffer, inSize );
+   U32 context = 0;
+
+   for ( U32 i = 0; i < outSize; i++ )
+   {
+      U16 *tree = probs[context];
+      U32 node = 1;
+      while ( node < TreeSize )
+         node = ( node << 1 ) | rc.decodeBit( tree[node] );
+
+      outBuffer[i] = U8( node );
+      context = outBuffer[i] >> 4;
+   }
+}
+
+U32 NetPacketCoder::getModelCRC( U32 group )
+{
+   AssertFatal( group < NetClassGroupsCount, "NetPacketCoder::getModelCRC - Bad class group!" );
+   return smModels[group].crc;
+}
+
+void NetPacketCoder::train( U32 group, const U8 *buffer, U32 size )
+{
+   AssertFatal( group < NetClassGroupsCount, "NetPacketCoder::train - Bad class group!" );
+
+   Model &model = smModels[group];
+   if ( !model.counts )
+   {
+      model.counts = new U32[ContextCount * TreeSize * 2];
+      dMemset( model.counts, 0, sizeof( U32 ) * ContextCount * TreeSize * 2 );
+   }
+
+   U32 context = 0;
+   for ( U32 i = 0; i < size; i++ )
+   {
+      U32 *counts = model.counts + context * TreeSize * 2;
+      U32 node = 1;
+      for ( S32 b = 7; b >= 0; b-- )
+      {
+         U32 bit = ( buffer[i] >> b ) & 1;
+         counts[node * 2 + bit]++;
+         node = ( node << 1 ) | bit;
+      }
+
+      context = buffer[i] >> 4;
+   }
+}
+
+bool NetPacketCoder::loadModel( U32 group, const char *fileName )
+{
+   AssertFatal( group < NetClassGroupsCount, "NetPacketCoder::loadModel - Bad class group!" );
+
+   FileStream *stream = FileStream::createAndOpen( fileName, Torque::FS::File::Read );
+   if ( !stream )
+   {
+      Con::errorf( "NetPacketCoder::loadModel - Failed to open '%s'.", fileName );
+      return false;
+   }
+
+   U32 fourCC = 0, version = 0;
+   stream->read( &fourCC );
+   stream->read( &version );
+   if ( fourCC != NetPacketModelFourCC || version != NetPacketModelVersion )
+   {
+      Con::errorf( "NetPacketCoder::loadModel - '%s' is not a packet model.", fileName );
+      delete stream;
+      return false;
+   }
+
+   U16 probs[ContextCount][TreeSize];
+   for ( U32 i = 0; i < ContextCount; i++ )
+   {
+      for ( U32 j = 0; j < TreeSize; j++ )
+      {
+         stream->read( &probs[i][j] );
+
+         // Probabilities at the extremes would make the coder fail.
+         probs[i][j] = mClamp( probs[i][j], 31, ProbOne - 31 );
+      }
+   }
+
+   bool ok = stream->getStatus() == Stream::Ok;
+   delete stream;
+
+   if ( !ok )
+   {
+      Con::errorf( "NetPacketCoder::loadModel - '%s' is truncated.", fileName );
+      return false;
+   }
+
+   Model &model = smModels[group];
+   dMemcpy( model.probs, probs, sizeof( probs ) );
+   model.updateCRC();
+   return true;
+}
+
+bool NetPacketCoder::saveModel( U32 group, const char *fileName )
+{
+   AssertFatal( group < NetClassGroupsCount, "NetPacketCoder::saveModel - Bad class group!" );
+
+   Model &model = smModels[group];
+   if ( model.counts )
+   {
+      for ( U32 i = 0; i < ContextCount; i++ )
+      {
+         const U32 *counts = model.counts + i * TreeSize * 2;
+         for ( U32 j = 1; j < TreeSize; j++ )
+         {
+            // Laplace smoothed probability of a zero bit.
+            F64 zeros = counts[j * 2] + 1;
+            F64 total = zeros + counts[j * 2 + 1] + 1;
+            S32 prob = S32( ProbOne * zeros / total + 0.5 );
+            model.probs[i][j] = mClamp( prob, 31, ProbOne - 31 );
+         }
+      }
+
+      model.updateCRC();
+   }
+
+   FileStream *stream = FileStream::createAndOpen( fileName, Torque::FS::File::Write );
+   if ( !stream )
+   {
+      Con::errorf( "NetPacketCoder::saveModel - Failed to open '%s' for writing.", fileName );
+      return false;
+   }
+
+   stream->write( NetPacketModelFourCC );
+   stream->write( NetPacketModelVersion );
+   for ( U32 i = 0; i < ContextCount; i++ )
+      for ( U32 j = 0; j < TreeSize; j++ )
+         stream->write( model.probs[i][j] );
+
+   delete stream;
+   return true;
+}
+
+void NetPacketCoder::resetModel( U32 group )
+{
+   AssertFatal( group < NetClassGroupsCount, "NetPacketCoder::resetModel - Bad class group!" );
+   smModels[group].reset();
+}
+
+//-----------------------------------------------------------------------------
+
+DefineEngineFunction( loadNetPacketModel, bool, ( S32 group, const char *fileName ),,
+   "@brief Loads a trained packet coding model for a NetClassGroup.\n\n"
+   "Both sides of a connection must have the same model loaded for coded packets to be used.\n\n"
+   "@param group The NetClassGroup, 0 for game connections.\n"
+   "@param fileName The model file written by saveNetPacketModel().\n"
+   "@return True if the model was loaded.\n\n"
+   "@see $pref::Net::packetCoding\n\n"
+   "@ingroup Networking")
+{
+   if ( group < 0 || group >= NetClassGroupsCount )
+   {
+      Con::errorf( "loadNetPacketModel - Invalid class group %d.", group );
+      return false;
+   }
+
+   return NetPacketCoder::loadModel( group, fileName );
+}
+
+DefineEngineFunction( saveNetPacketModel, bool, ( S32 group, const char *fileName ),,
+   "@brief Builds a packet coding model from the statistics gathered while "
+   "$Net::trainPacketModels was enabled and writes it to a file.\n\n"
+   "@param group The NetClassGroup, 0 for game connections.\n"
+   "@param fileName The file to write.\n"
+   "@return True if the model was written.\n\n"
+   "@ingroup Networking")
+{
+   if ( group < 0 || group >= NetClassGroupsCount )
+   {
+      Con::errorf( "saveNetPacketModel - Invalid class group %d.", group );
+      return false;
+   }
+
+   return NetPacketCoder::saveModel( group, fileName );
+}
+
+DefineEngineFunction( resetNetPacketModel, void, ( S32 group ),,
+   "@brief Restores the untrained packet coding model for a NetClassGroup "
+   "and discards any gathered training statistics.\n\n"
+   "@param group The NetClassGroup, 0 for game connections.\n\n"
+   "@ingroup Networking")
+{
+   if ( group < 0 || group >= NetClassGroupsCount )
+   {
+      Con::errorf( "resetNetPacketModel - Invalid class group %d.", group );
+      return;
+   }
+
+   NetPacketCoder::resetModel( group );
+}
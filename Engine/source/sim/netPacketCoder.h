@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _NETPACKETCODER_H_
+#define _NETPACKETCODER_H_
+
+#ifndef _PLATFORM_H_
+#include "platform/platform.h"
+#endif
+#ifndef _CONSOLEOBJECT_H_
+#include "console/consoleObject.h"
+#endif
+
+
+/// Adaptive binary range coder for packet payloads.
+///
+/// Each byte is coded bit by bit through a binary tree of probabilities
+/// selected by the high nibble of the previous byte.  Every NetClassGroup
+/// has its own trained model which both sides of a connection must agree
+/// on; the connection handshake compares the model CRCs and only enables
+/// coding when they match.
+///
+/// Coding always starts from the trained model and adapts only within the
+/// packet being coded, so dropped or reordered packets and demo playback
+/// can never desynchronize the two sides.
+///
+/// @see NetConnection::checkPacketSend
+class NetPacketCoder
+{
+public:
+
+   enum Constants
+   {
+      ProbBits = 11,
+      ProbOne = 1 << ProbBits,
+      AdaptShift = 4,
+
+      ContextCount = 16,
+      TreeSize = 256,
+   };
+
+   /// If true connections negotiate coded packets when
+   /// both sides have the same model.
+   static bool smEnabled;
+
+   /// If true the raw payloads of outgoing packets are
+   /// accumulated into the training statistics.
+   static bool smTraining;
+
+   /// Codes inSize bytes into outBuffer.  Returns the coded size in
+   /// bytes, or zero if the result does not fit in outSize.
+   static U32 encode( U32 group, const U8 *inBuffer, U32 inSize, U8 *outBuffer, U32 outSize );
+
+   /// Decodes outSize bytes from inBuffer.  Bytes past the end of the
+   /// input are treated as zero, which matches the trimmed encoder output.
+   static void decode( U32 group, const U8 *inBuffer, U32 inSize, U8 *outBuffer, U32 outSize );
+
+   /// Returns the CRC of the model for the group.
+   static U32 getModelCRC( U32 group );
+
+   /// Adds a raw payload to the training statistics of the group.
+   static void train( U32 group, const U8 *buffer, U32 size );
+
+   /// Loads a model written by saveModel.
+   static bool loadModel( U32 group, const char *fileName );
+
+   /// Writes the model for the group, first rebuilding it from the
+   /// training statistics if any were collected.
+   static bool saveModel( U32 group, const char *fileName );
+
+   /// Restores the untrained model and clears the training statistics.
+   static void resetModel( U32 group );
+
+protected:
+
+   struct Model
+   {
+      U16 probs[ContextCount][TreeSize];
+
+      /// CRC of probs, compared during the connection handshake.
+      U32 crc;
+
+      /// Bit counts accumulated by train(), allocated on first use.
+      U32 *counts;
+
+      Model();
+      ~Model();
+
+      void reset();
+      void updateCRC();
+   };
+
+   static Model smModels[NetClassGroupsCount];
+};
+
+#endif // _NETPACKETCODER_H_
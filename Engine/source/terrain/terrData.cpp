@@ -81,6 +81,7 @@ Signal<void(U32,TerrainBlock*,const Point2I& ,const Point2I&)> TerrainBlock::smU
 
 F32 TerrainBlock::smLODScale = 1.0f;
 F32 TerrainBlock::smDetailScale = 1.0f;
+F32 TerrainBlock::smPagePreloadDistance = 512.0f;
 
 
 //RBP - Global function declared in Terrdata.h
@@ -771,6 +772,7 @@ void TerrainBlock::removeMaterial( U32 index )
 
    mFile->mMaterials.erase( index );
    mFile->_initMaterialInstMapping();
+   mFile->makeResident();
 
    for ( S32 i = 0; i < mFile->mLayerMap.size(); i++ )
    {
@@ -1124,6 +1126,22 @@ void TerrainBlock::initPersistFields()
 
    Con::addVariable( "$pref::Terrain::detailScale", TypeF32, &smDetailScale, "A global detail scale used to tweak the material detail distances.\n\n" 
 	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::pagingMinSize", TypeS32, &TerrainFile::smPagingMinSize, "Terrain files of this size or larger are paged in on demand "
+      "instead of being fully loaded.  Zero disables paging.\n\n"
+	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::pageBudget", TypeS32, &TerrainFile::smPageBudget, "The number of terrain pages to keep resident before the least "
+      "recently used page is evicted.\n\n"
+	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::gridThreads", TypeS32, &TerrainFile::smGridThreads, "The number of threads used to build the terrain "
+      "collision grid and smooth the height map.  Zero uses one per logical processor.\n\n"
+	   "@ingroup Terrain");
+
+   Con::addVariable( "$pref::Terrain::pagePreloadDistance", TypeF32, &smPagePreloadDistance, "The distance in meters around the camera within which the "
+      "pages of paged terrains are loaded ahead of use.\n\n"
+	   "@ingroup Terrain");
 }
 
 void TerrainBlock::inspectPostApply()
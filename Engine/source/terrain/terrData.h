@@ -172,6 +172,10 @@ protected:
    /// material detail distances.
    static F32 smDetailScale;
 
+   /// The distance around the camera in meters within 
+   /// which we preload the pages of paged terrains.
+   static F32 smPagePreloadDistance;
+
    /// True if the zoning needs to be recalculated for the terrain.
    bool mZoningDirty;
 
@@ -274,9 +278,9 @@ public:
    /// Accessors and mutators for TerrainMaterialUndoAction.
    /// @{
    const Vector<TerrainMaterial*>& getMaterials() const { return mFile->mMaterials; }   
-   const Vector<U8>& getLayerMap() const { return mFile->mLayerMap; }
+   const Vector<U8>& getLayerMap() const { mFile->makeResident(); return mFile->mLayerMap; }
    void setMaterials( const Vector<TerrainMaterial*> &materials ) { mFile->mMaterials = materials; }
-   void setLayerMap( const Vector<U8> &layers ) { mFile->mLayerMap = layers; }
+   void setLayerMap( const Vector<U8> &layers ) { mFile->makeResident(); mFile->mLayerMap = layers; }
    /// @}
 
    TerrainMaterial* getMaterial( U32 index ) const;
@@ -36,6 +36,9 @@ bool TerrainBlock::exportHeightMap( const UTF8 *filePath, const String &format )
                      false,
                      GFXFormatR5G6B5 );
 
+   // We need the whole height map.
+   mFile->makeResident();
+
    // First capture the max height... we'll normalize 
    // everything to this value.
    U16 maxHeight = 0;
@@ -91,6 +94,9 @@ bool TerrainBlock::exportHeightMap( const UTF8 *filePath, const String &format )
 
 bool TerrainBlock::exportLayerMaps( const UTF8 *filePrefix, const String &format ) const
 {
+   // We need the whole layer map.
+   mFile->makeResident();
+
    for(S32 i = 0; i < mFile->mMaterials.size(); i++)
    {
       Vector<const U8>::iterator iBits = mFile->mLayerMap.begin();
@@ -30,6 +30,8 @@
 #include "gfx/bitmap/gBitmap.h"
 #include "platform/profiler.h"
 #include "math/mPlane.h"
+#include "platform/threads/threadPoolJob.h"
+#include "platform/platformSlabAllocator.h"
 
 
 template<>
@@ -44,10 +46,19 @@ template<> ResourceBase::Signature Resource<TerrainFile>::signature()
 }
 
 
+U32 TerrainFile::smPagingMinSize = 4096;
+U32 TerrainFile::smPageBudget = 64;
+S32 TerrainFile::smGridThreads = 0;
+
+
 TerrainFile::TerrainFile()
    : mNeedsResaving( false ),
      mFileVersion( FILE_VERSION ),
-     mSize( 256 )
+     mSize( 256 ),
+     mPageStream( NULL ),
+     mPageShift( 0 ),
+     mPagesPerSide( 0 ),
+     mPageClock( 0 )
 {
    mLayerMap.setSize( mSize * mSize );
    dMemset( mLayerMap.address(), 0, mLayerMap.memSize() );
@@ -58,6 +69,15 @@ TerrainFile::TerrainFile()
 
 TerrainFile::~TerrainFile()
 {
+   _releasePages();
+}
+
+S32 TerrainFile::getGridThreadCount()
+{
+   if ( smGridThreads > 0 )
+      return smGridThreads;
+
+   return getMax( (S32)Platform::SystemInfo.processor.numLogicalProcessors, 1 );
 }
 
 static U16 calcDev( const PlaneF &pl, const Point3F &pt )
@@ -89,6 +109,309 @@ inline U32 getMostSignificantBit( U32 v )
    return bit;
 }
 
+/// Samples the heights and layers of a single resident page
+/// using terrain sample coordinates.
+struct TerrainPageSampler
+{
+   const TerrainPage *page;
+   U32 originX;
+   U32 originY;
+   U32 shift;
+
+   U16 getHeight( U32 x, U32 y ) const
+   {
+      return page->heights[ ( x - originX ) + ( y - originY ) * ( ( 1 << shift ) + 1 ) ];
+   }
+
+   bool isEmptyAt( U32 x, U32 y ) const
+   {
+      return page->layers[ ( x - originX ) + ( ( y - originY ) << shift ) ] == U8_MAX;
+   }
+};
+
+/// The bounds, deviance and empty state gathered from the samples
+/// of a grid square before the square itself is filled in.
+struct GridSquareAccum
+{
+   U16 min;
+   U16 max;
+   U16 mindev45;
+   U16 mindev135;
+   bool empty;
+   bool hasEmpty;
+
+   GridSquareAccum()
+      :  min( 0xFFFF ),
+         max( 0 ),
+         mindev45( 0 ),
+         mindev135( 0 ),
+         empty( true ),
+         hasEmpty( false )
+   {
+   }
+
+   void merge( const GridSquareAccum &accum )
+   {
+      min = getMin( min, accum.min );
+      max = getMax( max, accum.max );
+      mindev45 = getMax( mindev45, accum.mindev45 );
+      mindev135 = getMax( mindev135, accum.mindev135 );
+      empty &= accum.empty;
+      hasEmpty |= accum.hasEmpty;
+   }
+};
+
+/// Gathers the samples of a grid square from either the whole 
+/// terrain or a single page of it.  Only the sample columns from
+/// beginX up to endX are visited so that the very large squares
+/// can be split across threads.
+template<class T>
+static void accumGridSquare(  const T &sampler,
+                              GridSquareAccum &accum,
+                              S32 squareX,
+                              S32 squareY,
+                              S32 squareSize,
+                              S32 beginX,
+                              S32 endX )
+{
+   // determine max error for both possible splits.
+
+   const Point3F p1(0, 0, sampler.getHeight(squareX * squareSize, squareY * squareSize));
+   const Point3F p2(0, (F32)squareSize, sampler.getHeight(squareX * squareSize, squareY * squareSize + squareSize));
+   const Point3F p3((F32)squareSize, (F32)squareSize, sampler.getHeight(squareX * squareSize + squareSize, squareY * squareSize + squareSize));
+   const Point3F p4((F32)squareSize, 0, sampler.getHeight(squareX * squareSize + squareSize, squareY * squareSize));
+
+   // pl1, pl2 = split45, pl3, pl4 = split135
+   const PlaneF pl1(p1, p2, p3);
+   const PlaneF pl2(p1, p3, p4);
+   const PlaneF pl3(p1, p2, p4);
+   const PlaneF pl4(p2, p3, p4);
+
+   for ( S32 sizeX = beginX; sizeX < endX; sizeX++ )
+   {
+      for ( S32 sizeY = 0; sizeY <= squareSize; sizeY++ )
+      {
+         S32 x = squareX * squareSize + sizeX;
+         S32 y = squareY * squareSize + sizeY;
+
+         if(sizeX != squareSize && sizeY != squareSize)
+         {
+            if ( !sampler.isEmptyAt( x, y ) )
+               accum.empty = false;
+            else
+               accum.hasEmpty = true;
+         }
+
+         U16 ht = sampler.getHeight( x, y );
+         if ( ht < accum.min )
+            accum.min = ht;
+         if( ht > accum.max )
+            accum.max = ht;
+
+         Point3F pt( (F32)sizeX, (F32)sizeY, (F32)ht );
+         U16 dev;
+
+         if(sizeX < sizeY)
+            dev = calcDev(pl1, pt);
+         else if(sizeX > sizeY)
+            dev = calcDev(pl2, pt);
+         else
+            dev = Umax(calcDev(pl1, pt), calcDev(pl2, pt));
+
+         if(dev > accum.mindev45)
+            accum.mindev45 = dev;
+
+         if(sizeX + sizeY < squareSize)
+            dev = calcDev(pl3, pt);
+         else if(sizeX + sizeY > squareSize)
+            dev = calcDev(pl4, pt);
+         else
+            dev = Umax(calcDev(pl3, pt), calcDev(pl4, pt));
+
+         if(dev > accum.mindev135)
+            accum.mindev135 = dev;
+      }
+   }
+}
+
+/// Fills in the grid square from its gathered samples and picks 
+/// its split.  The parent gets the max of its children's deviance.
+static void finishGridSquare( const GridSquareAccum &accum,
+                              TerrainSquare *sq,
+                              TerrainSquare *parent,
+                              S32 level,
+                              S32 squareX,
+                              S32 squareY )
+{
+   bool parentSplit45 = false;
+   if ( parent )
+      parentSplit45 = parent->flags & TerrainSquare::Split45;
+
+   sq->minHeight = accum.min;
+   sq->maxHeight = accum.max;
+
+   sq->flags = accum.empty ? TerrainSquare::Empty : 0;
+   if ( accum.hasEmpty )
+      sq->flags |= TerrainSquare::HasEmpty;
+
+   bool shouldSplit45 = ((squareX ^ squareY) & 1) == 0;
+   bool split45;
+
+   //split45 = shouldSplit45;
+   if ( level == 0 )
+      split45 = shouldSplit45;
+   else if( level < 4 && shouldSplit45 == parentSplit45 )
+      split45 = shouldSplit45;
+   else
+      split45 = accum.mindev45 < accum.mindev135;
+
+   //split45 = shouldSplit45;
+   if(split45)
+   {
+      sq->flags |= TerrainSquare::Split45;
+      sq->heightDeviance = accum.mindev45;
+   }
+   else
+      sq->heightDeviance = accum.mindev135;
+
+   if( parent )
+      if (  parent->heightDeviance < sq->heightDeviance )
+            parent->heightDeviance = sq->heightDeviance;
+}
+
+/// Calculates the bounds, empty state and split for one grid square.
+template<class T>
+static void buildGridSquare(  const T &sampler,
+                              TerrainSquare *sq,
+                              TerrainSquare *parent,
+                              S32 level,
+                              S32 squareX,
+                              S32 squareY,
+                              S32 squareSize )
+{
+   GridSquareAccum accum;
+   accumGridSquare( sampler, accum, squareX, squareY, squareSize, 0, squareSize + 1 );
+   finishGridSquare( accum, sq, parent, level, squareX, squareY );
+}
+
+
+/// Work over a range of rows which is safe to split across threads.
+struct TerrainRowTask
+{
+   virtual ~TerrainRowTask() {}
+
+   virtual void processRows( S32 begin, S32 end ) const = 0;
+};
+
+/// Runs a range of rows of a TerrainRowTask on the thread pool.
+struct TerrainRowJob : public ThreadPoolJob
+{
+   const TerrainRowTask *mTask;
+   S32 mBegin;
+   S32 mEnd;
+
+   TerrainRowJob( const TerrainRowTask *task, S32 begin, S32 end )
+      :  mTask( task ),
+         mBegin( begin ),
+         mEnd( end ) {}
+
+protected:
+
+   virtual void run() { mTask->processRows( mBegin, mEnd ); }
+};
+
+/// Runs the task over the rows splitting them across the thread pool 
+/// on multiples of the alignment.  The first range is run on the calling
+/// thread and we return once all the ranges are done.  Small amounts of
+/// work are not worth the job overhead and run inline.
+static void runRowTask( const TerrainRowTask &task, S32 begin, S32 end, U32 samplesPerRow, S32 align = 1 )
+{
+   // Below this many samples we don't bother with threads.
+   const U32 MinJobSamples = 128 * 128;
+
+   const S32 rows = end - begin;
+   if ( rows <= 0 )
+      return;
+
+   S32 jobCount = TerrainFile::getGridThreadCount();
+   if ( (U32)rows * samplesPerRow < MinJobSamples * 2 )
+      jobCount = 1;
+   jobCount = mClamp( jobCount, 1, rows / align );
+
+   if ( jobCount <= 1 )
+   {
+      task.processRows( begin, end );
+      return;
+   }
+
+   // Round the rows per job up to the alignment.
+   S32 rowsPerJob = ( rows + jobCount - 1 ) / jobCount;
+   rowsPerJob = ( ( rowsPerJob + align - 1 ) / align ) * align;
+
+   ThreadPoolJobGroup< TerrainRowJob > jobs;
+   jobs.reserve( jobCount - 1 );
+
+   for ( S32 start = begin + rowsPerJob; start < end; start += rowsPerJob )
+      jobs.queue( new TerrainRowJob( &task, start, getMin( start + rowsPerJob, end ) ) );
+
+   task.processRows( begin, getMin( begin + rowsPerJob, end ) );
+
+   jobs.wait();
+}
+
+/// Builds whole rows of grid squares in a level.  The rows are
+/// split in pairs so that each parent is only ever updated by
+/// the thread building its children.
+struct GridLevelTask : public TerrainRowTask
+{
+   const TerrainFile *file;
+   S32 level;
+   S32 gridLevels;
+   S32 squareCount;
+   S32 squareSize;
+
+   virtual void processRows( S32 begin, S32 end ) const
+   {
+      for ( S32 squareY = begin; squareY < end; squareY++ )
+      {
+         for ( S32 squareX = 0; squareX < squareCount; squareX++ )
+         {
+            TerrainSquare *parent = NULL;
+            if ( level < gridLevels )
+               parent = file->findSquare( level+1, squareX * squareSize, squareY * squareSize );
+
+            buildGridSquare(  *file, 
+                              file->findSquare( level, squareX * squareSize, squareY * squareSize ),
+                              parent,
+                              level, squareX, squareY, squareSize );
+         }
+      }
+   }
+};
+
+/// Gathers the sample columns of a single large grid square 
+/// which is split across threads and merged when done.
+struct GridSquareTask : public TerrainRowTask
+{
+   const TerrainFile *file;
+   S32 squareX;
+   S32 squareY;
+   S32 squareSize;
+
+   mutable Mutex mutex;
+   mutable GridSquareAccum accum;
+
+   virtual void processRows( S32 begin, S32 end ) const
+   {
+      GridSquareAccum local;
+      accumGridSquare( *file, local, squareX, squareY, squareSize, begin, end );
+
+      MutexHandle handle;
+      handle.lock( &mutex );
+      accum.merge( local );
+   }
+};
+
 void TerrainFile::_buildGridMap()
 {
    // The grid level count is the same as the
@@ -117,121 +440,52 @@ void TerrainFile::_buildGridMap()
       sq += 1 << ( 2 * ( mGridLevels - i ) );
    }
 
+   PROFILE_SCOPE( TerrainFile_BuildGridMap );
+
+   // Each level only depends on the flags of the level above
+   // it, so we build a level at a time and split the squares
+   // of the level across threads.
+   const S32 threadCount = getGridThreadCount();
+
    for( S32 i = mGridLevels; i >= 0; i-- )
    {
       S32 squareCount = 1 << ( mGridLevels - i );
       S32 squareSize = mSize / squareCount;
 
+      if ( squareCount >= threadCount * 2 )
+      {
+         GridLevelTask task;
+         task.file = this;
+         task.level = i;
+         task.gridLevels = mGridLevels;
+         task.squareCount = squareCount;
+         task.squareSize = squareSize;
+         runRowTask( task, 0, squareCount, squareCount * squareSize * squareSize, 2 );
+         continue;
+      }
+
+      // There are too few squares at the top levels to keep
+      // all the threads busy, so we split the samples of each
+      // square across the threads instead.
       for ( S32 squareX = 0; squareX < squareCount; squareX++ )
       {
          for ( S32 squareY = 0; squareY < squareCount; squareY++ )
          {
-            U16 min = 0xFFFF;
-            U16 max = 0;
-            U16 mindev45 = 0;
-            U16 mindev135 = 0;
-
-            // determine max error for both possible splits.
-
-            const Point3F p1(0, 0, getHeight(squareX * squareSize, squareY * squareSize));
-            const Point3F p2(0, (F32)squareSize, getHeight(squareX * squareSize, squareY * squareSize + squareSize));
-            const Point3F p3((F32)squareSize, (F32)squareSize, getHeight(squareX * squareSize + squareSize, squareY * squareSize + squareSize));
-            const Point3F p4((F32)squareSize, 0, getHeight(squareX * squareSize + squareSize, squareY * squareSize));
+            GridSquareTask task;
+            task.file = this;
+            task.squareX = squareX;
+            task.squareY = squareY;
+            task.squareSize = squareSize;
+            runRowTask( task, 0, squareSize + 1, squareSize + 1 );
 
-            // pl1, pl2 = split45, pl3, pl4 = split135
-            const PlaneF pl1(p1, p2, p3);
-            const PlaneF pl2(p1, p3, p4);
-            const PlaneF pl3(p1, p2, p4);
-            const PlaneF pl4(p2, p3, p4);
-
-            bool parentSplit45 = false;
             TerrainSquare *parent = NULL;
             if ( i < mGridLevels )
-            {
                parent = findSquare( i+1, squareX * squareSize, squareY * squareSize );
-               parentSplit45 = parent->flags & TerrainSquare::Split45;
-            }
-
-            bool empty = true;
-            bool hasEmpty = false;
-
-            for ( S32 sizeX = 0; sizeX <= squareSize; sizeX++ )
-            {
-               for ( S32 sizeY = 0; sizeY <= squareSize; sizeY++ )
-               {
-                  S32 x = squareX * squareSize + sizeX;
-                  S32 y = squareY * squareSize + sizeY;
-
-                  if(sizeX != squareSize && sizeY != squareSize)
-                  {
-                     if ( !isEmptyAt( x, y ) )
-                        empty = false;
-                     else
-                        hasEmpty = true;
-                  }
-
-                  U16 ht = getHeight( x, y );
-                  if ( ht < min )
-                     min = ht;
-                  if( ht > max )
-                     max = ht;
-
-                  Point3F pt( (F32)sizeX, (F32)sizeY, (F32)ht );
-                  U16 dev;
-
-                  if(sizeX < sizeY)
-                     dev = calcDev(pl1, pt);
-                  else if(sizeX > sizeY)
-                     dev = calcDev(pl2, pt);
-                  else
-                     dev = Umax(calcDev(pl1, pt), calcDev(pl2, pt));
-
-                  if(dev > mindev45)
-                     mindev45 = dev;
-
-                  if(sizeX + sizeY < squareSize)
-                     dev = calcDev(pl3, pt);
-                  else if(sizeX + sizeY > squareSize)
-                     dev = calcDev(pl4, pt);
-                  else
-                     dev = Umax(calcDev(pl3, pt), calcDev(pl4, pt));
-
-                  if(dev > mindev135)
-                     mindev135 = dev;
-               }
-            }
-
-            TerrainSquare *sq = findSquare( i, squareX * squareSize, squareY * squareSize );
-            sq->minHeight = min;
-            sq->maxHeight = max;
 
-            sq->flags = empty ? TerrainSquare::Empty : 0;
-            if ( hasEmpty )
-               sq->flags |= TerrainSquare::HasEmpty;
-
-            bool shouldSplit45 = ((squareX ^ squareY) & 1) == 0;
-            bool split45;
-
-            //split45 = shouldSplit45;
-            if ( i == 0 )
-               split45 = shouldSplit45;
-            else if( i < 4 && shouldSplit45 == parentSplit45 )
-               split45 = shouldSplit45;
-            else
-               split45 = mindev45 < mindev135;
-
-            //split45 = shouldSplit45;
-            if(split45)
-            {
-               sq->flags |= TerrainSquare::Split45;
-               sq->heightDeviance = mindev45;
-            }
-            else
-               sq->heightDeviance = mindev135;
-
-            if( parent )
-               if (  parent->heightDeviance < sq->heightDeviance )
-                     parent->heightDeviance = sq->heightDeviance;
+            finishGridSquare( task.accum, 
+                              findSquare( i, squareX * squareSize, squareY * squareSize ),
+                              parent,
+                              i, squareX, squareY );
          }
       }
    }
@@ -267,6 +521,28 @@ void TerrainFile::_initMaterialInstMapping()
 
 bool TerrainFile::save( const char *filename )
 {
+   // We need the whole map and grid to write the pages.
+   makeResident();
+
+   // Small terrains are written as a single page.
+   const U32 pageShift = getMin( (U32)PAGE_SHIFT, mGridLevels );
+   const U32 pageSize = 1 << pageShift;
+   const U32 pagesPerSide = mSize >> pageShift;
+   const U32 pageCount = pagesPerSide * pagesPerSide;
+   const U32 pageBytes = ( pageSize + 1 ) * ( pageSize + 1 ) * sizeof( U16 ) + pageSize * pageSize;
+
+   // The page directory holds 32bit stream offsets, so refuse
+   // to write a file we couldn't seek through.  The material
+   // names and upper grid levels ahead of the pages are well
+   // under the megabyte of slack we leave for them.
+   const U64 pageDataBytes = U64( pageCount ) * ( pageBytes + sizeof( U32 ) );
+   if ( pageDataBytes > U64( U32_MAX ) - 1024 * 1024 )
+   {
+      Con::errorf( "TerrainFile::save - '%s' is too large to save, the pages would need %.0f MB.",
+         filename, F64( pageDataBytes ) / ( 1024.0 * 1024.0 ) );
+      return false;
+   }
+
    FileStream stream;
    stream.open( filename, Torque::FS::File::Write );
    if ( stream.getStatus() != Stream::Ok )
@@ -276,24 +552,61 @@ bool TerrainFile::save( const char *filename )
 
    stream.write( mSize );
 
-   // Write out the height map.
-   for ( U32 i=0; i < mHeightMap.size(); i++)
-      stream.write( mHeightMap[i] );
-
-   // Write out the layer map.
-   for ( U32 i=0; i < mLayerMap.size(); i++)
-      stream.write( mLayerMap[i] );
-
-   // Write out the material names.
+   // Write out the material names first so that a paged
+   // load can resolve them without touching the pages.
    stream.write( (U32)mMaterials.size() );
    for ( U32 i=0; i < mMaterials.size(); i++ )
       stream.write( String( mMaterials[i]->getInternalName() ) );
 
+   stream.write( (U8)pageShift );
+
+   // Write out the grid levels above the page size which
+   // stay resident when the terrain is paged.
+   for ( S32 i = mGridLevels; i > (S32)pageShift; i-- )
+   {
+      const U32 squareCount = 1 << ( 2 * ( mGridLevels - i ) );
+      for ( U32 j=0; j < squareCount; j++ )
+      {
+         const TerrainSquare &sq = mGridMap[i][j];
+         stream.write( sq.minHeight );
+         stream.write( sq.maxHeight );
+         stream.write( sq.heightDeviance );
+         stream.write( sq.flags );
+      }
+   }
+
+   // The pages are all the same size so we can write 
+   // out the page directory before the pages.
+   const U32 dataStart = stream.getPosition() + pageCount * sizeof( U32 );
+   for ( U32 i=0; i < pageCount; i++ )
+      stream.write( dataStart + i * pageBytes );
+
+   for ( U32 py=0; py < pagesPerSide; py++ )
+   {
+      for ( U32 px=0; px < pagesPerSide; px++ )
+      {
+         const U32 originX = px << pageShift;
+         const U32 originY = py << pageShift;
+
+         // Write out the heights including the far edge
+         // apron which wraps like getHeight() does.
+         for ( U32 y=0; y <= pageSize; y++ )
+            for ( U32 x=0; x <= pageSize; x++ )
+               stream.write( getHeight( originX + x, originY + y ) );
+
+         // Write out the layers.
+         for ( U32 y=0; y < pageSize; y++ )
+            stream.write( pageSize, &mLayerMap[ originX + ( originY + y ) * mSize ] );
+      }
+   }
+
    return stream.getStatus() == FileStream::Ok;
 }
 
 TerrainFile* TerrainFile::load( const Torque::Path &path )
 {
+   SLAB_TAG_SCOPE( Terrain );
+
    FileStream stream;
 
    stream.open( path.getFullPath(), Torque::FS::File::Read );
@@ -315,13 +628,33 @@ TerrainFile* TerrainFile::load( const Torque::Path &path )
    ret->mFileVersion = version;
    ret->mFilePath = path;
 
-   if ( version >= 7 )
-      ret->_load( stream );
+   if ( version >= TILED_FILE_VERSION )
+   {
+      // The tiled loader keeps its own stream open
+      // to fault in the pages.
+      stream.close();
+
+      if ( !ret->_loadTiled() )
+      {
+         Con::errorf( "Resource<TerrainFile>::create - could not read the pages of '%s'", path.getFullPath().c_str() );
+         delete ret;
+         return NULL;
+      }
+
+      // Smaller terrains are not worth paging.
+      if ( smPagingMinSize == 0 || ret->mSize < smPagingMinSize )
+         ret->makeResident();
+   }
    else
-      ret->_loadLegacy( stream );
+   {
+      if ( version >= 7 )
+         ret->_load( stream );
+      else
+         ret->_loadLegacy( stream );
 
-   // Update the collision structures.
-   ret->_buildGridMap();
+      // Update the collision structures.
+      ret->_buildGridMap();
+   }
    
    // Do the material mapping.
    ret->_initMaterialInstMapping();
@@ -329,6 +662,322 @@ TerrainFile* TerrainFile::load( const Torque::Path &path )
    return ret;
 }
 
+bool TerrainFile::_loadTiled()
+{
+   mPageStream = new FileStream;
+   if ( !mPageStream->open( mFilePath.getFullPath(), Torque::FS::File::Read ) )
+   {
+      _releasePages();
+      return false;
+   }
+
+   U8 version;
+   mPageStream->read( &version );
+   mPageStream->read( &mSize );
+
+   // Get the material name count.
+   U32 materialCount;
+   mPageStream->read( &materialCount );
+   Vector<String> materials;
+   materials.setSize( materialCount );
+
+   // Load the material names.
+   for ( U32 i=0; i < materialCount; i++ )
+      mPageStream->read( &materials[i] );
+
+   // Resolve the TerrainMaterial objects from the names.
+   _resolveMaterials( materials );
+
+   U8 pageShift;
+   mPageStream->read( &pageShift );
+   mPageShift = pageShift;
+
+   mGridLevels = getMostSignificantBit( mSize );
+   if ( !isPow2( mSize ) || mPageShift > mGridLevels )
+   {
+      _releasePages();
+      return false;
+   }
+
+   mPagesPerSide = mSize >> mPageShift;
+
+   // Setup the grid levels above the page size.  The levels
+   // at or below it are owned by the pages.
+   U32 poolSize = 0;
+   for ( U32 i = mPageShift + 1; i <= mGridLevels; i++ )
+      poolSize += 1 << ( 2 * ( mGridLevels - i ) );
+
+   mGridMapPool.setSize( poolSize );
+   mGridMapPool.compact();
+   mGridMap.setSize( mGridLevels + 1 );
+   mGridMap.compact();
+
+   TerrainSquare *sq = mGridMapPool.address();
+   for ( S32 i = mGridLevels; i >= 0; i-- )
+   {
+      if ( i <= (S32)mPageShift )
+      {
+         mGridMap[i] = NULL;
+         continue;
+      }
+
+      mGridMap[i] = sq;
+      sq += 1 << ( 2 * ( mGridLevels - i ) );
+   }
+
+   for ( U32 i=0; i < mGridMapPool.size(); i++ )
+   {
+      mPageStream->read( &mGridMapPool[i].minHeight );
+      mPageStream->read( &mGridMapPool[i].maxHeight );
+      mPageStream->read( &mGridMapPool[i].heightDeviance );
+      mPageStream->read( &mGridMapPool[i].flags );
+   }
+
+   // Read the page directory.
+   const U32 pageCount = mPagesPerSide * mPagesPerSide;
+   mPageOffsets.setSize( pageCount );
+   for ( U32 i=0; i < pageCount; i++ )
+      mPageStream->read( &mPageOffsets[i] );
+
+   mPages.setSize( pageCount );
+   for ( U32 i=0; i < pageCount; i++ )
+      mPages[i] = NULL;
+
+   if ( mPageStream->getStatus() != Stream::Ok )
+   {
+      _releasePages();
+      return false;
+   }
+
+   return true;
+}
+
+bool TerrainFile::_readPage( U32 index, TerrainPage *page ) const
+{
+   const U32 pageSize = 1 << mPageShift;
+
+   page->heights.setSize( ( pageSize + 1 ) * ( pageSize + 1 ) );
+   page->layers.setSize( pageSize * pageSize );
+
+   // NOTE: We read the heights one at a time so that
+   // the stream does the endian conversions for us.
+   bool success = mPageStream->setPosition( mPageOffsets[index] );
+   if ( success )
+   {
+      for ( U32 i=0; i < page->heights.size(); i++ )
+         mPageStream->read( &page->heights[i] );
+
+      mPageStream->read( page->layers.size(), page->layers.address() );
+
+      success = mPageStream->getStatus() == Stream::Ok;
+   }
+
+   if ( !success )
+   {
+      Con::errorf( "TerrainFile::_readPage - Failed reading page %d of '%s'!", index, mFilePath.getFullPath().c_str() );
+      dMemset( page->heights.address(), 0, page->heights.memSize() );
+      dMemset( page->layers.address(), 0, page->layers.memSize() );
+   }
+
+   return success;
+}
+
+void TerrainFile::_buildPageGrid( U32 index, TerrainPage *page ) const
+{
+   PROFILE_SCOPE( TerrainFile_BuildPageGrid );
+
+   U32 poolSize = 0;
+   for ( U32 i=0; i <= mPageShift; i++ )
+      poolSize += 1 << ( 2 * i );
+
+   page->gridPool.setSize( poolSize );
+   page->grid.setSize( mPageShift + 1 );
+
+   // Assign memory from the pool to each grid level.
+   TerrainSquare *sq = page->gridPool.address();
+   for ( S32 i = mPageShift; i >= 0; i-- )
+   {
+      page->grid[i] = sq;
+      sq += 1 << ( 2 * ( mPageShift - i ) );
+   }
+
+   TerrainPageSampler sampler;
+   sampler.page = page;
+   sampler.originX = ( index % mPagesPerSide ) << mPageShift;
+   sampler.originY = ( index / mPagesPerSide ) << mPageShift;
+   sampler.shift = mPageShift;
+
+   // The squares come out the same as _buildGridMap() would
+   // give us as the apron covers the far edge samples and the
+   // resident levels above us were saved from a full build.
+   for ( S32 i = mPageShift; i >= 0; i-- )
+   {
+      const S32 squareCount = 1 << ( mPageShift - i );
+      const S32 squareSize = 1 << i;
+      const S32 baseX = sampler.originX >> i;
+      const S32 baseY = sampler.originY >> i;
+
+      for ( S32 squareX = 0; squareX < squareCount; squareX++ )
+      {
+         for ( S32 squareY = 0; squareY < squareCount; squareY++ )
+         {
+            TerrainSquare *parent = NULL;
+            if ( i < (S32)mPageShift )
+               parent = page->grid[i+1] + ( squareX >> 1 ) + ( ( squareY >> 1 ) << ( mPageShift - i - 1 ) );
+            else if ( i < (S32)mGridLevels )
+               parent = mGridMap[i+1] + ( baseX >> 1 ) + ( ( baseY >> 1 ) << ( mGridLevels - i - 1 ) );
+
+            buildGridSquare(  sampler, 
+                              page->grid[i] + squareX + ( squareY << ( mPageShift - i ) ),
+                              parent,
+                              i, baseX + squareX, baseY + squareY, squareSize );
+         }
+      }
+   }
+}
+
+TerrainPage* TerrainFile::_loadPage( U32 index ) const
+{
+   PROFILE_SCOPE( TerrainFile_LoadPage );
+   SLAB_TAG_SCOPE( Terrain );
+
+   // Evict the least recently used page if we're over budget.  We
+   // never go below a minimum so that the squares and heights used
+   // within a single collision or render query stay resident.
+   const U32 budget = getMax( smPageBudget, (U32)MIN_RESIDENT_PAGES );
+   if ( mResidentPages.size() >= budget )
+   {
+      U32 lru = 0;
+      for ( U32 i=1; i < mResidentPages.size(); i++ )
+      {
+         if ( mPages[ mResidentPages[i] ]->lastUsed < mPages[ mResidentPages[lru] ]->lastUsed )
+            lru = i;
+      }
+
+      delete mPages[ mResidentPages[lru] ];
+      mPages[ mResidentPages[lru] ] = NULL;
+      mResidentPages.erase_fast( lru );
+   }
+
+   TerrainPage *page = new TerrainPage;
+   _readPage( index, page );
+   _buildPageGrid( index, page );
+
+   mPages[index] = page;
+   mResidentPages.push_back( index );
+
+   return page;
+}
+
+void TerrainFile::_releasePages()
+{
+   for ( U32 i=0; i < mPages.size(); i++ )
+      delete mPages[i];
+
+   mPages.clear();
+   mResidentPages.clear();
+   mPageOffsets.clear();
+   mPagesPerSide = 0;
+
+   SAFE_DELETE( mPageStream );
+}
+
+void TerrainFile::makeResident() const
+{
+   if ( !mPageStream )
+      return;
+
+   PROFILE_SCOPE( TerrainFile_MakeResident );
+
+   // Residency is a cache state and not a change 
+   // to the terrain data, so we allow it on const.
+   TerrainFile *self = const_cast<TerrainFile*>( this );
+
+   const U32 pageSize = 1 << mPageShift;
+   self->mHeightMap.setSize( mSize * mSize );
+   self->mHeightMap.compact();
+   self->mLayerMap.setSize( mSize * mSize );
+   self->mLayerMap.compact();
+
+   TerrainPage scratch;
+
+   for ( U32 i=0; i < mPages.size(); i++ )
+   {
+      // Use the resident page if we have it else read
+      // it without building the grid or evicting.
+      const TerrainPage *page = mPages[i];
+      if ( !page )
+      {
+         _readPage( i, &scratch );
+         page = &scratch;
+      }
+
+      const U32 originX = ( i % mPagesPerSide ) << mPageShift;
+      const U32 originY = ( i / mPagesPerSide ) << mPageShift;
+
+      for ( U32 y=0; y < pageSize; y++ )
+      {
+         const U32 offset = originX + ( originY + y ) * mSize;
+         dMemcpy( &self->mHeightMap[offset], &page->heights[ y * ( pageSize + 1 ) ], pageSize * sizeof( U16 ) );
+         dMemcpy( &self->mLayerMap[offset], &page->layers[ y * pageSize ], pageSize );
+      }
+   }
+
+   self->_releasePages();
+   self->_buildGridMap();
+}
+
+void TerrainFile::preloadPages( const Point2I &minPt, const Point2I &maxPt ) const
+{
+   if ( !mPageStream )
+      return;
+
+   const S32 maxSample = mSize - 1;
+   const S32 minX = mClamp( minPt.x, 0, maxSample ) >> mPageShift;
+   const S32 minY = mClamp( minPt.y, 0, maxSample ) >> mPageShift;
+   const S32 maxX = mClamp( maxPt.x, 0, maxSample ) >> mPageShift;
+   const S32 maxY = mClamp( maxPt.y, 0, maxSample ) >> mPageShift;
+
+   for ( S32 y = minY; y <= maxY; y++ )
+      for ( S32 x = minX; x <= maxX; x++ )
+         _getPage( x << mPageShift, y << mPageShift );
+}
+
+void TerrainFile::copyLayerRows( U32 y, U32 rowCount, U8 *dest ) const
+{
+   AssertFatal( y + rowCount <= mSize, "TerrainFile::copyLayerRows - The rows are out of range!" );
+
+   if ( !mPageStream )
+   {
+      dMemcpy( dest, &mLayerMap[ y * mSize ], rowCount * mSize );
+      return;
+   }
+
+   const U32 pageSize = 1 << mPageShift;
+   const U32 pageMask = pageSize - 1;
+
+   while ( rowCount > 0 )
+   {
+      // Copy the rows that fall in this band of pages.
+      const U32 pageY = y & pageMask;
+      const U32 bandRows = getMin( rowCount, pageSize - pageY );
+
+      for ( U32 px=0; px < mPagesPerSide; px++ )
+      {
+         const TerrainPage *page = _getPage( px << mPageShift, y );
+         const U8 *src = &page->layers[ pageY << mPageShift ];
+         U8 *out = dest + ( px << mPageShift );
+
+         for ( U32 row=0; row < bandRows; row++ )
+            dMemcpy( out + row * mSize, src + ( row << mPageShift ), pageSize );
+      }
+
+      dest += bandRows * mSize;
+      y += bandRows;
+      rowCount -= bandRows;
+   }
+}
+
 void TerrainFile::_load( FileStream &stream )
 {
    // NOTE: We read using a loop instad of in one large chunk
@@ -580,6 +1229,10 @@ void TerrainFile::setSize( U32 newSize, bool clear )
    // 
    if ( clear )
    {
+      // We're replacing everything so don't bother
+      // reading in the pages.
+      _releasePages();
+
       mLayerMap.setSize( newSize * newSize );
       mLayerMap.compact();
       dMemset( mLayerMap.address(), 0, mLayerMap.memSize() );
@@ -595,6 +1248,8 @@ void TerrainFile::setSize( U32 newSize, bool clear )
    }
    else
    {
+      makeResident();
+
       // We're resizing here!
 
 
@@ -606,33 +1261,22 @@ void TerrainFile::setSize( U32 newSize, bool clear )
    _buildGridMap();
 }
 
-void TerrainFile::smooth( F32 factor, U32 steps, bool updateCollision )
+/// Does one smoothing step over a range of height map rows.  The
+/// rows only read from the source so they can be split freely.
+struct SmoothTask : public TerrainRowTask
 {
-   const U32 blockSize = mSize * mSize;
-
-   // Grab some temp buffers for our smoothing results.
-   Vector<F32> h1, h2;
-   h1.setSize( blockSize );
-   h2.setSize( blockSize );
-
-   // Fill the first buffer with the current heights.   
-   for ( U32 i=0; i < blockSize; i++ )
-      h1[i] = (F32)mHeightMap[i];
-
-   // factor of 0.0 = NO Smoothing
-   // factor of 1.0 = MAX Smoothing
-   const F32 matrixM = 1.0f - getMax(0.0f, getMin(1.0f, factor));
-   const F32 matrixE = (1.0f-matrixM) * (1.0f/12.0f) * 2.0f;
-   const F32 matrixC = matrixE * 0.5f;
-
-   // Now loop for our interations.
-   F32 *src = h1.address();
-   F32 *dst = h2.address();
-   for ( U32 s=0; s < steps; s++ )
+   const F32 *src;
+   F32 *dst;
+   S32 size;
+   F32 matrixM;
+   F32 matrixE;
+   F32 matrixC;
+
+   virtual void processRows( S32 begin, S32 end ) const
    {
-      for ( S32 y=0; y < mSize; y++ )
+      for ( S32 y=begin; y < end; y++ )
       {
-         for ( S32 x=0; x < mSize; x++ )
+         for ( S32 x=0; x < size; x++ )
          {
             F32 samples[9];
 
@@ -640,22 +1284,59 @@ void TerrainFile::smooth( F32 factor, U32 steps, bool updateCollision )
             for (S32 i = y-1; i < y+2; i++)
                for (S32 j = x-1; j < x+2; j++)
                {
-                  if ( i < 0 || j < 0 || i >= mSize || j >= mSize )
-                     samples[c++] = src[ x + ( y * mSize ) ];
+                  if ( i < 0 || j < 0 || i >= size || j >= size )
+                     samples[c++] = src[ x + ( y * size ) ];
                   else
-                     samples[c++] = src[ j + ( i * mSize ) ];
+                     samples[c++] = src[ j + ( i * size ) ];
                }
 
             //  0  1  2
             //  3 x,y 5
             //  6  7  8
 
-            dst[ x + ( y * mSize ) ] =
+            dst[ x + ( y * size ) ] =
                ((samples[0]+samples[2]+samples[6]+samples[8]) * matrixC) +
                ((samples[1]+samples[3]+samples[5]+samples[7]) * matrixE) +
                (samples[4] * matrixM);
          }
       }
+   }
+};
+
+void TerrainFile::smooth( F32 factor, U32 steps, bool updateCollision )
+{
+   PROFILE_SCOPE( TerrainFile_Smooth );
+
+   makeResident();
+
+   const U32 blockSize = mSize * mSize;
+
+   // Grab some temp buffers for our smoothing results.
+   Vector<F32> h1, h2;
+   h1.setSize( blockSize );
+   h2.setSize( blockSize );
+
+   // Fill the first buffer with the current heights.   
+   for ( U32 i=0; i < blockSize; i++ )
+      h1[i] = (F32)mHeightMap[i];
+
+   // factor of 0.0 = NO Smoothing
+   // factor of 1.0 = MAX Smoothing
+   SmoothTask task;
+   task.size = mSize;
+   task.matrixM = 1.0f - getMax(0.0f, getMin(1.0f, factor));
+   task.matrixE = (1.0f-task.matrixM) * (1.0f/12.0f) * 2.0f;
+   task.matrixC = task.matrixE * 0.5f;
+
+   // Now loop for our interations.  Each step
+   // is split by rows across the threads.
+   F32 *src = h1.address();
+   F32 *dst = h2.address();
+   for ( U32 s=0; s < steps; s++ )
+   {
+      task.src = src;
+      task.dst = dst;
+      runRowTask( task, 0, mSize, mSize );
 
       // Swap!
       F32 *tmp = dst;
@@ -673,8 +1354,10 @@ void TerrainFile::smooth( F32 factor, U32 steps, bool updateCollision )
 
 void TerrainFile::setHeightMap( const Vector<U16> &heightmap, bool updateCollision )
 {
+   makeResident();
+
    AssertFatal( mHeightMap.size() == heightmap.size(), "TerrainFile::setHeightMap - Incorrect heightmap size!" );
-   dMemcpy( mHeightMap.address(), heightmap.address(), mHeightMap.size() ); 
+   dMemcpy( mHeightMap.address(), heightmap.address(), mHeightMap.memSize() ); 
 
    if ( updateCollision )
       _buildGridMap();
@@ -689,8 +1372,11 @@ void TerrainFile::import(  const GBitmap &heightMap,
    AssertFatal( heightMap.getWidth() == heightMap.getHeight(), "TerrainFile::import - Height map is not square!" );
    AssertFatal( isPow2( heightMap.getWidth() ), "TerrainFile::import - Height map is not power of two!" );
 
+   // The imported maps replace everything.
+   _releasePages();
+
    const U32 newSize = heightMap.getWidth();
-   if ( newSize != mSize )
+   if ( newSize != mSize || mHeightMap.size() != newSize * newSize )
    {
       mHeightMap.setSize( newSize * newSize );
       mHeightMap.compact();
@@ -813,6 +1499,118 @@ inline void checkSquare( TerrainSquare *parent, const TerrainSquare *child )
       parent->flags |= TerrainSquare::HasEmpty;
 }
 
+/// Updates the bounds of a range of rows of grid squares in one
+/// level from the level below and notes if any of them changed.
+/// Each square only writes itself so the rows can be split freely.
+struct UpdateGridTask : public TerrainRowTask
+{
+   const TerrainFile *file;
+   S32 level;
+   S32 minX;
+   S32 maxX;
+
+   mutable volatile U32 changed;
+
+   virtual void processRows( S32 begin, S32 end ) const
+   {
+      bool anyChanged = false;
+
+      for ( S32 y = begin; y < end; y++ )
+      {
+         for ( S32 x = minX; x < maxX; x++ )
+         {
+            if ( level == 0 )
+               anyChanged |= _updateSample( x, y );
+            else
+               anyChanged |= _updateSquare( x, y );
+         }
+      }
+
+      if ( anyChanged )
+         dCompareAndSwap( changed, 0, 1 );
+   }
+
+   bool _updateSample( S32 x, S32 y ) const
+   {
+      S32 px = x;
+      S32 py = y;
+      if ( px < 0 )
+         px += file->getSize();
+      if ( py < 0 )
+         py += file->getSize();
+
+      TerrainSquare *sq = file->findSquare( 0, px, py );
+      const TerrainSquare old = *sq;
+
+      sq->minHeight = 0xFFFF;
+      sq->maxHeight = 0;
+
+      // Update the empty state.
+      if ( file->isEmptyAt( x, y ) )
+         sq->flags |= TerrainSquare::Empty;
+      else
+         sq->flags &= ~TerrainSquare::Empty;
+
+      getMinMax( sq->minHeight, sq->maxHeight, file->getHeight( x, y ) );
+      getMinMax( sq->minHeight, sq->maxHeight, file->getHeight( x+1, y ) );
+      getMinMax( sq->minHeight, sq->maxHeight, file->getHeight( x, y+1 ) );
+      getMinMax( sq->minHeight, sq->maxHeight, file->getHeight( x+1, y+1 ) );
+
+      return   old.minHeight != sq->minHeight ||
+               old.maxHeight != sq->maxHeight ||
+               old.flags != sq->flags;
+   }
+
+   bool _updateSquare( S32 x, S32 y ) const
+   {
+      const S32 halfSize = 1 << ( level - 1 );
+      const S32 px = x << level;
+      const S32 py = y << level;
+
+      TerrainSquare *sq = file->findSquare( level, px, py );
+      const TerrainSquare old = *sq;
+
+      sq->minHeight = 0xFFFF;
+      sq->maxHeight = 0;
+      sq->flags &= ~( TerrainSquare::Empty | TerrainSquare::HasEmpty );
+
+      checkSquare( sq, file->findSquare( level - 1, px, py ) );
+      checkSquare( sq, file->findSquare( level - 1, px + halfSize, py ) );
+      checkSquare( sq, file->findSquare( level - 1, px, py + halfSize ) );
+      checkSquare( sq, file->findSquare( level - 1, px + halfSize, py + halfSize ) );
+
+      return   old.minHeight != sq->minHeight ||
+               old.maxHeight != sq->maxHeight ||
+               old.flags != sq->flags;
+   }
+};
+
+/// Runs the update task over a range of squares in a level.  The
+/// range wraps around the terrain like findSquare() does, but when
+/// it spans the whole level we drop the wrapped squares so that no
+/// square is updated by two threads at once.
+static void runUpdateGridLevel( UpdateGridTask &task, S32 level, S32 minX, S32 minY, S32 maxX, S32 maxY )
+{
+   const S32 count = task.file->getSize() >> level;
+
+   if ( maxX - minX > count )
+   {
+      minX = 0;
+      maxX = count;
+   }
+
+   if ( maxY - minY > count )
+   {
+      minY = 0;
+      maxY = count;
+   }
+
+   task.level = level;
+   task.minX = minX;
+   task.maxX = maxX;
+   runRowTask( task, minY, maxY, ( maxX - minX ) * ( level == 0 ? 4 : 1 ) );
+}
+
 void TerrainFile::updateGrid( const Point2I &minPt, const Point2I &maxPt )
 {
    // here's how it works:
@@ -826,58 +1624,33 @@ void TerrainFile::updateGrid( const Point2I &minPt, const Point2I &maxPt )
 
    PROFILE_SCOPE( TerrainFile_UpdateGrid );
 
-   for ( S32 y = minPt.y - 1; y < maxPt.y + 1; y++ )
-   {
-      for ( S32 x = minPt.x - 1; x < maxPt.x + 1; x++ )
-      {
-         S32 px = x;
-         S32 py = y;
-         if ( px < 0 )
-            px += mSize;
-         if ( py < 0 )
-            py += mSize;
-
-         TerrainSquare *sq = findSquare( 0, px, py );
-         sq->minHeight = 0xFFFF;
-         sq->maxHeight = 0;
-
-         // Update the empty state.
-         if ( isEmptyAt( x, y ) )
-            sq->flags |= TerrainSquare::Empty;
-         else
-            sq->flags &= ~TerrainSquare::Empty;
+   makeResident();
 
-         getMinMax( sq->minHeight, sq->maxHeight, getHeight( x, y ) );
-         getMinMax( sq->minHeight, sq->maxHeight, getHeight( x+1, y ) );
-         getMinMax( sq->minHeight, sq->maxHeight, getHeight( x, y+1 ) );
-         getMinMax( sq->minHeight, sq->maxHeight, getHeight( x+1, y+1 ) );
-      }
-   }
+   // Callers pass Point2I::Max to mean the whole terrain
+   // so keep the dirty area within the height map.
+   const Point2I clampedMin( mClamp( minPt.x, 0, (S32)mSize ), mClamp( minPt.y, 0, (S32)mSize ) );
+   const Point2I clampedMax( mClamp( maxPt.x, 0, (S32)mSize ), mClamp( maxPt.y, 0, (S32)mSize ) );
+
+   UpdateGridTask task;
+   task.file = this;
+   task.changed = 0;
+
+   runUpdateGridLevel( task, 0, clampedMin.x - 1, clampedMin.y - 1, clampedMax.x + 1, clampedMax.y + 1 );
 
    // ok, all the level 0 grid squares are updated:
-   // now update all the parent grid squares that need to be updated:
-   for( S32 level = 1; level <= mGridLevels; level++ )
+   // now update all the parent grid squares that need to be updated.
+   // Once a level comes out unchanged none of the levels above it
+   // can change either, so we stop there.
+   for( S32 level = 1; level <= mGridLevels && task.changed; level++ )
    {
       S32 size = 1 << level;
-      S32 halfSize = size >> 1;  
 
-      for( S32 y = (minPt.y - 1) >> level; y < (maxPt.y + size) >> level; y++ )
-      {
-         for ( S32 x = (minPt.x - 1) >> level; x < (maxPt.x + size) >> level; x++ )
-         {
-            S32 px = x << level;
-            S32 py = y << level;
-
-            TerrainSquare *sq = findSquare(level, px, py);
-            sq->minHeight = 0xFFFF;
-            sq->maxHeight = 0;
-            sq->flags &= ~( TerrainSquare::Empty | TerrainSquare::HasEmpty );
-
-            checkSquare( sq, findSquare( level - 1, px, py ) );
-            checkSquare( sq, findSquare( level - 1, px + halfSize, py ) );
-            checkSquare( sq, findSquare( level - 1, px, py + halfSize ) );
-            checkSquare( sq, findSquare( level - 1, px + halfSize, py + halfSize ) );
-         }
-      }
+      task.changed = 0;
+      runUpdateGridLevel(  task, 
+                           level,
+                           ( clampedMin.x - 1 ) >> level,
+                           ( clampedMin.y - 1 ) >> level,
+                           ( clampedMax.x + size ) >> level,
+                           ( clampedMax.y + size ) >> level );
    }
 }
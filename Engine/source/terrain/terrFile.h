@@ -68,6 +68,30 @@ struct TerrainSquare
 typedef U16 TerrainHeight;
 
 
+/// A resident tile of a paged TerrainFile.
+///
+/// The height samples include a one sample apron on the
+/// far edges so that the grid squares for the page can be
+/// built without touching the neighboring pages.
+struct TerrainPage
+{
+   /// The (size+1)^2 fixed point height samples.
+   Vector<U16> heights;
+
+   /// The size^2 layer indices.
+   Vector<U8> layers;
+
+   /// The memory pool used by the page grid levels.
+   Vector<TerrainSquare> gridPool;
+
+   /// The grid levels from zero up to the page size.
+   Vector<TerrainSquare*> grid;
+
+   /// The page access stamp used for LRU eviction.
+   U64 lastUsed;
+};
+
+
 /// 
 class TerrainFile
 {
@@ -111,12 +135,57 @@ protected:
    /// The full path and name of the TerrainFile
    Torque::Path mFilePath;
 
+   /// The open file we fault pages in from or NULL
+   /// if the terrain is fully resident.
+   FileStream *mPageStream;
+
+   /// The log2 of the page size in samples.
+   U32 mPageShift;
+
+   /// The number of pages along each side.
+   U32 mPagesPerSide;
+
+   /// The file offset of each page.
+   Vector<U32> mPageOffsets;
+
+   /// The resident page table which is NULL for pages
+   /// which have not been faulted in.
+   mutable Vector<TerrainPage*> mPages;
+
+   /// The indices of the resident pages.
+   mutable Vector<U32> mResidentPages;
+
+   /// The access stamp given to the last touched page.
+   mutable U64 mPageClock;
+
    /// The internal loading function.
    void _load( FileStream &stream );
 
    /// The legacy file loading code.
    void _loadLegacy( FileStream &stream );
 
+   /// Opens the tiled file format and reads the page
+   /// directory leaving the pages on disk.
+   bool _loadTiled();
+
+   /// Returns the page containing the wrapped sample
+   /// faulting it in if it is not resident.
+   TerrainPage* _getPage( U32 x, U32 y ) const;
+
+   /// Reads the page from disk and builds its grid squares
+   /// evicting the least recently used page if we're over
+   /// the page budget.
+   TerrainPage* _loadPage( U32 index ) const;
+
+   /// Reads the page samples from the file.
+   bool _readPage( U32 index, TerrainPage *page ) const;
+
+   /// Builds the grid levels of a freshly read page.
+   void _buildPageGrid( U32 index, TerrainPage *page ) const;
+
+   /// Frees all the pages and closes the page file.
+   void _releasePages();
+
    /// Used to populate the materail vector by finding the 
    /// TerrainMaterial objects by name.
    void _resolveMaterials( const Vector<String> &materials );
@@ -131,9 +200,35 @@ public:
 
    enum Constants
    {
-      FILE_VERSION = 7
+      FILE_VERSION = 8,
+
+      /// The first version using the tiled page format.
+      TILED_FILE_VERSION = 8,
+
+      /// The log2 of the page size we save with.
+      PAGE_SHIFT = 8,
+
+      /// The fewest pages we keep resident regardless
+      /// of the page budget so that the square pointers
+      /// used within a single query stay valid.
+      MIN_RESIDENT_PAGES = 16
    };
 
+   /// Terrains at or above this size are paged in on demand
+   /// instead of being fully loaded.  Zero disables paging.
+   static U32 smPagingMinSize;
+
+   /// The soft limit on the number of resident pages.
+   static U32 smPageBudget;
+
+   /// The number of threads used to build the grid map, update
+   /// it and smooth the height map.  Zero uses one per logical
+   /// processor and one does all the work on the calling thread.
+   static S32 smGridThreads;
+
+   /// Returns the number of threads to split grid work across.
+   static S32 getGridThreadCount();
+
    TerrainFile();
 
    virtual ~TerrainFile();
@@ -163,6 +258,9 @@ public:
 
    void setSize( U32 newResolution, bool clear );
 
+   /// Returns the size of the height and layer maps.
+   U32 getSize() const { return mSize; }
+
    TerrainSquare* findSquare( U32 level, U32 x, U32 y ) const;
    
    BaseMatInstance* getMaterialMapping( U32 index ) const;
@@ -181,10 +279,28 @@ public:
 
    U16 getHeight( U32 x, U32 y ) const;
 
-   U16 getMaxHeight() const { return mGridMap[mGridLevels]->maxHeight; }
+   U16 getMaxHeight() const { return findSquare( mGridLevels, 0, 0 )->maxHeight; }
 
    /// Returns the constant heightmap vector.
-   const Vector<U16>& getHeightMap() const { return mHeightMap; }
+   /// @note This forces a paged terrain to be fully resident.
+   const Vector<U16>& getHeightMap() const { makeResident(); return mHeightMap; }
+
+   /// Returns true if the height and layer data is 
+   /// being paged in on demand.
+   bool isPaged() const { return mPageStream != NULL; }
+
+   /// Loads all the pages of a paged terrain into the contiguous 
+   /// height and layer maps and stops paging.  This is used by 
+   /// editing and by systems which need the whole map at once.
+   void makeResident() const;
+
+   /// Faults in all the pages overlapping the sample range
+   /// so that they are resident before they are queried.
+   void preloadPages( const Point2I &minPt, const Point2I &maxPt ) const;
+
+   /// Copies the full width layer rows starting at @a y into
+   /// @a dest looking up each page the rows cross only once.
+   void copyLayerRows( U32 y, U32 rowCount, U8 *dest ) const;
 
    /// Sets a new heightmap state.
    void setHeightMap( const Vector<U16> &heightmap, bool updateCollision );
@@ -194,10 +310,32 @@ public:
 };
 
 
+inline TerrainPage* TerrainFile::_getPage( U32 x, U32 y ) const
+{
+   const U32 index = ( x >> mPageShift ) + ( y >> mPageShift ) * mPagesPerSide;
+
+   TerrainPage *page = mPages[index];
+   if ( !page )
+      page = _loadPage( index );
+
+   page->lastUsed = ++mPageClock;
+   return page;
+}
+
 inline TerrainSquare* TerrainFile::findSquare( U32 level, U32 x, U32 y ) const
 {
    x %= mSize;
    y %= mSize;
+
+   if ( mPageStream && level <= mPageShift )
+   {
+      const U32 pageMask = ( 1 << mPageShift ) - 1;
+      TerrainPage *page = _getPage( x, y );
+      x = ( x & pageMask ) >> level;
+      y = ( y & pageMask ) >> level;
+      return page->grid[level] + x + ( y << ( mPageShift - level ) );
+   }
+
    x >>= level;
    y >>= level;
 
@@ -206,6 +344,9 @@ inline TerrainSquare* TerrainFile::findSquare( U32 level, U32 x, U32 y ) const
 
 inline void TerrainFile::setHeight( U32 x, U32 y, U16 height )
 {
+   if ( mPageStream )
+      makeResident();
+
    x %= mSize;
    y %= mSize;
    mHeightMap[ x + ( y * mSize ) ] = height;
@@ -215,25 +356,42 @@ inline const U16* TerrainFile::getHeightAddress( U32 x, U32 y ) const
 {
    x %= mSize;
    y %= mSize;
+
+   if ( mPageStream )
+   {
+      const U32 pageMask = ( 1 << mPageShift ) - 1;
+      const TerrainPage *page = _getPage( x, y );
+      return &page->heights[ ( x & pageMask ) + ( y & pageMask ) * ( pageMask + 2 ) ];
+   }
+
    return &mHeightMap[ x + ( y * mSize ) ];
 }
 
 inline U16 TerrainFile::getHeight( U32 x, U32 y ) const
 {
-   x %= mSize;
-   y %= mSize;
-   return mHeightMap[ x + ( y * mSize ) ];
+   return *getHeightAddress( x, y );
 }
 
 inline U8 TerrainFile::getLayerIndex( U32 x, U32 y ) const
 {
    x %= mSize;
    y %= mSize;
+
+   if ( mPageStream )
+   {
+      const U32 pageMask = ( 1 << mPageShift ) - 1;
+      const TerrainPage *page = _getPage( x, y );
+      return page->layers[ ( x & pageMask ) + ( ( y & pageMask ) << mPageShift ) ];
+   }
+
    return mLayerMap[ x + ( y * mSize ) ];
 }
 
 inline void TerrainFile::setLayerIndex( U32 x, U32 y, U8 index )
 {
+   if ( mPageStream )
+      makeResident();
+
    x %= mSize;
    y %= mSize;
    mLayerMap[ x + ( y * mSize ) ] = index;
@@ -249,9 +407,7 @@ inline BaseMatInstance* TerrainFile::getMaterialMapping( U32 index ) const
 
 inline StringTableEntry TerrainFile::getMaterialName( U32 x, U32 y) const
 {
-   x %= mSize;
-   y %= mSize;
-   const U8 &index = mLayerMap[ x + ( y * mSize ) ];
+   const U8 index = getLayerIndex( x, y );
 
    if ( index < mMaterials.size() )
       return mMaterials[ index ]->getInternalName();
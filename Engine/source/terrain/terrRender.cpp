@@ -107,8 +107,7 @@ void TerrainBlock::_updateMaterials()
 void TerrainBlock::_updateLayerTexture()
 {
    const U32 layerSize = mFile->mSize;
-   const Vector<U8> &layerMap = mFile->mLayerMap;
-   const U32 pixelCount = layerMap.size();
+   const U32 pixelCount = layerSize * layerSize;
 
    if (  mLayerTex.isNull() ||
          mLayerTex.getWidth() != layerSize ||
@@ -122,26 +121,57 @@ void TerrainBlock::_updateLayerTexture()
    // Update the layer texture.
    GFXLockedRect *lock = mLayerTex.lock();
 
-   for ( U32 i=0; i < pixelCount; i++ )
-   {  
-      lock->bits[0] = layerMap[i];
+   // A paged terrain doesn't need to be fully resident, so
+   // we work thru it a band of pages at a time.  Each band
+   // is copied along with the two rows below it which hold
+   // the neighbors along the seam with the next band.
+   const U32 bandSize = mFile->isPaged() ? BIT( mFile->mPageShift ) : layerSize;
 
-      if ( i + 1 >= pixelCount )
-         lock->bits[1] = lock->bits[0];
-      else
-         lock->bits[1] = layerMap[i+1];
+   Vector<U8> band;
+   if ( mFile->isPaged() )
+      band.setSize( ( bandSize + 2 ) * layerSize );
 
-      if ( i + layerSize >= pixelCount )
-         lock->bits[2] = lock->bits[0];
-      else
-         lock->bits[2] = layerMap[i + layerSize];
+   for ( U32 bandY=0; bandY < layerSize; bandY += bandSize )
+   {
+      const U32 rowsLeft = layerSize - bandY;
+      const U8 *layers;
+      U32 layerCount;
 
-      if ( i + layerSize + 1 >= pixelCount )
-         lock->bits[3] = lock->bits[0];
+      if ( mFile->isPaged() )
+      {
+         const U32 rowCount = getMin( bandSize + 2, rowsLeft );
+         mFile->copyLayerRows( bandY, rowCount, band.address() );
+         layers = band.address();
+         layerCount = rowCount * layerSize;
+      }
       else
-         lock->bits[3] = layerMap[i + layerSize + 1];
+      {
+         layers = mFile->mLayerMap.address();
+         layerCount = pixelCount;
+      }
+
+      const U32 texelCount = getMin( bandSize, rowsLeft ) * layerSize;
+      for ( U32 i=0; i < texelCount; i++ )
+      {  
+         lock->bits[0] = layers[i];
+
+         if ( i + 1 >= layerCount )
+            lock->bits[1] = lock->bits[0];
+         else
+            lock->bits[1] = layers[i+1];
+
+         if ( i + layerSize >= layerCount )
+            lock->bits[2] = lock->bits[0];
+         else
+            lock->bits[2] = layers[i + layerSize];
+
+         if ( i + layerSize + 1 >= layerCount )
+            lock->bits[3] = lock->bits[0];
+         else
+            lock->bits[3] = layers[i + layerSize + 1];
 
-      lock->bits += 4;
+         lock->bits += 4;
+      }
    }
 
    mLayerTex.unlock();
@@ -353,6 +383,15 @@ void TerrainBlock::_renderBlock( SceneRenderState *state )
    Point3F objCamPos = state->getDiffuseCameraPosition();
    objectXfm.mulP( objCamPos );
 
+   // Fault in the pages around the camera before the
+   // cells and collision start querying them.
+   if ( mFile->isPaged() && state->isDiffusePass() )
+   {
+      const S32 radius = mCeil( smPagePreloadDistance / mSquareSize );
+      const Point2I camPt( objCamPos.x / mSquareSize, objCamPos.y / mSquareSize );
+      mFile->preloadPages( camPt - Point2I( radius, radius ), camPt + Point2I( radius, radius ) );
+   }
+
    // Get the shadow material.
    if ( !mDefaultMatInst )
       mDefaultMatInst = TerrainCellMaterial::getShadowMat();
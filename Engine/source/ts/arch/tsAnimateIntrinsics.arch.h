@@ -0,0 +1,36 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSANIMATEINTRINSICS_ARCH_H_
+#define _TSANIMATEINTRINSICS_ARCH_H_
+
+#if defined(TORQUE_CPU_X86)
+# // x86 CPU family implementations
+extern void ts_nlerp_quat_soa_SSE(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr);
+extern void ts_lerp_point_soa_SSE(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr);
+extern void ts_build_node_matrices_SSE(const QuatF * __restrict rots, const Point3F * __restrict trans, const S32 count, MatrixF * __restrict outPtr);
+#
+#else
+# // Other CPU types go here...
+#endif
+
+#endif // _TSANIMATEINTRINSICS_ARCH_H_
@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+#include "platform/platform.h"
+
+#if defined(TORQUE_CPU_X86)
+#include "ts/tsAnimateIntrinsics.h"
+#include <xmmintrin.h>
+
+void ts_nlerp_quat_soa_SSE(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr)
+{
+   const __m128 vT = _mm_set1_ps(t);
+   const __m128 vZero = _mm_setzero_ps();
+   const __m128 vSignBit = _mm_set1_ps(-0.0f);
+
+   // The renormalization polynomials from TSTransform::interpolate
+   const __m128 vSplit = _mm_set1_ps(0.857f);
+   const __m128 vLo0 = _mm_set1_ps(0.699368f);
+   const __m128 vLo1 = _mm_set1_ps(-1.819985f);
+   const __m128 vLo2 = _mm_set1_ps(2.126369f);
+   const __m128 vHi0 = _mm_set1_ps(0.454012f);
+   const __m128 vHi1 = _mm_set1_ps(-1.403517f);
+   const __m128 vHi2 = _mm_set1_ps(1.949542f);
+
+   for(S32 i = 0; i < count; i += 4)
+   {
+      // load four rotations from each key
+      __m128 x1 = _mm_loadu_ps(key1 + i);
+      __m128 y1 = _mm_loadu_ps(key1 + i + stride);
+      __m128 z1 = _mm_loadu_ps(key1 + i + stride * 2);
+      __m128 w1 = _mm_loadu_ps(key1 + i + stride * 3);
+      const __m128 x2 = _mm_loadu_ps(key2 + i);
+      const __m128 y2 = _mm_loadu_ps(key2 + i + stride);
+      const __m128 z2 = _mm_loadu_ps(key2 + i + stride * 2);
+      const __m128 w2 = _mm_loadu_ps(key2 + i + stride * 3);
+
+      // flip the first rotation where they're more than 90 degrees apart
+      __m128 dot = _mm_mul_ps(x1, x2);
+      dot = _mm_add_ps(dot, _mm_mul_ps(y1, y2));
+      dot = _mm_add_ps(dot, _mm_mul_ps(z1, z2));
+      dot = _mm_add_ps(dot, _mm_mul_ps(w1, w2));
+      const __m128 vFlip = _mm_and_ps(_mm_cmplt_ps(dot, vZero), vSignBit);
+      x1 = _mm_xor_ps(x1, vFlip);
+      y1 = _mm_xor_ps(y1, vFlip);
+      z1 = _mm_xor_ps(z1, vFlip);
+      w1 = _mm_xor_ps(w1, vFlip);
+
+      // interpolate
+      x1 = _mm_add_ps(x1, _mm_mul_ps(vT, _mm_sub_ps(x2, x1)));
+      y1 = _mm_add_ps(y1, _mm_mul_ps(vT, _mm_sub_ps(y2, y1)));
+      z1 = _mm_add_ps(z1, _mm_mul_ps(vT, _mm_sub_ps(z2, z1)));
+      w1 = _mm_add_ps(w1, _mm_mul_ps(vT, _mm_sub_ps(w2, w1)));
+
+      // renormalize picking the polynomial for each lane
+      __m128 dist2 = _mm_mul_ps(x1, x1);
+      dist2 = _mm_add_ps(dist2, _mm_mul_ps(y1, y1));
+      dist2 = _mm_add_ps(dist2, _mm_mul_ps(z1, z1));
+      dist2 = _mm_add_ps(dist2, _mm_mul_ps(w1, w1));
+
+      const __m128 vLo = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(vLo0, dist2), vLo1), dist2), vLo2);
+      const __m128 vHi = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(vHi0, dist2), vHi1), dist2), vHi2);
+      const __m128 vMask = _mm_cmplt_ps(dist2, vSplit);
+      const __m128 vOneOverL = _mm_or_ps(_mm_and_ps(vMask, vLo), _mm_andnot_ps(vMask, vHi));
+
+      // store
+      _mm_storeu_ps(outPtr + i, _mm_mul_ps(x1, vOneOverL));
+      _mm_storeu_ps(outPtr + i + stride, _mm_mul_ps(y1, vOneOverL));
+      _mm_storeu_ps(outPtr + i + stride * 2, _mm_mul_ps(z1, vOneOverL));
+      _mm_storeu_ps(outPtr + i + stride * 3, _mm_mul_ps(w1, vOneOverL));
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void ts_lerp_point_soa_SSE(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr)
+{
+   const __m128 vT = _mm_set1_ps(t);
+
+   for(S32 i = 0; i < stride * 3; i += stride)
+   {
+      for(S32 j = i; j < i + count; j += 4)
+      {
+         const __m128 p1 = _mm_loadu_ps(key1 + j);
+         const __m128 p2 = _mm_loadu_ps(key2 + j);
+         _mm_storeu_ps(outPtr + j, _mm_add_ps(p1, _mm_mul_ps(vT, _mm_sub_ps(p2, p1))));
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void ts_build_node_matrices_SSE(const QuatF * __restrict rots, const Point3F * __restrict trans, const S32 count, MatrixF * __restrict outPtr)
+{
+   const __m128 vOne = _mm_set1_ps(1.0f);
+   const __m128 vRow3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+   S32 i = 0;
+   for(; i + 4 <= count; i += 4)
+   {
+      // load four rotations and turn them into x, y, z and w rows
+      __m128 x = _mm_loadu_ps(&rots[i].x);
+      __m128 y = _mm_loadu_ps(&rots[i + 1].x);
+      __m128 z = _mm_loadu_ps(&rots[i + 2].x);
+      __m128 w = _mm_loadu_ps(&rots[i + 3].x);
+      _MM_TRANSPOSE4_PS(x, y, z, w);
+
+      // the same terms as m_quatF_set_matF
+      const __m128 xs = _mm_add_ps(x, x);
+      const __m128 ys = _mm_add_ps(y, y);
+      const __m128 zs = _mm_add_ps(z, z);
+      const __m128 wx = _mm_mul_ps(w, xs);
+      const __m128 wy = _mm_mul_ps(w, ys);
+      const __m128 wz = _mm_mul_ps(w, zs);
+      const __m128 xx = _mm_mul_ps(x, xs);
+      const __m128 xy = _mm_mul_ps(x, ys);
+      const __m128 xz = _mm_mul_ps(x, zs);
+      const __m128 yy = _mm_mul_ps(y, ys);
+      const __m128 yz = _mm_mul_ps(y, zs);
+      const __m128 zz = _mm_mul_ps(z, zs);
+
+      __m128 m00 = _mm_sub_ps(vOne, _mm_add_ps(yy, zz));
+      __m128 m01 = _mm_add_ps(xy, wz);
+      __m128 m02 = _mm_sub_ps(xz, wy);
+      __m128 m10 = _mm_sub_ps(xy, wz);
+      __m128 m11 = _mm_sub_ps(vOne, _mm_add_ps(xx, zz));
+      __m128 m12 = _mm_add_ps(yz, wx);
+      __m128 m20 = _mm_add_ps(xz, wy);
+      __m128 m21 = _mm_sub_ps(yz, wx);
+      __m128 m22 = _mm_sub_ps(vOne, _mm_add_ps(xx, yy));
+
+      __m128 tx = _mm_set_ps(trans[i + 3].x, trans[i + 2].x, trans[i + 1].x, trans[i].x);
+      __m128 ty = _mm_set_ps(trans[i + 3].y, trans[i + 2].y, trans[i + 1].y, trans[i].y);
+      __m128 tz = _mm_set_ps(trans[i + 3].z, trans[i + 2].z, trans[i + 1].z, trans[i].z);
+
+      // turn the element rows back into matrix rows
+      _MM_TRANSPOSE4_PS(m00, m01, m02, tx);
+      _MM_TRANSPOSE4_PS(m10, m11, m12, ty);
+      _MM_TRANSPOSE4_PS(m20, m21, m22, tz);
+
+      F32 *m = outPtr[i];
+      _mm_storeu_ps(m, m00);
+      _mm_storeu_ps(m + 4, m10);
+      _mm_storeu_ps(m + 8, m20);
+      _mm_storeu_ps(m + 12, vRow3);
+
+      m = outPtr[i + 1];
+      _mm_storeu_ps(m, m01);
+      _mm_storeu_ps(m + 4, m11);
+      _mm_storeu_ps(m + 8, m21);
+      _mm_storeu_ps(m + 12, vRow3);
+
+      m = outPtr[i + 2];
+      _mm_storeu_ps(m, m02);
+      _mm_storeu_ps(m + 4, m12);
+      _mm_storeu_ps(m + 8, m22);
+      _mm_storeu_ps(m + 12, vRow3);
+
+      m = outPtr[i + 3];
+      _mm_storeu_ps(m, tx);
+      _mm_storeu_ps(m + 4, ty);
+      _mm_storeu_ps(m + 8, tz);
+      _mm_storeu_ps(m + 12, vRow3);
+   }
+
+   // finish off the last few one at a time
+   for(; i < count; i++)
+   {
+      rots[i].setMatrix(&outPtr[i]);
+      outPtr[i].setColumn(3, trans[i]);
+   }
+}
+
+#endif // TORQUE_CPU_X86
@@ -21,6 +21,10 @@
 //-----------------------------------------------------------------------------
 
 #include "ts/tsShapeInstance.h"
+#include "ts/tsSequenceTracks.h"
+#include "ts/tsCompressedSequence.h"
+#include "ts/tsAnimateIntrinsics.h"
+#include "ts/tsPoseCache.h"
 
 //----------------------------------------------------------------------------------
 // some utility functions
@@ -58,7 +62,59 @@ void TSShapeInstance::clearDirty(U32 dirty)
 // Animate nodes
 //-------------------------------------------------------------------------------------
 
-void TSShapeInstance::animateNodes(S32 ss)
+// Scratch space for sampling all the tracks of a thread at once.
+static Vector<F32> smSampledRotations(__FILE__, __LINE__);
+static Vector<F32> smSampledTranslations(__FILE__, __LINE__);
+
+// Scratch space for the keyframes of compressed sequences.
+static Vector<F32> smDecodedRotations(__FILE__, __LINE__);
+static Vector<F32> smDecodedTranslations(__FILE__, __LINE__);
+
+// The pose cache key of the instance being animated and
+// the thread positions from before they were rounded.
+static TSPoseCache::Key smPoseKey;
+static Vector<F32> smPoseKeyPositions(__FILE__, __LINE__);
+
+bool TSShapeInstance::beginSharedPose(S32 ss)
+{
+   // Anything that is set up per instance rules out sharing
+   if (inTransition() || mNodeCallbacks.size() || mThreadList.empty() ||
+       mHandsOffNodes.testAll() || mCallbackNodes.testAll() || mMaskRotationNodes.testAll() ||
+       mMaskPosXNodes.testAll() || mMaskPosYNodes.testAll() || mMaskPosZNodes.testAll())
+      return false;
+
+   const S32 steps = getMax(TSPoseCache::smPositionSteps,1);
+
+   smPoseKey.set(mShape,ss);
+   smPoseKey.add(mThreadList.size());
+   smPoseKeyPositions.setSize(mThreadList.size());
+   for (S32 i=0; i<mThreadList.size(); i++)
+   {
+      TSThread * th = mThreadList[i];
+
+      // round the position so that nearby instances share the pose
+      const S32 step = (S32)(th->keyPos * steps + 0.5f);
+      smPoseKeyPositions[i] = th->keyPos;
+      th->keyPos = (F32)step / (F32)steps;
+
+      smPoseKey.add(th->sequence);
+      smPoseKey.add(th->keyNum1);
+      smPoseKey.add(th->keyNum2);
+      smPoseKey.add(step);
+      smPoseKey.add(th->blendDisabled);
+   }
+   smPoseKey.finish();
+
+   return true;
+}
+
+void TSShapeInstance::endSharedPose()
+{
+   for (S32 i=0; i<mThreadList.size(); i++)
+      mThreadList[i]->keyPos = smPoseKeyPositions[i];
+}
+
+void TSShapeInstance::animateNodes(S32 ss, bool sharePose)
 {
    PROFILE_SCOPE( TSShapeInstance_animateNodes );
 
@@ -68,6 +124,23 @@ void TSShapeInstance::animateNodes(S32 ss)
    // @todo: When a node is added, we need to make sure to resize the nodeTransforms array as well
    mNodeTransforms.setSize(mShape->nodes.size());
 
+   // another instance in the same state may have done the work already
+   const S32 firstNode = mShape->subShapeFirstNode[ss];
+   const S32 numNodes = mShape->subShapeNumNodes[ss];
+   if (sharePose && TSPoseCache::smEnabled && numNodes)
+   {
+      sharePose = beginSharedPose(ss);
+      if (!sharePose)
+         TSPoseCache::countSkipped();
+      else if (TSPoseCache::find(smPoseKey,&mNodeTransforms[firstNode],numNodes))
+      {
+         endSharedPose();
+         return;
+      }
+   }
+   else
+      sharePose = false;
+
    // temporary storage for node transforms
    smNodeCurrentRotations.setSize(mShape->nodes.size());
    smNodeCurrentTranslations.setSize(mShape->nodes.size());
@@ -146,6 +219,47 @@ void TSShapeInstance::animateNodes(S32 ss)
    {
       TSThread * th = mThreadList[i];
 
+      // find the two keyframes of every rotation and translation track
+      const F32 * rotKey1, * rotKey2, * tranKey1, * tranKey2;
+      S32 rotStride, tranStride;
+      const TSCompressedSequence * compressed = mShape->getCompressedSequence(th->getSeqIndex());
+      if (compressed)
+      {
+         // decode just the keyframes we're between
+         rotStride = (compressed->getNumRotations() + 3) & ~3;
+         smDecodedRotations.setSize(rotStride*8);
+         rotKey1 = smDecodedRotations.address();
+         rotKey2 = rotKey1 + rotStride*4;
+         compressed->decodeRotationKey(th->keyNum1,smDecodedRotations.address(),rotStride);
+         compressed->decodeRotationKey(th->keyNum2,smDecodedRotations.address()+rotStride*4,rotStride);
+
+         tranStride = (compressed->getNumTranslations() + 3) & ~3;
+         smDecodedTranslations.setSize(tranStride*6);
+         tranKey1 = smDecodedTranslations.address();
+         tranKey2 = tranKey1 + tranStride*3;
+         compressed->decodeTranslationKey(th->keyNum1,smDecodedTranslations.address(),tranStride);
+         compressed->decodeTranslationKey(th->keyNum2,smDecodedTranslations.address()+tranStride*3,tranStride);
+      }
+      else
+      {
+         const TSSequenceTracks * tracks = mShape->getSequenceTracks(th->getSeqIndex());
+         rotStride = tracks->getRotationStride();
+         rotKey1 = tracks->getRotationKey(th->keyNum1);
+         rotKey2 = tracks->getRotationKey(th->keyNum2);
+         tranStride = tracks->getTranslationStride();
+         tranKey1 = tracks->getTranslationKey(th->keyNum1);
+         tranKey2 = tracks->getTranslationKey(th->keyNum2);
+      }
+
+      // sample them all in one go
+      smSampledRotations.setSize(rotStride*4);
+      ts_nlerp_quat_soa(rotKey1,rotKey2,th->keyPos,rotStride,rotStride,smSampledRotations.address());
+      const F32 * rot = smSampledRotations.address();
+
+      smSampledTranslations.setSize(tranStride*3);
+      ts_lerp_point_soa(tranKey1,tranKey2,th->keyPos,tranStride,tranStride,smSampledTranslations.address());
+      const F32 * tran = smSampledTranslations.address();
+
       j=0;
       start = th->getSequence()->rotationMatters.start();
       end   = b;
@@ -156,10 +270,7 @@ void TSShapeInstance::animateNodes(S32 ss)
             continue;
          if (!rotBeenSet.test(nodeIndex))
          {
-            QuatF q1,q2;
-            mShape->getRotation(*th->getSequence(),th->keyNum1,j,&q1);
-            mShape->getRotation(*th->getSequence(),th->keyNum2,j,&q2);
-            TSTransform::interpolate(q1,q2,th->keyPos,&smNodeCurrentRotations[nodeIndex]);
+            smNodeCurrentRotations[nodeIndex].set(rot[j],rot[j+rotStride],rot[j+rotStride*2],rot[j+rotStride*3]);
             rotBeenSet.set(nodeIndex);
             smRotationThreads[nodeIndex] = th;
          }
@@ -178,9 +289,7 @@ void TSShapeInstance::animateNodes(S32 ss)
                handleMaskedPositionNode(th,nodeIndex,j);
             else
             {
-               const Point3F & p1 = mShape->getTranslation(*th->getSequence(),th->keyNum1,j);
-               const Point3F & p2 = mShape->getTranslation(*th->getSequence(),th->keyNum2,j);
-               TSTransform::interpolate(p1,p2,th->keyPos,&smNodeCurrentTranslations[nodeIndex]);
+               smNodeCurrentTranslations[nodeIndex].set(tran[j],tran[j+tranStride],tran[j+tranStride*2]);
                smTranslationThreads[nodeIndex] = th;
             }
             tranBeenSet.set(nodeIndex);
@@ -192,11 +301,11 @@ void TSShapeInstance::animateNodes(S32 ss)
    }
 
    // compute transforms
+   if (b>a)
+      ts_build_node_matrices(&smNodeCurrentRotations[a],&smNodeCurrentTranslations[a],b-a,&smNodeLocalTransforms[a]);
    for (i=a; i<b; i++)
    {
-      if (!mHandsOffNodes.test(i))
-         TSTransform::setMatrix(smNodeCurrentRotations[i],smNodeCurrentTranslations[i],&smNodeLocalTransforms[i]);
-      else
+      if (mHandsOffNodes.test(i))
          smNodeLocalTransforms[i] = mNodeTransforms[i];     // in case mNodeTransform was changed externally
    }
 
@@ -241,6 +350,12 @@ void TSShapeInstance::animateNodes(S32 ss)
       else
          mNodeTransforms[i].mul(mNodeTransforms[parentIdx],smNodeLocalTransforms[i]);
    }
+
+   if (sharePose)
+   {
+      TSPoseCache::store(smPoseKey,&mNodeTransforms[firstNode],numNodes);
+      endSharedPose();
+   }
 }
 
 void TSShapeInstance::handleDefaultScale(S32 a, S32 b, TSIntegerSet & scaleBeenSet)
@@ -855,7 +970,7 @@ void TSShapeInstance::animate(S32 dl)
 
    // animate nodes?
    if (dirtyFlags & TransformDirty)
-      animateNodes(ss);
+      animateNodes(ss,true);
 
    // animate objects?
    if (dirtyFlags & VisDirty)
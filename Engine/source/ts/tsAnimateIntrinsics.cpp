@@ -0,0 +1,100 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+#include "platform/platform.h"
+#include "ts/tsAnimateIntrinsics.h"
+#include "ts/arch/tsAnimateIntrinsics.arch.h"
+#include "ts/tsTransform.h"
+#include "core/module.h"
+
+
+void (*ts_nlerp_quat_soa)(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr) = NULL;
+void (*ts_lerp_point_soa)(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr) = NULL;
+void (*ts_build_node_matrices)(const QuatF * __restrict rots, const Point3F * __restrict trans, const S32 count, MatrixF * __restrict outPtr) = NULL;
+
+//------------------------------------------------------------------------------
+// Default C++ Implementations
+//------------------------------------------------------------------------------
+
+void ts_nlerp_quat_soa_C(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr)
+{
+   QuatF q1, q2, q;
+
+   for(S32 i = 0; i < count; i++)
+   {
+      q1.set( key1[i], key1[i + stride], key1[i + stride * 2], key1[i + stride * 3] );
+      q2.set( key2[i], key2[i + stride], key2[i + stride * 2], key2[i + stride * 3] );
+
+      TSTransform::interpolate( q1, q2, t, &q );
+
+      outPtr[i] = q.x;
+      outPtr[i + stride] = q.y;
+      outPtr[i + stride * 2] = q.z;
+      outPtr[i + stride * 3] = q.w;
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void ts_lerp_point_soa_C(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr)
+{
+   for(S32 i = 0; i < stride * 3; i += stride)
+   {
+      for(S32 j = i; j < i + count; j++)
+         outPtr[j] = key1[j] + t * (key2[j] - key1[j]);
+   }
+}
+
+//------------------------------------------------------------------------------
+
+void ts_build_node_matrices_C(const QuatF * __restrict rots, const Point3F * __restrict trans, const S32 count, MatrixF * __restrict outPtr)
+{
+   for(S32 i = 0; i < count; i++)
+      TSTransform::setMatrix( rots[i], trans[i], &outPtr[i] );
+}
+
+//------------------------------------------------------------------------------
+// Initializer.
+//------------------------------------------------------------------------------
+
+MODULE_BEGIN( TSAnimateIntrinsics )
+
+   MODULE_INIT_AFTER( 3D )
+   
+   MODULE_INIT
+   {
+      // Assign defaults (C++ versions)
+      ts_nlerp_quat_soa = ts_nlerp_quat_soa_C;
+      ts_lerp_point_soa = ts_lerp_point_soa_C;
+      ts_build_node_matrices = ts_build_node_matrices_C;
+
+      // Find the best implementation for the current CPU
+      if(Platform::SystemInfo.processor.properties & CPU_PROP_SSE)
+      {
+   #if defined(TORQUE_CPU_X86)
+         ts_nlerp_quat_soa = ts_nlerp_quat_soa_SSE;
+         ts_lerp_point_soa = ts_lerp_point_soa_SSE;
+         ts_build_node_matrices = ts_build_node_matrices_SSE;
+   #endif
+      }
+   }
+
+MODULE_END;
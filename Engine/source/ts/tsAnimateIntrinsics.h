@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSANIMATEINTRINSICS_H_
+#define _TSANIMATEINTRINSICS_H_
+
+#ifndef _MQUAT_H_
+#include "math/mQuat.h"
+#endif
+#ifndef _MMATRIX_H_
+#include "math/mMatrix.h"
+#endif
+
+/// Interpolates between two keyframes of structure of arrays rotations
+/// and renormalizes them the same way TSTransform::interpolate does.
+///
+/// @param key1      The x, y, z and w rows of the first keyframe
+/// @param key2      The x, y, z and w rows of the second keyframe
+/// @param t         The position between the keyframes
+/// @param count     Number of rotations, rounded up to a multiple of four
+/// @param stride    Length of each row, a multiple of four
+/// @param outPtr    The x, y, z and w rows of the results with the same stride
+extern void (*ts_nlerp_quat_soa)
+                        (const F32 * __restrict key1,
+                         const F32 * __restrict key2,
+                         const F32 t,
+                         const S32 count,
+                         const S32 stride,
+                         F32 * __restrict outPtr);
+
+/// Interpolates between two keyframes of structure of arrays translations.
+///
+/// @param key1      The x, y and z rows of the first keyframe
+/// @param key2      The x, y and z rows of the second keyframe
+/// @param t         The position between the keyframes
+/// @param count     Number of translations, rounded up to a multiple of four
+/// @param stride    Length of each row, a multiple of four
+/// @param outPtr    The x, y and z rows of the results with the same stride
+extern void (*ts_lerp_point_soa)
+                        (const F32 * __restrict key1,
+                         const F32 * __restrict key2,
+                         const F32 t,
+                         const S32 count,
+                         const S32 stride,
+                         F32 * __restrict outPtr);
+
+/// Builds the local node transforms from their rotations and 
+/// translations as TSTransform::setMatrix does.
+///
+/// @param rots      The node rotations
+/// @param trans     The node translations
+/// @param count     Number of nodes
+/// @param outPtr    The node transforms
+extern void (*ts_build_node_matrices)
+                        (const QuatF * __restrict rots,
+                         const Point3F * __restrict trans,
+                         const S32 count,
+                         MatrixF * __restrict outPtr);
+
+#endif // _TSANIMATEINTRINSICS_H_
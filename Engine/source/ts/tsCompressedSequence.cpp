@@ -0,0 +1,385 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "ts/tsCompressedSequence.h"
+
+#include "ts/tsTransform.h"
+#include "platform/profiler.h"
+
+
+/// The longest run of keyframes we'll try to rebuild from a single 
+/// pair of kept keyframes.  This bounds the cost of compression on
+/// very long sequences.
+static const S32 MaxKeyGap = 256;
+
+static inline F32 getComponent( const QuatF &q, S32 i ) { return (&q.x)[i]; }
+static inline F32 getComponent( const Point3F &p, S32 i ) { return (&p.x)[i]; }
+static inline void setComponent( QuatF &q, S32 i, F32 val ) { (&q.x)[i] = val; }
+static inline void setComponent( Point3F &p, S32 i, F32 val ) { (&p.x)[i] = val; }
+
+/// Returns the angle between two rotations.
+static F32 getKeyError( const QuatF &q1, const QuatF &q2 )
+{
+   QuatF a( q1 ), b( q2 );
+   a.normalize();
+   b.normalize();
+   if ( a.dot( b ) < 0.0f )
+      b.neg();
+
+   // The chord between the unit quaternions keeps 
+   // its precision for the small angles we care about.
+   const QuatF diff = a - b;
+   const F32 chord = mSqrt( diff.dot( diff ) );
+   return 4.0f * mAsin( getMin( chord * 0.5f, 1.0f ) );
+}
+
+/// Returns the distance between two translations.
+static F32 getKeyError( const Point3F &p1, const Point3F &p2 )
+{
+   return ( p1 - p2 ).len();
+}
+
+
+TSCompressedSequence::TSCompressedSequence()
+   :  mNumKeyframes( 0 )
+{
+   VECTOR_SET_ASSOCIATION( mRotationTracks );
+   VECTOR_SET_ASSOCIATION( mRotationFrames );
+   VECTOR_SET_ASSOCIATION( mRotationValues );
+   VECTOR_SET_ASSOCIATION( mRotationRawValues );
+   VECTOR_SET_ASSOCIATION( mTranslationTracks );
+   VECTOR_SET_ASSOCIATION( mTranslationFrames );
+   VECTOR_SET_ASSOCIATION( mTranslationValues );
+   VECTOR_SET_ASSOCIATION( mTranslationRawValues );
+}
+
+void TSCompressedSequence::compress(   const TSShape *shape, 
+                                       const TSShape::Sequence &seq, 
+                                       F32 rotTolerance, 
+                                       F32 tranTolerance )
+{
+   PROFILE_SCOPE( TSCompressedSequence_compress );
+
+   AssertFatal( seq.numKeyframes <= U16_MAX + 1, 
+      "TSCompressedSequence::compress - Too many keyframes!" );
+
+   mNumKeyframes = seq.numKeyframes;
+
+   mRotationTracks.clear();
+   mRotationFrames.clear();
+   mRotationValues.clear();
+   mRotationRawValues.clear();
+   mTranslationTracks.clear();
+   mTranslationFrames.clear();
+   mTranslationValues.clear();
+   mTranslationRawValues.clear();
+
+   const S32 numRotations = seq.rotationMatters.count();
+   Vector<QuatF> rotKeys( mNumKeyframes );
+   rotKeys.setSize( mNumKeyframes );
+   for ( S32 j = 0; j < numRotations; j++ )
+   {
+      for ( S32 k = 0; k < mNumKeyframes; k++ )
+      {
+         shape->getRotation( seq, k, j, &rotKeys[k] );
+
+         // Keep neighbouring keys in the same hemisphere so 
+         // the track has the smallest range to quantize.
+         if ( k > 0 && rotKeys[k].dot( rotKeys[k-1] ) < 0.0f )
+            rotKeys[k].neg();
+      }
+
+      _compressTrack( rotKeys, 4, rotTolerance, mRotationTracks, mRotationFrames, mRotationValues, mRotationRawValues );
+   }
+
+   const S32 numTranslations = seq.translationMatters.count();
+   Vector<Point3F> tranKeys( mNumKeyframes );
+   tranKeys.setSize( mNumKeyframes );
+   for ( S32 j = 0; j < numTranslations; j++ )
+   {
+      for ( S32 k = 0; k < mNumKeyframes; k++ )
+         tranKeys[k] = shape->getTranslation( seq, k, j );
+
+      _compressTrack( tranKeys, 3, tranTolerance, mTranslationTracks, mTranslationFrames, mTranslationValues, mTranslationRawValues );
+   }
+}
+
+template< class T >
+void TSCompressedSequence::_compressTrack(   const Vector<T> &keys,
+                                             const S32 numComponents,
+                                             const F32 tolerance,
+                                             Vector<Track> &tracks,
+                                             Vector<U16> &frames,
+                                             Vector<U16> &values,
+                                             Vector<F32> &rawValues )
+{
+   const S32 numKeys = keys.size();
+
+   tracks.increment();
+   Track &track = tracks.last();
+   track.firstKey = frames.size();
+   track.firstValue = values.size();
+   track.raw = false;
+
+   // A track which never strays from its first key 
+   // only needs to store that key.
+   bool constant = true;
+   for ( S32 k = 1; k < numKeys && constant; k++ )
+      constant = getKeyError( keys[k], keys[0] ) <= tolerance;
+
+   if ( constant )
+   {
+      track.numKeys = 1;
+      for ( S32 c = 0; c < 4; c++ )
+      {
+         track.min[c] = c < numComponents ? getComponent( keys[0], c ) : 0.0f;
+         track.scale[c] = 0.0f;
+      }
+
+      frames.push_back( 0 );
+      for ( S32 c = 0; c < numComponents; c++ )
+         values.push_back( 0 );
+      return;
+   }
+
+   // Find the quantization range of each component.
+   for ( S32 c = 0; c < 4; c++ )
+   {
+      track.min[c] = 0.0f;
+      track.scale[c] = 0.0f;
+   }
+   for ( S32 c = 0; c < numComponents; c++ )
+   {
+      F32 minVal = getComponent( keys[0], c );
+      F32 maxVal = minVal;
+      for ( S32 k = 1; k < numKeys; k++ )
+      {
+         const F32 val = getComponent( keys[k], c );
+         minVal = getMin( minVal, val );
+         maxVal = getMax( maxVal, val );
+      }
+
+      track.min[c] = minVal;
+      track.scale[c] = ( maxVal - minVal ) / F32( U16_MAX );
+   }
+
+   // Quantize every key up front so that the key reduction 
+   // below measures the error of what we'll actually decode.
+   Vector<U16> quantized( numKeys * numComponents );
+   quantized.setSize( numKeys * numComponents );
+   Vector<T> decoded( numKeys );
+   decoded.setSize( numKeys );
+   for ( S32 k = 0; k < numKeys; k++ )
+   {
+      for ( S32 c = 0; c < numComponents; c++ )
+      {
+         U16 q = 0;
+         if ( track.scale[c] > 0.0f )
+         {
+            const F32 steps = ( getComponent( keys[k], c ) - track.min[c] ) / track.scale[c];
+            q = (U16)mClamp( (S32)( steps + 0.5f ), 0, (S32)U16_MAX );
+         }
+
+         quantized[ k * numComponents + c ] = q;
+         setComponent( decoded[k], c, track.min[c] + q * track.scale[c] );
+      }
+
+      // Any key may end up kept, so if 16 bits over the range of
+      // the track can't hold one within the tolerance the track
+      // keeps its keys as floats instead.
+      if ( !track.raw && getKeyError( keys[k], decoded[k] ) > tolerance )
+         track.raw = true;
+   }
+
+   if ( track.raw )
+   {
+      track.firstValue = rawValues.size();
+      for ( S32 c = 0; c < 4; c++ )
+      {
+         track.min[c] = 0.0f;
+         track.scale[c] = 0.0f;
+      }
+
+      for ( S32 k = 0; k < numKeys; k++ )
+         decoded[k] = keys[k];
+   }
+
+   // Always keep the first and last keys, and stretch each run 
+   // between kept keys as far as the keys it skips can be rebuilt
+   // by interpolation.
+   Vector<S32> kept;
+   kept.push_back( 0 );
+
+   S32 last = 0;
+   T interp;
+   for ( S32 k = 2; k < numKeys; k++ )
+   {
+      bool fits = ( k - last ) <= MaxKeyGap;
+      for ( S32 m = last + 1; m < k && fits; m++ )
+      {
+         TSTransform::interpolate( decoded[last], decoded[k], F32( m - last ) / F32( k - last ), &interp );
+         fits = getKeyError( keys[m], interp ) <= tolerance;
+      }
+
+      if ( !fits )
+      {
+         last = k - 1;
+         kept.push_back( last );
+      }
+   }
+   kept.push_back( numKeys - 1 );
+
+   track.numKeys = kept.size();
+   for ( S32 i = 0; i < kept.size(); i++ )
+   {
+      frames.push_back( kept[i] );
+
+      if ( !track.raw )
+      {
+         values.merge( &quantized[ kept[i] * numComponents ], numComponents );
+         continue;
+      }
+
+      for ( S32 c = 0; c < numComponents; c++ )
+         rawValues.push_back( getComponent( keys[ kept[i] ], c ) );
+   }
+}
+
+S32 TSCompressedSequence::_findKey( const Track &track, const Vector<U16> &frames, S32 keyframe )
+{
+   // Find the last kept keyframe at or before the one we want.
+   const U16 *keyFrames = frames.address() + track.firstKey;
+   S32 lo = 0;
+   S32 hi = track.numKeys - 1;
+   while ( lo < hi )
+   {
+      const S32 mid = ( lo + hi + 1 ) >> 1;
+      if ( keyFrames[mid] <= keyframe )
+         lo = mid;
+      else
+         hi = mid - 1;
+   }
+
+   return lo;
+}
+
+template< class T >
+T TSCompressedSequence::_getKey( const Track &track,
+                                 const Vector<U16> &values,
+                                 const Vector<F32> &rawValues,
+                                 const S32 numComponents,
+                                 S32 key )
+{
+   T result;
+   if ( track.raw )
+   {
+      const F32 *r = rawValues.address() + track.firstValue + key * numComponents;
+      for ( S32 c = 0; c < numComponents; c++ )
+         setComponent( result, c, r[c] );
+   }
+   else
+   {
+      const U16 *q = values.address() + track.firstValue + key * numComponents;
+      for ( S32 c = 0; c < numComponents; c++ )
+         setComponent( result, c, track.min[c] + q[c] * track.scale[c] );
+   }
+
+   return result;
+}
+
+template< class T >
+T TSCompressedSequence::_decode( const Track &track, 
+                                 const Vector<U16> &frames, 
+                                 const Vector<U16> &values, 
+                                 const Vector<F32> &rawValues,
+                                 const S32 numComponents,
+                                 S32 keyframe )
+{
+   const S32 key = ( track.numKeys == 1 ) ? 0 : _findKey( track, frames, keyframe );
+
+   const T key1 = _getKey<T>( track, values, rawValues, numComponents, key );
+
+   const S32 frame1 = frames[ track.firstKey + key ];
+   if ( frame1 == keyframe || key + 1 >= (S32)track.numKeys )
+      return key1;
+
+   // Rebuild the dropped keyframe from the kept ones on either side.
+   const T key2 = _getKey<T>( track, values, rawValues, numComponents, key + 1 );
+
+   const S32 frame2 = frames[ track.firstKey + key + 1 ];
+
+   T result;
+   TSTransform::interpolate( key1, key2, F32( keyframe - frame1 ) / F32( frame2 - frame1 ), &result );
+   return result;
+}
+
+QuatF& TSCompressedSequence::getRotation( S32 keyframe, S32 rotNum, QuatF *outRot ) const
+{
+   *outRot = _decode<QuatF>( mRotationTracks[rotNum], mRotationFrames, mRotationValues, mRotationRawValues, 4, keyframe );
+   return *outRot;
+}
+
+Point3F TSCompressedSequence::getTranslation( S32 keyframe, S32 tranNum ) const
+{
+   return _decode<Point3F>( mTranslationTracks[tranNum], mTranslationFrames, mTranslationValues, mTranslationRawValues, 3, keyframe );
+}
+
+void TSCompressedSequence::decodeRotationKey( S32 keyframe, F32 *outRows, S32 stride ) const
+{
+   const S32 numRotations = mRotationTracks.size();
+   for ( S32 j = 0; j < numRotations; j++ )
+   {
+      const QuatF q = _decode<QuatF>( mRotationTracks[j], mRotationFrames, mRotationValues, mRotationRawValues, 4, keyframe );
+      outRows[j] = q.x;
+      outRows[j + stride] = q.y;
+      outRows[j + stride * 2] = q.z;
+      outRows[j + stride * 3] = q.w;
+   }
+
+   for ( S32 j = numRotations; j < stride; j++ )
+      outRows[j] = outRows[j + stride] = outRows[j + stride * 2] = outRows[j + stride * 3] = 0.0f;
+}
+
+void TSCompressedSequence::decodeTranslationKey( S32 keyframe, F32 *outRows, S32 stride ) const
+{
+   const S32 numTranslations = mTranslationTracks.size();
+   for ( S32 j = 0; j < numTranslations; j++ )
+   {
+      const Point3F p = _decode<Point3F>( mTranslationTracks[j], mTranslationFrames, mTranslationValues, mTranslationRawValues, 3, keyframe );
+      outRows[j] = p.x;
+      outRows[j + stride] = p.y;
+      outRows[j + stride * 2] = p.z;
+   }
+
+   for ( S32 j = numTranslations; j < stride; j++ )
+      outRows[j] = outRows[j + stride] = outRows[j + stride * 2] = 0.0f;
+}
+
+U32 TSCompressedSequence::getMemorySize() const
+{
+   return   sizeof( TSCompressedSequence ) +
+            ( mRotationTracks.size() + mTranslationTracks.size() ) * sizeof( Track ) +
+            ( mRotationFrames.size() + mRotationValues.size() +
+              mTranslationFrames.size() + mTranslationValues.size() ) * sizeof( U16 ) +
+            ( mRotationRawValues.size() + mTranslationRawValues.size() ) * sizeof( F32 );
+}
@@ -0,0 +1,152 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSCOMPRESSEDSEQUENCE_H_
+#define _TSCOMPRESSEDSEQUENCE_H_
+
+#ifndef _TSSHAPE_H_
+#include "ts/tsShape.h"
+#endif
+
+
+/// A compact encoding of the node rotation and translation keyframes
+/// of a single sequence.
+///
+/// Each track keeps only the keyframes which can't be rebuilt from
+/// their neighbours to within a tolerance, and a track which never 
+/// moves keeps a single keyframe.  The keyframes that remain are
+/// quantized to 16 bits per component over the range of their track,
+/// unless that range is too wide to meet the tolerance, in which case
+/// the track keeps them as floats.
+///
+/// Keyframes are decoded on demand as the sequence is sampled.
+///
+/// @see TSShape::compressSequences
+class TSCompressedSequence
+{
+public:
+
+   TSCompressedSequence();
+
+   /// Encodes the rotation and translation keyframes of the sequence.
+   ///
+   /// @param shape           The shape holding the uncompressed keyframes.
+   /// @param seq             The sequence to encode.
+   /// @param rotTolerance    The largest rotation error in radians.
+   /// @param tranTolerance   The largest translation error in shape units.
+   void compress( const TSShape *shape, 
+                  const TSShape::Sequence &seq, 
+                  F32 rotTolerance, 
+                  F32 tranTolerance );
+
+   /// Decodes the rotation of a single track at a keyframe.
+   QuatF& getRotation( S32 keyframe, S32 rotNum, QuatF *outRot ) const;
+
+   /// Decodes the translation of a single track at a keyframe.
+   Point3F getTranslation( S32 keyframe, S32 tranNum ) const;
+
+   /// Decodes every rotation track at a keyframe into x, y, z
+   /// and w rows of the given stride.  The rows are padded with
+   /// zeros out to the stride.
+   void decodeRotationKey( S32 keyframe, F32 *outRows, S32 stride ) const;
+
+   /// Decodes every translation track at a keyframe into x, y
+   /// and z rows of the given stride.  The rows are padded with
+   /// zeros out to the stride.
+   void decodeTranslationKey( S32 keyframe, F32 *outRows, S32 stride ) const;
+
+   S32 getNumRotations() const { return mRotationTracks.size(); }
+   S32 getNumTranslations() const { return mTranslationTracks.size(); }
+
+   /// Returns the size of the encoded keyframes in bytes.
+   U32 getMemorySize() const;
+
+protected:
+
+   /// The kept keyframes of a single track.
+   struct Track
+   {
+      /// The index of the first kept keyframe in the frame array.
+      U32 firstKey;
+
+      /// The number of kept keyframes.  It is one for
+      /// tracks that never change.
+      U32 numKeys;
+
+      /// The index of the first component of the kept keyframes
+      /// in the value array, or in the raw value array if the 
+      /// track isn't quantized.
+      U32 firstValue;
+
+      /// True if the keyframes are stored as floats because 
+      /// quantizing them can't meet the tolerance.
+      bool raw;
+
+      /// The quantization range of each component.
+      F32 min[4];
+      F32 scale[4];
+   };
+
+   /// Quantizes the keys of a track and picks the ones to keep.
+   template< class T >
+   static void _compressTrack(   const Vector<T> &keys,
+                                 const S32 numComponents,
+                                 const F32 tolerance,
+                                 Vector<Track> &tracks,
+                                 Vector<U16> &frames,
+                                 Vector<U16> &values,
+                                 Vector<F32> &rawValues );
+
+   /// Returns the kept keyframe at or before the keyframe.
+   static S32 _findKey( const Track &track, const Vector<U16> &frames, S32 keyframe );
+
+   /// Returns a kept keyframe of a track.
+   template< class T >
+   static T _getKey( const Track &track,
+                     const Vector<U16> &values,
+                     const Vector<F32> &rawValues,
+                     const S32 numComponents,
+                     S32 key );
+
+   /// Returns the decoded keyframe of a track.
+   template< class T >
+   static T _decode( const Track &track, 
+                     const Vector<U16> &frames, 
+                     const Vector<U16> &values, 
+                     const Vector<F32> &rawValues,
+                     const S32 numComponents,
+                     S32 keyframe );
+
+   S32 mNumKeyframes;
+
+   Vector<Track> mRotationTracks;
+   Vector<U16> mRotationFrames;
+   Vector<U16> mRotationValues;
+   Vector<F32> mRotationRawValues;
+
+   Vector<Track> mTranslationTracks;
+   Vector<U16> mTranslationFrames;
+   Vector<U16> mTranslationValues;
+   Vector<F32> mTranslationRawValues;
+};
+
+#endif // _TSCOMPRESSEDSEQUENCE_H_
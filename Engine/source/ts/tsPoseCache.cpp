@@ -0,0 +1,181 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "ts/tsPoseCache.h"
+
+#include "core/util/hashFunction.h"
+#include "core/util/journal/process.h"
+#include "core/module.h"
+#include "console/console.h"
+#include "console/consoleTypes.h"
+#include "console/engineAPI.h"
+
+
+bool TSPoseCache::smEnabled = false;
+S32 TSPoseCache::smPositionSteps = 8;
+S32 TSPoseCache::smMaxPoses = 512;
+
+S32 TSPoseCache::smLastHits = 0;
+S32 TSPoseCache::smLastMisses = 0;
+S32 TSPoseCache::smLastSkipped = 0;
+S32 TSPoseCache::smLastPoses = 0;
+
+S32 TSPoseCache::smHits = 0;
+S32 TSPoseCache::smMisses = 0;
+S32 TSPoseCache::smSkipped = 0;
+
+Vector<TSPoseCache::Entry> TSPoseCache::smEntries( __FILE__, __LINE__ );
+Vector<U32> TSPoseCache::smStates( __FILE__, __LINE__ );
+Vector<MatrixF> TSPoseCache::smTransforms( __FILE__, __LINE__ );
+HashTable<U32,S32> TSPoseCache::smLookup;
+
+
+MODULE_BEGIN( TSPoseCache )
+
+   MODULE_INIT
+   {
+      Process::notify( &TSPoseCache::beginFrame, PROCESS_FIRST_ORDER );
+
+      Con::addVariable( "$pref::TS::poseCache", TypeBool, &TSPoseCache::smEnabled,
+         "@brief Lets shape instances in the same animation state share their node transforms.\n"
+         "Thread positions are rounded to $pref::TS::poseCacheSteps steps between keyframes "
+         "so that more instances end up in the same state.  The default value is false.\n"
+         "@ingroup Rendering\n" );
+
+      Con::addVariable( "$pref::TS::poseCacheSteps", TypeS32, &TSPoseCache::smPositionSteps,
+         "@brief The number of steps between keyframes that thread positions are rounded "
+         "to when the pose cache is enabled.  The default value is 8.\n"
+         "@see $pref::TS::poseCache\n"
+         "@ingroup Rendering\n" );
+
+      Con::addVariable( "$pref::TS::poseCacheSize", TypeS32, &TSPoseCache::smMaxPoses,
+         "@brief The most poses the pose cache will keep in a single frame.  "
+         "The default value is 512.\n"
+         "@see $pref::TS::poseCache\n"
+         "@ingroup Rendering\n" );
+
+      Con::addVariable( "$TSPoseCache::hits", TypeS32, &TSPoseCache::smLastHits, "@internal" );
+      Con::addVariable( "$TSPoseCache::misses", TypeS32, &TSPoseCache::smLastMisses, "@internal" );
+      Con::addVariable( "$TSPoseCache::skipped", TypeS32, &TSPoseCache::smLastSkipped, "@internal" );
+      Con::addVariable( "$TSPoseCache::poses", TypeS32, &TSPoseCache::smLastPoses, "@internal" );
+   }
+
+   MODULE_SHUTDOWN
+   {
+      Process::remove( &TSPoseCache::beginFrame );
+   }
+
+MODULE_END;
+
+
+void TSPoseCache::Key::set( const TSShape *shape, S32 subShape )
+{
+   mShape = shape;
+   mSubShape = subShape;
+   mState.clear();
+   mHash = 0;
+}
+
+void TSPoseCache::Key::finish()
+{
+   mHash = Torque::hash( (const U8*)mState.address(), mState.size() * sizeof( U32 ), (U32)(dsize_t)mShape ^ mSubShape );
+}
+
+bool TSPoseCache::_matches( const Entry &entry, const Key &key )
+{
+   return   entry.shape == key.mShape &&
+            entry.subShape == key.mSubShape &&
+            entry.numState == key.mState.size() &&
+            dMemcmp( &smStates[entry.firstState], key.mState.address(), entry.numState * sizeof( U32 ) ) == 0;
+}
+
+bool TSPoseCache::find( const Key &key, MatrixF *outTransforms, S32 numNodes )
+{
+   HashTable<U32,S32>::Iterator iter = smLookup.find( key.getHash() );
+   if ( iter != smLookup.end() )
+   {
+      const Entry &entry = smEntries[iter->value];
+      if ( entry.numTransforms == numNodes && _matches( entry, key ) )
+      {
+         dCopyArray( outTransforms, &smTransforms[entry.firstTransform], numNodes );
+         smHits++;
+         return true;
+      }
+   }
+
+   smMisses++;
+   return false;
+}
+
+void TSPoseCache::store( const Key &key, const MatrixF *transforms, S32 numNodes )
+{
+   // Keep the first pose stored for a hash, we'd just 
+   // trade one pose for another on a collision.
+   if ( smEntries.size() >= smMaxPoses || smLookup.find( key.getHash() ) != smLookup.end() )
+      return;
+
+   Entry entry;
+   entry.shape = key.mShape;
+   entry.subShape = key.mSubShape;
+   entry.firstState = smStates.size();
+   entry.numState = key.mState.size();
+   entry.firstTransform = smTransforms.size();
+   entry.numTransforms = numNodes;
+
+   smStates.merge( key.mState );
+   smTransforms.merge( transforms, numNodes );
+
+   smLookup.insertUnique( key.getHash(), smEntries.size() );
+   smEntries.push_back( entry );
+}
+
+void TSPoseCache::beginFrame()
+{
+   smLastHits = smHits;
+   smLastMisses = smMisses;
+   smLastSkipped = smSkipped;
+   smLastPoses = smEntries.size();
+
+   smHits = smMisses = smSkipped = 0;
+
+   if ( smEntries.empty() )
+      return;
+
+   // Clearing the arrays keeps their memory for the next frame.
+   smEntries.clear();
+   smStates.clear();
+   smTransforms.clear();
+   smLookup.clear();
+}
+
+DefineEngineFunction( getTSPoseCacheStats, const char*, (),,
+   "@brief Returns the pose cache statistics from the last frame.\n\n"
+   "@return A string of the hits, misses, skipped animations and stored poses.\n"
+   "@see $pref::TS::poseCache\n"
+   "@ingroup Rendering\n" )
+{
+   char *ret = Con::getReturnBuffer( 64 );
+   dSprintf( ret, 64, "%d %d %d %d", TSPoseCache::smLastHits, TSPoseCache::smLastMisses, 
+      TSPoseCache::smLastSkipped, TSPoseCache::smLastPoses );
+   return ret;
+}
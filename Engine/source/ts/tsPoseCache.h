@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSPOSECACHE_H_
+#define _TSPOSECACHE_H_
+
+#ifndef _MMATRIX_H_
+#include "math/mMatrix.h"
+#endif
+#ifndef _TVECTOR_H_
+#include "core/util/tVector.h"
+#endif
+#ifndef _TDICTIONARY_H_
+#include "core/util/tDictionary.h"
+#endif
+
+class TSShape;
+
+
+/// Shares animated node transforms between shape instances which are
+/// in the same animation state during a frame.
+///
+/// Crowds of instances often play the same sequence at the same spot,
+/// like idle and run cycles.  The first instance to animate a given 
+/// state stores its node transforms here and the rest of them copy 
+/// the result instead of sampling and combining every track again.
+///
+/// The cache is emptied at the start of every frame.
+///
+/// @see TSShapeInstance::animateNodes
+class TSPoseCache
+{
+public:
+
+   /// Describes everything that goes into the node transforms
+   /// of one subshape of an instance.
+   class Key
+   {
+   public:
+
+      Key() : mShape( NULL ), mSubShape( 0 ), mHash( 0 ) {}
+
+      /// Starts a new key.
+      void set( const TSShape *shape, S32 subShape );
+
+      /// Appends a value to the animation state.
+      void add( U32 value ) { mState.push_back( value ); }
+
+      /// Computes the hash once all the state has been added.
+      void finish();
+
+      U32 getHash() const { return mHash; }
+
+   protected:
+
+      friend class TSPoseCache;
+
+      const TSShape *mShape;
+      S32 mSubShape;
+      Vector<U32> mState;
+      U32 mHash;
+   };
+
+   /// Copies the cached node transforms for the key if 
+   /// we have them and returns true.
+   static bool find( const Key &key, MatrixF *outTransforms, S32 numNodes );
+
+   /// Stores the node transforms for the key.
+   static void store( const Key &key, const MatrixF *transforms, S32 numNodes );
+
+   /// Counts an animation which couldn't use the cache.
+   static void countSkipped() { smSkipped++; }
+
+   /// Empties the cache and updates the statistics for the last frame.
+   static void beginFrame();
+
+   /// Is the pose cache enabled.
+   static bool smEnabled;
+
+   /// The number of steps between keyframes to which thread positions
+   /// are rounded.  Fewer steps means more instances share the same
+   /// pose, at the cost of smooth motion.
+   static S32 smPositionSteps;
+
+   /// The most poses we'll keep in a single frame.
+   static S32 smMaxPoses;
+
+   /// @name Statistics
+   /// The counts from the last frame.
+   /// @{
+   static S32 smLastHits;
+   static S32 smLastMisses;
+   static S32 smLastSkipped;
+   static S32 smLastPoses;
+   /// @}
+
+protected:
+
+   /// A single stored pose.  The key state and transforms
+   /// are kept in shared arrays which are reused every frame.
+   struct Entry
+   {
+      const TSShape *shape;
+      S32 subShape;
+      U32 firstState;
+      U32 numState;
+      U32 firstTransform;
+      U32 numTransforms;
+   };
+
+   /// Returns true if the entry was stored with the key.
+   static bool _matches( const Entry &entry, const Key &key );
+
+   static Vector<Entry> smEntries;
+   static Vector<U32> smStates;
+   static Vector<MatrixF> smTransforms;
+
+   /// Maps key hashes to entries.
+   static HashTable<U32,S32> smLookup;
+
+   static S32 smHits;
+   static S32 smMisses;
+   static S32 smSkipped;
+};
+
+#endif // _TSPOSECACHE_H_
@@ -0,0 +1,107 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "ts/tsSequenceTracks.h"
+
+
+TSSequenceTracks::TSSequenceTracks()
+   :  mNumKeyframes( 0 ),
+      mBaseRotation( 0 ),
+      mBaseTranslation( 0 ),
+      mNumRotations( 0 ),
+      mRotationStride( 0 ),
+      mNumTranslations( 0 ),
+      mTranslationStride( 0 ),
+      mRotations( NULL ),
+      mTranslations( NULL )
+{
+}
+
+TSSequenceTracks::~TSSequenceTracks()
+{
+   if ( mRotations )
+      dFree_aligned( mRotations );
+   if ( mTranslations )
+      dFree_aligned( mTranslations );
+}
+
+bool TSSequenceTracks::matches( const TSShape::Sequence &seq ) const
+{
+   return   mNumKeyframes == seq.numKeyframes &&
+            mBaseRotation == seq.baseRotation &&
+            mBaseTranslation == seq.baseTranslation &&
+            mNumRotations == seq.rotationMatters.count() &&
+            mNumTranslations == seq.translationMatters.count();
+}
+
+void TSSequenceTracks::build( const TSShape *shape, const TSShape::Sequence &seq )
+{
+   PROFILE_SCOPE( TSSequenceTracks_build );
+
+   if ( mRotations )
+      dFree_aligned( mRotations );
+   if ( mTranslations )
+      dFree_aligned( mTranslations );
+
+   mNumKeyframes = seq.numKeyframes;
+   mBaseRotation = seq.baseRotation;
+   mBaseTranslation = seq.baseTranslation;
+
+   mNumRotations = seq.rotationMatters.count();
+   mRotationStride = ( mNumRotations + 3 ) & ~3;
+   mNumTranslations = seq.translationMatters.count();
+   mTranslationStride = ( mNumTranslations + 3 ) & ~3;
+
+   // Allocate at least one row so that the key lookups
+   // are always valid even for empty tracks.
+   const U32 rotSize = getMax( mNumKeyframes * mRotationStride * 4, 4 ) * sizeof( F32 );
+   mRotations = (F32*)dMalloc_aligned( rotSize, 16 );
+   dMemset( mRotations, 0, rotSize );
+
+   const U32 tranSize = getMax( mNumKeyframes * mTranslationStride * 3, 4 ) * sizeof( F32 );
+   mTranslations = (F32*)dMalloc_aligned( tranSize, 16 );
+   dMemset( mTranslations, 0, tranSize );
+
+   QuatF q;
+   for ( S32 k = 0; k < mNumKeyframes; k++ )
+   {
+      F32 *rot = mRotations + k * mRotationStride * 4;
+      for ( S32 j = 0; j < mNumRotations; j++ )
+      {
+         shape->getRotation( seq, k, j, &q );
+         rot[j] = q.x;
+         rot[j + mRotationStride] = q.y;
+         rot[j + mRotationStride * 2] = q.z;
+         rot[j + mRotationStride * 3] = q.w;
+      }
+
+      F32 *tran = mTranslations + k * mTranslationStride * 3;
+      for ( S32 j = 0; j < mNumTranslations; j++ )
+      {
+         const Point3F &p = shape->getTranslation( seq, k, j );
+         tran[j] = p.x;
+         tran[j + mTranslationStride] = p.y;
+         tran[j + mTranslationStride * 2] = p.z;
+      }
+   }
+}
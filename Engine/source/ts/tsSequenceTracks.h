@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#ifndef _TSSEQUENCETRACKS_H_
+#define _TSSEQUENCETRACKS_H_
+
+#ifndef _TSSHAPE_H_
+#include "ts/tsShape.h"
+#endif
+
+
+/// The node rotation and translation keyframes of a single sequence
+/// rearranged so that all of its tracks can be sampled at once.
+///
+/// TSShape stores the keyframes of each track together.  Here each
+/// keyframe holds every track as a structure of arrays, so sampling
+/// a thread only touches the two keyframes it is between.  The track
+/// counts are padded to a multiple of four with zeros so the batch
+/// functions in tsAnimateIntrinsics.h can work on four tracks at once.
+///
+/// @see TSShape::getSequenceTracks
+class TSSequenceTracks
+{
+public:
+
+   TSSequenceTracks();
+   ~TSSequenceTracks();
+
+   /// Fills in the tracks from the sequence keyframes.
+   void build( const TSShape *shape, const TSShape::Sequence &seq );
+
+   /// Returns true if the tracks were built from a sequence with
+   /// the same keyframe layout.  This does not look at the keyframe
+   /// values, so edits which change them in place must also call
+   /// TSShape::clearSequenceTracks().
+   bool matches( const TSShape::Sequence &seq ) const;
+
+   /// Returns the x, y, z and w rows of a rotation keyframe.
+   const F32* getRotationKey( S32 keyframe ) const { return mRotations + keyframe * mRotationStride * 4; }
+
+   /// Returns the x, y and z rows of a translation keyframe.
+   const F32* getTranslationKey( S32 keyframe ) const { return mTranslations + keyframe * mTranslationStride * 3; }
+
+   S32 getNumRotations() const { return mNumRotations; }
+   S32 getRotationStride() const { return mRotationStride; }
+
+   S32 getNumTranslations() const { return mNumTranslations; }
+   S32 getTranslationStride() const { return mTranslationStride; }
+
+protected:
+
+   /// The layout of the sequence we were built from.
+   S32 mNumKeyframes;
+   S32 mBaseRotation;
+   S32 mBaseTranslation;
+
+   /// The number of rotation tracks and the padded 
+   /// length of each component row.
+   S32 mNumRotations;
+   S32 mRotationStride;
+
+   /// The number of translation tracks and the padded
+   /// length of each component row.
+   S32 mNumTranslations;
+   S32 mTranslationStride;
+
+   /// The 16 byte aligned keyframe data.
+   F32 *mRotations;
+   F32 *mTranslations;
+};
+
+#endif // _TSSEQUENCETRACKS_H_
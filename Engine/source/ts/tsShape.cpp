@@ -28,6 +28,8 @@
 #include "core/stringTable.h"
 #include "console/console.h"
 #include "ts/tsShapeInstance.h"
+#include "ts/tsSequenceTracks.h"
+#include "ts/tsCompressedSequence.h"
 #include "collision/convex.h"
 #include "materials/matInstance.h"
 #include "materials/materialManager.h"
@@ -36,6 +38,7 @@
 #include "core/stream/fileStream.h"
 #include "console/compiler.h"
 #include "core/fileObject.h"
+#include "platform/platformSlabAllocator.h"
 
 #ifdef TORQUE_COLLADA
 extern TSShape* loadColladaShape(const Torque::Path &path);
@@ -59,6 +62,10 @@ S32 TSShape::smNumSkipLoadDetails = 0;
 
 bool TSShape::smInitOnRead = true;
 
+bool TSShape::smCompressSequences = false;
+F32 TSShape::smCompressRotationTolerance = 0.001f;
+F32 TSShape::smCompressTranslationTolerance = 0.0005f;
+
 
 TSShape::TSShape()
 {
@@ -152,6 +159,11 @@ TSShape::~TSShape()
 
    if( mShapeData )
       delete[] mShapeData;
+
+   clearSequenceTracks();
+
+   for ( S32 i = 0; i < mCompressedSequences.size(); i++ )
+      delete mCompressedSequences[i];
 }
 
 const String& TSShape::getName( S32 nameIndex ) const
@@ -387,8 +399,219 @@ void TSShape::getObjectDetails(S32 objIndex, Vector<S32>& objDetails)
    }
 }
 
+const TSSequenceTracks* TSShape::getSequenceTracks( S32 seqIndex ) const
+{
+   if ( mSequenceTracks.size() != sequences.size() )
+   {
+      // Sequences were added or removed since we last looked.  Any
+      // tracks left in place get checked against their sequence.
+      const S32 oldSize = mSequenceTracks.size();
+      for ( S32 i = sequences.size(); i < oldSize; i++ )
+         delete mSequenceTracks[i];
+
+      mSequenceTracks.setSize( sequences.size() );
+      for ( S32 i = oldSize; i < mSequenceTracks.size(); i++ )
+         mSequenceTracks[i] = NULL;
+   }
+
+   const Sequence &seq = sequences[seqIndex];
+   TSSequenceTracks *tracks = mSequenceTracks[seqIndex];
+   if ( !tracks || !tracks->matches( seq ) )
+   {
+      if ( !tracks )
+         tracks = mSequenceTracks[seqIndex] = new TSSequenceTracks;
+
+      tracks->build( this, seq );
+   }
+
+   return tracks;
+}
+
+void TSShape::clearSequenceTracks()
+{
+   for ( S32 i = 0; i < mSequenceTracks.size(); i++ )
+      delete mSequenceTracks[i];
+
+   mSequenceTracks.clear();
+}
+
+QuatF & TSShape::getRotation(const Sequence & seq, S32 keyframeNum, S32 rotNum, QuatF * quat) const
+{
+   const TSCompressedSequence *compressed = getCompressedSequence(seq);
+   if (compressed)
+      return compressed->getRotation(keyframeNum, rotNum, quat);
+
+   return nodeRotations[seq.baseRotation + rotNum*seq.numKeyframes + keyframeNum].getQuatF(quat);
+}
+
+Point3F TSShape::getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const
+{
+   const TSCompressedSequence *compressed = getCompressedSequence(seq);
+   if (compressed)
+      return compressed->getTranslation(keyframeNum, tranNum);
+
+   return nodeTranslations[seq.baseTranslation + tranNum*seq.numKeyframes + keyframeNum];
+}
+
+void TSShape::compressSequences( F32 rotTolerance, F32 tranTolerance )
+{
+   PROFILE_SCOPE( TSShape_compressSequences );
+
+   clearSequenceTracks();
+
+   // Sequences can only be appended while we're compressed, since any 
+   // other edit decompresses them first.
+   AssertFatal( mCompressedSequences.size() <= sequences.size(),
+      "TSShape::compressSequences - Sequences removed while compressed!" );
+
+   const S32 oldSize = mCompressedSequences.size();
+   mCompressedSequences.setSize( sequences.size() );
+   for ( S32 i = oldSize; i < mCompressedSequences.size(); i++ )
+      mCompressedSequences[i] = NULL;
+
+   // Rebuild the keyframe arrays with only the sequences that stay
+   // uncompressed.  The compressed ones keep an empty range in place
+   // so that the sequences stay in order for the shape edit methods.
+   Vector<Quat16> rotations;
+   Vector<Point3F> translations;
+   for ( S32 i = 0; i < sequences.size(); i++ )
+   {
+      Sequence &seq = sequences[i];
+      if ( !mCompressedSequences[i] && seq.numKeyframes <= U16_MAX + 1 )
+      {
+         TSCompressedSequence *compressed = new TSCompressedSequence;
+         compressed->compress( this, seq, rotTolerance, tranTolerance );
+         mCompressedSequences[i] = compressed;
+      }
+
+      if ( mCompressedSequences[i] )
+      {
+         seq.baseRotation = rotations.size();
+         seq.baseTranslation = translations.size();
+      }
+      else
+      {
+         const S32 numRots = seq.rotationMatters.count() * seq.numKeyframes;
+         const S32 numTrans = seq.translationMatters.count() * seq.numKeyframes;
+         rotations.merge( nodeRotations.address() + seq.baseRotation, numRots );
+         translations.merge( nodeTranslations.address() + seq.baseTranslation, numTrans );
+         seq.baseRotation = rotations.size() - numRots;
+         seq.baseTranslation = translations.size() - numTrans;
+      }
+   }
+
+   nodeRotations = rotations;
+   nodeTranslations = translations;
+}
+
+void TSShape::decompressSequences()
+{
+   if ( mCompressedSequences.empty() )
+      return;
+
+   PROFILE_SCOPE( TSShape_decompressSequences );
+
+   Vector<TSCompressedSequence*> compressed( mCompressedSequences );
+   _decodeSequences();
+
+   for ( S32 i = 0; i < compressed.size(); i++ )
+      delete compressed[i];
+}
+
+void TSShape::_decodeSequences()
+{
+   clearSequenceTracks();
+
+   Vector<Quat16> rotations;
+   Vector<Point3F> translations;
+   for ( S32 i = 0; i < sequences.size(); i++ )
+   {
+      Sequence &seq = sequences[i];
+      const S32 numRots = seq.rotationMatters.count();
+      const S32 numTrans = seq.translationMatters.count();
+
+      const TSCompressedSequence *compressed = getCompressedSequence( i );
+      if ( compressed )
+      {
+         QuatF q;
+         Quat16 q16;
+         for ( S32 j = 0; j < numRots; j++ )
+         {
+            for ( S32 k = 0; k < seq.numKeyframes; k++ )
+            {
+               q16.set( compressed->getRotation( k, j, &q ) );
+               rotations.push_back( q16 );
+            }
+         }
+
+         for ( S32 j = 0; j < numTrans; j++ )
+         {
+            for ( S32 k = 0; k < seq.numKeyframes; k++ )
+               translations.push_back( compressed->getTranslation( k, j ) );
+         }
+      }
+      else
+      {
+         rotations.merge( nodeRotations.address() + seq.baseRotation, numRots * seq.numKeyframes );
+         translations.merge( nodeTranslations.address() + seq.baseTranslation, numTrans * seq.numKeyframes );
+      }
+
+      seq.baseRotation = rotations.size() - numRots * seq.numKeyframes;
+      seq.baseTranslation = translations.size() - numTrans * seq.numKeyframes;
+   }
+
+   mCompressedSequences.clear();
+
+   nodeRotations = rotations;
+   nodeTranslations = translations;
+}
+
+TSShape::UncompressedScope::UncompressedScope( TSShape *shape )
+   : mShape( shape )
+{
+   if ( !mShape->hasCompressedSequences() )
+      return;
+
+   mCompressed = mShape->mCompressedSequences;
+   mRotations = mShape->nodeRotations;
+   mTranslations = mShape->nodeTranslations;
+
+   mBaseRotations.setSize( mShape->sequences.size() );
+   mBaseTranslations.setSize( mShape->sequences.size() );
+   for ( S32 i = 0; i < mShape->sequences.size(); i++ )
+   {
+      mBaseRotations[i] = mShape->sequences[i].baseRotation;
+      mBaseTranslations[i] = mShape->sequences[i].baseTranslation;
+   }
+
+   mShape->_decodeSequences();
+}
+
+TSShape::UncompressedScope::~UncompressedScope()
+{
+   if ( mCompressed.empty() )
+      return;
+
+   AssertFatal( mBaseRotations.size() == mShape->sequences.size(),
+      "TSShape::UncompressedScope - Sequences were edited within the scope!" );
+
+   mShape->clearSequenceTracks();
+
+   mShape->mCompressedSequences = mCompressed;
+   mShape->nodeRotations = mRotations;
+   mShape->nodeTranslations = mTranslations;
+
+   for ( S32 i = 0; i < mShape->sequences.size(); i++ )
+   {
+      mShape->sequences[i].baseRotation = mBaseRotations[i];
+      mShape->sequences[i].baseTranslation = mBaseTranslations[i];
+   }
+}
+
 void TSShape::init()
 {
+   clearSequenceTracks();
+
    S32 numSubShapes = subShapeFirstNode.size();
    AssertFatal(numSubShapes==subShapeFirstObject.size(),"TSShape::init");
 
@@ -1468,6 +1691,9 @@ bool TSShape::canWriteOldFormat() const
 
 void TSShape::write(Stream * s, bool saveOldFormat)
 {
+   // the file format only knows about uncompressed keyframes
+   UncompressedScope uncompressed(this);
+
    S32 currentVersion = smVersion;
    if (saveOldFormat)
       smVersion = 24;
@@ -1533,6 +1759,8 @@ void TSShape::write(Stream * s, bool saveOldFormat)
 
 bool TSShape::read(Stream * s)
 {
+   SLAB_TAG_SCOPE( TS );
+
    // read version - read handles endian-flip
    s->read(&smReadVersion);
    mExporterVersion = smReadVersion >> 16;
@@ -42,6 +42,8 @@
 class TSMaterialList;
 class TSLastDetail;
 class PhysicsCollision;
+class TSSequenceTracks;
+class TSCompressedSequence;
 
 //
 struct CollisionShapeInfo
@@ -391,6 +393,17 @@ class TSShape
 
    bool mSequencesConstructed;
 
+   /// The batch sampling tracks for each sequence or NULL
+   /// if the sequence hasn't been sampled yet.
+   /// @see getSequenceTracks
+   mutable Vector<TSSequenceTracks*> mSequenceTracks;
+
+   /// The compressed keyframes for each sequence or NULL if the
+   /// sequence keeps its keyframes in the node arrays.  This is
+   /// empty when no sequences are compressed.
+   /// @see compressSequences
+   Vector<TSCompressedSequence*> mCompressedSequences;
+
    S8* mShapeData;
    U32 mShapeDataSize;
 
@@ -419,11 +432,70 @@ class TSShape
    /// @{
 
    QuatF & getRotation(const Sequence & seq, S32 keyframeNum, S32 rotNum, QuatF *) const;
-   const Point3F & getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const;
+   Point3F getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const;
    F32 getUniformScale(const Sequence & seq, S32 keyframeNum, S32 scaleNum) const;
    const Point3F & getAlignedScale(const Sequence & seq, S32 keyframeNum, S32 scaleNum) const;
    TSScale & getArbitraryScale(const Sequence & seq, S32 keyframeNum, S32 scaleNum, TSScale *) const;
    const ObjectState & getObjectState(const Sequence & seq, S32 keyframeNum, S32 objectNum) const;
+
+   /// Returns the rotation and translation keyframes of the sequence
+   /// rearranged for batch sampling.  They are built the first time
+   /// the sequence is sampled.
+   const TSSequenceTracks* getSequenceTracks( S32 seqIndex ) const;
+
+   /// Frees the batch sampling tracks of all the sequences.
+   void clearSequenceTracks();
+
+   /// Returns the compressed keyframes of the sequence or NULL
+   /// if the sequence isn't compressed.
+   const TSCompressedSequence* getCompressedSequence( S32 seqIndex ) const;
+   const TSCompressedSequence* getCompressedSequence( const Sequence &seq ) const;
+   /// @}
+
+   /// @name Animation Compression
+   /// Sequences can trade their node rotation and translation keyframes
+   /// for a compact encoding that is decoded as they are sampled.  Any
+   /// edit to the keyframes decompresses the sequences first.  Writing
+   /// the shape out decodes them only while it writes.
+   /// @{
+
+   /// Compresses the node rotations and translations of every sequence
+   /// and frees their uncompressed keyframes.
+   ///
+   /// @param rotTolerance    The largest rotation error in radians.
+   /// @param tranTolerance   The largest translation error in shape units.
+   void compressSequences( F32 rotTolerance, F32 tranTolerance );
+
+   /// Restores the keyframes of any compressed sequences into the
+   /// node rotation and translation arrays.
+   void decompressSequences();
+
+   /// Decodes the compressed sequences into the node rotation and
+   /// translation arrays and drops the list without freeing them.
+   void _decodeSequences();
+
+   bool hasCompressedSequences() const { return !mCompressedSequences.empty(); }
+
+   /// Decodes any compressed sequences into the node rotation and
+   /// translation arrays for the life of the scope, then puts the
+   /// compressed keyframes back.  This lets the shape be written out
+   /// without leaving it decompressed or compressing it again.
+   ///
+   /// The sequences must not be edited within the scope.
+   class UncompressedScope
+   {
+   public:
+      UncompressedScope( TSShape *shape );
+      ~UncompressedScope();
+
+   protected:
+      TSShape *mShape;
+      Vector<TSCompressedSequence*> mCompressed;
+      Vector<Quat16> mRotations;
+      Vector<Point3F> mTranslations;
+      Vector<S32> mBaseRotations;
+      Vector<S32> mBaseTranslations;
+   };
    /// @}
 
    /// build LOS collision detail
@@ -548,6 +620,15 @@ class TSShape
    /// by default we initialize shape when we read...
    static bool smInitOnRead;
 
+   /// @name Animation Compression Prefs
+   /// If enabled, shape resources compress their sequences once they
+   /// have loaded and any TSShapeConstructor has applied its edits.
+   /// @{
+   static bool smCompressSequences;
+   static F32 smCompressRotationTolerance;
+   static F32 smCompressTranslationTolerance;
+   /// @}
+
    /// @name Version Info
    /// @{
 
@@ -657,14 +738,18 @@ class TSShape
 #define TSSequence TSShape::Sequence
 #define TSDetail TSShape::Detail
 
-inline QuatF & TSShape::getRotation(const Sequence & seq, S32 keyframeNum, S32 rotNum, QuatF * quat) const
+inline const TSCompressedSequence* TSShape::getCompressedSequence( S32 seqIndex ) const
 {
-   return nodeRotations[seq.baseRotation + rotNum*seq.numKeyframes + keyframeNum].getQuatF(quat);
+   // Sequences imported since the last compression aren't in the list yet.
+   return ( seqIndex < mCompressedSequences.size() ) ? mCompressedSequences[seqIndex] : NULL;
 }
 
-inline const Point3F & TSShape::getTranslation(const Sequence & seq, S32 keyframeNum, S32 tranNum) const
+inline const TSCompressedSequence* TSShape::getCompressedSequence( const Sequence &seq ) const
 {
-   return nodeTranslations[seq.baseTranslation + tranNum*seq.numKeyframes + keyframeNum];
+   if ( mCompressedSequences.empty() )
+      return NULL;
+
+   return getCompressedSequence( (S32)( &seq - sequences.address() ) );
 }
 
 inline F32 TSShape::getUniformScale(const Sequence & seq, S32 keyframeNum, S32 scaleNum) const
@@ -86,6 +86,8 @@ void TSShapeConstructor::_onTSShapeLoaded( Resource< TSShape >& resource )
    TSShapeConstructor* ctor = findShapeConstructor( resource.getPath().getFullPath() );
    if( ctor )
       ctor->_onLoad( resource );
+   else if ( TSShape::smCompressSequences )
+      resource->compressSequences( TSShape::smCompressRotationTolerance, TSShape::smCompressTranslationTolerance );
 }
 
 void TSShapeConstructor::_onTSShapeUnloaded( const Torque::Path& path, TSShape* shape )
@@ -411,6 +413,11 @@ void TSShapeConstructor::_onLoad(TSShape* shape)
 
    // Call script function
    onLoad_callback();
+
+   // Compress once our edits are done, so that the keyframes
+   // only lose precision the one time.
+   if ( TSShape::smCompressSequences )
+      mShape->compressSequences( TSShape::smCompressRotationTolerance, TSShape::smCompressTranslationTolerance );
 }
 
 //-----------------------------------------------------------------------------
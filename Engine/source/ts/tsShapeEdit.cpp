@@ -538,6 +538,9 @@ bool TSShape::removeNode(const String& name)
 
    S32 nodeParentIndex = nodes[nodeIndex].parentIndex;
 
+   // Edit the uncompressed keyframes
+   decompressSequences();
+
    // Warn if there are objects attached to this node
    Vector<S32> nodeObjects;
    getNodeObjects(nodeIndex, nodeObjects);
@@ -1442,6 +1445,7 @@ bool TSShape::addSequence(const Torque::Path& path, const String& fromSeq,
          return false;
       }
       srcShape = const_cast<TSShape*>((const TSShape*)hSrcShape);
+      srcShape->decompressSequences();
       if (!srcShape->sequences.size())
       {
          Con::errorf("TSShape::addSequence: Source shape '%s' does not contain any sequences", path.getFullPath().c_str());
@@ -1458,6 +1462,9 @@ bool TSShape::addSequence(const Torque::Path& path, const String& fromSeq,
       oldName = path.getFullPath();
    }
 
+   // Copy the uncompressed keyframes
+   decompressSequences();
+
    // Find the sequence
    S32 seqIndex = srcShape->findSequence(oldName);
    if (seqIndex < 0)
@@ -1782,6 +1789,8 @@ bool TSShape::removeSequence(const String& name)
       return false;
    }
 
+   decompressSequences();
+
    TSShape::Sequence& seq = sequences[seqIndex];
 
    // Remove the node transforms for this sequence
@@ -1824,6 +1833,9 @@ bool TSShape::removeSequence(const String& name)
    // Remove the sequence itself
    sequences.erase(seqIndex);
 
+   // The batch sampling tracks are stored by sequence index
+   clearSequenceTracks();
+
    // Remove the sequence name if it is no longer in use
    removeName(name);
 
@@ -1966,19 +1978,13 @@ void TSShape::getNodeKeyframe(S32 nodeIndex, const TSShape::Sequence& seq, S32 k
    // Get the node rotation and translation
    QuatF rot;
    if (seq.rotationMatters.test(nodeIndex))
-   {
-      S32 index = seq.rotationMatters.count(nodeIndex) * seq.numKeyframes + keyframe;
-      nodeRotations[seq.baseRotation + index].getQuatF(&rot);
-   }   
+      getRotation(seq, keyframe, seq.rotationMatters.count(nodeIndex), &rot);
    else
       defaultRotations[nodeIndex].getQuatF(&rot);
 
    Point3F trans;
    if (seq.translationMatters.test(nodeIndex))
-   {
-      S32 index = seq.translationMatters.count(nodeIndex) * seq.numKeyframes + keyframe;
-      trans = nodeTranslations[seq.baseTranslation + index];
-   }
+      trans = getTranslation(seq, keyframe, seq.translationMatters.count(nodeIndex));
    else
       trans = defaultTranslations[nodeIndex];
 
@@ -2002,6 +2008,9 @@ bool TSShape::setSequenceBlend(const String& seqName, bool blend, const String&
    if (seq.isBlend() == blend)
       return true;
 
+   // Edit the uncompressed keyframes
+   decompressSequences();
+
    // Find the sequence containing the reference frame
    S32 blendRefSeqIndex = findSequence(blendRefSeqName);
    if (blendRefSeqIndex < 0)
@@ -2066,6 +2075,10 @@ bool TSShape::setSequenceBlend(const String& seqName, bool blend, const String&
       }
    }
 
+   // The keyframes were changed in place, so rebuild the batch
+   // sampling tracks the next time the sequence is sampled.
+   clearSequenceTracks();
+
    // Update sequence blend information
    seq.sourceData.blendSeq = blendRefSeqName;
    seq.sourceData.blendFrame = blendRefFrame;
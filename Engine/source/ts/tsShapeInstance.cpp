@@ -38,6 +38,7 @@
 #include "gfx/primBuilder.h"
 #include "gfx/gfxDrawUtil.h"
 #include "core/module.h"
+#include "platform/platformSlabAllocator.h"
 
 
 MODULE_BEGIN( TSShapeInstance )
@@ -76,6 +77,26 @@ MODULE_BEGIN( TSShapeInstance )
          "@brief Enables mesh instancing on non-skin meshes that have less that this count of verts.\n"
          "The default value is 200.  Higher values can degrade performance.\n"
          "@ingroup Rendering\n" );
+
+      Con::addVariable("$pref::TS::compressAnimations", TypeBool, &TSShape::smCompressSequences,
+         "@brief User perference which compresses the node animation of TSShapes as they load.\n"
+         "This greatly reduces the memory used by shapes with many sequences, at the cost of "
+         "decoding keyframes as they are sampled.  The default value is false.\n"
+         "@see $pref::TS::animRotationTolerance\n"
+         "@see $pref::TS::animTranslationTolerance\n"
+         "@ingroup Rendering\n" );
+
+      Con::addVariable("$pref::TS::animRotationTolerance", TypeF32, &TSShape::smCompressRotationTolerance,
+         "@brief The largest node rotation error in radians allowed when compressing animation.\n"
+         "The default value is 0.001.\n"
+         "@see $pref::TS::compressAnimations\n"
+         "@ingroup Rendering\n" );
+
+      Con::addVariable("$pref::TS::animTranslationTolerance", TypeF32, &TSShape::smCompressTranslationTolerance,
+         "@brief The largest node translation error allowed when compressing animation.\n"
+         "The default value is 0.0005.\n"
+         "@see $pref::TS::compressAnimations\n"
+         "@ingroup Rendering\n" );
    }
 
 MODULE_END;
@@ -439,6 +460,7 @@ void TSShapeInstance::render( const TSRenderState &rdata )
       return;
 
    PROFILE_SCOPE( TSShapeInstance_Render );
+   SLAB_TAG_SCOPE( TS );
 
    // alphaIn:  we start to alpha-in next detail level when intraDL > 1-alphaIn-alphaOut
    //           (finishing when intraDL = 1-alphaOut)
@@ -431,6 +431,14 @@ protected:
    void handleMaskedPositionNode(TSThread *, S32 nodeIndex, S32 offset);
    void handleBlendSequence(TSThread *, S32 a, S32 b);
    void checkScaleCurrentlyAnimated();
+
+   /// Builds the pose cache key for a subshape and rounds the thread
+   /// positions to match.  Returns false if the pose can't be shared.
+   /// @see TSPoseCache
+   bool beginSharedPose(S32 ss);
+
+   /// Restores the thread positions rounded by beginSharedPose().
+   void endSharedPose();
    /// @}
 
 //-------------------------------------------------------------------------------------
@@ -490,7 +498,11 @@ protected:
 
    void animate() { animate( mCurrentDetailLevel ); }
    void animate(S32 dl);
-   void animateNodes(S32 ss);
+   /// Animates the nodes of a subshape.  If sharePose is set, the node
+   /// transforms may come from another instance in the same animation
+   /// state this frame.
+   /// @see TSPoseCache
+   void animateNodes(S32 ss, bool sharePose = false);
    void animateVisibility(S32 ss);
    void animateFrame(S32 ss);
    void animateMatFrame(S32 ss);
@@ -190,6 +190,9 @@ void TSShape::fixupOldSkins(S32 numMeshes, S32 numSkins, S32 numDetails, S32 * d
 //-------------------------------------------------
 void TSShape::exportSequences(Stream * s)
 {
+   // the file format only knows about uncompressed keyframes
+   UncompressedScope uncompressed(this);
+
    // write version
    s->write(smVersion);
 
@@ -295,6 +298,9 @@ void TSShape::exportSequences(Stream * s)
 //-------------------------------------------------
 void TSShape::exportSequence(Stream * s, const TSShape::Sequence& seq, bool saveOldFormat)
 {
+   // the file format only knows about uncompressed keyframes
+   UncompressedScope uncompressed(this);
+
    S32 currentVersion = smVersion;
    if ( saveOldFormat )
       smVersion = 24;
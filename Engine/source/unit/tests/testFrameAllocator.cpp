@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "core/frameAllocator.h"
+#include "platform/threads/thread.h"
+
+using namespace UnitTesting;
+
+#ifdef TORQUE_MULTITHREAD
+
+CreateUnitTest( TestFrameAllocatorThreads, "Core/FrameAllocator" )
+{
+   struct ThreadResult
+   {
+      U8 *mainPtr;
+      U8 *threadPtr;
+      U32 waterMarkBefore;
+      U32 waterMarkAfter;
+      U32 peak;
+   };
+
+   static void threadBody( void *arg )
+   {
+      ThreadResult *result = reinterpret_cast< ThreadResult* >( arg );
+
+      FrameAllocator::initThread( 4096 );
+      result->waterMarkBefore = FrameAllocator::getWaterMark();
+
+      {
+         FrameTemp< U8 > temp( 1000 );
+         result->threadPtr = ~temp;
+         dMemset( ~temp, 0xFF, 1000 );
+      }
+
+      result->waterMarkAfter = FrameAllocator::getWaterMark();
+      result->peak = FrameAllocator::getPeakWaterMark();
+
+      FrameAllocator::destroyThread();
+   }
+
+   void run()
+   {
+      FrameAllocatorMarker marker;
+
+      ThreadResult result;
+      result.mainPtr = reinterpret_cast< U8* >( marker.alloc( 16 ) );
+      const U32 mainWaterMark = FrameAllocator::getWaterMark();
+
+      Thread thread( &threadBody, &result );
+      thread.start();
+      thread.join();
+
+      // The worker must have used its own arena.
+      test( result.waterMarkBefore == 0, "Worker arena did not start empty!" );
+      test( result.waterMarkAfter == 0, "FrameTemp did not restore the worker watermark!" );
+      test( result.peak >= 1000, "Worker peak watermark was not tracked!" );
+      test( result.threadPtr != result.mainPtr, "Worker allocated from the main arena!" );
+
+      // And the main thread's arena must be untouched.
+      test( FrameAllocator::getWaterMark() == mainWaterMark, "Worker changed the main thread watermark!" );
+   }
+};
+
+#endif // TORQUE_MULTITHREAD
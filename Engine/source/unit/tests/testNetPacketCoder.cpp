@@ -0,0 +1,137 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "sim/netPacketCoder.h"
+#include "platform/platformNet.h"
+#include "math/mRandom.h"
+
+using namespace UnitTesting;
+
+CreateUnitTest( TestNetPacketCoder, "Net/PacketCoder" )
+{
+   enum
+   {
+      /// Bytes after the buffers which must be left alone.
+      GuardSize = 16,
+      GuardByte = 0xCD,
+   };
+
+   enum Payload
+   {
+      RandomBytes,
+      ZeroBytes,
+      FullBytes,
+      SmallAlphabet,
+      PayloadCount
+   };
+
+   static void fill( U8 *buffer, U32 size, Payload payload, MRandomLCG &rand )
+   {
+      for ( U32 i = 0; i < size; i++ )
+      {
+         switch ( payload )
+         {
+            case RandomBytes:    buffer[i] = U8( rand.randI() ); break;
+            case ZeroBytes:      buffer[i] = 0; break;
+            case FullBytes:      buffer[i] = 0xFF; break;
+            case SmallAlphabet:  buffer[i] = U8( 'a' + rand.randI( 0, 3 ) ); break;
+            default:             break;
+         }
+      }
+   }
+
+   static bool guardIntact( const U8 *buffer )
+   {
+      for ( U32 i = 0; i < GuardSize; i++ )
+         if ( buffer[i] != GuardByte )
+            return false;
+      return true;
+   }
+
+   bool roundTrip( U32 group, const U8 *payload, U32 size )
+   {
+      // Random data can grow a little when coded.
+      const U32 codedMax = size + size / 8 + 16;
+
+      Vector<U8> coded( codedMax + GuardSize );
+      coded.setSize( codedMax + GuardSize );
+      dMemset( coded.address(), GuardByte, coded.size() );
+
+      const U32 codedSize = NetPacketCoder::encode( group, payload, size, coded.address(), codedMax );
+      if ( !test( guardIntact( coded.address() + codedMax ), "Encoder wrote past the end of the buffer!" ) )
+         return false;
+
+      Vector<U8> decoded( size + GuardSize );
+      decoded.setSize( size + GuardSize );
+      dMemset( decoded.address(), GuardByte, decoded.size() );
+
+      NetPacketCoder::decode( group, coded.address(), codedSize, decoded.address(), size );
+      if ( !test( guardIntact( decoded.address() + size ), "Decoder wrote past the end of the buffer!" ) )
+         return false;
+
+      return test( dMemcmp( payload, decoded.address(), size ) == 0, "Decoded payload does not match!" );
+   }
+
+   void run()
+   {
+      MRandomLCG rand( 1 );
+
+      const U32 sizes[] = { 0, 1, 2, 3, 15, 16, 17, 64, 255, 256, 1000, Net::MaxPacketDataSize };
+
+      Vector<U8> payload( Net::MaxPacketDataSize );
+      payload.setSize( Net::MaxPacketDataSize );
+
+      for ( U32 group = 0; group < NetClassGroupsCount; group++ )
+      {
+         for ( U32 p = 0; p < PayloadCount; p++ )
+         {
+            for ( U32 s = 0; s < sizeof( sizes ) / sizeof( sizes[0] ); s++ )
+            {
+               fill( payload.address(), sizes[s], (Payload)p, rand );
+               if ( !roundTrip( group, payload.address(), sizes[s] ) )
+                  return;
+            }
+         }
+      }
+
+      // Lots of random sizes with random contents.
+      for ( U32 i = 0; i < 200; i++ )
+      {
+         const U32 size = rand.randI( 0, Net::MaxPacketDataSize );
+         fill( payload.address(), size, RandomBytes, rand );
+         if ( !roundTrip( NetClassGroupGame, payload.address(), size ) )
+            return;
+      }
+
+      // Random data does not compress, so it must not fit a
+      // buffer of half its size and the encoder has to say so.
+      const U32 size = 1000;
+      fill( payload.address(), size, RandomBytes, rand );
+
+      U8 small[ size / 2 + GuardSize ];
+      dMemset( small, GuardByte, sizeof( small ) );
+      test( NetPacketCoder::encode( NetClassGroupGame, payload.address(), size, small, size / 2 ) == 0, "Overflow was not reported!" );
+      test( guardIntact( small + size / 2 ), "Encoder wrote past the end of a full buffer!" );
+   }
+};
@@ -0,0 +1,214 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "renderInstance/renderBinManager.h"
+#include "math/mRandom.h"
+#include "platform/platformTimer.h"
+#include "console/console.h"
+
+
+#ifndef TORQUE_SHIPPING
+
+using namespace UnitTesting;
+
+/// Exposes the sorting internals of RenderBinManager to the tests.
+class RenderBinSortTester : public RenderBinManager
+{
+public:
+
+   typedef RenderBinManager::MainSortElem Elem;
+
+   enum Distribution
+   {
+      /// Mesh bins: key is the material state hint out of a
+      /// couple hundred materials and key2 the vertex buffer.
+      MeshKeys,
+
+      /// Translucent bin: key is the bits of the squared sort
+      /// distance and key2 the state hint.
+      TranslucentKeys,
+   };
+
+   static void fill( Vector< Elem > &elements, U32 count, Distribution distribution, MRandomLCG &rand )
+   {
+      U32 hints[ 256 ];
+      for ( U32 i = 0; i < 256; i++ )
+         hints[i] = rand.randI();
+
+      elements.setSize( count );
+      for ( U32 i = 0; i < count; i++ )
+      {
+         Elem &elem = elements[i];
+
+         // Tag the element with its position so we can test stability.
+         elem.inst = (RenderInst*)( (dsize_t)i );
+
+         if ( distribution == MeshKeys )
+         {
+            elem.key = hints[ rand.randI( 0, 199 ) ];
+            elem.key2 = 0x10000000 + rand.randI( 0, 2047 ) * 64;
+         }
+         else
+         {
+            const F32 distSq = rand.randF( 0.0f, 1000000.0f );
+            elem.key = *( (U32*)&distSq );
+            elem.key2 = hints[ rand.randI( 0, 199 ) ];
+         }
+      }
+   }
+
+   static void radixSort( Vector< Elem > &elements ) { _sortElements( elements ); }
+
+   static void qsort( Vector< Elem > &elements )
+   {
+      dQsort( elements.address(), elements.size(), sizeof( Elem ), cmpKeyFunc );
+   }
+
+   static bool isSorted( const Vector< Elem > &elements )
+   {
+      for ( U32 i = 1; i < elements.size(); i++ )
+      {
+         const Elem &a = elements[i-1];
+         const Elem &b = elements[i];
+
+         if ( _isSortedBefore( b, a ) )
+            return false;
+
+         // Equal keys must keep their original order.
+         if ( a.key == b.key && a.key2 == b.key2 && a.inst > b.inst )
+            return false;
+      }
+
+      return true;
+   }
+};
+
+CreateUnitTest( TestRenderBinSort, "RenderInstance/BinSort" )
+{
+   typedef RenderBinSortTester::Elem Elem;
+
+   void run()
+   {
+      MRandomLCG rand( 1 );
+      Vector< Elem > elements;
+      Vector< Elem > reference;
+
+      // Sizes around the insertion sort cutoff and up.
+      const U32 sizes[] = { 0, 1, 2, 17, 63, 64, 65, 1000, 20000 };
+
+      for ( U32 n = 0; n < sizeof( sizes ) / sizeof( sizes[0] ); n++ )
+      {
+         for ( U32 d = 0; d < 2; d++ )
+         {
+            const RenderBinSortTester::Distribution distribution = (RenderBinSortTester::Distribution)d;
+
+            RenderBinSortTester::fill( elements, sizes[n], distribution, rand );
+            reference = elements;
+
+            RenderBinSortTester::radixSort( elements );
+            test( RenderBinSortTester::isSorted( elements ), "Elements are not in stable sorted order" );
+
+            // The translucent keys are all below 2^31 so the qsort callback
+            // orders them the same way; compare the key sequences.
+            if ( distribution == RenderBinSortTester::TranslucentKeys )
+            {
+               RenderBinSortTester::qsort( reference );
+
+               bool matches = true;
+               for ( U32 i = 0; i < elements.size(); i++ )
+                  matches &= elements[i].key == reference[i].key;
+               test( matches, "Sort order differs from cmpKeyFunc" );
+            }
+         }
+      }
+
+      // A list with all equal keys must come out untouched.
+      RenderBinSortTester::fill( elements, 1000, RenderBinSortTester::MeshKeys, rand );
+      for ( U32 i = 0; i < elements.size(); i++ )
+         elements[i].key = elements[i].key2 = 7;
+
+      RenderBinSortTester::radixSort( elements );
+
+      bool untouched = true;
+      for ( U32 i = 0; i < elements.size(); i++ )
+         untouched &= elements[i].inst == (RenderInst*)( (dsize_t)i );
+      test( untouched, "Equal keys were reordered" );
+   }
+};
+
+CreateUnitTest( TestRenderBinSortPerformance, "RenderInstance/BinSortPerformance" )
+{
+   // Times the radix sort against the old qsort on the same
+   // lists and prints the results to the console.
+
+   typedef RenderBinSortTester::Elem Elem;
+
+   enum { NumIterations = 100 };
+
+   void run()
+   {
+      static const char* sDistributionNames[] = { "mesh", "translucent" };
+      const U32 sizes[] = { 500, 10000, 50000 };
+
+      PlatformTimer* timer = PlatformTimer::create();
+      MRandomLCG rand( 1 );
+
+      Vector< Elem > source;
+      Vector< Elem > elements;
+
+      Con::printf( "Render bin sort, %d iterations:", NumIterations );
+
+      for ( U32 d = 0; d < 2; d++ )
+      {
+         for ( U32 n = 0; n < sizeof( sizes ) / sizeof( sizes[0] ); n++ )
+         {
+            RenderBinSortTester::fill( source, sizes[n], (RenderBinSortTester::Distribution)d, rand );
+
+            timer->reset();
+            for ( U32 i = 0; i < NumIterations; i++ )
+            {
+               elements = source;
+               RenderBinSortTester::qsort( elements );
+            }
+            const S32 qsortMs = timer->getElapsedMs();
+
+            timer->reset();
+            for ( U32 i = 0; i < NumIterations; i++ )
+            {
+               elements = source;
+               RenderBinSortTester::radixSort( elements );
+            }
+            const S32 radixMs = timer->getElapsedMs();
+
+            Con::printf( "   %-12s %6d elements  qsort: %5dms  radix: %5dms  (%.2fx)",
+               sDistributionNames[d], sizes[n], qsortMs, radixMs,
+               radixMs > 0 ? F32( qsortMs ) / F32( radixMs ) : 0.f );
+         }
+      }
+
+      delete timer;
+   }
+};
+
+#endif // TORQUE_SHIPPING
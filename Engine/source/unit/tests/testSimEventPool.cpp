@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "console/simEvents.h"
+
+using namespace UnitTesting;
+
+CreateUnitTest( TestSimEventPool, "Console/SimEventPool" )
+{
+   void run()
+   {
+      const SimEventPool::SizeClassStats before = SimEventPool::getStats( 0 );
+
+      // Blocks of the same class must be reused once freed.
+      void *first = SimEventPool::alloc( 16 );
+      SimEventPool::free( first );
+      void *second = SimEventPool::alloc( 16 );
+      test( first == second, "Freed block was not reused!" );
+      SimEventPool::free( second );
+
+      const SimEventPool::SizeClassStats after = SimEventPool::getStats( 0 );
+      test( after.totalAllocs == before.totalAllocs + 2, "Allocations were not counted!" );
+      test( after.liveAllocs == before.liveAllocs, "Live allocations were not released!" );
+
+      // Oversized blocks fall back to the heap.
+      const SimEventPool::SizeClassStats heapBefore = SimEventPool::getStats( SimEventPool::FallbackClass );
+      void *big = SimEventPool::alloc( 4096 );
+      dMemset( big, 0, 4096 );
+      test( SimEventPool::getStats( SimEventPool::FallbackClass ).liveAllocs == heapBefore.liveAllocs + 1, "Oversized block was not counted!" );
+      SimEventPool::free( big );
+
+      // Events and their arguments must come from the pool.
+      const SimEventPool::SizeClassStats heapBeforeEvent = SimEventPool::getStats( SimEventPool::FallbackClass );
+      const char *argv[] = { "echo", "hello", "world" };
+      SimConsoleEvent *evt = new SimConsoleEvent( 3, argv, false );
+      test( SimEventPool::getStats( SimEventPool::FallbackClass ).totalAllocs == heapBeforeEvent.totalAllocs, "Event was not pooled!" );
+      delete evt;
+   }
+};
@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "math/mMath.h"
+#include "math/mRandom.h"
+#include "ts/tsTransform.h"
+#include "ts/tsAnimateIntrinsics.h"
+#include "ts/arch/tsAnimateIntrinsics.arch.h"
+
+extern void ts_nlerp_quat_soa_C(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr);
+extern void ts_lerp_point_soa_C(const F32 * __restrict key1, const F32 * __restrict key2, const F32 t, const S32 count, const S32 stride, F32 * __restrict outPtr);
+extern void ts_build_node_matrices_C(const QuatF * __restrict rots, const Point3F * __restrict trans, const S32 count, MatrixF * __restrict outPtr);
+
+using namespace UnitTesting;
+
+CreateUnitTest( TestTSAnimateIntrinsics, "TS/AnimateIntrinsics" )
+{
+   // Verifies that the batch sampling functions used by TSShapeInstance::animateNodes
+   // agree with the scalar TSTransform path they replace.
+
+   typedef void (*SampleFn)(const F32 * __restrict, const F32 * __restrict, const F32, const S32, const S32, F32 * __restrict);
+   typedef void (*BuildFn)(const QuatF * __restrict, const Point3F * __restrict, const S32, MatrixF * __restrict);
+
+   enum
+   {
+      NumTracks = 13,
+      Stride = ( NumTracks + 3 ) & ~3,
+   };
+
+   QuatF mRots1[NumTracks], mRots2[NumTracks];
+   Point3F mTrans1[NumTracks], mTrans2[NumTracks];
+
+   // The keyframes as TSSequenceTracks lays them out.
+   F32 mRotKey1[Stride * 4], mRotKey2[Stride * 4];
+   F32 mTranKey1[Stride * 3], mTranKey2[Stride * 3];
+
+   void makeKeys()
+   {
+      dMemset( mRotKey1, 0, sizeof( mRotKey1 ) );
+      dMemset( mRotKey2, 0, sizeof( mRotKey2 ) );
+      dMemset( mTranKey1, 0, sizeof( mTranKey1 ) );
+      dMemset( mTranKey2, 0, sizeof( mTranKey2 ) );
+
+      for ( S32 i = 0; i < NumTracks; i++ )
+      {
+         Point3F axis( gRandGen.randF( -1.0f, 1.0f ), gRandGen.randF( -1.0f, 1.0f ), gRandGen.randF( -1.0f, 1.0f ) );
+         if ( axis.isZero() )
+            axis.set( 0.0f, 0.0f, 1.0f );
+         axis.normalize();
+
+         mRots1[i].set( AngAxisF( axis, gRandGen.randF( 0.0f, M_2PI_F ) ) );
+         mRots2[i].set( AngAxisF( axis, gRandGen.randF( 0.0f, M_2PI_F ) ) );
+
+         // Make some of the pairs more than 90 degrees apart.
+         if ( i & 1 )
+            mRots2[i].neg();
+
+         mTrans1[i].set( gRandGen.randF( -10.0f, 10.0f ), gRandGen.randF( -10.0f, 10.0f ), gRandGen.randF( -10.0f, 10.0f ) );
+         mTrans2[i].set( gRandGen.randF( -10.0f, 10.0f ), gRandGen.randF( -10.0f, 10.0f ), gRandGen.randF( -10.0f, 10.0f ) );
+
+         mRotKey1[i] = mRots1[i].x;
+         mRotKey1[i + Stride] = mRots1[i].y;
+         mRotKey1[i + Stride * 2] = mRots1[i].z;
+         mRotKey1[i + Stride * 3] = mRots1[i].w;
+         mRotKey2[i] = mRots2[i].x;
+         mRotKey2[i + Stride] = mRots2[i].y;
+         mRotKey2[i + Stride * 2] = mRots2[i].z;
+         mRotKey2[i + Stride * 3] = mRots2[i].w;
+
+         mTranKey1[i] = mTrans1[i].x;
+         mTranKey1[i + Stride] = mTrans1[i].y;
+         mTranKey1[i + Stride * 2] = mTrans1[i].z;
+         mTranKey2[i] = mTrans2[i].x;
+         mTranKey2[i + Stride] = mTrans2[i].y;
+         mTranKey2[i + Stride * 2] = mTrans2[i].z;
+      }
+   }
+
+   bool checkSampling( SampleFn nlerp, SampleFn lerp, const char *name )
+   {
+      static const F32 sPositions[] = { 0.0f, 0.1f, 0.5f, 0.77f, 1.0f };
+      static const S32 sNumPositions = sizeof( sPositions ) / sizeof( sPositions[0] );
+
+      F32 rots[Stride * 4];
+      F32 trans[Stride * 3];
+      bool same = true;
+
+      for ( S32 p = 0; p < sNumPositions; p++ )
+      {
+         const F32 t = sPositions[p];
+
+         nlerp( mRotKey1, mRotKey2, t, Stride, Stride, rots );
+         lerp( mTranKey1, mTranKey2, t, Stride, Stride, trans );
+
+         for ( S32 i = 0; i < NumTracks; i++ )
+         {
+            QuatF q;
+            TSTransform::interpolate( mRots1[i], mRots2[i], t, &q );
+            same &= mIsEqual( rots[i], q.x, 1.0e-5f );
+            same &= mIsEqual( rots[i + Stride], q.y, 1.0e-5f );
+            same &= mIsEqual( rots[i + Stride * 2], q.z, 1.0e-5f );
+            same &= mIsEqual( rots[i + Stride * 3], q.w, 1.0e-5f );
+
+            Point3F pos;
+            TSTransform::interpolate( mTrans1[i], mTrans2[i], t, &pos );
+            same &= mIsEqual( trans[i], pos.x, 1.0e-4f );
+            same &= mIsEqual( trans[i + Stride], pos.y, 1.0e-4f );
+            same &= mIsEqual( trans[i + Stride * 2], pos.z, 1.0e-4f );
+         }
+      }
+
+      return test( same, avar( "Batch sampling does not match TSTransform::interpolate. (%s)", name ) );
+   }
+
+   bool checkMatrices( BuildFn build, const char *name )
+   {
+      MatrixF mats[NumTracks];
+      build( mRots1, mTrans1, NumTracks, mats );
+
+      bool same = true;
+      for ( S32 i = 0; i < NumTracks; i++ )
+      {
+         MatrixF mat;
+         TSTransform::setMatrix( mRots1[i], mTrans1[i], &mat );
+
+         const F32 *a = mats[i];
+         const F32 *b = mat;
+         for ( S32 j = 0; j < 16; j++ )
+            same &= mIsEqual( a[j], b[j], 1.0e-5f );
+      }
+
+      return test( same, avar( "Node matrices do not match TSTransform::setMatrix. (%s)", name ) );
+   }
+
+   void run()
+   {
+      for ( S32 i = 0; i < 8; i++ )
+      {
+         makeKeys();
+
+         checkSampling( ts_nlerp_quat_soa_C, ts_lerp_point_soa_C, "C" );
+         checkMatrices( ts_build_node_matrices_C, "C" );
+
+#if defined(TORQUE_CPU_X86)
+         if ( Platform::SystemInfo.processor.properties & CPU_PROP_SSE )
+         {
+            checkSampling( ts_nlerp_quat_soa_SSE, ts_lerp_point_soa_SSE, "SSE" );
+            checkMatrices( ts_build_node_matrices_SSE, "SSE" );
+         }
+         else if ( i == 0 )
+            warn( "Could not test SSE batch sampling because CPU does not support SSE." );
+#endif
+      }
+   }
+};
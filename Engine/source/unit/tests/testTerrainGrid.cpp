@@ -0,0 +1,140 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+#include "platform/platform.h"
+#include "unit/test.h"
+#include "terrain/terrFile.h"
+#include "math/mRandom.h"
+#include "console/console.h"
+
+using namespace UnitTesting;
+
+CreateUnitTest( TestTerrainGrid, "Terrain/Grid" )
+{
+   /// Rolling hills with a little noise.  The raised copy
+   /// changes every square when we switch between them.
+   static void buildHeights( S32 size, Vector<U16> &heights, Vector<U16> &raised )
+   {
+      MRandomLCG random( 1 );
+      heights.setSize( size * size );
+      raised.setSize( size * size );
+      for ( S32 y=0; y < size; y++ )
+      {
+         for ( S32 x=0; x < size; x++ )
+         {
+            const F32 hills = 256.0f + 128.0f * mSin( x * 0.01f ) * mCos( y * 0.013f );
+            const U16 height = floatToFixed( hills + random.randF() * 4.0f );
+            heights[ x + y * size ] = height;
+            raised[ x + y * size ] = height + floatToFixed( 1.0f );
+         }
+      }
+   }
+
+   static bool gridsMatch( const TerrainFile &a, const TerrainFile &b )
+   {
+      const U32 size = a.getSize();
+      for ( U32 level=0; ( 1U << level ) <= size; level++ )
+      {
+         const U32 step = 1 << level;
+         for ( U32 y=0; y < size; y += step )
+         {
+            for ( U32 x=0; x < size; x += step )
+            {
+               const TerrainSquare *sa = a.findSquare( level, x, y );
+               const TerrainSquare *sb = b.findSquare( level, x, y );
+               if (  sa->minHeight != sb->minHeight ||
+                     sa->maxHeight != sb->maxHeight ||
+                     sa->heightDeviance != sb->heightDeviance ||
+                     sa->flags != sb->flags )
+                  return false;
+            }
+         }
+      }
+
+      return dMemcmp( a.getHeightMap().address(), b.getHeightMap().address(), a.getHeightMap().memSize() ) == 0;
+   }
+
+   void run()
+   {
+      // Big enough that the work is split across the threads.
+      const S32 size = 1024;
+      const S32 iterations = 3;
+
+      Vector<U16> heights, raised;
+      buildHeights( size, heights, raised );
+
+      TerrainFile files[2];
+      files[0].setSize( size, true );
+      files[1].setSize( size, true );
+
+      const S32 oldThreads = TerrainFile::smGridThreads;
+      const S32 threadCounts[2] = { 1, getMax( TerrainFile::getGridThreadCount(), 2 ) };
+
+      for ( U32 i=0; i < 2; i++ )
+      {
+         TerrainFile &file = files[i];
+         TerrainFile::smGridThreads = threadCounts[i];
+
+         U32 gridMs = 0;
+         U32 smoothMs = 0;
+         U32 updateMs = 0;
+
+         for ( S32 j=0; j < iterations; j++ )
+         {
+            file.setHeightMap( heights, false );
+
+            U32 start = Platform::getRealMilliseconds();
+            file.setHeightMap( heights, true );
+            gridMs += Platform::getRealMilliseconds() - start;
+
+            start = Platform::getRealMilliseconds();
+            file.smooth( 0.5f, 4, false );
+            smoothMs += Platform::getRealMilliseconds() - start;
+
+            file.setHeightMap( raised, false );
+
+            start = Platform::getRealMilliseconds();
+            file.updateGrid( Point2I::Zero, Point2I( size, size ) );
+            updateMs += Platform::getRealMilliseconds() - start;
+         }
+
+         Con::printf( "TestTerrainGrid - %dx%d with %d threads: grid build %.1fms, smooth (4 steps) %.1fms, full update %.1fms",
+            size, size, TerrainFile::getGridThreadCount(),
+            (F32)gridMs / iterations, (F32)smoothMs / iterations, (F32)updateMs / iterations );
+      }
+
+      TerrainFile::smGridThreads = oldThreads;
+
+      test( gridsMatch( files[0], files[1] ), "Threaded grid build does not match the serial one!" );
+
+      // Smoothing the same heights on both must give the same result.
+      TerrainFile::smGridThreads = 1;
+      files[0].setHeightMap( heights, true );
+      files[0].smooth( 0.5f, 4, false );
+      TerrainFile::smGridThreads = threadCounts[1];
+      files[1].setHeightMap( heights, true );
+      files[1].smooth( 0.5f, 4, false );
+      TerrainFile::smGridThreads = oldThreads;
+
+      test( gridsMatch( files[0], files[1] ), "Threaded smoothing does not match the serial one!" );
+   }
+};
@@ -42,6 +42,8 @@ function gfxMetricsCallback()
    return "  | GFX |" @
           "  PolyCount: " @ $GFXDeviceStatistics::polyCount @
           "  DrawCalls: " @ $GFXDeviceStatistics::drawCalls @
+          "  Instanced: " @ $GFXDeviceStatistics::instancedDrawCalls @
+          "  Instances: " @ $GFXDeviceStatistics::instancesDrawn @
           "  RTChanges: " @ $GFXDeviceStatistics::renderTargetChanges;
           
 }
@@ -192,6 +194,15 @@ function partMetricsCallback()
    return particleMetricsCallback();
 }
 
+function animMetricsCallback()
+{
+   return "  | Animation |" @
+          "  Pose Hits: " @ $TSPoseCache::hits @
+          "  Misses: " @ $TSPoseCache::misses @
+          "  Skipped: " @ $TSPoseCache::skipped @
+          "  Poses: " @ $TSPoseCache::poses;
+}
+
 
 // alias
 function audioMetricsCallback()
@@ -55,7 +55,7 @@ function defaultParseArgs()
       $logModeSpecified = false;
 
       // Check for dedicated run
-      if( stricmp($arg,"-dedicated") == 0  )
+      if( stricmp($arg,"-dedicated") == 0 || stricmp($arg,"-benchmark") == 0 )
       {
          $userDirs = $defaultGame;
          $dirCount = 1;
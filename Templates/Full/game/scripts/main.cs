@@ -33,7 +33,9 @@ function displayHelp() {
       "Fps Mod options:\n"@
       "  -dedicated             Start as dedicated server\n"@
       "  -connect <address>     For non-dedicated: Connect to a game at <address>\n" @
-      "  -mission <filename>    For dedicated: Load the mission\n"
+      "  -mission <filename>    For dedicated: Load the mission\n"@
+      "  -benchmark <bots> <clients> <ticks> <seed>\n"@
+      "                         Run the server benchmark on the -mission\n"
    );
 }
 
@@ -78,6 +80,25 @@ function parseArgs()
             }
             else
                error("Error: Missing Command Line argument. Usage: -connect <ip_address>");
+
+         //--------------------
+         case "-benchmark":
+            $argUsed[%i]++;
+            if ($Game::argc - %i > 4) {
+               $Server::Dedicated = true;
+               $Benchmark::Enabled = true;
+               $Benchmark::Bots = $Game::argv[%i+1];
+               $Benchmark::Clients = $Game::argv[%i+2];
+               $Benchmark::Ticks = $Game::argv[%i+3];
+               $Benchmark::Seed = $Game::argv[%i+4];
+               $argUsed[%i+1]++;
+               $argUsed[%i+2]++;
+               $argUsed[%i+3]++;
+               $argUsed[%i+4]++;
+               %i += 4;
+            }
+            else
+               error("Error: Missing Command Line argument. Usage: -benchmark <bots> <clients> <ticks> <seed>");
       }
    }
 }
@@ -99,8 +120,12 @@ function onStart()
    // Init the physics plugin.
    physicsInit();
       
-   // Start up the audio system.
-   sfxStartup();
+   // Start up the audio system.  The benchmark always runs
+   // on the Null provider so that results are comparable.
+   if ($Benchmark::Enabled)
+      sfxCreateDevice("Null", "SFX Null Device", false, -1);
+   else
+      sfxStartup();
 
    // Server gets loaded for all sessions, since clients
    // can host in-game servers.
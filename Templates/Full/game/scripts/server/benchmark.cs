@@ -0,0 +1,93 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2012 GarageGames, LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+//-----------------------------------------------------------------------------
+
+// ----------------------------------------------------------------------------
+// Server benchmark
+//
+// Started from the command line with:
+//
+//    -benchmark <bots> <clients> <ticks> <seed> -mission <filename>
+//
+// Runs the server as a dedicated server on the Null GFX device and the
+// Null SFX provider.  Once the mission has loaded the bots and simulated
+// clients are spawned around the first player drop point and the ticks are
+// run back to back.  The per-subsystem timing report is echoed to the
+// console and written to $Benchmark::ReportFile before the server quits.
+// ----------------------------------------------------------------------------
+
+// These may be overridden before the server is created.
+if ( $Benchmark::Radius $= "" )
+   $Benchmark::Radius = 100;
+if ( $Benchmark::RetargetTicks $= "" )
+   $Benchmark::RetargetTicks = 96;
+if ( $Benchmark::BotDataBlock $= "" )
+   $Benchmark::BotDataBlock = "DefaultPlayerData";
+if ( $Benchmark::ReportFile $= "" )
+   $Benchmark::ReportFile = "benchmark.csv";
+
+function getServerBenchmarkCenter()
+{
+   foreach$( %groupName in $Game::defaultPlayerSpawnGroups )
+   {
+      if ( isObject( %groupName ) && %groupName.getCount() > 0 )
+         return %groupName.getObject( 0 ).position;
+   }
+
+   return "0 0 0";
+}
+
+function startServerBenchmark()
+{
+   initServerBenchmark( $Benchmark::Ticks, $Benchmark::Seed, getServerBenchmarkCenter(),
+                        $Benchmark::Radius, $Benchmark::RetargetTicks );
+
+   %bots = serverBenchmarkSpawnBots( $Benchmark::BotDataBlock, $Benchmark::Bots );
+   %clients = serverBenchmarkAddClients( $Benchmark::BotDataBlock, $Benchmark::Clients );
+
+   if ( %bots != $Benchmark::Bots || %clients != $Benchmark::Clients )
+      error( "Benchmark: only spawned " @ %bots @ " bots and " @ %clients @ " clients!" );
+
+   // The ticks are run from the main loop once we return.
+   runServerBenchmark( $Benchmark::ReportFile );
+}
+
+function onServerBenchmarkDone( %avgMs )
+{
+   echo( "Benchmark: average tick " @ %avgMs @ " ms, report written to " @ $Benchmark::ReportFile );
+
+   destroyServerBenchmark();
+   quit();
+}
+
+package ServerBenchmark
+{
+   function onMissionLoaded()
+   {
+      Parent::onMissionLoaded();
+
+      // Let the game finish starting before we take over.
+      schedule( 0, 0, "startServerBenchmark" );
+   }
+};
+
+if ( $Benchmark::Enabled )
+   activatePackage( ServerBenchmark );
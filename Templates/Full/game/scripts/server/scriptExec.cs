@@ -56,3 +56,6 @@ exec("./turret.cs");
 // Load our gametypes
 exec("./gameCore.cs"); // This is the 'core' of the gametype functionality.
 exec("./gameDM.cs"); // Overrides GameCore with DeathMatch functionality.
+
+// Load the optional server benchmark.
+exec("./benchmark.cs");
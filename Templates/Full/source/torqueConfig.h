@@ -52,6 +52,11 @@
 #define TORQUE_DISABLE_MEMORY_MANAGER
 #endif
 
+/// Define me if you want to serve all allocations from the size-class slab
+/// allocator (see platform/platformSlabAllocator.h).  Works with or without
+/// the Torque memory manager; it is ignored when TORQUE_DEBUG_GUARD is set.
+//#define TORQUE_SLAB_ALLOCATOR
+
 /// Define me if you want to disable the virtual mount system.
 //#define TORQUE_DISABLE_VIRTUAL_MOUNT_SYSTEM
 
@@ -169,6 +174,11 @@
 /// texture manager.
 #define TORQUE_FRAME_SIZE     16 << 20
 
+/// This #define is used by the FrameAllocator to set the size of the frame
+/// given to every thread other than the main thread, such as the ThreadPool
+/// worker threads.
+#define TORQUE_THREAD_FRAME_SIZE     1 << 20
+
 // Finally, we define some dependent #defines. This enables some subsidiary
 // functionality to get automatically turned on in certain configurations.
 